@@ -2,14 +2,16 @@
 
 BasicPixel main(BasicVertex vsIn){
     BasicPixel vsOut;
-    float4 world = mul(float4(vsIn.posL, 1.0f), objConst.toWorld);
+    ObjectConstants objConst = instances[instConst.firstInstance + vsIn.instanceID];
+    float4 world = mul(float4(DequantizePosition(vsIn.posQ), 1.0f), objConst.toWorld);
 
     vsOut.posW = world.xyz;
     vsOut.posH = mul(world, mainConst.view);
     vsOut.posH = mul(vsOut.posH, mainConst.proj);
 
-    vsIn.normalL   = normalize(vsIn.normalL);
-    vsOut.normalW  = normalize(mul(vsIn.normalL, transpose((float3x3)objConst.toLocal)));
+    float3 normalL = DecodeOctahedral(vsIn.normalQ);
+    vsOut.normalW  = normalize(mul(normalL, transpose((float3x3)objConst.toLocal)));
+    vsOut.objectID = objConst.objectIndex;
 
     return vsOut;
 }
\ No newline at end of file
@@ -10,10 +10,17 @@ struct MainFrameConstants{
     float  time;
 };
 
+// one instance of an instanced draw, padded to the 144 byte ObjectConstBuffer stride
 struct ObjectConstants{
     matrix toWorld;
     matrix toLocal;
-    uint   objectIndex;   
+    uint   objectIndex;
+    uint3  padding;
+};
+
+// root constant per draw, SV_InstanceID does not include the start instance
+struct InstanceConstants{
+    uint firstInstance;
 };
 
 struct MaterialConstants{
@@ -33,9 +40,18 @@ struct MaterialConstants{
     float2 tex5TexScale;
 };
 
+// root constants per draw, positions are stored as snorm16 inside the mesh bounds
+struct MeshConstants{
+    float4 positionCenter;
+    float4 positionExtent;
+};
+
 ConstantBuffer<MainFrameConstants> mainConst : register(b0);
-ConstantBuffer<ObjectConstants>    objConst  : register(b1);
 ConstantBuffer<MaterialConstants>  matConst  : register(b2);
+ConstantBuffer<MeshConstants>      meshConst : register(b3);
+ConstantBuffer<InstanceConstants>  instConst : register(b4);
+
+StructuredBuffer<ObjectConstants>  instances : register(t6);
 
 SamplerState pointSampler : register(s0);
 SamplerState anisoSampler : register(s1);
@@ -48,30 +64,47 @@ Texture2D<uint>   tex4 : register(t4);
 
 Texture2D<float4>   luminance : register(t5);
 
+// compact vertex layout, see Vertex0 / Vertex1
 struct BasicVertex{
-    float3 posL    : POSITION;
-    float3 normalL : NORMAL;
+    float4 posQ       : POSITION;
+    float2 normalQ    : NORMAL;
+    uint   instanceID : SV_InstanceID;
 };
 
 struct BasicPixel{
     float4 posH    : SV_POSITION;
     float3 posW    : POSITION;
     float3 normalW : NORMAL;
+    nointerpolation uint objectID : OBJECTID;
 };
 
 struct TexVertex{
-    float3 posL     : POSITION;
-    float3 normalL  : NORMAL;
-    float4 tangent  : TANGENT;
-    float2 texCoord : TEXCOORD;
+    float4 posQ       : POSITION;
+    float2 normalQ    : NORMAL;
+    float4 tangent    : TANGENT;
+    float2 texCoord   : TEXCOORD;
+    uint   instanceID : SV_InstanceID;
 };
 
+float3 DequantizePosition(float4 posQ){
+    return posQ.xyz * meshConst.positionExtent.xyz + meshConst.positionCenter.xyz;
+}
+
+float3 DecodeOctahedral(float2 e){
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float  t = saturate(-n.z);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 struct TexPixel{
     float4 posH      : SV_POSITION;
     float3 posW      : POSITION;
     float3 normalW   : NORMAL;
     float4 tangent   : TANGENT;
     float2 texCoord  : TEXCOORD;
+    nointerpolation uint objectID : OBJECTID;
 };
 
 struct GBuffer{
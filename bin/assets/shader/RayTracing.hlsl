@@ -33,6 +33,8 @@ struct RayTraceMeshInfo{
     uint tangentOffsetBytes;
     uint uvOffsetBytes;
     uint matIndex;
+    float3 positionCenter;
+    float3 positionExtent;
 };
 
 struct Payload{
@@ -53,6 +55,38 @@ StructuredBuffer<MaterialConstants> matConst : register(t2, space1);
 ByteAddressBuffer indices     : register(t3, space1);
 ByteAddressBuffer attributes  : register(t4, space1);
 
+// two snorm16 packed in a uint, low half first
+float2 UnpackSNorm16x2(uint packed){
+    int2 value = int2(int(packed << 16) >> 16, int(packed) >> 16);
+    return max(float2(value) / 32767.0f, -1.0f);
+}
+
+float2 UnpackHalf2(uint packed){
+    return float2(f16tof32(packed), f16tof32(packed >> 16));
+}
+
+float3 DecodeOctahedral(float2 e){
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float  t = saturate(-n.z);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+// vertex attributes of the compact layout in Vertex0 / Vertex1
+float3 LoadPosition(RayTraceMeshInfo info, uint index){
+    const uint2 packed = attributes.Load2(info.positionOffsetBytes+index*8);
+    return float3(UnpackSNorm16x2(packed.x), UnpackSNorm16x2(packed.y).x) * info.positionExtent + info.positionCenter;
+}
+
+float3 LoadNormal(RayTraceMeshInfo info, uint index){
+    return DecodeOctahedral(UnpackSNorm16x2(attributes.Load(info.normalOffsetBytes+index*4)));
+}
+
+float2 LoadTexCoord(RayTraceMeshInfo info, uint index){
+    return UnpackHalf2(attributes.Load(info.uvOffsetBytes+index*4));
+}
+
 float3 RayPlaneIntersection(float3 planeOrigin, float3 planeNormal, float3 rayOrigin, float3 rayDirection){
     float t = dot(-planeNormal, rayOrigin - planeOrigin) / dot(planeNormal, rayDirection);
     return rayOrigin + rayDirection * t;
@@ -231,10 +265,10 @@ void Hit(inout Payload payload, in BuiltInTriangleIntersectionAttributes attr){
         const float3 rayDirection = WorldRayDirection();
         const float3 origin = WorldRayOrigin() + rayDirection * RayTCurrent();
 
-        const float3 normal0 = asfloat(attributes.Load3(info.normalOffsetBytes+ii.x*12));
-        const float3 normal1 = asfloat(attributes.Load3(info.normalOffsetBytes+ii.y*12));
-        const float3 normal2 = asfloat(attributes.Load3(info.normalOffsetBytes+ii.z*12));
-        const float3 p0 = mul(float4(asfloat(attributes.Load3(info.positionOffsetBytes+ii.x*12)), 1.0f), ObjectToWorld4x3()).xyz;
+        const float3 normal0 = LoadNormal(info, ii.x);
+        const float3 normal1 = LoadNormal(info, ii.y);
+        const float3 normal2 = LoadNormal(info, ii.z);
+        const float3 p0 = mul(float4(LoadPosition(info, ii.x), 1.0f), ObjectToWorld4x3()).xyz;
         
         float3 normal = normalize(mul(bary.x * normal0 + bary.y * normal1 + bary.z * normal2, (float3x3)WorldToObject3x4()));
         if(dot(rayDirection, normal) > 0.0f){
@@ -272,9 +306,9 @@ void Hit(inout Payload payload, in BuiltInTriangleIntersectionAttributes attr){
            payload.color = mat.baseColor.bgr; 
         }
         else{
-            const float2 uv0 = asfloat(attributes.Load2(info.uvOffsetBytes+ii.x*8));
-            const float2 uv1 = asfloat(attributes.Load2(info.uvOffsetBytes+ii.y*8));
-            const float2 uv2 = asfloat(attributes.Load2(info.uvOffsetBytes+ii.z*8));
+            const float2 uv0 = LoadTexCoord(info, ii.x);
+            const float2 uv1 = LoadTexCoord(info, ii.y);
+            const float2 uv2 = LoadTexCoord(info, ii.z);
             const float2 uv = bary.x * uv0 + bary.y * uv1 + bary.z * uv2;
             payload.color = essisiveTex.SampleLevel(pointSampler, uv, 0).rgb;
         }  
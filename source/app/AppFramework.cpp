@@ -39,11 +39,14 @@ int AppFramework::Run(Application* pApp, HINSTANCE hInstance, int nCmdShow)
     while (msg.message != WM_QUIT)
     {
 
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        // everything queued goes before the next tick, which may sleep until its frame is due
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
         {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
+            if (msg.message == WM_QUIT) break;
         }
+        if (msg.message == WM_QUIT) break;
 
         pApp->OnTick();
     }
@@ -9,11 +9,15 @@
 #include "dxcapi.h"
 #include "dxcapi.use.h"
 
+#include <cstring>
+
 Pipeline::Pipeline(std::string& name, uint16_t width, uint16_t height)
     : Application(name, width, height)
     , m_openDenoising(false)
     , m_openFrameBlend(false)
     , m_openReprojection(false)
+    , m_openFrustumCulling(true)
+    , m_renderOnDemand(false)
     , m_alpha(1.0f)
     , m_beta(1.0f)
     , m_gamma(1.0f)
@@ -21,6 +25,7 @@ Pipeline::Pipeline(std::string& name, uint16_t width, uint16_t height)
     , m_isLeftMouseDown(false)
     , m_lastMousePosX(0)
     , m_lastMousePosY(0)
+    , m_renderedChange(0)
     , m_cameraMode(0)
     , m_camera(nullptr)
     , m_rtvDescriptorSize(0)
@@ -113,15 +118,17 @@ void Pipeline::InitD3D(){
                 D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
                 1, 5, 0, 0
             };
-            CD3DX12_ROOT_PARAMETER rootParameter[5] = {};
-            rootParameter[0].InitAsConstantBufferView(1);
+            CD3DX12_ROOT_PARAMETER rootParameter[7] = {};
+            rootParameter[0].InitAsShaderResourceView(6);
             rootParameter[1].InitAsConstantBufferView(0);
             rootParameter[2].InitAsConstantBufferView(2);
             rootParameter[3].InitAsDescriptorTable(1, &gbuffer);
             rootParameter[4].InitAsDescriptorTable(1, &luminance);
+            rootParameter[5].InitAsConstants(sizeof(MeshConstants) / 4, 3);
+            rootParameter[6].InitAsConstants(1, 4);
 
             CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc(
-                5, rootParameter, 2, samplers,
+                7, rootParameter, 2, samplers,
                 D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
             );
 
@@ -320,9 +327,13 @@ void Pipeline::InitD3D(){
     dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     ThrowIfFailed(dxDevice->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&m_dsvHeap)));
 
-    auto model = Dx12Model("assets\\gltf\\Room\\scene.gltf");
+    // the package AssetCooker wrote for the scene when it is current, the glTF otherwise
+    ScenePackage package("assets\\gltf\\Room\\scene.pak");
+    auto model = package.IsValid() ? Dx12Model(package) : Dx12Model("assets\\gltf\\Room\\scene.gltf");
     m_scene = std::move(model.root);
-    m_scene->SetMatrix(&GeoMath::Matrix4f::Scale(1.0f, -1.0f, 1.0f), nullptr, nullptr);
+    GeoMath::Transform flipY;
+    flipY.scale = GeoMath::Vector3f(1.0f, -1.0f, 1.0f);
+    m_scene->SetTransform(flipY);
 
     m_cbvHeap        = std::move(model.cbvHeap);
     m_matConstBuffer = std::move(model.matConstBuffer);
@@ -337,7 +348,9 @@ void Pipeline::InitD3D(){
     float aspRatio = GetAspectRatio();
     m_camera = new Dx12Camera(0, m_scene.get());
     m_camera->SetLens(nullptr, nullptr, &aspRatio, nullptr);
-    m_camera->SetMatrix(nullptr, nullptr, &GeoMath::Matrix4f::Translation(0.0, 5.0, -10.0f));
+    GeoMath::Transform eye;
+    eye.translation = GeoMath::Vector3f(0.0f, 5.0f, -10.0f);
+    m_camera->SetTransform(eye);
 
     m_scene->AddChild(std::unique_ptr<SceneNode>(m_camera));
 
@@ -509,25 +522,74 @@ void Pipeline::InitGUI(){
 }
 
 void Pipeline::OnTick(){
-    static const std::chrono::duration<double, std::ratio<1, 60>> deltaTime(1);
-    static std::chrono::time_point<std::chrono::steady_clock> startTime;
-    static std::chrono::time_point<std::chrono::steady_clock> endTime;
+    // not due yet, sleep and return so the messages that came in meanwhile are handled before the frame
+    if(!m_scheduler.IsFrameDue()){
+        m_scheduler.WaitForFrame();
+        return;
+    }
 
-    endTime = std::chrono::steady_clock::now();
-    if(endTime - startTime > deltaTime){
-        startTime = std::chrono::steady_clock::now();
+    const uint32_t steps = m_scheduler.BeginFrame();
+    for(uint32_t step = 0; step < steps; step++){
         OnUpdate();
+    }
+
+    // on demand the simulation keeps its steps, a frame is only rendered when it would differ
+    const bool isRendered = !m_renderOnDemand || IsRedrawNeeded();
+    if(isRendered){
         OnRender();
+        m_redraw.OnFrameRendered();
+    }
+    m_scheduler.EndFrame();
+
+    // nothing can change before the next step or a message, without present or a frame time to pace
+    // the loop it would spin a core on a still scene. A scene no step would change waits for messages only
+    if(!isRendered){
+        const DWORD wait = m_scene->IsUpdateNeeded()
+            ? static_cast<DWORD>(m_scheduler.GetTimeToNextStep() * 1000.0 + 0.999)
+            : INFINITE;
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, wait, QS_ALLINPUT);
+    }
+}
+
+bool Pipeline::IsRedrawNeeded(){
+    // the input and settings invalidate through the messages, the scene and the view are compared here
+    const GeoMath::Matrix4f viewProj = m_camera->GetView() * m_camera->GetProj();
+    if(m_scene->GetChangeGeneration() != m_renderedChange || memcmp(&viewProj, &m_renderedViewProj, sizeof(viewProj)) != 0){
+        m_renderedChange   = m_scene->GetChangeGeneration();
+        m_renderedViewProj = viewProj;
+        m_redraw.Invalidate();
     }
+
+    m_redraw.SetAccumulation(m_openFrameBlend, m_alpha);
+    return m_redraw.IsRedrawNeeded();
 }
 
 void Pipeline::OnUpdate(){
+    m_scene->OnUpdate(static_cast<float>(m_scheduler.GetSettings().stepTime));
+}
+
+void Pipeline::PrepareFrame(){
+    // the changes go into the frame resource this frame renders from, not the one before it
+    m_graphicsMgr->NextFrame();
+
     m_graphicsMgr->GetMainConstBuffer().alpha = m_alpha;
-    m_scene->OnUpdate();
+    // above the step rate frames blend the last two steps, or motion would judder at the step rate
+    m_scene->Interpolate(m_scheduler.GetInterpolation());
+    m_scene->Sync(m_graphicsMgr->GetFrameResource().sceneGeneration);
+
+    m_scene->SetView(m_camera->GetView());
+    if(m_openFrustumCulling){
+        m_scene->Cull(GeoMath::Frustum::FromMatrix(m_camera->GetView() * m_camera->GetProj()));
+    }
+    else{
+        m_scene->DisableCulling();
+    }
+
     m_graphicsMgr->OnUpdate();
 }
 
 void Pipeline::OnRender(){
+    PrepareFrame();
 
     auto& currFrameRes = m_graphicsMgr->GetFrameResource();
     auto  cmdList      = m_graphicsMgr->GetCommandList();
@@ -752,12 +814,31 @@ void Pipeline::RenderGUI(){
         ImGui::Checkbox("Bilateral Filter", &m_openDenoising);
         ImGui::Checkbox("Temporal Blend", &m_openFrameBlend);
         ImGui::Checkbox("Reprojection", &m_openReprojection);
+        ImGui::Checkbox("Frustum Culling", &m_openFrustumCulling);
+        ImGui::Checkbox("Render On Demand", &m_renderOnDemand);
         ImGui::Separator();
 
         ImGui::SliderFloat("Alpha", &m_alpha, 0.0f, 1.0f);
         ImGui::Separator();
 
+        ImGui::Text("Visible nodes %zu / %zu",
+            m_scene->GetCullingSet().GetVisibleCount(), m_scene->GetCullingSet().GetSize()
+        );
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        ImGui::Separator();
+
+        Utility::FrameScheduler::Settings settings = m_scheduler.GetSettings();
+        int frameRate = settings.frameTime > 0.0 ? static_cast<int>(1.0 / settings.frameTime + 0.5) : 0;
+        if(ImGui::SliderInt("Frame Rate (0 = vsync)", &frameRate, 0, 240)){
+            settings.frameTime = frameRate > 0 ? 1.0 / frameRate : 0.0;
+            m_scheduler.SetSettings(settings);
+        }
+        const auto& average = m_scheduler.GetAverage();
+        ImGui::Text("CPU %.3f ms, slack %.3f ms", average.cpuTime * 1000.0, average.slack * 1000.0);
+        ImGui::Text("Sleep %.3f ms, yield %.3f ms, %.2f steps/frame", average.sleepTime * 1000.0, average.yieldTime * 1000.0, average.steps);
+        if(m_renderOnDemand){
+            ImGui::Text("Frames since change %u / %u", m_redraw.GetFramesSinceChange(), m_redraw.GetFramesToConverge());
+        }
         ImGui::End();
     }
 
@@ -875,6 +956,11 @@ void Pipeline::OnKeyUp(const uint16_t key, const int16_t x, const int16_t y){
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT Pipeline::MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam){
 
+    // input may change the picture or the gui over it
+    if((msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST) || (msg >= WM_KEYFIRST && msg <= WM_KEYLAST) || msg == WM_SIZE){
+        m_redraw.Invalidate();
+    }
+
     if(ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam)){
         return true;
     }
@@ -3,6 +3,8 @@
 #include "Application.hpp"
 #include "Dx12SceneNode.hpp"
 #include "GraphicsManager.hpp" 
+#include "FrameScheduler.hpp"
+#include "RedrawTracker.hpp"
 
 class Pipeline : public Application{
 public:
@@ -27,6 +29,10 @@ public:
 private:
     void InitD3D();
     void InitGUI();
+    // per frame part of the update, whatever number of steps ran before
+    void PrepareFrame();
+    // whether the frame would differ from the one on screen, for the render on demand mode
+    bool IsRedrawNeeded();
 
     void RenderScene();
     void RenderGUI();
@@ -36,6 +42,8 @@ protected:
     bool                               m_openDenoising;
     bool                               m_openFrameBlend;
     bool                               m_openReprojection;
+    bool                               m_openFrustumCulling;
+    bool                               m_renderOnDemand;
     float                              m_alpha;
     float                              m_beta;
     float                              m_gamma;
@@ -45,6 +53,12 @@ protected:
     uint16_t                           m_lastMousePosX;
     uint16_t                           m_lastMousePosY;
 
+    Utility::FrameScheduler            m_scheduler;
+    Utility::RedrawTracker             m_redraw;
+    // scene change and view of the last frame rendered
+    uint64_t                           m_renderedChange;
+    GeoMath::Matrix4f                  m_renderedViewProj;
+
     int                                m_cameraMode;
     Dx12Camera*                        m_camera;
     std::unique_ptr<Scene>             m_scene;
@@ -0,0 +1,346 @@
+#include "Animation.hpp"
+
+#include <cmath>
+
+namespace{
+
+    // cubic Hermite basis at s in [0, 1], for the values and the tangents scaled by the key interval
+    struct Hermite{
+        float value0, tangent0, value1, tangent1;
+
+        explicit Hermite(float s){
+            const float s2 = s * s;
+            const float s3 = s2 * s;
+            value0   = 2.0f * s3 - 3.0f * s2 + 1.0f;
+            tangent0 = s3 - 2.0f * s2 + s;
+            value1   = -2.0f * s3 + 3.0f * s2;
+            tangent1 = s3 - s2;
+        }
+    };
+
+    // position of time between two keys, 0 for a step or a time outside them
+    float KeyWeight(const float* keyTimes, uint32_t key, uint32_t next, float time, AnimationClip::Interpolation interpolation){
+        if(next == key || interpolation == AnimationClip::Interpolation::Step) return 0.0f;
+        float weight = (time - keyTimes[key]) / (keyTimes[next] - keyTimes[key]);
+        return weight < 0.0f ? 0.0f : (weight > 1.0f ? 1.0f : weight);
+    }
+
+}
+
+void AnimationClip::AddChannel(uint32_t target, Path path, Interpolation interpolation, const float* times, const float* values, uint32_t keyCount){
+    const uint32_t componentCount = path == Path::Rotation ? 4 : 3;
+    const uint32_t firstKey     = static_cast<uint32_t>(m_times.size());
+    const uint32_t firstTangent = static_cast<uint32_t>(m_inTangents[0].size());
+    const bool     isCubic      = interpolation == Interpolation::CubicSpline;
+    // the value sits between the two tangents of a cubic key
+    const uint32_t stride = isCubic ? 3 * componentCount : componentCount;
+    const uint32_t offset = isCubic ? componentCount : 0;
+
+    m_times.insert(m_times.end(), times, times + keyCount);
+    for(uint32_t component = 0; component < 4; component++){
+        const bool isUsed = component < componentCount;
+        for(uint32_t key = 0; key < keyCount; key++){
+            const float* keyValues = values + key * stride + component;
+            m_values[component].emplace_back(isUsed ? keyValues[offset] : 0.0f);
+            if(!isCubic) continue;
+            m_inTangents[component].emplace_back(isUsed ? keyValues[0] : 0.0f);
+            m_outTangents[component].emplace_back(isUsed ? keyValues[2 * componentCount] : 0.0f);
+        }
+    }
+    if(keyCount > 0) m_duration = times[keyCount - 1] > m_duration ? times[keyCount - 1] : m_duration;
+
+    // at the end of its path group, the later groups move up by one
+    const int group = static_cast<int>(path);
+    m_channels.insert(m_channels.begin() + m_pathEnds[group], {target, path, interpolation, firstKey, keyCount, firstTangent});
+    for(int i = group; i < static_cast<int>(PathCount); i++){
+        m_pathEnds[i]++;
+    }
+}
+
+void AnimationClip::AddWeightChannel(uint32_t target, Interpolation interpolation, const float* times, const float* values, uint32_t keyCount, uint32_t weightCount){
+    const uint32_t firstKey   = static_cast<uint32_t>(m_times.size());
+    const uint32_t firstValue = static_cast<uint32_t>(m_weightValues.size());
+    const uint32_t valueCount = keyCount * weightCount * (interpolation == Interpolation::CubicSpline ? 3 : 1);
+
+    m_times.insert(m_times.end(), times, times + keyCount);
+    m_weightValues.insert(m_weightValues.end(), values, values + valueCount);
+    if(keyCount > 0) m_duration = times[keyCount - 1] > m_duration ? times[keyCount - 1] : m_duration;
+
+    m_weightChannels.push_back({target, interpolation, firstKey, keyCount, weightCount, firstValue});
+}
+
+void Animator::Stop(uint32_t playback){
+    if(playback < m_playbacks.size()){
+        m_playbacks[playback].isPlaying = false;
+        m_playbacks[playback].clip.reset();
+    }
+}
+
+bool Animator::IsAnyPlaying() const{
+    return std::any_of(m_playbacks.begin(), m_playbacks.end(), [](const Playback& p){ return p.isPlaying; });
+}
+
+void Animator::Update(float deltaTime){
+    m_update++;
+    m_changed.clear();
+    m_changedMorphs.clear();
+
+    for(auto& playback : m_playbacks){
+        if(!playback.isPlaying) continue;
+
+        const float duration = playback.clip->GetDuration();
+        float time = playback.time + deltaTime * playback.speed;
+        bool  isLast = false;
+        if(playback.isLooping && duration > 0.0f){
+            time = std::fmod(time, duration);
+            time = time < 0.0f ? time + duration : time;
+        }
+        else if(time >= duration || time <= 0.0f){
+            time   = time >= duration ? duration : 0.0f;
+            isLast = deltaTime * playback.speed != 0.0f;
+        }
+        playback.time = time;
+
+        Sample(playback);
+        if(isLast){
+            playback.isPlaying = false;
+            playback.clip.reset();
+        }
+    }
+}
+
+void Animator::Sample(Playback& playback){
+    SamplePath(playback, AnimationClip::Path::Translation);
+    SamplePath(playback, AnimationClip::Path::Rotation);
+    SamplePath(playback, AnimationClip::Path::Scale);
+    SampleWeights(playback);
+}
+
+void Animator::SamplePath(Playback& playback, AnimationClip::Path path){
+    const AnimationClip& clip = *playback.clip;
+    const uint32_t begin = clip.GetPathBegin(path);
+    const uint32_t end   = clip.GetPathEnd(path);
+    const uint32_t count = end - begin;
+    if(count == 0) return;
+
+    const uint32_t componentCount = path == AnimationClip::Path::Rotation ? 4 : 3;
+    const auto&    channels = clip.GetChannels();
+    const float*   times    = clip.GetTimes();
+    const float*   values[4] = {clip.GetValues(0), clip.GetValues(1), clip.GetValues(2), clip.GetValues(3)};
+    const float*   inTangents[4]  = {clip.GetInTangents(0), clip.GetInTangents(1), clip.GetInTangents(2), clip.GetInTangents(3)};
+    const float*   outTangents[4] = {clip.GetOutTangents(0), clip.GetOutTangents(1), clip.GetOutTangents(2), clip.GetOutTangents(3)};
+
+    for(uint32_t c = 0; c < componentCount; c++){
+        m_from[c].resize(count);
+        m_to[c].resize(count);
+    }
+    m_weights.resize(count);
+
+    // gather the key pair around the time of every channel
+    for(uint32_t i = 0; i < count; i++){
+        const AnimationClip::Channel& channel = channels[begin + i];
+        const float* keyTimes = times + channel.firstKey;
+
+        uint32_t key = Seek(keyTimes, channel.keyCount, playback.cursors[begin + i], playback.time);
+        playback.cursors[begin + i] = key;
+
+        uint32_t next   = key + 1 < channel.keyCount ? key + 1 : key;
+        float    weight = KeyWeight(keyTimes, key, next, playback.time, channel.interpolation);
+
+        if(channel.interpolation == AnimationClip::Interpolation::CubicSpline && next != key){
+            // evaluated here, the batch passes it through with a weight of 0
+            const Hermite h(weight);
+            const float   interval = keyTimes[next] - keyTimes[key];
+            float length = 0.0f;
+            for(uint32_t c = 0; c < componentCount; c++){
+                const float v = h.value0   * values[c][channel.firstKey + key]
+                              + h.tangent0 * interval * outTangents[c][channel.firstTangent + key]
+                              + h.value1   * values[c][channel.firstKey + next]
+                              + h.tangent1 * interval * inTangents[c][channel.firstTangent + next];
+                m_from[c][i] = v;
+                length += v * v;
+            }
+            if(path == AnimationClip::Path::Rotation && length > 0.0f){
+                const float scale = 1.0f / std::sqrt(length);
+                for(uint32_t c = 0; c < 4; c++) m_from[c][i] *= scale;
+            }
+            for(uint32_t c = 0; c < componentCount; c++) m_to[c][i] = m_from[c][i];
+            m_weights[i] = 0.0f;
+            continue;
+        }
+        m_weights[i] = weight;
+
+        for(uint32_t c = 0; c < componentCount; c++){
+            m_from[c][i] = values[c][channel.firstKey + key];
+            m_to[c][i]   = values[c][channel.firstKey + next];
+        }
+    }
+
+    // the result goes back into m_from
+    if(path == AnimationClip::Path::Rotation){
+        GeoMath::QuaternionStream out{m_from[0].data(), m_from[1].data(), m_from[2].data(), m_from[3].data()};
+        GeoMath::SlerpQuaternions(
+            out, GeoMath::ConstQuaternionStream(m_to[0].data(), m_to[1].data(), m_to[2].data(), m_to[3].data()),
+            m_weights.data(), out, count
+        );
+    }
+    else{
+        for(uint32_t c = 0; c < 3; c++){
+            GeoMath::LerpFloats(m_from[c].data(), m_to[c].data(), m_weights.data(), m_from[c].data(), count);
+        }
+    }
+
+    // scatter into the poses
+    for(uint32_t i = 0; i < count; i++){
+        const uint32_t pose = playback.poses[begin + i];
+        GeoMath::Transform& transform = m_poses[pose];
+        switch(path){
+            case AnimationClip::Path::Translation:
+                transform.translation = GeoMath::Vector3f(m_from[0][i], m_from[1][i], m_from[2][i]);
+                break;
+            case AnimationClip::Path::Rotation:
+                for(uint32_t c = 0; c < 4; c++) transform.rotation[c] = m_from[c][i];
+                break;
+            case AnimationClip::Path::Scale:
+                transform.scale = GeoMath::Vector3f(m_from[0][i], m_from[1][i], m_from[2][i]);
+                break;
+        }
+
+        if(m_changedUpdates[pose] != m_update){
+            m_changedUpdates[pose] = m_update;
+            m_changed.emplace_back(pose);
+        }
+    }
+}
+
+void Animator::SampleWeights(Playback& playback){
+    const AnimationClip& clip = *playback.clip;
+    const auto&  channels = clip.GetWeightChannels();
+    const float* times    = clip.GetTimes();
+    const float* values   = clip.GetWeightValues();
+
+    // a handful of nodes with a few weights each, not worth gathering into a batch
+    for(size_t i = 0; i < channels.size(); i++){
+        const AnimationClip::WeightChannel& channel = channels[i];
+        const float* keyTimes = times + channel.firstKey;
+
+        uint32_t key = Seek(keyTimes, channel.keyCount, playback.weightCursors[i], playback.time);
+        playback.weightCursors[i] = key;
+
+        const uint32_t next   = key + 1 < channel.keyCount ? key + 1 : key;
+        const float    weight = KeyWeight(keyTimes, key, next, playback.time, channel.interpolation);
+        const uint32_t count  = channel.weightCount;
+        const float*   keyValues = values + channel.firstValue;
+
+        const uint32_t morph = playback.morphs[i];
+        std::vector<float>& out = m_morphWeights[morph];
+        if(out.size() < count) out.resize(count, 0.0f);
+
+        if(channel.interpolation == AnimationClip::Interpolation::CubicSpline){
+            // in tangents, values and out tangents of a key in turn
+            const float* from = keyValues + key * 3 * count;
+            const float* to   = keyValues + next * 3 * count;
+            if(next == key){
+                for(uint32_t w = 0; w < count; w++) out[w] = from[count + w];
+            }
+            else{
+                const Hermite h(weight);
+                const float   interval = keyTimes[next] - keyTimes[key];
+                for(uint32_t w = 0; w < count; w++){
+                    out[w] = h.value0 * from[count + w] + h.tangent0 * interval * from[2 * count + w]
+                           + h.value1 * to[count + w]   + h.tangent1 * interval * to[w];
+                }
+            }
+        }
+        else{
+            const float* from = keyValues + key * count;
+            const float* to   = keyValues + next * count;
+            for(uint32_t w = 0; w < count; w++) out[w] = from[w] + (to[w] - from[w]) * weight;
+        }
+
+        if(m_morphChangedUpdates[morph] != m_update){
+            m_morphChangedUpdates[morph] = m_update;
+            m_changedMorphs.emplace_back(morph);
+        }
+    }
+}
+
+Skin::Skin(uint32_t meshNode, std::vector<uint32_t> joints, std::vector<GeoMath::Matrix4f> inverseBinds)
+    : m_meshNode(meshNode)
+    , m_joints(std::move(joints))
+    , m_inverseBinds(std::move(inverseBinds))
+    , m_palette(m_joints.size())
+{
+    m_inverseBinds.resize(m_joints.size());
+}
+
+bool Skin::UpdatePalette(const SceneHierarchy& hierarchy, bool isForced){
+    bool isChanged = isForced || m_version == 0 || hierarchy.IsChanged(m_meshNode);
+    for(size_t j = 0; j < m_joints.size() && !isChanged; j++){
+        isChanged = hierarchy.IsChanged(m_joints[j]);
+    }
+    if(!isChanged) return false;
+
+    GeoMath::Matrix4f toMesh = hierarchy.GetWorld(m_meshNode).Inverse(hierarchy.GetWorldType(m_meshNode));
+    for(size_t j = 0; j < m_joints.size(); j++){
+        m_palette[j] = m_inverseBinds[j] * hierarchy.GetWorld(m_joints[j]) * toMesh;
+    }
+    if(m_method == Method::DualQuaternion){
+        m_dualQuaternions.resize(m_palette.size());
+        GeoMath::ConvertToDualQuaternions(m_palette.data(), m_dualQuaternions.data(), m_palette.size());
+    }
+    m_version++;
+    return true;
+}
+
+GeoMath::BoundingBox Skin::GetPoseBounds(const GeoMath::BoundingBox& bindBounds) const{
+    if(bindBounds.IsEmpty() || m_palette.empty()) return bindBounds;
+
+    if(m_method == Method::LinearBlend){
+        GeoMath::BoundingBox bounds;
+        for(const auto& matrix : m_palette){
+            bounds = bounds.Merge(bindBounds.Transform(matrix));
+        }
+        return bounds;
+    }
+
+    // a blended dual quaternion turns the vertex about the origin of the mesh node and moves it by at
+    // most the longest joint translation over the length of the blended rotation. With 4 influences
+    // summing to 1 that length squared is at least 1/4 + 3/4 cos(2 angle), angle the widest between
+    // two joints, as the blend aligns every joint with the first of the vertex
+    float cosine = 1.0f, translation = 0.0f;
+    for(size_t i = 0; i < m_dualQuaternions.size(); i++){
+        const float* a = m_dualQuaternions[i].real;
+        for(size_t j = i + 1; j < m_dualQuaternions.size(); j++){
+            const float* b = m_dualQuaternions[j].real;
+            const float dot = std::abs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+            cosine = dot < cosine ? dot : cosine;
+        }
+        const GeoMath::Matrix4f& matrix = m_palette[i];
+        const float length = std::sqrt(matrix.data[3][0] * matrix.data[3][0] + matrix.data[3][1] * matrix.data[3][1] + matrix.data[3][2] * matrix.data[3][2]);
+        translation = length > translation ? length : translation;
+    }
+    const float blendLength2 = 0.25f + 0.75f * (2.0f * cosine * cosine - 1.0f);
+    if(blendLength2 < MinBlendLength2) return GeoMath::BoundingBox(GeoMath::Vector3f(0.0f, 0.0f, 0.0f), GeoMath::Vector3f(Unbounded, Unbounded, Unbounded));
+
+    const GeoMath::Vector3f corner(
+        std::abs(bindBounds.center.x) + bindBounds.extent.x,
+        std::abs(bindBounds.center.y) + bindBounds.extent.y,
+        std::abs(bindBounds.center.z) + bindBounds.extent.z
+    );
+    const float radius = std::sqrt(corner.x * corner.x + corner.y * corner.y + corner.z * corner.z) + translation / std::sqrt(blendLength2);
+    return GeoMath::BoundingBox(GeoMath::Vector3f(0.0f, 0.0f, 0.0f), GeoMath::Vector3f(radius, radius, radius));
+}
+
+void Skin::SetMethod(Method method){
+    if(method == m_method) return;
+    m_method = method;
+    if(m_version == 0) return;
+
+    // the next skinning picks the new method up through the version
+    if(m_method == Method::DualQuaternion){
+        m_dualQuaternions.resize(m_palette.size());
+        GeoMath::ConvertToDualQuaternions(m_palette.data(), m_dualQuaternions.data(), m_palette.size());
+    }
+    m_version++;
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include "GeoMath.hpp"
+#include "GeoMathBatch.hpp"
+#include "SceneHierarchy.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Keyframes of one animation, the times and every value component in their own array shared
+// by all channels. Channels stay grouped by the path they drive, so each path is sampled in one batch.
+// Blend shape weights have channels of their own, a node has as many weights as its mesh has targets.
+class AnimationClip{
+public:
+    enum class Path : uint8_t{ Translation = 0, Rotation = 1, Scale = 2 };
+    // CubicSpline is the Hermite spline of glTF, every key with an in and an out tangent
+    enum class Interpolation : uint8_t{ Step, Linear, CubicSpline };
+
+    struct Channel{
+        uint32_t      target;       // hierarchy slot of the node
+        Path          path;
+        Interpolation interpolation;
+        uint32_t      firstKey;
+        uint32_t      keyCount;
+        uint32_t      firstTangent; // in GetInTangents and GetOutTangents, CubicSpline only
+    };
+
+    struct WeightChannel{
+        uint32_t      target;
+        Interpolation interpolation;
+        uint32_t      firstKey;
+        uint32_t      keyCount;
+        uint32_t      weightCount;  // per key
+        uint32_t      firstValue;   // in GetWeightValues, laid out as given to AddWeightChannel
+    };
+
+    // times ascending, 3 values per key or 4 for rotations (x, y, z, w). A CubicSpline key holds
+    // the in tangent, the value and the out tangent in turn, the way glTF stores them
+    void AddChannel(uint32_t target, Path path, Interpolation interpolation, const float* times, const float* values, uint32_t keyCount);
+    // blend shape weights of the mesh of a node, weightCount per key or three runs of them for CubicSpline
+    void AddWeightChannel(uint32_t target, Interpolation interpolation, const float* times, const float* values, uint32_t keyCount, uint32_t weightCount);
+
+    const std::vector<Channel>& GetChannels() const { return m_channels; }
+    // channels [GetPathBegin(path), GetPathEnd(path)) drive path
+    uint32_t GetPathBegin(Path path) const { return path == Path::Translation ? 0 : m_pathEnds[static_cast<int>(path) - 1]; }
+    uint32_t GetPathEnd(Path path)   const { return m_pathEnds[static_cast<int>(path)]; }
+
+    const float* GetTimes() const { return m_times.data(); }
+    const float* GetValues(uint32_t component) const { return m_values[component].data(); }
+    const float* GetInTangents(uint32_t component)  const { return m_inTangents[component].data(); }
+    const float* GetOutTangents(uint32_t component) const { return m_outTangents[component].data(); }
+
+    const std::vector<WeightChannel>& GetWeightChannels() const { return m_weightChannels; }
+    const float* GetWeightValues() const { return m_weightValues.data(); }
+    // time of the last key
+    float GetDuration() const { return m_duration; }
+
+    inline static const uint32_t PathCount = 3;
+
+protected:
+    std::vector<Channel> m_channels;
+    uint32_t             m_pathEnds[PathCount] = {0, 0, 0};
+
+    std::vector<float> m_times;
+    std::vector<float> m_values[4];
+    std::vector<float> m_inTangents[4];
+    std::vector<float> m_outTangents[4];
+    float              m_duration = 0.0f;
+
+    std::vector<WeightChannel> m_weightChannels;
+    std::vector<float>         m_weightValues;
+};
+
+// Plays clips on the nodes of a hierarchy. Every channel keeps a cursor on its current key, so
+// moving forward costs a step per channel instead of a search. The key pairs of a path are
+// gathered into SoA streams and interpolated with one batched lerp or slerp, cubic spline
+// channels are evaluated while gathering and pass through the batch unchanged.
+// A node driven by several playbacks takes the pose of the last one.
+class Animator{
+public:
+    // rest(slot) gives the local transform of a node before it is animated,
+    // the paths the clip does not drive keep it
+    template<typename Func>
+    uint32_t Play(const std::shared_ptr<const AnimationClip>& clip, Func&& rest, bool loop = true, float speed = 1.0f);
+    void Stop(uint32_t playback);
+    bool IsPlaying(uint32_t playback) const { return playback < m_playbacks.size() && m_playbacks[playback].isPlaying; }
+    bool IsAnyPlaying() const;
+
+    // moves every playback deltaTime seconds forward and samples it into the poses of its targets,
+    // a playback that does not loop stops after sampling its last key
+    void Update(float deltaTime);
+
+    // slot and local transform of every animated node
+    const std::vector<uint32_t>&           GetTargets() const { return m_targets; }
+    const std::vector<GeoMath::Transform>& GetPoses()   const { return m_poses; }
+    // poses written by the last Update, each once
+    const std::vector<uint32_t>&           GetChanged() const { return m_changed; }
+
+    // slot and blend shape weights of every node with animated weights, written by the last Update
+    // when in GetChangedMorphs
+    const std::vector<uint32_t>& GetMorphTargets() const { return m_morphTargets; }
+    const std::vector<float>&    GetMorphWeights(uint32_t morph) const { return m_morphWeights[morph]; }
+    const std::vector<uint32_t>& GetChangedMorphs() const { return m_changedMorphs; }
+
+    inline static const uint32_t NoPose = 0xFFFFFFFF;
+
+protected:
+    struct Playback{
+        std::shared_ptr<const AnimationClip> clip;
+        float time;
+        float speed;
+        bool  isLooping;
+        bool  isPlaying;
+        std::vector<uint32_t> cursors;  // key of every channel
+        std::vector<uint32_t> poses;    // pose every channel writes
+        std::vector<uint32_t> weightCursors;
+        std::vector<uint32_t> morphs;   // weights every weight channel writes
+    };
+
+    void Sample(Playback& playback);
+    void SamplePath(Playback& playback, AnimationClip::Path path);
+    void SampleWeights(Playback& playback);
+    // key at or before time, searched only when the time went back
+    static inline uint32_t Seek(const float* times, uint32_t count, uint32_t cursor, float time);
+
+    std::vector<Playback>           m_playbacks;
+    std::vector<uint32_t>           m_targets;
+    std::vector<GeoMath::Transform> m_poses;
+    std::vector<uint32_t>           m_poseOfSlot;
+    std::vector<uint32_t>           m_changed;
+    std::vector<uint64_t>           m_changedUpdates;
+    uint64_t                        m_update = 0;
+
+    std::vector<uint32_t>           m_morphTargets;
+    std::vector<std::vector<float>> m_morphWeights;
+    std::vector<uint32_t>           m_morphOfSlot;
+    std::vector<uint32_t>           m_changedMorphs;
+    std::vector<uint64_t>           m_morphChangedUpdates;
+
+    // key pairs and weights of the path being sampled
+    std::vector<float> m_from[4];
+    std::vector<float> m_to[4];
+    std::vector<float> m_weights;
+};
+
+// Joints of one skinned mesh node. The palette takes a vertex from the bind pose into the current
+// pose of the joints, in the space of the mesh node: inverseBind * jointWorld * meshWorld^-1.
+class Skin{
+public:
+    // dual quaternions keep the volume around twisting joints but drop any scale of the joints
+    enum class Method : uint8_t{ LinearBlend, DualQuaternion };
+
+    Skin(uint32_t meshNode, std::vector<uint32_t> joints, std::vector<GeoMath::Matrix4f> inverseBinds);
+
+    // recomputes the palette when a joint or the mesh node moved in the last hierarchy update or when
+    // forced to, returns whether it did
+    bool UpdatePalette(const SceneHierarchy& hierarchy, bool isForced = false);
+
+    void   SetMethod(Method method);
+    Method GetMethod() const { return m_method; }
+
+    uint32_t GetMeshNode() const { return m_meshNode; }
+    const std::vector<uint32_t>&          GetJoints()  const { return m_joints; }
+    const std::vector<GeoMath::Matrix4f>& GetPalette() const { return m_palette; }
+    // the palette as dual quaternions, kept only for Method::DualQuaternion
+    const std::vector<GeoMath::DualQuaternion>& GetDualQuaternions() const { return m_dualQuaternions; }
+    // moves on with every palette change, 0 before the first one
+    uint64_t GetVersion() const { return m_version; }
+
+    // bounds in the space of the mesh node of a mesh with bindBounds in the bind pose, as the palette
+    // deforms it. A linear blended vertex is a weighted average of its images under the palette
+    // matrices, so it stays in the union of the bind box moved by every joint. Dual quaternions get a
+    // looser sphere, unbounded when two joints turn so far apart that a blend could cancel out
+    GeoMath::BoundingBox GetPoseBounds(const GeoMath::BoundingBox& bindBounds) const;
+
+protected:
+    uint32_t                       m_meshNode;
+    std::vector<uint32_t>          m_joints;
+    std::vector<GeoMath::Matrix4f> m_inverseBinds;
+    std::vector<GeoMath::Matrix4f> m_palette;
+    std::vector<GeoMath::DualQuaternion> m_dualQuaternions;
+    Method                         m_method  = Method::LinearBlend;
+    uint64_t                       m_version = 0;
+
+    // squared length of a blended rotation below which the pose bounds give up, and their extent then
+    inline static const float MinBlendLength2 = 0.01f;
+    inline static const float Unbounded       = 1e15f;
+};
+
+template<typename Func>
+uint32_t Animator::Play(const std::shared_ptr<const AnimationClip>& clip, Func&& rest, bool loop, float speed){
+    const auto& channels = clip->GetChannels();
+
+    Playback playback;
+    playback.clip      = clip;
+    playback.time      = 0.0f;
+    playback.speed     = speed;
+    playback.isLooping = loop;
+    playback.isPlaying = true;
+    playback.cursors.assign(channels.size(), 0);
+    playback.poses.resize(channels.size());
+
+    for(size_t i = 0; i < channels.size(); i++){
+        uint32_t slot = channels[i].target;
+        if(slot >= m_poseOfSlot.size()) m_poseOfSlot.resize(slot + 1, NoPose);
+        if(m_poseOfSlot[slot] == NoPose){
+            m_poseOfSlot[slot] = static_cast<uint32_t>(m_poses.size());
+            m_targets.emplace_back(slot);
+            m_poses.emplace_back(rest(slot));
+            m_changedUpdates.emplace_back(0);
+        }
+        playback.poses[i] = m_poseOfSlot[slot];
+    }
+
+    const auto& weightChannels = clip->GetWeightChannels();
+    playback.weightCursors.assign(weightChannels.size(), 0);
+    playback.morphs.resize(weightChannels.size());
+    for(size_t i = 0; i < weightChannels.size(); i++){
+        uint32_t slot = weightChannels[i].target;
+        if(slot >= m_morphOfSlot.size()) m_morphOfSlot.resize(slot + 1, NoPose);
+        if(m_morphOfSlot[slot] == NoPose){
+            m_morphOfSlot[slot] = static_cast<uint32_t>(m_morphWeights.size());
+            m_morphTargets.emplace_back(slot);
+            m_morphWeights.emplace_back(weightChannels[i].weightCount, 0.0f);
+            m_morphChangedUpdates.emplace_back(0);
+        }
+        playback.morphs[i] = m_morphOfSlot[slot];
+    }
+
+    // stopped playbacks give their place to new ones
+    auto idle = std::find_if(m_playbacks.begin(), m_playbacks.end(), [](const Playback& p){ return !p.isPlaying; });
+    if(idle != m_playbacks.end()){
+        *idle = std::move(playback);
+        return static_cast<uint32_t>(idle - m_playbacks.begin());
+    }
+    m_playbacks.emplace_back(std::move(playback));
+    return static_cast<uint32_t>(m_playbacks.size() - 1);
+}
+
+uint32_t Animator::Seek(const float* times, uint32_t count, uint32_t cursor, float time){
+    if(cursor >= count || times[cursor] > time){
+        // looped around or sought back
+        cursor = static_cast<uint32_t>(std::upper_bound(times, times + count, time) - times);
+        cursor = cursor > 0 ? cursor - 1 : 0;
+    }
+    while(cursor + 1 < count && times[cursor + 1] <= time) cursor++;
+    return cursor;
+}
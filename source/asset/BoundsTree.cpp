@@ -0,0 +1,404 @@
+#include "BoundsTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace{
+
+    void ToMinMax(const GeoMath::BoundingBox& box, float* lo, float* hi){
+        for(int i = 0; i < 3; i++){
+            lo[i] = box.center.data[i] - box.extent.data[i];
+            hi[i] = box.center.data[i] + box.extent.data[i];
+        }
+    }
+
+    void Merge(const float* lo0, const float* hi0, const float* lo1, const float* hi1, float* lo, float* hi){
+        for(int i = 0; i < 3; i++){
+            lo[i] = lo0[i] < lo1[i] ? lo0[i] : lo1[i];
+            hi[i] = hi0[i] > hi1[i] ? hi0[i] : hi1[i];
+        }
+    }
+
+    // >= 0 inside the plane, the box is pushed towards it by its projected radius
+    float PlaneDistance(const GeoMath::Vector4f& plane, const float* center, const float* extent, float& radius){
+        radius = std::abs(plane.x) * extent[0] + std::abs(plane.y) * extent[1] + std::abs(plane.z) * extent[2];
+        return plane.x * center[0] + plane.y * center[1] + plane.z * center[2] + plane.w;
+    }
+
+    template<typename Func>
+    void ForEachQuery(size_t count, Utility::WorkerPool* pool, Func&& func){
+        if(pool == nullptr){
+            for(size_t i = 0; i < count; i++) func(i);
+            return;
+        }
+        const size_t grain = count / (pool->GetThreadCount() * 4) + 1;
+        pool->ParallelFor(count, grain, [&](size_t begin, size_t end){
+            for(size_t i = begin; i < end; i++) func(i);
+        });
+    }
+
+    const uint32_t BinCount = 16;
+
+}
+
+uint32_t BoundsTree::Allocate(){
+    if(!m_freeNodes.empty()){
+        uint32_t index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        return index;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void BoundsTree::Free(uint32_t index){
+    m_freeNodes.emplace_back(index);
+}
+
+bool BoundsTree::RefitNode(uint32_t index){
+    Node& node = m_nodes[index];
+    const Node& c0 = m_nodes[node.childs[0]];
+    const Node& c1 = m_nodes[node.childs[1]];
+
+    float lo[3], hi[3];
+    Merge(c0.lo, c0.hi, c1.lo, c1.hi, lo, hi);
+    if(memcmp(lo, node.lo, sizeof(lo)) == 0 && memcmp(hi, node.hi, sizeof(hi)) == 0) return false;
+
+    m_innerArea += Area(lo, hi) - Area(node);
+    memcpy(node.lo, lo, sizeof(lo));
+    memcpy(node.hi, hi, sizeof(hi));
+    return true;
+}
+
+void BoundsTree::Insert(uint32_t key, const GeoMath::BoundingBox& box){
+    assert(!Has(key));
+
+    uint32_t leaf = Allocate();
+    Node& node = m_nodes[leaf];
+    ToMinMax(box, node.lo, node.hi);
+    node.parent    = NoNode;
+    node.childs[0] = NoNode;
+    node.childs[1] = NoNode;
+    node.key       = key;
+
+    if(key >= m_leaves.size()) m_leaves.resize(key + 1, NoNode);
+    m_leaves[key] = leaf;
+    m_leafCount++;
+
+    if(m_root == NoNode){
+        m_root = leaf;
+        return;
+    }
+
+    // walk down to the sibling adding the least area, a parent grows for every level below it
+    const float* lo = m_nodes[leaf].lo;
+    const float* hi = m_nodes[leaf].hi;
+    float mergedLo[3], mergedHi[3];
+
+    uint32_t sibling = m_root;
+    while(!IsLeaf(sibling)){
+        const Node& current = m_nodes[sibling];
+        Merge(current.lo, current.hi, lo, hi, mergedLo, mergedHi);
+        const float merged      = Area(mergedLo, mergedHi);
+        const float here        = 2.0f * merged;
+        const float inheritance = 2.0f * (merged - Area(current));
+
+        float costs[2];
+        for(int i = 0; i < 2; i++){
+            const Node& child = m_nodes[current.childs[i]];
+            Merge(child.lo, child.hi, lo, hi, mergedLo, mergedHi);
+            costs[i] = Area(mergedLo, mergedHi) + inheritance - (IsLeaf(current.childs[i]) ? 0.0f : Area(child));
+        }
+        if(here < costs[0] && here < costs[1]) break;
+
+        sibling = current.childs[costs[1] < costs[0] ? 1 : 0];
+    }
+
+    // the new parent takes the place of the sibling
+    const uint32_t oldParent = m_nodes[sibling].parent;
+    const uint32_t parent    = Allocate();
+    Node& inner = m_nodes[parent];
+    inner.parent    = oldParent;
+    inner.childs[0] = sibling;
+    inner.childs[1] = leaf;
+    inner.key       = NoKey;
+    Merge(m_nodes[sibling].lo, m_nodes[sibling].hi, m_nodes[leaf].lo, m_nodes[leaf].hi, inner.lo, inner.hi);
+    m_innerArea += Area(inner);
+
+    if(oldParent == NoNode){
+        m_root = parent;
+    }
+    else{
+        Node& up = m_nodes[oldParent];
+        up.childs[up.childs[0] == sibling ? 0 : 1] = parent;
+    }
+    m_nodes[sibling].parent = parent;
+    m_nodes[leaf].parent    = parent;
+
+    for(uint32_t p = oldParent; p != NoNode && RefitNode(p); p = m_nodes[p].parent){}
+}
+
+void BoundsTree::Remove(uint32_t key){
+    assert(Has(key));
+
+    const uint32_t leaf   = m_leaves[key];
+    const uint32_t parent = m_nodes[leaf].parent;
+    m_leaves[key] = NoNode;
+    m_leafCount--;
+    m_moved.erase(std::remove(m_moved.begin(), m_moved.end(), leaf), m_moved.end());
+    Free(leaf);
+
+    if(parent == NoNode){
+        m_root = NoNode;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    const Node& inner = m_nodes[parent];
+    const uint32_t sibling     = inner.childs[inner.childs[0] == leaf ? 1 : 0];
+    const uint32_t grandParent = inner.parent;
+    m_innerArea -= Area(inner);
+    Free(parent);
+
+    m_nodes[sibling].parent = grandParent;
+    if(grandParent == NoNode){
+        m_root = sibling;
+    }
+    else{
+        Node& up = m_nodes[grandParent];
+        up.childs[up.childs[0] == parent ? 0 : 1] = sibling;
+    }
+
+    for(uint32_t p = grandParent; p != NoNode && RefitNode(p); p = m_nodes[p].parent){}
+}
+
+void BoundsTree::Update(uint32_t key, const GeoMath::BoundingBox& box){
+    const uint32_t leaf = m_leaves[key];
+    ToMinMax(box, m_nodes[leaf].lo, m_nodes[leaf].hi);
+    m_moved.emplace_back(leaf);
+}
+
+void BoundsTree::Refit(){
+    // every leaf is in place before the walks, so a walk stops at the first ancestor that
+    // did not change: whatever lies above it was already handled by an earlier walk
+    for(auto leaf : m_moved){
+        for(uint32_t p = m_nodes[leaf].parent; p != NoNode && RefitNode(p); p = m_nodes[p].parent){}
+    }
+    m_moved.clear();
+
+    if(GetCost() > m_buildCost * RebuildRatio) Rebuild();
+}
+
+void BoundsTree::Rebuild(){
+    std::vector<BuildItem> items;
+    items.reserve(m_leafCount);
+    for(uint32_t key = 0; key < m_leaves.size(); key++){
+        if(m_leaves[key] == NoNode) continue;
+
+        const Node& leaf = m_nodes[m_leaves[key]];
+        BuildItem item;
+        memcpy(item.lo, leaf.lo, sizeof(item.lo));
+        memcpy(item.hi, leaf.hi, sizeof(item.hi));
+        item.key = key;
+        items.emplace_back(item);
+    }
+
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_moved.clear();
+    m_innerArea = 0.0;
+    m_nodes.reserve(items.size() * 2);
+
+    m_root      = items.empty() ? NoNode : Build(items.data(), static_cast<uint32_t>(items.size()), NoNode);
+    m_buildCost = GetCost();
+}
+
+uint32_t BoundsTree::Build(BuildItem* items, uint32_t count, uint32_t parent){
+    const uint32_t index = Allocate();
+    m_nodes[index].parent = parent;
+
+    if(count == 1){
+        Node& leaf = m_nodes[index];
+        memcpy(leaf.lo, items[0].lo, sizeof(leaf.lo));
+        memcpy(leaf.hi, items[0].hi, sizeof(leaf.hi));
+        leaf.childs[0] = NoNode;
+        leaf.childs[1] = NoNode;
+        leaf.key       = items[0].key;
+        m_leaves[leaf.key] = index;
+        return index;
+    }
+
+    // split along the longest axis of the centers, sizes are doubled centers
+    float centerLo[3] = { 1e30f,  1e30f,  1e30f};
+    float centerHi[3] = {-1e30f, -1e30f, -1e30f};
+    for(uint32_t i = 0; i < count; i++){
+        for(int a = 0; a < 3; a++){
+            float c = items[i].lo[a] + items[i].hi[a];
+            centerLo[a] = c < centerLo[a] ? c : centerLo[a];
+            centerHi[a] = c > centerHi[a] ? c : centerHi[a];
+        }
+    }
+    int axis = 0;
+    for(int a = 1; a < 3; a++){
+        if(centerHi[a] - centerLo[a] > centerHi[axis] - centerLo[axis]) axis = a;
+    }
+
+    uint32_t split = count / 2;
+    const float range = centerHi[axis] - centerLo[axis];
+    if(range > 0.0f){
+        struct Bin{
+            float    lo[3] = { 1e30f,  1e30f,  1e30f};
+            float    hi[3] = {-1e30f, -1e30f, -1e30f};
+            uint32_t count = 0;
+        };
+        Bin bins[BinCount];
+
+        const float scale = BinCount * 0.9999f / range;
+        auto binOf = [&](const BuildItem& item){
+            return static_cast<uint32_t>((item.lo[axis] + item.hi[axis] - centerLo[axis]) * scale);
+        };
+        for(uint32_t i = 0; i < count; i++){
+            Bin& bin = bins[binOf(items[i])];
+            Merge(bin.lo, bin.hi, items[i].lo, items[i].hi, bin.lo, bin.hi);
+            bin.count++;
+        }
+
+        // area times count of both sides for every split between bins
+        float rightCosts[BinCount];
+        Bin right;
+        for(uint32_t b = BinCount - 1; b > 0; b--){
+            Merge(right.lo, right.hi, bins[b].lo, bins[b].hi, right.lo, right.hi);
+            right.count += bins[b].count;
+            rightCosts[b] = right.count > 0 ? Area(right.lo, right.hi) * right.count : 0.0f;
+        }
+
+        float    bestCost = 1e30f;
+        uint32_t bestBin  = 0;
+        Bin left;
+        for(uint32_t b = 0; b < BinCount - 1; b++){
+            Merge(left.lo, left.hi, bins[b].lo, bins[b].hi, left.lo, left.hi);
+            left.count += bins[b].count;
+            float cost = (left.count > 0 ? Area(left.lo, left.hi) * left.count : 0.0f) + rightCosts[b + 1];
+            if(left.count > 0 && left.count < count && cost < bestCost){
+                bestCost = cost;
+                bestBin  = b;
+            }
+        }
+
+        BuildItem* middle = std::partition(items, items + count, [&](const BuildItem& item){
+            return binOf(item) <= bestBin;
+        });
+        split = static_cast<uint32_t>(middle - items);
+    }
+    // every center in one place or one bin, any half is as good as the other
+    if(split == 0 || split == count) split = count / 2;
+
+    const uint32_t child0 = Build(items, split, index);
+    const uint32_t child1 = Build(items + split, count - split, index);
+
+    Node& inner = m_nodes[index];
+    inner.childs[0] = child0;
+    inner.childs[1] = child1;
+    inner.key       = NoKey;
+    Merge(m_nodes[child0].lo, m_nodes[child0].hi, m_nodes[child1].lo, m_nodes[child1].hi, inner.lo, inner.hi);
+    m_innerArea += Area(inner);
+    return index;
+}
+
+float BoundsTree::GetCost() const{
+    if(m_root == NoNode || IsLeaf(m_root)) return 0.0f;
+    const float rootArea = Area(m_nodes[m_root]);
+    return rootArea > 0.0f ? static_cast<float>(m_innerArea / rootArea) : 0.0f;
+}
+
+GeoMath::BoundingBox BoundsTree::GetBounds() const{
+    if(m_root == NoNode) return GeoMath::BoundingBox();
+    const Node& root = m_nodes[m_root];
+    return GeoMath::BoundingBox::FromMinMax(
+        GeoMath::Vector3f(root.lo[0], root.lo[1], root.lo[2]),
+        GeoMath::Vector3f(root.hi[0], root.hi[1], root.hi[2])
+    );
+}
+
+void BoundsTree::QueryFrustum(const GeoMath::Frustum& frustum, std::vector<uint32_t>& keys) const{
+    Query([&frustum](const Node& node){
+        float center[3], extent[3];
+        for(int i = 0; i < 3; i++){
+            center[i] = 0.5f * (node.hi[i] + node.lo[i]);
+            extent[i] = 0.5f * (node.hi[i] - node.lo[i]);
+        }
+
+        Overlap overlap = Overlap::Inside;
+        for(const auto& plane : frustum.planes){
+            float radius;
+            float distance = PlaneDistance(plane, center, extent, radius);
+            if(distance + radius < 0.0f) return Overlap::Outside;
+            if(distance - radius < 0.0f) overlap = Overlap::Partial;
+        }
+        return overlap;
+    }, [&keys](uint32_t key){ keys.emplace_back(key); });
+}
+
+void BoundsTree::QueryBox(const GeoMath::BoundingBox& box, std::vector<uint32_t>& keys) const{
+    float lo[3], hi[3];
+    ToMinMax(box, lo, hi);
+
+    Query([&](const Node& node){
+        bool isInside = true;
+        for(int i = 0; i < 3; i++){
+            if(node.hi[i] < lo[i] || node.lo[i] > hi[i]) return Overlap::Outside;
+            isInside = isInside && node.lo[i] >= lo[i] && node.hi[i] <= hi[i];
+        }
+        return isInside ? Overlap::Inside : Overlap::Partial;
+    }, [&keys](uint32_t key){ keys.emplace_back(key); });
+}
+
+void BoundsTree::QuerySphere(const GeoMath::Vector3f& center, float radius, std::vector<uint32_t>& keys) const{
+    const float radius2 = radius * radius;
+
+    Query([&](const Node& node){
+        // nearest and farthest point of the box from the center
+        float nearest = 0.0f, farthest = 0.0f;
+        for(int i = 0; i < 3; i++){
+            float below = node.lo[i] - center.data[i];
+            float above = center.data[i] - node.hi[i];
+            float n = below > 0.0f ? below : (above > 0.0f ? above : 0.0f);
+            float f = -below > -above ? -below : -above;
+            nearest  += n * n;
+            farthest += f * f;
+        }
+        if(nearest > radius2) return Overlap::Outside;
+        return farthest <= radius2 ? Overlap::Inside : Overlap::Partial;
+    }, [&keys](uint32_t key){ keys.emplace_back(key); });
+}
+
+BoundsTree::RayHit BoundsTree::RayCast(const Ray& ray) const{
+    return RayCast(ray, [](uint32_t, float boxDistance){ return boxDistance; });
+}
+
+void BoundsTree::QueryFrustums(const GeoMath::Frustum* frustums, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool) const{
+    ForEachQuery(count, pool, [&](size_t i){
+        results[i].clear();
+        QueryFrustum(frustums[i], results[i]);
+    });
+}
+
+void BoundsTree::QueryBoxes(const GeoMath::BoundingBox* boxes, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool) const{
+    ForEachQuery(count, pool, [&](size_t i){
+        results[i].clear();
+        QueryBox(boxes[i], results[i]);
+    });
+}
+
+void BoundsTree::QuerySpheres(const GeoMath::Vector3f* centers, const float* radii, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool) const{
+    ForEachQuery(count, pool, [&](size_t i){
+        results[i].clear();
+        QuerySphere(centers[i], radii[i], results[i]);
+    });
+}
+
+void BoundsTree::RayCasts(const Ray* rays, size_t count, RayHit* hits, Utility::WorkerPool* pool) const{
+    ForEachQuery(count, pool, [&](size_t i){
+        hits[i] = RayCast(rays[i]);
+    });
+}
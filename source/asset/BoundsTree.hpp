@@ -0,0 +1,229 @@
+#pragma once
+#include "GeoMath.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// Dynamic AABB tree over world bounds, keyed by the hierarchy slot of the node.
+// Moved leaves are refitted bottom up in Refit; once inserts and refits push the cost of
+// the tree too far past its last build, it is rebuilt with a binned SAH split.
+// Queries are const and may run on several threads at once.
+class BoundsTree{
+public:
+    struct Ray{
+        GeoMath::Vector3f origin;
+        GeoMath::Vector3f direction;
+        float             maxDistance;
+    };
+
+    struct RayHit{
+        uint32_t key;       // NoKey when nothing was hit
+        float    distance;
+    };
+
+    void Insert(uint32_t key, const GeoMath::BoundingBox& box);
+    void Remove(uint32_t key);
+    // the leaf takes the new box, its ancestors follow in the next Refit
+    void Update(uint32_t key, const GeoMath::BoundingBox& box);
+    bool Has(uint32_t key) const { return key < m_leaves.size() && m_leaves[key] != NoNode; }
+
+    // refits the ancestors of the leaves updated since the last call, rebuilds a degraded tree
+    void Refit();
+    void Rebuild();
+
+    // keys of the leaves overlapping the volume, appended to keys
+    void QueryFrustum(const GeoMath::Frustum& frustum, std::vector<uint32_t>& keys) const;
+    void QueryBox(const GeoMath::BoundingBox& box, std::vector<uint32_t>& keys) const;
+    void QuerySphere(const GeoMath::Vector3f& center, float radius, std::vector<uint32_t>& keys) const;
+
+    // nearest leaf box along the ray
+    RayHit RayCast(const Ray& ray) const;
+    // hitTest(key, boxDistance) returns the exact distance or a negative one for a miss,
+    // it is only called for boxes entered before the best hit so far
+    template<typename Func>
+    RayHit RayCast(const Ray& ray, Func&& hitTest) const;
+
+    // one query per element, results[i] is cleared first; spread over the pool when given
+    void QueryFrustums(const GeoMath::Frustum* frustums, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool = nullptr) const;
+    void QueryBoxes(const GeoMath::BoundingBox* boxes, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool = nullptr) const;
+    void QuerySpheres(const GeoMath::Vector3f* centers, const float* radii, size_t count, std::vector<uint32_t>* results, Utility::WorkerPool* pool = nullptr) const;
+    void RayCasts(const Ray* rays, size_t count, RayHit* hits, Utility::WorkerPool* pool = nullptr) const;
+
+    size_t GetLeafCount() const { return m_leafCount; }
+    // summed surface area of the inner nodes over the area of the root, lower is better
+    float GetCost() const;
+    GeoMath::BoundingBox GetBounds() const;
+
+    inline static const uint32_t NoKey  = 0xFFFFFFFF;
+    inline static const uint32_t NoNode = 0xFFFFFFFF;
+
+    // rebuilt once the cost grows this much over the last build
+    inline static const float RebuildRatio = 1.5f;
+
+protected:
+    struct Node{
+        float    lo[3];
+        float    hi[3];
+        uint32_t parent;
+        uint32_t childs[2];     // NoNode for a leaf
+        uint32_t key;
+    };
+
+    struct BuildItem{
+        float    lo[3];
+        float    hi[3];
+        uint32_t key;
+    };
+
+    enum class Overlap{ Outside, Partial, Inside };
+
+    bool IsLeaf(uint32_t index) const { return m_nodes[index].childs[0] == NoNode; }
+
+    uint32_t Allocate();
+    void     Free(uint32_t index);
+    // box of an inner node from its children, false when it did not change
+    bool     RefitNode(uint32_t index);
+    uint32_t Build(BuildItem* items, uint32_t count, uint32_t parent);
+
+    // overlap(node) classifies a node, func(key) gets every leaf not Outside
+    template<typename Test, typename Func>
+    void Query(Test&& overlap, Func&& func) const;
+    template<typename Func>
+    void ForEachLeaf(uint32_t index, std::vector<uint32_t>& stack, Func&& func) const;
+
+    static inline float Area(const float* lo, const float* hi);
+    static inline float Area(const Node& node){ return Area(node.lo, node.hi); }
+    // distance at which the ray enters the node, negative for a miss
+    static inline float Enter(const Node& node, const float* origin, const float* invDirection, float maxDistance);
+
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_freeNodes;
+    std::vector<uint32_t> m_leaves;     // node of every key, NoNode when absent
+    std::vector<uint32_t> m_moved;
+    uint32_t m_root      = NoNode;
+    size_t   m_leafCount = 0;
+
+    // summed area of the inner nodes kept up to date by every change, and the cost of the last build
+    double m_innerArea = 0.0;
+    float  m_buildCost = 0.0f;
+};
+
+float BoundsTree::Area(const float* lo, const float* hi){
+    float x = hi[0] - lo[0];
+    float y = hi[1] - lo[1];
+    float z = hi[2] - lo[2];
+    return x * y + y * z + z * x;
+}
+
+float BoundsTree::Enter(const Node& node, const float* origin, const float* invDirection, float maxDistance){
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+    for(int i = 0; i < 3; i++){
+        float t0 = (node.lo[i] - origin[i]) * invDirection[i];
+        float t1 = (node.hi[i] - origin[i]) * invDirection[i];
+        if(t1 < t0) std::swap(t0, t1);
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+    }
+    return tMin <= tMax ? tMin : -1.0f;
+}
+
+template<typename Func>
+void BoundsTree::ForEachLeaf(uint32_t index, std::vector<uint32_t>& stack, Func&& func) const{
+    const size_t bottom = stack.size();
+    stack.emplace_back(index);
+    while(stack.size() > bottom){
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if(node.childs[0] == NoNode){
+            func(node.key);
+        }
+        else{
+            stack.emplace_back(node.childs[1]);
+            stack.emplace_back(node.childs[0]);
+        }
+    }
+}
+
+template<typename Test, typename Func>
+void BoundsTree::Query(Test&& overlap, Func&& func) const{
+    if(m_root == NoNode) return;
+
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.emplace_back(m_root);
+
+    while(!stack.empty()){
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        switch(overlap(node)){
+            case Overlap::Outside:
+                break;
+            case Overlap::Inside:
+                // nothing below needs testing
+                ForEachLeaf(index, stack, func);
+                break;
+            case Overlap::Partial:
+                if(node.childs[0] == NoNode){
+                    func(node.key);
+                }
+                else{
+                    stack.emplace_back(node.childs[1]);
+                    stack.emplace_back(node.childs[0]);
+                }
+                break;
+        }
+    }
+}
+
+template<typename Func>
+BoundsTree::RayHit BoundsTree::RayCast(const Ray& ray, Func&& hitTest) const{
+    RayHit hit{NoKey, ray.maxDistance};
+    if(m_root == NoNode) return hit;
+
+    const float* origin = ray.origin.data;
+    float invDirection[3];
+    for(int i = 0; i < 3; i++){
+        invDirection[i] = 1.0f / ray.direction.data[i];
+    }
+
+    struct Entry{
+        uint32_t index;
+        float    distance;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+
+    float distance = Enter(m_nodes[m_root], origin, invDirection, hit.distance);
+    if(distance >= 0.0f) stack.push_back({m_root, distance});
+
+    while(!stack.empty()){
+        Entry entry = stack.back();
+        stack.pop_back();
+        // a nearer hit was found after this node was pushed
+        if(entry.distance > hit.distance) continue;
+
+        const Node& node = m_nodes[entry.index];
+        if(node.childs[0] == NoNode){
+            float exact = hitTest(node.key, entry.distance);
+            if(exact >= 0.0f && exact <= hit.distance){
+                hit.key      = node.key;
+                hit.distance = exact;
+            }
+            continue;
+        }
+
+        // the nearer child goes on top so it is walked first
+        float t0 = Enter(m_nodes[node.childs[0]], origin, invDirection, hit.distance);
+        float t1 = Enter(m_nodes[node.childs[1]], origin, invDirection, hit.distance);
+        Entry first {node.childs[0], t0};
+        Entry second{node.childs[1], t1};
+        if(t1 >= 0.0f && (t0 < 0.0f || t1 < t0)) std::swap(first, second);
+        if(second.distance >= 0.0f) stack.push_back(second);
+        if(first.distance  >= 0.0f) stack.push_back(first);
+    }
+    return hit;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "IComponent.hpp"
+#include "Mesh.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// Components of one kind in a dense array sorted by the hierarchy slot of their node,
+// so the components of a node are contiguous and nodes come parents first.
+// Not owning, the nodes keep the components alive.
+template<typename T>
+class ComponentArray{
+public:
+    void Add(uint32_t node, T* component){
+        auto position = std::upper_bound(m_nodes.begin(), m_nodes.end(), node);
+        m_components.insert(m_components.begin() + (position - m_nodes.begin()), component);
+        m_nodes.insert(position, node);
+    }
+
+    bool Has(uint32_t node) const { return std::binary_search(m_nodes.begin(), m_nodes.end(), node); }
+
+    size_t   GetSize() const { return m_nodes.size(); }
+    uint32_t GetNode(size_t index) const { return m_nodes[index]; }
+    T&       Get(size_t index) const { return *m_components[index]; }
+
+    // func(node, component) for every component
+    template<typename Func>
+    void ForEach(Func&& func) const {
+        for(size_t i = 0; i < m_nodes.size(); i++){
+            func(m_nodes[i], *m_components[i]);
+        }
+    }
+
+    // func(component) for the components of one node
+    template<typename Func>
+    void ForEachOf(uint32_t node, Func&& func) const {
+        size_t i = std::lower_bound(m_nodes.begin(), m_nodes.end(), node) - m_nodes.begin();
+        for(; i < m_nodes.size() && m_nodes[i] == node; i++){
+            func(*m_components[i]);
+        }
+    }
+
+    // func(node) once for every node holding at least one component
+    template<typename Func>
+    void ForEachNode(Func&& func) const {
+        for(size_t i = 0; i < m_nodes.size(); i++){
+            if(i == 0 || m_nodes[i] != m_nodes[i - 1]) func(m_nodes[i]);
+        }
+    }
+
+protected:
+    std::vector<uint32_t> m_nodes;
+    std::vector<T*>       m_components;
+};
+
+// Typed component arrays of a scene, picked when the component is added so the frame loop
+// needs neither RTTI nor shared_ptr copies
+struct ComponentStore{
+    ComponentArray<StaticMesh> meshes;
+    // any other kind, run through IComponent::Execute every frame
+    ComponentArray<IComponent> executables;
+};
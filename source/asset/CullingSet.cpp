@@ -0,0 +1,49 @@
+#include "CullingSet.hpp"
+
+#include <algorithm>
+
+uint32_t CullingSet::AddBounds(){
+    uint32_t index = static_cast<uint32_t>(m_centerX.size());
+
+    m_centerX.emplace_back(0.0f);
+    m_centerY.emplace_back(0.0f);
+    m_centerZ.emplace_back(0.0f);
+    m_extentX.emplace_back(0.0f);
+    m_extentY.emplace_back(0.0f);
+    m_extentZ.emplace_back(0.0f);
+
+    // new bounds stay visible until the next cull
+    if((index & 31) == 0) m_visible.emplace_back(0);
+    m_visible[index >> 5] |= 1u << (index & 31);
+
+    return index;
+}
+
+void CullingSet::SetBounds(uint32_t index, const GeoMath::BoundingBox& worldBounds){
+    m_centerX[index] = worldBounds.center.x;
+    m_centerY[index] = worldBounds.center.y;
+    m_centerZ[index] = worldBounds.center.z;
+    m_extentX[index] = worldBounds.extent.x;
+    m_extentY[index] = worldBounds.extent.y;
+    m_extentZ[index] = worldBounds.extent.z;
+}
+
+void CullingSet::Cull(const GeoMath::Frustum& frustum){
+    GeoMath::ConstBoxStream boxes{
+        m_centerX.data(), m_centerY.data(), m_centerZ.data(),
+        m_extentX.data(), m_extentY.data(), m_extentZ.data()
+    };
+    GeoMath::CullBoxes(frustum, boxes, m_centerX.size(), m_visible.data());
+}
+
+void CullingSet::Reset(){
+    std::fill(m_visible.begin(), m_visible.end(), ~0u);
+}
+
+size_t CullingSet::GetVisibleCount() const{
+    size_t count = 0;
+    for(uint32_t index = 0; index < m_centerX.size(); index++){
+        count += IsVisible(index) ? 1 : 0;
+    }
+    return count;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "GeoMathBatch.hpp"
+
+#include <vector>
+
+// World bounds of the scene nodes kept as SoA streams, culled in one pass before rendering
+class CullingSet{
+public:
+    uint32_t AddBounds();
+    void SetBounds(uint32_t index, const GeoMath::BoundingBox& worldBounds);
+
+    void Cull(const GeoMath::Frustum& frustum);
+    // every bounds visible again
+    void Reset();
+
+    bool IsVisible(uint32_t index) const { return (m_visible[index >> 5] >> (index & 31)) & 1u; }
+    GeoMath::Vector3f GetCenter(uint32_t index) const { return GeoMath::Vector3f(m_centerX[index], m_centerY[index], m_centerZ[index]); }
+
+    size_t GetSize() const { return m_centerX.size(); }
+    size_t GetVisibleCount() const;
+
+protected:
+    std::vector<float> m_centerX, m_centerY, m_centerZ;
+    std::vector<float> m_extentX, m_extentY, m_extentZ;
+    std::vector<uint32_t> m_visible;
+};
@@ -0,0 +1,92 @@
+#include "ImageDecoder.hpp"
+#include "stb_image.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+ImageDecoder::ImageDecoder(Utility::WorkerPool* pool)
+    : m_pool(pool != nullptr ? pool : &Utility::WorkerPool::GetInstance())
+{
+}
+
+void ImageDecoder::Add(size_t key, const uint8_t* data, size_t size){
+    m_keys.emplace_back(key);
+    m_encoded.emplace_back(data, data + size);
+}
+
+void ImageDecoder::Decode(
+    const std::function<void(size_t key, Image& image)>& onDecoded,
+    const std::function<void(size_t key, Image& image)>& onWorker
+){
+    const size_t count = m_encoded.size();
+    std::vector<Image> images(count);
+
+    std::mutex              mutex;
+    std::condition_variable decoded;
+    std::vector<size_t>     ready;
+    // the first exception of a callback, rethrown once the decoder thread is joined
+    std::exception_ptr      error;
+
+    // the pool decodes from a thread of its own, this one hands the images on while the rest decode
+    std::thread decoder([&](){
+        m_pool->ParallelFor(count, 1, [&](size_t begin, size_t end){
+            for(size_t i = begin; i < end; i++){
+                std::exception_ptr workerError;
+                try{
+                    if(DecodeOne(m_encoded[i].data(), m_encoded[i].size(), images[i]) && onWorker) onWorker(m_keys[i], images[i]);
+                }
+                catch(...){
+                    workerError = std::current_exception();
+                }
+                std::vector<uint8_t>().swap(m_encoded[i]);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if(workerError && !error) error = workerError;
+                ready.emplace_back(i);
+                decoded.notify_one();
+            }
+        });
+    });
+
+    // a throwing onDecoded stops the hand over, the rest still decode before the thread is joined
+    try{
+        std::vector<size_t> batch;
+        for(size_t delivered = 0; delivered < count; delivered += batch.size()){
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                decoded.wait(lock, [&](){ return !ready.empty(); });
+                batch.swap(ready);
+            }
+            for(size_t i : batch){
+                if(onDecoded) onDecoded(m_keys[i], images[i]);
+                images[i] = Image();
+            }
+        }
+    }
+    catch(...){
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+    decoder.join();
+
+    m_keys.clear();
+    m_encoded.clear();
+    if(error) std::rethrow_exception(error);
+}
+
+bool ImageDecoder::DecodeOne(const uint8_t* data, size_t size, Image& image){
+    int width, height, component;
+    stbi_uc* texels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &component, 4);
+    if(texels == nullptr) return false;
+
+    image.width  = static_cast<uint32_t>(width);
+    image.height = static_cast<uint32_t>(height);
+    image.texels.resize(size_t(width) * height * 4);
+    memcpy(image.texels.data(), texels, image.texels.size());
+    stbi_image_free(texels);
+    return true;
+}
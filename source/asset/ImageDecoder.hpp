@@ -0,0 +1,48 @@
+#pragma once
+#include "WorkerPool.hpp"
+#include "MipGenerator.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Decodes PNG, JPG and the other formats stb_image reads to RGBA8 on a worker pool. Images are
+// queued while the glTF is parsed and decoded all at once, the caller gets every image as soon as
+// it is done so uploads overlap the decoding of the rest.
+class ImageDecoder{
+public:
+    struct Image{
+        std::vector<uint8_t> texels;  // rows of width * 4 bytes, empty when decoding failed
+        uint32_t width  = 0;
+        uint32_t height = 0;
+        // filled by the worker callback when it builds one
+        Utility::MipGenerator::MipChain mips;
+    };
+
+    // nullptr decodes on the shared pool
+    explicit ImageDecoder(Utility::WorkerPool* pool = nullptr);
+
+    ImageDecoder(const ImageDecoder&)            = delete;
+    ImageDecoder& operator=(const ImageDecoder&) = delete;
+    ImageDecoder(ImageDecoder&&)                 = default;
+    ImageDecoder& operator=(ImageDecoder&&)      = default;
+
+    // copies the encoded bytes, key is handed back with the decoded image
+    void   Add(size_t key, const uint8_t* data, size_t size);
+    size_t GetCount() const { return m_encoded.size(); }
+
+    // decodes and empties the queue, onDecoded runs on the calling thread in the order images complete.
+    // onWorker runs on the worker right after an image decoded, for the work that should be parallel too.
+    // An exception of either callback is rethrown after the decoding finished
+    void Decode(
+        const std::function<void(size_t key, Image& image)>& onDecoded,
+        const std::function<void(size_t key, Image& image)>& onWorker = nullptr
+    );
+
+    static bool DecodeOne(const uint8_t* data, size_t size, Image& image);
+
+protected:
+    Utility::WorkerPool*              m_pool;
+    std::vector<size_t>               m_keys;
+    std::vector<std::vector<uint8_t>> m_encoded;
+};
@@ -0,0 +1,39 @@
+#include "InstanceBatcher.hpp"
+
+void InstanceBatcher::Clear(){
+    m_queue.Clear();
+    m_items.clear();
+    m_draws.clear();
+    m_instances.clear();
+}
+
+void InstanceBatcher::Add(uint64_t key, Material* material, Mesh* mesh, uint32_t node){
+    m_queue.Add(key, static_cast<uint32_t>(m_items.size()));
+    m_items.push_back({material, mesh, node});
+}
+
+void InstanceBatcher::Build(){
+    m_queue.Sort();
+
+    const std::vector<uint64_t>& keys  = m_queue.GetKeys();
+    const std::vector<uint32_t>& items = m_queue.GetValues();
+
+    m_draws.clear();
+    m_instances.resize(items.size());
+    for(uint32_t i = 0; i < items.size(); i++){
+        const Item& item = m_items[items[i]];
+        m_instances[i] = item.node;
+
+        // the ids in the key are truncated, the pointers decide what shares a draw
+        const bool isSame = !m_draws.empty()
+            && RenderQueue::GetStateKey(m_draws.back().key) == RenderQueue::GetStateKey(keys[i])
+            && m_draws.back().mesh     == item.mesh
+            && m_draws.back().material == item.material;
+        if(!isSame){
+            m_draws.push_back({keys[i], item.material, item.mesh, i, 0});
+        }
+        m_draws.back().instanceCount++;
+    }
+
+    m_stateChanges = RenderQueue::CountStateChanges(keys.data(), keys.size());
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "RenderQueue.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Mesh;
+class Material;
+
+// Visible draws sharing pipeline state, material and mesh folded into one instanced draw.
+// The draws are ordered by their RenderQueue key, every draw gets a contiguous range of
+// instances and the node of each instance is kept so the per instance data can be packed in draw order.
+class InstanceBatcher{
+public:
+    struct Draw{
+        uint64_t  key;
+        Material* material;
+        Mesh*     mesh;
+        uint32_t  firstInstance;
+        uint32_t  instanceCount;
+    };
+
+    void Clear();
+    // one node drawing mesh, key from RenderQueue::MakeKey
+    void Add(uint64_t key, Material* material, Mesh* mesh, uint32_t node);
+    // sorts the keys, one draw per run of equal state, the instances of a draw follow the depth bucket
+    void Build();
+
+    const std::vector<Draw>&     GetDraws()     const { return m_draws; }
+    // node of every instance, the instances of a draw start at its firstInstance
+    const std::vector<uint32_t>& GetInstances() const { return m_instances; }
+    // binds the draws of the last Build cost
+    const RenderQueue::StateChanges& GetStateChanges() const { return m_stateChanges; }
+
+    // out[i] = record(node of instance i), out has room for GetInstances().size() records
+    template<typename T, typename Func>
+    void Pack(T* out, Func&& record) const {
+        for(size_t i = 0; i < m_instances.size(); i++){
+            out[i] = record(m_instances[i]);
+        }
+    }
+
+protected:
+    struct Item{
+        Material* material;
+        Mesh*     mesh;
+        uint32_t  node;
+    };
+
+    RenderQueue           m_queue;
+    std::vector<Item>     m_items;
+    std::vector<Draw>     m_draws;
+    std::vector<uint32_t> m_instances;
+
+    RenderQueue::StateChanges m_stateChanges{0, 0, 0, 0};
+};
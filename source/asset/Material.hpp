@@ -2,6 +2,8 @@
 #include "GeoMath.hpp"
 #include "Texture.hpp"
 
+#include <atomic>
+
 struct MaterialConstant{
 
     MaterialConstant(){}
@@ -57,6 +59,16 @@ static_assert(sizeof(MaterialConstant) == 112);
 
 class Material{
 public:
-    Material(){}
+    Material() : m_sortId(SortIdCount++){}
     virtual void OnRender() = 0;
+    // pipeline state bits the material sets, part of the draw's sort key
+    virtual uint64_t GetPipelineFlag() const = 0;
+
+    // dense id in creation order, the material field of the draw's sort key
+    uint32_t GetSortId() const { return m_sortId; }
+
+protected:
+    const uint32_t m_sortId;
+
+    inline static std::atomic<uint32_t> SortIdCount{0};
 };
\ No newline at end of file
@@ -1,15 +1,9 @@
 #include "Mesh.hpp"
 
 void StaticMesh::Execute(){
-    OnRender();
+
 }
 
 void StaticMesh::OnUpdate(){
 
-}
-
-void StaticMesh::OnRender(){
-    for(auto& mesh : m_meshes){
-        mesh->OnRender();
-    }
 }
\ No newline at end of file
@@ -1,17 +1,39 @@
 #pragma once
 #include "IComponent.hpp"
 #include "Material.hpp"
+#include "GeoMath.hpp"
 #include "Utility.hpp"
 
+class Skin;
+
 class Mesh{
 public:
     Mesh(const std::shared_ptr<Material>& material)
         : m_material(material)
+        , m_sortId(SortIdCount++)
     {}
-    virtual void OnRender() = 0;
+    // draws instances [firstInstance, firstInstance + instanceCount) of the frame's instance data
+    virtual void OnRender(uint32_t firstInstance, uint32_t instanceCount) = 0;
+    // pipeline state the mesh is drawn with, meshes sharing it and the material are batched together
+    virtual uint64_t GetPipelineFlag() const = 0;
+    // deforms the vertices by the blend shape weights and the current pose of skin (null for
+    // meshes that are only morphed), for meshes registered with the scene. Called on worker
+    // threads before the frame's draws, one task per mesh.
+    virtual void OnDeform(const Skin* skin){}
+    // one weight per blend shape, applied by the next OnDeform
+    virtual void SetMorphWeights(const float* weights, size_t count){}
+    virtual uint32_t GetMorphTargetCount() const { return 0; }
+
+    // dense id in creation order, the mesh field of the draw's sort key
+    uint32_t GetSortId() const { return m_sortId; }
 
 public:
     std::shared_ptr<Material> m_material;
+
+protected:
+    const uint32_t m_sortId;
+
+    inline static std::atomic<uint32_t> SortIdCount{0};
 };
 
 class StaticMesh : public IComponent{
@@ -26,13 +48,27 @@ public:
 
     virtual void Execute() override;
     virtual void OnUpdate();
-    virtual void OnRender();
+
+    // drawn through the scene's instance batches
+    const std::vector<std::unique_ptr<Mesh>>& GetMeshes() const{
+        return m_meshes;
+    }
 
     const std::vector<uint32_t>& GetIndices() const{
         return m_meshIndices;
     }
 
+    // local space bounds of all meshes
+    void AddBounds(const GeoMath::BoundingBox& bounds){
+        m_bounds = m_bounds.Merge(bounds);
+    }
+
+    const GeoMath::BoundingBox& GetBounds() const{
+        return m_bounds;
+    }
+
 protected:
     std::vector<std::unique_ptr<Mesh>> m_meshes;
     std::vector<uint32_t> m_meshIndices;
+    GeoMath::BoundingBox m_bounds;
 };
\ No newline at end of file
@@ -1,12 +1,22 @@
 #include "Model.hpp"
 
+#include <cstring>
+
 Model::Model(const char* fileName){
 
     tinygltf::TinyGLTF loader;
     std::string err;
     std::string warn;
+    loader.SetImageLoader(&Model::QueueImage, this);
+
+    const std::string path(fileName);
+    const bool isBinary = path.size() > 4 && (path.compare(path.size() - 4, 4, ".glb") == 0 || path.compare(path.size() - 4, 4, ".GLB") == 0);
+    bool ret = isBinary ? LoadBinary(loader, err, warn, path) : loader.LoadASCIIFromFile(&m_model, &err, &warn, fileName);
 
-    bool ret = loader.LoadASCIIFromFile(&m_model, &err, &warn, fileName);
+    m_buffers.reserve(m_model.buffers.size());
+    for(size_t i = 0; i < m_model.buffers.size(); i++){
+        m_buffers.emplace_back(i == 0 && m_binChunk != nullptr ? m_binChunk : m_model.buffers[i].data.data());
+    }
 
     if(!warn.empty()){
         OutputDebugString(("Warn: %s\n"+warn).c_str());
@@ -21,7 +31,255 @@ Model::Model(const char* fileName){
     }
 }
 
-uint8_t* Model::GetBuffer(size_t bufferViewIndex){
+bool Model::LoadBinary(tinygltf::TinyGLTF& loader, std::string& err, std::string& warn, const std::string& fileName){
+    m_file = Utility::MappedFile(fileName.c_str());
+    if(!m_file.IsOpen() || m_file.GetSize() < 20){
+        err = "Failed to map " + fileName;
+        return false;
+    }
+
+    const size_t slash = fileName.find_last_of("/\\");
+    const std::string baseDir = slash == std::string::npos ? std::string() : fileName.substr(0, slash);
+    if(!loader.LoadBinaryFromMemory(&m_model, &err, &warn, m_file.GetData(), static_cast<unsigned int>(m_file.GetSize()), baseDir)){
+        return false;
+    }
+
+    // 12 byte header, then chunks of length, type and data, JSON first and the optional BIN after it
+    const uint8_t* data = m_file.GetData();
+    uint32_t jsonLength;
+    memcpy(&jsonLength, data + 12, sizeof(uint32_t));
+    const size_t binOffset = 20 + size_t(jsonLength);
+    if(binOffset + 8 > m_file.GetSize()) return true;
+
+    uint32_t binHeader[2];
+    memcpy(binHeader, data + binOffset, sizeof(binHeader));
+    if(binHeader[1] != 0x004E4942 || binOffset + 8 + binHeader[0] > m_file.GetSize()) return true;
+
+    // the parser copied the BIN chunk into the first buffer, it is read from the mapping instead
+    if(!m_model.buffers.empty() && m_model.buffers[0].uri.empty()){
+        m_binChunk = data + binOffset + 8;
+        std::vector<unsigned char>().swap(m_model.buffers[0].data);
+    }
+    return true;
+}
+
+bool Model::QueueImage(
+    tinygltf::Image* image, const int imageIndex, std::string* err, std::string* warn,
+    int reqWidth, int reqHeight, const unsigned char* bytes, int size, void* userData
+){
+    static_cast<Model*>(userData)->m_imageDecoder.Add(static_cast<size_t>(imageIndex), bytes, static_cast<size_t>(size));
+    return true;
+}
+
+void Model::DecodeImages(const TextureCompression& compression, const std::function<void(size_t imageIndex)>& onDecoded){
+    using Utility::BlockCompressor;
+
+    // how the materials sample every image. Color is filtered in linear light and base colors of cutout
+    // materials keep their alpha test coverage, the usage also picks the block compression format
+    enum : uint32_t{ ColorUse = 1, NormalUse = 2, OcclusionUse = 4, DataUse = 8 };
+    std::vector<uint32_t> uses(m_model.images.size(), 0);
+    std::vector<float>    alphaCutoffs(m_model.images.size(), 0.0f);
+
+    auto Use = [&](int textureIndex, uint32_t use, float alphaCutoff){
+        if(textureIndex < 0 || textureIndex >= static_cast<int>(m_model.textures.size())) return;
+        const int imageIndex = GetTextureImage(textureIndex);
+        if(imageIndex < 0) return;
+        uses[imageIndex]        |= use;
+        alphaCutoffs[imageIndex] = alphaCutoff > alphaCutoffs[imageIndex] ? alphaCutoff : alphaCutoffs[imageIndex];
+    };
+    for(auto& mat : m_model.materials){
+        const float alphaCutoff = mat.alphaMode == "MASK" ? static_cast<float>(mat.alphaCutoff) : 0.0f;
+        Use(mat.pbrMetallicRoughness.baseColorTexture.index, ColorUse, alphaCutoff);
+        Use(mat.pbrMetallicRoughness.metallicRoughnessTexture.index, DataUse, 0.0f);
+        Use(mat.emissiveTexture.index, ColorUse, 0.0f);
+        Use(mat.normalTexture.index, NormalUse, 0.0f);
+        Use(mat.occlusionTexture.index, OcclusionUse, 0.0f);
+
+        auto pbrParam = mat.extensions.find("KHR_materials_pbrSpecularGlossiness");
+        if(pbrParam != mat.extensions.end()){
+            if(pbrParam->second.Has("diffuseTexture")){
+                Use(pbrParam->second.Get("diffuseTexture").Get("index").GetNumberAsInt(), ColorUse, alphaCutoff);
+            }
+            if(pbrParam->second.Has("specularGlossinessTexture")){
+                Use(pbrParam->second.Get("specularGlossinessTexture").Get("index").GetNumberAsInt(), DataUse, 0.0f);
+            }
+        }
+    }
+
+    // an image shared by several uses keeps every channel, occlusion packed with metallic roughness among them
+    std::vector<BlockCompressor::Usage> usages(m_model.images.size());
+    for(size_t i = 0; i < usages.size(); i++){
+        usages[i] = uses[i] & ColorUse      ? BlockCompressor::Usage::Color :
+                    uses[i] == NormalUse    ? BlockCompressor::Usage::Normal :
+                    uses[i] == OcclusionUse ? BlockCompressor::Usage::SingleChannel : BlockCompressor::Usage::Data;
+    }
+
+    m_mipChains.assign(m_model.images.size(), Utility::MipGenerator::MipChain());
+    m_imageFormats.assign(m_model.images.size(), BlockCompressor::Format::RGBA8);
+    m_imageDecoder.Decode([&](size_t imageIndex, ImageDecoder::Image& decoded){
+        auto& image = m_model.images[imageIndex];
+        if(decoded.texels.empty()){
+            OutputDebugString(("Failed to decode " + image.uri + "\n").c_str());
+            return;
+        }
+
+        image.width      = static_cast<int>(decoded.width);
+        image.height     = static_cast<int>(decoded.height);
+        image.component  = 4;
+        image.bits       = 8;
+        image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+        image.image      = std::move(decoded.texels);
+        m_mipChains[imageIndex] = std::move(decoded.mips);
+        if(onDecoded) onDecoded(imageIndex);
+    }, [&](size_t imageIndex, ImageDecoder::Image& decoded){
+        Utility::MipGenerator::Settings settings;
+        settings.isSrgb      = usages[imageIndex] == BlockCompressor::Usage::Color;
+        settings.alphaCutoff = alphaCutoffs[imageIndex];
+        decoded.mips = Utility::MipGenerator::Generate(decoded.texels.data(), decoded.width, decoded.height, decoded.width * 4, settings);
+
+        // block compressed textures need their top level in whole blocks, the rest stays RGBA8.
+        // Already on a worker, so each image is compressed on the thread that decoded it
+        if(compression.isEnabled && decoded.width % 4 == 0 && decoded.height % 4 == 0){
+            const bool isOpaque = BlockCompressor::IsOpaque(decoded.texels.data(), decoded.width, decoded.height, decoded.width * 4);
+            m_imageFormats[imageIndex] = BlockCompressor::SelectFormat(usages[imageIndex], compression.quality, isOpaque);
+            decoded.mips = BlockCompressor::Compress(decoded.mips, m_imageFormats[imageIndex], compression.quality);
+        }
+    });
+}
+
+int Model::GetTextureImage(size_t textureIndex) const{
+    const int source = m_model.textures[textureIndex].source;
+    return source >= 0 && source < static_cast<int>(m_model.images.size()) ? source : -1;
+}
+
+Utility::MipGenerator::MipChain Model::MakeFallbackChain(){
+    const uint8_t white[4] = {255, 255, 255, 255};
+    return Utility::MipGenerator::Generate(white, 1, 1, 4, Utility::MipGenerator::Settings());
+}
+
+const uint8_t* Model::GetBuffer(size_t bufferViewIndex) const{
     const auto& bufferView = m_model.bufferViews[bufferViewIndex];
-    return m_model.buffers[bufferView.buffer].data.data() + bufferView.byteOffset;
+    return m_buffers[bufferView.buffer] + bufferView.byteOffset;
+}
+
+std::vector<float> Model::ReadFloats(const tinygltf::Accessor& accessor, uint32_t componentCount){
+    assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+
+    // without a buffer view every element starts at zero
+    std::vector<float> values(accessor.count * componentCount, 0.0f);
+    if(accessor.bufferView >= 0){
+        const float* src = reinterpret_cast<const float*>(GetBuffer(accessor.bufferView) + accessor.byteOffset);
+        std::copy(src, src + values.size(), values.begin());
+    }
+
+    if(accessor.sparse.isSparse){
+        const auto& indices = accessor.sparse.indices;
+        const uint8_t* index = GetBuffer(indices.bufferView) + indices.byteOffset;
+        const float*   value = reinterpret_cast<const float*>(GetBuffer(accessor.sparse.values.bufferView) + accessor.sparse.values.byteOffset);
+
+        for(int i = 0; i < accessor.sparse.count; i++, value += componentCount){
+            uint32_t element;
+            switch(indices.componentType){
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    element = index[i];
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                    element = reinterpret_cast<const uint16_t*>(index)[i];
+                    break;
+                default:
+                    element = reinterpret_cast<const uint32_t*>(index)[i];
+                    break;
+            }
+            std::copy(value, value + componentCount, values.begin() + size_t(element) * componentCount);
+        }
+    }
+
+    return values;
+}
+
+std::vector<std::shared_ptr<AnimationClip>> Model::LoadAnimations(){
+    std::vector<std::shared_ptr<AnimationClip>> clips;
+
+    for(const auto& animation : m_model.animations){
+        auto clip = std::make_shared<AnimationClip>();
+
+        for(const auto& channel : animation.channels){
+            if(channel.target_node < 0 || m_nodeSlots[channel.target_node] == SceneHierarchy::NoNode) continue;
+
+            const bool isWeights = channel.target_path == "weights";
+            AnimationClip::Path path = AnimationClip::Path::Translation;
+            if(channel.target_path == "rotation")   path = AnimationClip::Path::Rotation;
+            else if(channel.target_path == "scale") path = AnimationClip::Path::Scale;
+            else if(channel.target_path != "translation" && !isWeights) continue;
+
+            const auto& sampler = animation.samplers[channel.sampler];
+            const auto& input   = m_model.accessors[sampler.input];
+            const auto& output  = m_model.accessors[sampler.output];
+            assert(input.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && output.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+
+            const float*   times    = reinterpret_cast<const float*>(GetBuffer(input.bufferView) + input.byteOffset);
+            const float*   values   = reinterpret_cast<const float*>(GetBuffer(output.bufferView) + output.byteOffset);
+            const uint32_t keyCount = static_cast<uint32_t>(input.count);
+            const uint32_t slot     = m_nodeSlots[channel.target_node];
+
+            // cubic keys keep their in tangent, value and out tangent
+            AnimationClip::Interpolation interpolation = AnimationClip::Interpolation::Linear;
+            if(sampler.interpolation == "STEP")             interpolation = AnimationClip::Interpolation::Step;
+            else if(sampler.interpolation == "CUBICSPLINE") interpolation = AnimationClip::Interpolation::CubicSpline;
+
+            if(isWeights){
+                // one output per morph target and key, three of them for a cubic key
+                const uint32_t runs = interpolation == AnimationClip::Interpolation::CubicSpline ? 3 : 1;
+                if(keyCount == 0 || output.count % (size_t(keyCount) * runs) != 0) continue;
+                const uint32_t weightCount = static_cast<uint32_t>(output.count / (size_t(keyCount) * runs));
+                clip->AddWeightChannel(slot, interpolation, times, values, keyCount, weightCount);
+            }
+            else{
+                clip->AddChannel(slot, path, interpolation, times, values, keyCount);
+            }
+        }
+
+        clips.emplace_back(std::move(clip));
+    }
+
+    return clips;
+}
+
+std::vector<std::shared_ptr<Skin>> Model::LoadSkins(){
+    std::vector<std::shared_ptr<Skin>> skins;
+
+    for(size_t nodeIndex = 0; nodeIndex < m_model.nodes.size(); nodeIndex++){
+        const auto& node = m_model.nodes[nodeIndex];
+        if(node.skin < 0 || node.mesh < 0 || m_nodeSlots[nodeIndex] == SceneHierarchy::NoNode) continue;
+
+        const auto& skin = m_model.skins[node.skin];
+        std::vector<uint32_t> joints;
+        joints.reserve(skin.joints.size());
+        for(auto joint : skin.joints){
+            assert(m_nodeSlots[joint] != SceneHierarchy::NoNode);
+            joints.emplace_back(m_nodeSlots[joint]);
+        }
+
+        // identity when the skin gives none
+        std::vector<GeoMath::Matrix4f> inverseBinds(joints.size());
+        if(skin.inverseBindMatrices >= 0){
+            const auto& accessor = m_model.accessors[skin.inverseBindMatrices];
+            assert(accessor.type == TINYGLTF_TYPE_MAT4 && accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+
+            // column major in glTF, read row by row it is the matrix for row vectors
+            const float* m = reinterpret_cast<const float*>(GetBuffer(accessor.bufferView) + accessor.byteOffset);
+            for(size_t j = 0; j < joints.size(); j++, m += 16){
+                inverseBinds[j] = GeoMath::Matrix4f(
+                    m[0],  m[1],  m[2],  m[3],
+                    m[4],  m[5],  m[6],  m[7],
+                    m[8],  m[9],  m[10], m[11],
+                    m[12], m[13], m[14], m[15]
+                );
+            }
+        }
+
+        skins.emplace_back(std::make_shared<Skin>(m_nodeSlots[nodeIndex], std::move(joints), std::move(inverseBinds)));
+    }
+
+    return skins;
 }
\ No newline at end of file
@@ -1,14 +1,69 @@
 #pragma once
 #include "tiny_gltf.h"
 #include "SceneNode.hpp"
+#include "MappedFile.hpp"
+#include "ImageDecoder.hpp"
+#include "BlockCompressor.hpp"
 #include <vector>
 
+// block compression of the decoded images, the format of each follows how the materials use it
+struct TextureCompression{
+    bool                              isEnabled = false;
+    Utility::BlockCompressor::Quality quality   = Utility::BlockCompressor::Quality::Normal;
+};
+
 class Model{
 public:
     Model(const char* fileName);
 
 protected:
+    // nothing loaded, for models built from a cooked package
+    Model() = default;
+
     tinygltf::Model m_model;
-    uint8_t* GetBuffer(size_t bufferViewIndex);
+    // start of a buffer view, inside the mapped file for the binary chunk of a .glb
+    const uint8_t* GetBuffer(size_t bufferViewIndex) const;
+    // float elements of an accessor with its sparse values applied, morph targets are usually sparse
+    std::vector<float> ReadFloats(const tinygltf::Accessor& accessor, uint32_t componentCount);
+
+    // decodes the images the parser queued and builds their mip chains on the worker pool, onDecoded gets
+    // the index of every image in m_model.images as soon as it holds its RGBA8 texels and m_mipChains its mips
+    void DecodeImages(
+        const TextureCompression& compression = TextureCompression(),
+        const std::function<void(size_t imageIndex)>& onDecoded = nullptr
+    );
+
+    // image of a texture in m_model.images, -1 when the texture has none the loader reads, an image
+    // given only through an extension such as KHR_texture_basisu or EXT_texture_webp
+    int GetTextureImage(size_t textureIndex) const;
+    // one white texel, what such textures are bound to
+    static Utility::MipGenerator::MipChain MakeFallbackChain();
+
+    // a clip for every glTF animation, channels on nodes missing from m_nodeSlots are dropped
+    std::vector<std::shared_ptr<AnimationClip>> LoadAnimations();
+    // a skin for every node drawing a skinned mesh
+    std::vector<std::shared_ptr<Skin>> LoadSkins();
+
+    // hierarchy slot of every glTF node, filled while the scene is built
+    std::vector<uint32_t> m_nodeSlots;
+    // every level of every image, laid out for upload, filled by DecodeImages
+    std::vector<Utility::MipGenerator::MipChain> m_mipChains;
+    // format of every chain in m_mipChains, RGBA8 unless it was block compressed
+    std::vector<Utility::BlockCompressor::Format> m_imageFormats;
+
+private:
+    // parses the JSON chunk of a .glb in place, the binary chunk stays in the mapping
+    bool LoadBinary(tinygltf::TinyGLTF& loader, std::string& err, std::string& warn, const std::string& fileName);
+    // image loader of the parser, keeps the encoded bytes for DecodeImages instead of decoding them in turn
+    static bool QueueImage(
+        tinygltf::Image* image, const int imageIndex, std::string* err, std::string* warn,
+        int reqWidth, int reqHeight, const unsigned char* bytes, int size, void* userData
+    );
+
+    Utility::MappedFile         m_file;
+    const uint8_t*              m_binChunk = nullptr;
+    // data of every glTF buffer
+    std::vector<const uint8_t*> m_buffers;
+    ImageDecoder                m_imageDecoder;
 };
 
@@ -0,0 +1,129 @@
+#include "MorphTargets.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+MorphTargets::MorphTargets(const float* positions, const float* normals, const float* tangents, uint32_t vertexCount)
+    : m_vertexCount(vertexCount)
+    , m_base(vertexCount * 9, 0.0f)
+{
+    float* position = m_base.data();
+    float* normal   = position + vertexCount * 3;
+    float* tangent  = normal   + vertexCount * 3;
+
+    for(uint32_t v = 0; v < vertexCount; v++){
+        for(uint32_t k = 0; k < 3; k++){
+            position[k * vertexCount + v] = positions[v * 3 + k];
+            normal[k * vertexCount + v]   = normals[v * 3 + k];
+        }
+    }
+
+    if(tangents != nullptr){
+        m_tangentSigns.resize(vertexCount);
+        for(uint32_t v = 0; v < vertexCount; v++){
+            for(uint32_t k = 0; k < 3; k++){
+                tangent[k * vertexCount + v] = tangents[v * 4 + k];
+            }
+            m_tangentSigns[v] = tangents[v * 4 + 3];
+        }
+    }
+
+    m_morphed = m_base;
+}
+
+void MorphTargets::AddTarget(const float* positions, const float* normals, const float* tangents){
+    const float* sources[3] = {positions, normals, HasTangents() ? tangents : nullptr};
+
+    Target target;
+    for(uint8_t a = 0; a < 3; a++){
+        if(sources[a] == nullptr) continue;
+        for(uint8_t k = 0; k < 3; k++) target.components.emplace_back(a * 3 + k);
+    }
+
+    auto IsMoved = [&](uint32_t v){
+        for(const float* source : sources){
+            if(source != nullptr && (source[v * 3] != 0.0f || source[v * 3 + 1] != 0.0f || source[v * 3 + 2] != 0.0f)) return true;
+        }
+        return false;
+    };
+
+    uint32_t v = 0;
+    while(v < m_vertexCount){
+        if(!IsMoved(v)){
+            v++;
+            continue;
+        }
+
+        // the span grows while the next moved vertex is close enough, the still ones between get zero deltas
+        uint32_t last = v;
+        for(uint32_t next = v + 1; next < m_vertexCount && next - last <= MergeGap; next++){
+            if(IsMoved(next)) last = next;
+        }
+
+        Span span{v, last + 1 - v, static_cast<uint32_t>(target.deltas.size())};
+        for(uint8_t component : target.components){
+            const float* source = sources[component / 3];
+            for(uint32_t u = v; u <= last; u++){
+                target.deltas.emplace_back(source[u * 3 + component % 3]);
+            }
+        }
+        target.spans.emplace_back(span);
+        v = last + 1;
+    }
+
+    m_targets.emplace_back(std::move(target));
+}
+
+size_t MorphTargets::GetDeltaCount() const{
+    size_t count = 0;
+    for(const auto& target : m_targets){
+        for(const auto& span : target.spans) count += span.count;
+    }
+    return count;
+}
+
+bool MorphTargets::Apply(const float* weights){
+    if(m_weights.size() == m_targets.size() && std::equal(m_weights.begin(), m_weights.end(), weights)) return false;
+    m_weights.assign(weights, weights + m_targets.size());
+
+    const uint32_t n = m_vertexCount;
+    const float* base    = m_base.data();
+    float*       morphed = m_morphed.data();
+
+    // back to the base where the previous weights moved the vertices
+    for(auto t : m_active){
+        const Target& target = m_targets[t];
+        for(const auto& span : target.spans){
+            for(uint8_t component : target.components){
+                const size_t first = size_t(component) * n + span.first;
+                memcpy(morphed + first, base + first, span.count * sizeof(float));
+            }
+        }
+    }
+    m_active.clear();
+
+    for(uint32_t t = 0; t < m_targets.size(); t++){
+        const Target& target = m_targets[t];
+        if(weights[t] == 0.0f || target.spans.empty()) continue;
+        m_active.emplace_back(t);
+
+        for(const auto& span : target.spans){
+            const float* delta = target.deltas.data() + span.offset;
+            for(uint8_t component : target.components){
+                GeoMath::AddScaledFloats(delta, weights[t], morphed + size_t(component) * n + span.first, span.count);
+                delta += span.count;
+            }
+        }
+    }
+    return true;
+}
+
+GeoMath::ConstSkinVertexStream MorphTargets::GetStreams(const float* data) const{
+    const uint32_t n = m_vertexCount;
+    const float* tangent = HasTangents() ? data + n * 6 : nullptr;
+    return GeoMath::ConstSkinVertexStream{
+        GeoMath::ConstVector3fStream(data, data + n, data + n * 2),
+        GeoMath::ConstVector3fStream(data + n * 3, data + n * 4, data + n * 5),
+        GeoMath::ConstVector3fStream(tangent, tangent != nullptr ? tangent + n : nullptr, tangent != nullptr ? tangent + n * 2 : nullptr)
+    };
+}
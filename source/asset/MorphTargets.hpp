@@ -0,0 +1,64 @@
+#pragma once
+#include "GeoMathBatch.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Blend shapes of one mesh as sparse deltas. A target keeps only the runs of vertices it moves,
+// runs less than MergeGap vertices apart are joined, so evaluating it is a weighted sum over a few
+// long contiguous spans. Targets of zero weight cost nothing.
+class MorphTargets{
+public:
+    // glTF layouts: positions and normals xyz, tangents xyzw or null
+    MorphTargets(const float* positions, const float* normals, const float* tangents, uint32_t vertexCount);
+
+    // xyz deltas of every vertex, null for an attribute the target does not move
+    void AddTarget(const float* positions, const float* normals, const float* tangents);
+
+    // morphed = base + sum(weights[t] * target t), one weight per target. Only the vertices moved by
+    // the previous or the new weights are written, returns false when the weights did not change.
+    bool Apply(const float* weights);
+
+    uint32_t GetTargetCount() const { return static_cast<uint32_t>(m_targets.size()); }
+    uint32_t GetVertexCount() const { return m_vertexCount; }
+    bool     HasTangents()    const { return !m_tangentSigns.empty(); }
+    // vertices every target moves, counted once per target
+    size_t   GetDeltaCount()  const;
+
+    GeoMath::ConstSkinVertexStream GetBase()    const { return GetStreams(m_base.data()); }
+    // result of the last Apply, the base before the first one
+    GeoMath::ConstSkinVertexStream GetMorphed() const { return GetStreams(m_morphed.data()); }
+    const float* GetTangentSigns() const { return m_tangentSigns.data(); }
+
+    // deltas further apart than this start a new span
+    inline static const uint32_t MergeGap = 16;
+
+protected:
+    GeoMath::ConstSkinVertexStream GetStreams(const float* data) const;
+
+    struct Span{
+        uint32_t first;
+        uint32_t count;
+        // the deltas of the span, one run of count floats per moved component
+        uint32_t offset;
+    };
+
+    struct Target{
+        std::vector<Span>  spans;
+        std::vector<float> deltas;
+        // components of m_base the target moves, 3 per attribute
+        std::vector<uint8_t> components;
+    };
+
+    uint32_t m_vertexCount;
+
+    // x, y, z streams of the positions, normals and tangents one after another
+    std::vector<float>    m_base;
+    std::vector<float>    m_morphed;
+    std::vector<float>    m_tangentSigns;
+
+    std::vector<Target>   m_targets;
+    std::vector<float>    m_weights;
+    // targets of non zero weight in the last Apply
+    std::vector<uint32_t> m_active;
+};
@@ -0,0 +1,79 @@
+#include "RenderQueue.hpp"
+
+RenderQueue::StateChanges RenderQueue::CountStateChanges(const uint64_t* keys, size_t count){
+    const uint64_t meshShift     = DepthBits;
+    const uint64_t materialShift = meshShift + MeshBits;
+    const uint64_t pipelineShift = materialShift + MaterialBits;
+    const uint64_t passShift     = pipelineShift + PipelineBits;
+
+    StateChanges changes{0, 0, 0, 0};
+    for(size_t i = 0; i < count; i++){
+        // the first key binds everything
+        uint64_t diff = i > 0 ? keys[i] ^ keys[i - 1] : ~0ull;
+        changes.passes    += (diff >> passShift) != 0 ? 1 : 0;
+        changes.pipelines += ((diff >> pipelineShift) & ((1u << PipelineBits) - 1)) != 0 ? 1 : 0;
+        changes.materials += ((diff >> materialShift) & ((1u << MaterialBits) - 1)) != 0 ? 1 : 0;
+        changes.meshes    += ((diff >> meshShift)     & ((1u << MeshBits) - 1))     != 0 ? 1 : 0;
+    }
+    return changes;
+}
+
+void RenderQueue::Clear(){
+    m_keys.clear();
+    m_values.clear();
+}
+
+void RenderQueue::Reserve(size_t count){
+    m_keys.reserve(count);
+    m_values.reserve(count);
+}
+
+void RenderQueue::Add(uint64_t key, uint32_t value){
+    m_keys.emplace_back(key);
+    m_values.emplace_back(value);
+}
+
+void RenderQueue::Sort(){
+    const size_t count = m_keys.size();
+    if(count < 2) return;
+
+    // one read builds the histograms of all 8 digits, the loop has no branches and vectorizes
+    uint32_t histograms[8][256] = {};
+    for(size_t i = 0; i < count; i++){
+        uint64_t key = m_keys[i];
+        for(uint32_t digit = 0; digit < 8; digit++){
+            histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    m_tmpKeys.resize(count);
+    m_tmpValues.resize(count);
+
+    for(uint32_t digit = 0; digit < 8; digit++){
+        uint32_t* histogram = histograms[digit];
+        const uint32_t shift = digit * 8;
+
+        // the pass and the pipeline rarely differ within a frame, their digits cost nothing
+        if(histogram[(m_keys[0] >> shift) & 0xFF] == count) continue;
+
+        uint32_t offset = 0;
+        for(uint32_t bucket = 0; bucket < 256; bucket++){
+            uint32_t size = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += size;
+        }
+
+        const uint64_t* keys   = m_keys.data();
+        const uint32_t* values = m_values.data();
+        uint64_t* outKeys   = m_tmpKeys.data();
+        uint32_t* outValues = m_tmpValues.data();
+        for(size_t i = 0; i < count; i++){
+            uint32_t target = histogram[(keys[i] >> shift) & 0xFF]++;
+            outKeys[target]   = keys[i];
+            outValues[target] = values[i];
+        }
+
+        m_keys.swap(m_tmpKeys);
+        m_values.swap(m_tmpValues);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 64 bit draw keys with the most expensive state in the top bits, sorted with an LSD radix sort.
+//   63..60 pass | 59..44 pipeline state flag | 43..28 material | 27..12 mesh | 11..0 view depth bucket
+// Every key carries a 32 bit value, the index of whatever the key was made for.
+class RenderQueue{
+public:
+    // state switched between two neighbouring keys
+    struct StateChanges{
+        uint32_t passes;
+        uint32_t pipelines;
+        uint32_t materials;
+        uint32_t meshes;
+    };
+
+    static inline uint64_t MakeKey(uint32_t pass, uint64_t pipelineFlag, uint32_t material, uint32_t mesh, float depth);
+    // key without the depth bucket, equal for draws that only differ in depth
+    static uint64_t GetStateKey(uint64_t key) { return key >> DepthBits; }
+
+    // state changes when the keys are submitted in the given order
+    static StateChanges CountStateChanges(const uint64_t* keys, size_t count);
+
+    void Clear();
+    void Reserve(size_t count);
+    void Add(uint64_t key, uint32_t value);
+    // stable, digits shared by every key are skipped
+    void Sort();
+
+    size_t GetSize() const { return m_keys.size(); }
+    const std::vector<uint64_t>& GetKeys()   const { return m_keys; }
+    const std::vector<uint32_t>& GetValues() const { return m_values; }
+
+    inline static const uint32_t GeometryPass = 0;
+
+    inline static const uint32_t DepthBits    = 12;
+    inline static const uint32_t MeshBits     = 16;
+    inline static const uint32_t MaterialBits = 16;
+    inline static const uint32_t PipelineBits = 16;
+    inline static const uint32_t PassBits     = 4;
+
+protected:
+    // depth >= 0 as the top bits of its float, a logarithmic bucket without a far plane
+    static inline uint32_t DepthBucket(float depth);
+
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_values;
+    std::vector<uint64_t> m_tmpKeys;
+    std::vector<uint32_t> m_tmpValues;
+};
+
+uint32_t RenderQueue::DepthBucket(float depth){
+    if(!(depth > 0.0f)) return 0;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (31 - DepthBits);
+}
+
+uint64_t RenderQueue::MakeKey(uint32_t pass, uint64_t pipelineFlag, uint32_t material, uint32_t mesh, float depth){
+    uint64_t key = pass & ((1u << PassBits) - 1);
+    key = (key << PipelineBits) | (pipelineFlag & ((1u << PipelineBits) - 1));
+    key = (key << MaterialBits) | (material     & ((1u << MaterialBits) - 1));
+    key = (key << MeshBits)     | (mesh         & ((1u << MeshBits) - 1));
+    key = (key << DepthBits)    | DepthBucket(depth);
+    return key;
+}
@@ -0,0 +1,234 @@
+#include "SceneCooker.hpp"
+#include "Material.hpp"
+#include "PackedVertex.hpp"
+
+#include <cstring>
+
+SceneCooker::SceneCooker(const char* fileName, const TextureCompression& compression)
+    : Model(fileName)
+    , m_compression(compression)
+{
+}
+
+bool SceneCooker::Cook(){
+    for(auto& section : m_sections) section.clear();
+
+    if(m_model.scenes.empty()) return Fail("no scene to cook");
+    if(!m_model.skins.empty() || !m_model.animations.empty()) return Fail("skins and animations are loaded from glTF");
+
+    DecodeImages(m_compression);
+    if(!CookTextures() || !CookMaterials() || !CookMeshes()) return false;
+    CookNodes();
+    return true;
+}
+
+bool SceneCooker::CookTextures(){
+    // textures without an image the loader reads get the white texel Dx12Model binds for them
+    const auto fallback = MakeFallbackChain();
+
+    for(size_t index = 0; index < m_model.textures.size(); index++){
+        const int imageIndex = GetTextureImage(index);
+        if(imageIndex >= 0){
+            const auto& image = m_model.images[imageIndex];
+            if(image.component != 4 || image.bits != 8) return Fail("texture " + image.name + " is not RGBA8");
+        }
+
+        // the mip chain as the loader copies it into the texture, DecodeImages built it
+        const auto& mips = imageIndex >= 0 ? m_mipChains[imageIndex] : fallback;
+        ScenePackage::Texture texture;
+        texture.format      = imageIndex >= 0 ? m_imageFormats[imageIndex] : Utility::BlockCompressor::Format::RGBA8;
+        texture.width       = mips.levels[0].width;
+        texture.height      = mips.levels[0].height;
+        texture.mipLevels   = static_cast<uint32_t>(mips.levels.size());
+        texture.texelOffset = m_sections[ScenePackage::Texels].size();
+        Append(ScenePackage::Textures, texture);
+
+        auto& texels = m_sections[ScenePackage::Texels];
+        texels.insert(texels.end(), mips.data.begin(), mips.data.end());
+    }
+    return true;
+}
+
+bool SceneCooker::CookMaterials(){
+    auto& constants = m_sections[ScenePackage::MaterialConstants];
+    constants.resize(m_model.materials.size() * ScenePackage::ConstantStride, 0);
+
+    // carried from one material to the next like in Dx12Model, factors a material does not give keep the last ones
+    MaterialConstant matConst;
+    for(size_t index = 0; index < m_model.materials.size(); index++){
+        auto& mat = m_model.materials[index];
+        ScenePackage::Material material = {0, mat.doubleSided ? 1u : 0u};
+
+        matConst.alphaCutoff = static_cast<float>(mat.alphaCutoff);
+        matConst.essisiveFactor = GeoMath::Vector3f(
+            static_cast<float>(mat.emissiveFactor[0]),
+            static_cast<float>(mat.emissiveFactor[1]),
+            static_cast<float>(mat.emissiveFactor[2])
+        );
+
+        if(mat.extensions.find("KHR_materials_pbrSpecularGlossiness") != mat.extensions.end()){
+            auto& pbrParam   = mat.extensions["KHR_materials_pbrSpecularGlossiness"];
+            auto& diffuse    = pbrParam.Get("diffuseFactor");
+            auto& specular   = pbrParam.Get("specularFactor");
+            auto& glossiness = pbrParam.Get("glossinessFactor");
+
+            matConst.diffuseFactor = GeoMath::Vector4f(
+                static_cast<float>(diffuse.Get(0).GetNumberAsDouble()),
+                static_cast<float>(diffuse.Get(1).GetNumberAsDouble()),
+                static_cast<float>(diffuse.Get(2).GetNumberAsDouble()),
+                static_cast<float>(diffuse.Get(3).GetNumberAsDouble())
+            );
+
+            matConst.specularFactor = GeoMath::Vector3f(
+                static_cast<float>(specular.Get(0).GetNumberAsDouble()),
+                static_cast<float>(specular.Get(1).GetNumberAsDouble()),
+                static_cast<float>(specular.Get(2).GetNumberAsDouble())
+            );
+
+            matConst.glossinessFactor = static_cast<float>(glossiness.GetNumberAsDouble());
+
+            if(pbrParam.Has("diffuseTexture")){
+                material.textureIndex = static_cast<uint32_t>(pbrParam.Get("diffuseTexture").Get("index").GetNumberAsInt());
+            }
+        }
+
+        memcpy(constants.data() + index * ScenePackage::ConstantStride, &matConst, sizeof(MaterialConstant));
+        Append(ScenePackage::Materials, material);
+    }
+    return true;
+}
+
+bool SceneCooker::CookMeshes(){
+    const auto& materials = m_sections[ScenePackage::Materials];
+
+    uint32_t primitiveCount = 0;
+    for(const auto& mesh : m_model.meshes){
+        ScenePackage::Mesh record = {primitiveCount, static_cast<uint32_t>(mesh.primitives.size()), 0, 0, 0};
+        ScenePackage::RayTraceInfo meshInfo;
+
+        for(const auto& primitive : mesh.primitives){
+            if(primitive.mode != TINYGLTF_MODE_TRIANGLES) return Fail("mesh " + mesh.name + " is not a triangle list");
+            if(!primitive.targets.empty()) return Fail("mesh " + mesh.name + " has morph targets");
+            if(primitive.material < 0 || primitive.indices < 0) return Fail("mesh " + mesh.name + " needs a material and indices");
+
+            ScenePackage::Primitive packed = {};
+            const float* position = nullptr;
+            const float* normal   = nullptr;
+            const float* tangent  = nullptr;
+            const float* texcoord = nullptr;
+
+            for(const auto& attributes : primitive.attributes){
+                const std::string& attrName = attributes.first;
+                const auto& accessor = m_model.accessors[attributes.second];
+                if(attrName == "JOINTS_0" || attrName == "WEIGHTS_0") return Fail("mesh " + mesh.name + " is skinned");
+
+                const bool isVertexAttribute = attrName == "POSITION" || attrName == "NORMAL" || attrName == "TANGENT" || attrName == "TEXCOORD_0";
+                if(!isVertexAttribute) continue;
+                if(accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) return Fail("mesh " + mesh.name + " has attributes that are not float");
+
+                const float* data = reinterpret_cast<const float*>(GetBuffer(accessor.bufferView) + accessor.byteOffset);
+                if(attrName == "POSITION"){
+                    position = data;
+                    if(accessor.minValues.size() == 3 && accessor.maxValues.size() == 3){
+                        for(int k = 0; k < 3; k++){
+                            packed.boundsMin[k] = static_cast<float>(accessor.minValues[k]);
+                            packed.boundsMax[k] = static_cast<float>(accessor.maxValues[k]);
+                        }
+                        packed.hasBounds = 1;
+                    }
+                }
+                else if(attrName == "NORMAL")   normal   = data;
+                else if(attrName == "TANGENT")  tangent  = data;
+                else                            texcoord = data;
+                packed.vertexCount = static_cast<uint32_t>(accessor.count);
+            }
+            if(position == nullptr || normal == nullptr) return Fail("mesh " + mesh.name + " lacks positions or normals");
+
+            const auto& indexAccessor = m_model.accessors[primitive.indices];
+            if(indexAccessor.type != TINYGLTF_TYPE_SCALAR || indexAccessor.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT){
+                return Fail("mesh " + mesh.name + " has indices that are not uint32");
+            }
+
+            const uint32_t vertexCount = packed.vertexCount;
+            packed.material   = static_cast<uint32_t>(primitive.material);
+            packed.indexCount = static_cast<uint32_t>(indexAccessor.count);
+            packed.layout     = tangent != nullptr && texcoord != nullptr ? ScenePackage::Layout::PositionNormalTangentTexCoord : ScenePackage::Layout::PositionNormal;
+
+            auto& indices = m_sections[ScenePackage::Indices];
+            const uint8_t* indexData = GetBuffer(indexAccessor.bufferView) + indexAccessor.byteOffset;
+            packed.indexOffset        = indices.size();
+            meshInfo.indexOffsetBytes = static_cast<uint32_t>(indices.size());
+            indices.insert(indices.end(), indexData, indexData + sizeof(uint32_t) * packed.indexCount);
+
+            // the streams one after another, as Dx12SOA lays them out
+            std::vector<GeoMath::SNorm16x4> packedPosition(vertexCount);
+            std::vector<GeoMath::SNorm16x2> packedNormal(vertexCount);
+            GeoMath::BoundingBox positionBounds = GeoMath::PackPositions(position, vertexCount, packedPosition.data());
+            GeoMath::PackNormals(normal, vertexCount, packedNormal.data());
+            for(int k = 0; k < 3; k++){
+                packed.center[k] = meshInfo.positionCenter[k] = positionBounds.center.data[k];
+                packed.extent[k] = meshInfo.positionExtent[k] = positionBounds.extent.data[k];
+            }
+
+            auto& vertices = m_sections[ScenePackage::Vertices];
+            auto AppendStream = [&](const void* data, size_t byteSize){
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                vertices.insert(vertices.end(), bytes, bytes + byteSize);
+            };
+
+            packed.vertexOffset          = vertices.size();
+            meshInfo.positionOffsetBytes = static_cast<uint32_t>(vertices.size());
+            AppendStream(packedPosition.data(), sizeof(GeoMath::SNorm16x4) * vertexCount);
+            meshInfo.normalOffsetBytes   = static_cast<uint32_t>(vertices.size());
+            AppendStream(packedNormal.data(), sizeof(GeoMath::SNorm16x2) * vertexCount);
+
+            if(packed.layout == ScenePackage::Layout::PositionNormalTangentTexCoord){
+                std::vector<GeoMath::SNorm16x4> packedTangent(vertexCount);
+                std::vector<GeoMath::Half2>     packedTexCoord(vertexCount);
+                GeoMath::PackTangents(tangent, vertexCount, packedTangent.data());
+                GeoMath::PackTexCoords(texcoord, vertexCount, packedTexCoord.data());
+
+                meshInfo.tangentOffsetBytes = static_cast<uint32_t>(vertices.size());
+                AppendStream(packedTangent.data(), sizeof(GeoMath::SNorm16x4) * vertexCount);
+                meshInfo.uvOffsetBytes      = static_cast<uint32_t>(vertices.size());
+                AppendStream(packedTexCoord.data(), sizeof(GeoMath::Half2) * vertexCount);
+            }
+
+            meshInfo.matIndex   = packed.material;
+            record.vertexCount  = vertexCount;
+            record.indexCount   = packed.indexCount;
+            record.textureIndex = packed.material * sizeof(ScenePackage::Material) < materials.size()
+                ? reinterpret_cast<const ScenePackage::Material*>(materials.data())[packed.material].textureIndex : 0;
+            Append(ScenePackage::Primitives, packed);
+        }
+
+        primitiveCount += record.primitiveCount;
+        Append(ScenePackage::Meshes, record);
+        Append(ScenePackage::RayTraceInfos, meshInfo);
+    }
+    return true;
+}
+
+void SceneCooker::CookNodes(){
+    for(const auto& glNode : m_model.nodes){
+        ScenePackage::Node node = {};
+        node.mesh       = glNode.mesh;
+        node.firstChild = static_cast<uint32_t>(m_sections[ScenePackage::Children].size() / sizeof(uint32_t));
+        node.childCount = static_cast<uint32_t>(glNode.children.size());
+        node.rotation[3] = 1.0f;
+        node.scale[0] = node.scale[1] = node.scale[2] = 1.0f;
+
+        for(size_t i = 0; i < glNode.translation.size() && i < 3; i++) node.translation[i] = static_cast<float>(glNode.translation[i]);
+        for(size_t i = 0; i < glNode.rotation.size()    && i < 4; i++) node.rotation[i]    = static_cast<float>(glNode.rotation[i]);
+        for(size_t i = 0; i < glNode.scale.size()       && i < 3; i++) node.scale[i]       = static_cast<float>(glNode.scale[i]);
+        if(glNode.matrix.size() == 16){
+            node.hasMatrix = 1;
+            for(size_t i = 0; i < 16; i++) node.matrix[i] = static_cast<float>(glNode.matrix[i]);
+        }
+
+        for(int child : glNode.children) Append(ScenePackage::Children, static_cast<uint32_t>(child));
+        Append(ScenePackage::Nodes, node);
+    }
+
+    for(int root : m_model.scenes[0].nodes) Append(ScenePackage::Roots, static_cast<uint32_t>(root));
+}
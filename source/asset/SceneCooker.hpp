@@ -0,0 +1,41 @@
+#pragma once
+#include "Model.hpp"
+#include "ScenePackage.hpp"
+
+#include <string>
+
+// Converts a glTF scene into a ScenePackage the way Dx12Model would at load: attributes packed into
+// the vertex0 or vertex1 streams, textures as block compressed mip chains, material constants and ray
+// tracing mesh info laid out for upload. Only static scenes are cooked, skins, morph targets and
+// animations are left to the glTF loader.
+class SceneCooker : public Model{
+public:
+    explicit SceneCooker(const char* fileName, const TextureCompression& compression = TextureCompression{true});
+
+    SceneCooker(const SceneCooker&)            = delete;
+    SceneCooker& operator=(const SceneCooker&) = delete;
+
+    // fills the sections, false with GetError set when the scene can not be cooked
+    bool Cook();
+    bool Write(const char* fileName) const { return ScenePackage::Write(fileName, m_sections); }
+
+    const std::string& GetError() const { return m_error; }
+
+protected:
+    bool CookTextures();
+    bool CookMaterials();
+    bool CookMeshes();
+    void CookNodes();
+
+    bool Fail(const std::string& error){ m_error = error; return false; }
+
+    template<typename T>
+    void Append(ScenePackage::Section section, const T& record){
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&record);
+        m_sections[section].insert(m_sections[section].end(), data, data + sizeof(T));
+    }
+
+    TextureCompression   m_compression;
+    std::vector<uint8_t> m_sections[ScenePackage::SectionCount];
+    std::string          m_error;
+};
@@ -0,0 +1,187 @@
+#include "SceneHierarchy.hpp"
+
+#include <cassert>
+
+uint32_t SceneHierarchy::Add(uint32_t parent, SceneNode* node){
+    uint32_t index = static_cast<uint32_t>(m_parents.size());
+
+    m_parents.emplace_back(parent);
+    m_firstChilds.emplace_back(NoNode);
+    m_nextSiblings.emplace_back(NoNode);
+    m_subtreeSizes.emplace_back(1);
+    m_locals.emplace_back();
+    m_worlds.emplace_back();
+    if(m_isKeepingPrevious) m_previousWorlds.emplace_back();
+    m_localTypes.emplace_back(GeoMath::TransformType::Rigid);
+    m_worldTypes.emplace_back(GeoMath::TransformType::Rigid);
+    m_dirty.emplace_back(0);
+    m_changedGenerations.emplace_back(0);
+    m_nodes.emplace_back(node);
+
+    if(parent != NoNode){
+        m_nextSiblings[index] = m_firstChilds[parent];
+        m_firstChilds[parent] = index;
+        for(uint32_t p = parent; p != NoNode; p = m_parents[p]) m_subtreeSizes[p]++;
+    }
+
+    Pollute(index);
+    return index;
+}
+
+void SceneHierarchy::SetParent(uint32_t index, uint32_t parent){
+    assert(parent == NoParent || parent < index);
+
+    const uint32_t oldParent = m_parents[index];
+    const uint32_t size      = m_subtreeSizes[index];
+
+    if(oldParent != parent){
+        if(oldParent != NoNode){
+            uint32_t* link = &m_firstChilds[oldParent];
+            while(*link != index) link = &m_nextSiblings[*link];
+            *link = m_nextSiblings[index];
+            for(uint32_t p = oldParent; p != NoNode; p = m_parents[p]) m_subtreeSizes[p] -= size;
+        }
+
+        m_parents[index]      = parent;
+        m_nextSiblings[index] = NoNode;
+
+        if(parent != NoNode){
+            m_nextSiblings[index] = m_firstChilds[parent];
+            m_firstChilds[parent] = index;
+            for(uint32_t p = parent; p != NoNode; p = m_parents[p]) m_subtreeSizes[p] += size;
+        }
+    }
+
+    Pollute(index);
+}
+
+void SceneHierarchy::SetLocal(uint32_t index, const GeoMath::Matrix4f& local, GeoMath::TransformType type){
+    m_locals[index]     = local;
+    m_localTypes[index] = type;
+    Pollute(index);
+}
+
+void SceneHierarchy::Pollute(uint32_t index){
+    if(m_dirty[index] == 0){
+        m_dirty[index] = 1;
+        m_dirtyList.emplace_back(index);
+    }
+}
+
+void SceneHierarchy::KeepPreviousWorlds(){
+    m_isKeepingPrevious = true;
+    m_previousWorlds    = m_worlds;
+}
+
+void SceneHierarchy::UpdateNode(uint32_t index){
+    const uint32_t parent = m_parents[index];
+    // a node updated for the first time had no world before
+    const bool isNew = m_changedGenerations[index] == 0;
+    if(m_isKeepingPrevious) m_previousWorlds[index] = m_worlds[index];
+
+    if(parent == NoParent){
+        m_worlds[index]     = m_locals[index];
+        m_worldTypes[index] = m_localTypes[index];
+    }
+    else{
+        m_worlds[index]     = m_locals[index] * m_worlds[parent];
+        m_worldTypes[index] = GeoMath::Combine(m_localTypes[index], m_worldTypes[parent]);
+    }
+    m_dirty[index]              = 0;
+    m_changedGenerations[index] = m_generation;
+    if(m_isKeepingPrevious && isNew) m_previousWorlds[index] = m_worlds[index];
+}
+
+uint32_t* SceneHierarchy::UpdateSubtree(uint32_t root, uint32_t* out){
+    // the output doubles as the queue, breadth first so a parent is always done before its children
+    uint32_t* head = out;
+    uint32_t* tail = out;
+    *tail++ = root;
+
+    while(head != tail){
+        uint32_t index = *head++;
+        UpdateNode(index);
+        for(uint32_t child = m_firstChilds[index]; child != NoNode; child = m_nextSiblings[child]){
+            *tail++ = child;
+        }
+    }
+    return tail;
+}
+
+void SceneHierarchy::Update(Utility::WorkerPool* pool){
+    m_generation++;
+    m_changed.clear();
+    if(m_dirtyList.empty()) return;
+
+    // a dirty node below another dirty one is covered by the walk from the upper one
+    m_roots.clear();
+    size_t total = 0;
+    for(auto index : m_dirtyList){
+        bool isCovered = false;
+        for(uint32_t p = m_parents[index]; p != NoNode && isCovered == false; p = m_parents[p]){
+            isCovered = m_dirty[p] != 0;
+        }
+        if(isCovered == false){
+            m_roots.emplace_back(index);
+            total += m_subtreeSizes[index];
+        }
+    }
+    m_dirtyList.clear();
+
+    m_changed.resize(total);
+    uint32_t* out = m_changed.data();
+
+    const uint32_t threadCount = pool != nullptr ? pool->GetThreadCount() : 1;
+    if(threadCount == 1 || total < ParallelThreshold){
+        if(total * 2 < m_parents.size()){
+            for(auto root : m_roots){
+                out = UpdateSubtree(root, out);
+            }
+        }
+        else{
+            // most of the scene moved, one pass in storage order beats chasing the child links
+            for(uint32_t i = 0; i < m_parents.size(); i++){
+                const uint32_t parent = m_parents[i];
+                if(m_dirty[i] != 0 || (parent != NoNode && m_changedGenerations[parent] == m_generation)){
+                    UpdateNode(i);
+                    *out++ = i;
+                }
+            }
+        }
+        return;
+    }
+
+    // a subtree holding too much of the work is opened up, its root is done here
+    // and its children become separate tasks
+    const size_t target = total / (threadCount * 4) + 1;
+    size_t taskCount = 0;
+    for(size_t i = 0; i < m_roots.size(); i++){
+        uint32_t root = m_roots[i];
+        if(m_subtreeSizes[root] > target && m_firstChilds[root] != NoNode){
+            UpdateNode(root);
+            *out++ = root;
+            for(uint32_t child = m_firstChilds[root]; child != NoNode; child = m_nextSiblings[child]){
+                m_roots.emplace_back(child);
+            }
+        }
+        else{
+            m_roots[taskCount++] = root;
+        }
+    }
+    m_roots.resize(taskCount);
+
+    // every task writes its own range of the changed list
+    m_rootOffsets.resize(taskCount);
+    size_t offset = out - m_changed.data();
+    for(size_t i = 0; i < taskCount; i++){
+        m_rootOffsets[i] = offset;
+        offset += m_subtreeSizes[m_roots[i]];
+    }
+
+    const size_t grain = taskCount / (threadCount * 8) + 1;
+    pool->ParallelFor(taskCount, grain, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            UpdateSubtree(m_roots[i], m_changed.data() + m_rootOffsets[i]);
+        }
+    });
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "GeoMath.hpp"
+#include "WorkerPool.hpp"
+
+#include <vector>
+
+class SceneNode;
+
+// Transforms of the scene nodes kept in flat arrays, a node is added after its parent.
+// Changed nodes go on a dirty list, an update only walks the subtrees below them, so its
+// cost follows what moved rather than the size of the scene. Large change sets are split
+// into subtrees spread over the worker pool.
+class SceneHierarchy{
+public:
+    uint32_t Add(uint32_t parent, SceneNode* node);
+
+    // parent has to precede index, NoParent makes the local matrix the world matrix
+    void SetParent(uint32_t index, uint32_t parent);
+    void SetLocal(uint32_t index, const GeoMath::Matrix4f& local, GeoMath::TransformType type);
+    void Pollute(uint32_t index);
+    // a node was set or polluted since the last Update
+    bool IsDirty() const { return !m_dirtyList.empty(); }
+
+    // recomputes the world matrices of the dirty nodes and of everything below them,
+    // the result does not depend on the pool
+    void Update(Utility::WorkerPool* pool = nullptr);
+
+    uint32_t GetParent(uint32_t index) const { return m_parents[index]; }
+    const GeoMath::Matrix4f& GetLocal(uint32_t index) const { return m_locals[index]; }
+    const GeoMath::Matrix4f& GetWorld(uint32_t index) const { return m_worlds[index]; }
+    GeoMath::TransformType GetWorldType(uint32_t index) const { return m_worldTypes[index]; }
+
+    // keeps the world matrices the next updates overwrite, for blending between two of them
+    void KeepPreviousWorlds();
+    // world matrix before the last Update, for the nodes it changed once previous worlds are kept
+    const GeoMath::Matrix4f& GetPreviousWorld(uint32_t index) const { return m_previousWorlds[index]; }
+    // replaces the world matrix without touching the children, until the node is updated again
+    void SetWorld(uint32_t index, const GeoMath::Matrix4f& world){ m_worlds[index] = world; }
+
+    // nodes whose world matrix changed in the last Update, every parent before its children
+    const std::vector<uint32_t>& GetChanged() const { return m_changed; }
+    bool IsChanged(uint32_t index) const { return m_changedGenerations[index] == m_generation; }
+
+    size_t GetSize() const { return m_parents.size(); }
+    size_t GetSubtreeSize(uint32_t index) const { return m_subtreeSizes[index]; }
+    const std::vector<SceneNode*>& GetNodes() const { return m_nodes; }
+
+    inline static const uint32_t NoNode   = 0xFFFFFFFF;
+    inline static const uint32_t NoParent = NoNode;
+
+    // below this many changed nodes the serial walk is faster than waking the workers
+    inline static const size_t ParallelThreshold = 16384;
+
+protected:
+    inline void UpdateNode(uint32_t index);
+    // root and everything below it, written to out in visiting order, returns the end
+    uint32_t* UpdateSubtree(uint32_t root, uint32_t* out);
+
+    std::vector<uint32_t>               m_parents;
+    std::vector<uint32_t>               m_firstChilds;
+    std::vector<uint32_t>               m_nextSiblings;
+    std::vector<uint32_t>               m_subtreeSizes;
+    std::vector<GeoMath::Matrix4f>      m_locals;
+    std::vector<GeoMath::Matrix4f>      m_worlds;
+    std::vector<GeoMath::Matrix4f>      m_previousWorlds;
+    std::vector<GeoMath::TransformType> m_localTypes;
+    std::vector<GeoMath::TransformType> m_worldTypes;
+    std::vector<uint8_t>                m_dirty;
+    std::vector<uint64_t>               m_changedGenerations;
+    std::vector<SceneNode*>             m_nodes;
+
+    bool                  m_isKeepingPrevious = false;
+    uint64_t              m_generation = 0;
+    std::vector<uint32_t> m_dirtyList;
+    std::vector<uint32_t> m_roots;
+    std::vector<size_t>   m_rootOffsets;
+    std::vector<uint32_t> m_changed;
+};
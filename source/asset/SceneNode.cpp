@@ -1,95 +1,316 @@
 #include "SceneNode.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 SceneNode::SceneNode(uint32_t nodeIndex, SceneNode* pParentNode)
     : m_isVisible(true)
-    , m_isDirty(true)
     , m_isUseSingleMatrix(false)
-    , m_dirtyCount(FrameCount)
+    , m_isDeformed(false)
     , m_nodeIndex(nodeIndex)
+    , m_slot(SceneHierarchy::NoParent)
+    , m_changedGeneration(0)
+    , m_boundsIndex(NoBounds)
+    , m_scene(pParentNode != nullptr ? pParentNode->m_scene : nullptr)
     , m_parentNode(pParentNode)
-{}
+{
+    // the scene itself takes its slot once its hierarchy is constructed
+    if(m_scene != nullptr) m_slot = m_scene->GetHierarchy().Add(pParentNode->m_slot, this);
+}
 
-void SceneNode::OnUpdate(){
+// called by Scene::OnUpdate parents first, after the world matrices are computed
+void SceneNode::OnTransformChanged(){
+    UpdateBounds();
+}
 
-    if(m_isDirty == true){
-        m_toWorld = (m_isUseSingleMatrix ? r : s * r * t) * m_parentNode->GetToWorld();
-        m_isDirty = false;
-        m_dirtyCount = FrameCount;
-    }
+void SceneNode::SetDeformedBounds(const GeoMath::BoundingBox& localBounds){
+    m_deformedBounds = localBounds;
+    m_isDeformed     = true;
+    UpdateBounds();
+}
 
-    if(m_isVisible){
-        for(const auto comp : m_components){
-            if(dynamic_cast<StaticMesh*>(comp.get()) == nullptr) comp->Execute();
-        }
-    }
+void SceneNode::UpdateBounds(){
+    if(m_boundsIndex != NoBounds){
+        GeoMath::BoundingBox worldBounds = (m_isDeformed ? m_deformedBounds : m_localBounds).Transform(GetToWorld());
+        m_scene->GetCullingSet().SetBounds(m_boundsIndex, worldBounds);
 
-    for(const auto& node : m_childNodes){
-        node->OnUpdate();
+        BoundsTree& tree = m_scene->GetBoundsTree();
+        if(tree.Has(m_slot)) tree.Update(m_slot, worldBounds);
+        else                 tree.Insert(m_slot, worldBounds);
     }
-
 }
 
 void SceneNode::AddChild(std::unique_ptr<SceneNode>&& childNode){
     m_childNodes.emplace_back(std::move(childNode));
 }
 
-void SceneNode::AddComponent(std::shared_ptr<IComponent>& component){
+void SceneNode::AddComponent(const std::shared_ptr<StaticMesh>& mesh){
+    m_components.emplace_back(mesh);
+    m_scene->GetComponents().meshes.Add(m_slot, mesh.get());
+
+    if(!mesh->GetBounds().IsEmpty()){
+        m_localBounds = m_localBounds.Merge(mesh->GetBounds());
+        if(m_boundsIndex == NoBounds) m_boundsIndex = m_scene->GetCullingSet().AddBounds();
+        Pollute();
+    }
+}
+
+void SceneNode::AddComponent(const std::shared_ptr<IComponent>& component){
     m_components.emplace_back(component);
+    m_scene->GetComponents().executables.Add(m_slot, component.get());
 }
 
-void SceneNode::SetMatrix(
-    const GeoMath::Matrix4f* S, 
-    const GeoMath::Matrix4f* R,
-    const GeoMath::Matrix4f* T
-){
+void SceneNode::SetTransform(const GeoMath::Transform& local){
     m_isUseSingleMatrix = false;
-    if(S != nullptr) s = *S;
-    if(R != nullptr) r = *R;
-    if(T != nullptr) t = *T;
-    Pollute();
+    m_local = local;
+    m_scene->GetHierarchy().SetLocal(m_slot, m_local.ToMatrix(), m_local.Classify());
 }
 
-void SceneNode::SetMatrix(const GeoMath::Matrix4f& toWorld){
+void SceneNode::SetMatrix(const GeoMath::Matrix4f& toParent){
     m_isUseSingleMatrix = true;
-    r = toWorld;
-    Pollute();
+    m_scene->GetHierarchy().SetLocal(m_slot, toParent, toParent.Classify());
 }
 
 GeoMath::Matrix4f SceneNode::GetTransform() const {
-    return (m_isUseSingleMatrix ? r : r * t) * m_parentNode->GetTransform(); 
+    GeoMath::Matrix4f local = m_isUseSingleMatrix ? m_scene->GetHierarchy().GetLocal(m_slot) : m_local.ToRigidMatrix();
+    return m_parentNode != nullptr ? local * m_parentNode->GetTransform() : local;
+}
+
+bool SceneNode::IsInFrustum() const {
+    return m_boundsIndex == NoBounds || m_scene->GetCullingSet().IsVisible(m_boundsIndex);
 }
 
 void SceneNode::Pollute(){
-    if(m_isDirty == false){
-        for(auto& node : m_childNodes){
-            node->Pollute();
+    // the children follow in the next hierarchy update
+    m_scene->GetHierarchy().Pollute(m_slot);
+}
+
+void SceneNode::Touch(){
+    m_scene->m_touchedNodes.emplace_back(this);
+}
+
+void Scene::OnUpdate(float deltaTime){
+
+    m_generation++;
+
+    const auto& nodes = m_hierarchy.GetNodes();
+
+    // the step goes on from the last simulated worlds, not from a blend rendered since
+    const bool isInterpolated = m_interpolation != 1.0f;
+    if(isInterpolated){
+        for(const auto& moved : m_interpolated){
+            m_hierarchy.SetWorld(moved.slot, moved.current);
         }
-        m_isDirty = true;
     }
+
+    // the sampled poses become local transforms before the hierarchy propagates them
+    m_animator.Update(deltaTime);
+    const auto& targets = m_animator.GetTargets();
+    const auto& poses   = m_animator.GetPoses();
+    for(auto pose : m_animator.GetChanged()){
+        nodes[targets[pose]]->SetTransform(poses[pose]);
+    }
+
+    // sampled blend shape weights go to the meshes of their node with as many targets, deformed in OnRender
+    const auto& morphTargets = m_animator.GetMorphTargets();
+    for(auto morph : m_animator.GetChangedMorphs()){
+        const uint32_t slot = morphTargets[morph];
+        const auto&    morphWeights = m_animator.GetMorphWeights(morph);
+        m_componentStore.meshes.ForEachOf(slot, [&morphWeights](StaticMesh& staticMesh){
+            for(const auto& mesh : staticMesh.GetMeshes()){
+                if(mesh->GetMorphTargetCount() == morphWeights.size()) mesh->SetMorphWeights(morphWeights.data(), morphWeights.size());
+            }
+        });
+        nodes[slot]->Touch();
+    }
+
+    // after the poses, the followers read the locals they follow
+    for(auto node : m_followers){
+        node->OnFollow();
+    }
+
+    m_hierarchy.Update(&Utility::WorkerPool::GetInstance());
+
+    for(auto slot : m_hierarchy.GetChanged()){
+        nodes[slot]->OnTransformChanged();
+        LogChange(nodes[slot]);
+    }
+
+    // nodes left at a blend that did not move again are shown where they stopped,
+    // the moved ones blend from here
+    if(isInterpolated){
+        for(const auto& moved : m_interpolated){
+            if(m_hierarchy.IsChanged(moved.slot)) continue;
+            nodes[moved.slot]->OnTransformChanged();
+            LogChange(nodes[moved.slot]);
+        }
+    }
+    m_interpolated.clear();
+    for(auto slot : m_hierarchy.GetChanged()){
+        m_interpolated.push_back({m_hierarchy.GetPreviousWorld(slot), m_hierarchy.GetWorld(slot), slot});
+    }
+    m_interpolation = 1.0f;
+
+    // skinned nodes are culled with the bounds of their pose, the refit below takes them in.
+    // Palettes taken from blended worlds are recomputed as well
+    for(const auto& skin : m_skins){
+        const bool isBlended = isInterpolated && std::find(m_interpolatedSkins.begin(), m_interpolatedSkins.end(), skin.get()) != m_interpolatedSkins.end();
+        if(!skin->UpdatePalette(m_hierarchy, isBlended)) continue;
+        SceneNode* node = nodes[skin->GetMeshNode()];
+        node->SetDeformedBounds(skin->GetPoseBounds(node->m_localBounds));
+    }
+    m_interpolatedSkins.clear();
+    m_boundsTree.Refit();
+
+    for(auto node : m_touchedNodes){
+        LogChange(node);
+    }
+    m_touchedNodes.clear();
+
+    m_componentStore.executables.ForEach([&nodes](uint32_t node, IComponent& component){
+        if(nodes[node]->IsVisible()) component.Execute();
+    });
 }
 
-void Scene::OnUpdate(){
+bool Scene::IsUpdateNeeded() const{
+    return m_animator.IsAnyPlaying() || m_componentStore.executables.GetSize() > 0 || m_hierarchy.IsDirty()
+        || !m_touchedNodes.empty() || !m_interpolated.empty();
+}
+
+void Scene::Interpolate(float factor){
+    factor = factor < 0.0f ? 0.0f : (factor > 1.0f ? 1.0f : factor);
+    if(m_interpolated.empty() || factor == m_interpolation) return;
 
-    if(m_isDirty == true){
-        m_toWorld = m_isUseSingleMatrix ? r : s * r * t;
-        m_isDirty = false;
-        m_dirtyCount = FrameCount;
+    // a blend of its own for the frame resources to sync
+    m_generation++;
+    m_interpolation = factor;
+
+    const auto& nodes = m_hierarchy.GetNodes();
+    for(const auto& moved : m_interpolated){
+        m_hierarchy.SetWorld(moved.slot, GeoMath::Matrix4f::Interpolate(moved.previous, moved.current, factor));
+        nodes[moved.slot]->OnTransformChanged();
+        LogChange(nodes[moved.slot]);
     }
 
-    if(m_isVisible){
-        for(const auto& comp : m_components){
-            comp->Execute();
+    // the skins the last OnUpdate moved follow their blended joints
+    m_interpolatedSkins.clear();
+    for(const auto& skin : m_skins){
+        if(!skin->UpdatePalette(m_hierarchy)) continue;
+        m_interpolatedSkins.emplace_back(skin.get());
+        SceneNode* node = nodes[skin->GetMeshNode()];
+        node->SetDeformedBounds(skin->GetPoseBounds(node->m_localBounds));
+    }
+    m_boundsTree.Refit();
+}
+
+void Scene::Sync(uint64_t& generation){
+
+    if(generation < m_logStart){
+        // the log does not reach back far enough, everything goes out again
+        for(auto node : m_hierarchy.GetNodes()){
+            node->OnUpload();
+        }
+    }
+    else{
+        // a node changed several times is only sent for its latest entry
+        for(const auto& change : m_changeLog){
+            if(change.generation > generation && change.generation == change.node->m_changedGeneration){
+                change.node->OnUpload();
+            }
         }
     }
 
-    for(const auto& node : m_childNodes){
-        node->OnUpdate();
+    // frame resources are filled in turn, the one synced here is the oldest, so changes it has seen are not
+    // needed by any, however many updates ran between frames
+    if(generation > m_logStart){
+        const uint64_t oldest = generation;
+        auto end = std::find_if(m_changeLog.begin(), m_changeLog.end(), [oldest](const Change& change){
+            return change.generation > oldest;
+        });
+        m_changeLog.erase(m_changeLog.begin(), end);
+        m_logStart = oldest;
+    }
+
+    generation = m_generation;
+}
+
+void Scene::LogChange(SceneNode* node){
+    if(node->m_changedGeneration != m_generation){
+        node->m_changedGeneration = m_generation;
+        m_changeLog.push_back({m_generation, node});
+        m_changeGeneration = m_generation;
     }
 }
 
+void Scene::Cull(const GeoMath::Frustum& frustum){
+    m_cullingSet.Cull(frustum);
+}
+
+void Scene::DisableCulling(){
+    m_cullingSet.Reset();
+}
+
+uint32_t Scene::PlayAnimation(const std::shared_ptr<const AnimationClip>& clip, bool loop, float speed){
+    const auto& nodes = m_hierarchy.GetNodes();
+    return m_animator.Play(clip, [&nodes](uint32_t slot){ return nodes[slot]->GetLocal(); }, loop, speed);
+}
+
+SceneNode* Scene::Pick(const BoundsTree::Ray& ray) const{
+    BoundsTree::RayHit hit = m_boundsTree.RayCast(ray);
+    return hit.key != BoundsTree::NoKey ? m_hierarchy.GetNodes()[hit.key] : nullptr;
+}
+
+void Scene::SetView(const GeoMath::Matrix4f& view){
+    m_depthRow = GeoMath::Vector4f(view.data[0][2], view.data[1][2], view.data[2][2], view.data[3][2]);
+}
+
+void Scene::CollectDraws(InstanceBatcher& batcher) const{
+    const auto& nodes = m_hierarchy.GetNodes();
+    m_componentStore.meshes.ForEach([&](uint32_t node, const StaticMesh& staticMesh){
+        const SceneNode* sceneNode = nodes[node];
+        if(sceneNode == this || sceneNode->IsInFrustum() == false) return;
+
+        float depth = 0.0f;
+        if(sceneNode->m_boundsIndex != NoBounds){
+            GeoMath::Vector3f center = m_cullingSet.GetCenter(sceneNode->m_boundsIndex);
+            depth = center.x * m_depthRow.x + center.y * m_depthRow.y + center.z * m_depthRow.z + m_depthRow.w;
+        }
+
+        for(const auto& mesh : staticMesh.GetMeshes()){
+            Material* material = mesh->m_material.get();
+            uint64_t key = RenderQueue::MakeKey(
+                RenderQueue::GeometryPass, mesh->GetPipelineFlag() | material->GetPipelineFlag(),
+                material->GetSortId(), mesh->GetSortId(), depth
+            );
+            batcher.Add(key, material, mesh.get(), node);
+        }
+    });
+}
+
 void Scene::OnRender(){
-    for(const auto& node : m_childNodes){
-        node->OnRender();
+    // deformed meshes out of view keep their last pose
+    const auto& nodes = m_hierarchy.GetNodes();
+    Utility::WorkerPool::GetInstance().ParallelFor(m_deformedMeshes.size(), 1, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            const DeformedMesh& deformed = m_deformedMeshes[i];
+            if(nodes[deformed.slot]->IsInFrustum()) deformed.mesh->OnDeform(deformed.skin);
+        }
+    });
+
+    m_batcher.Clear();
+    CollectDraws(m_batcher);
+    m_batcher.Build();
+
+    OnUploadInstances(m_batcher);
+
+    // the draws come sorted by state, a material is bound once for its whole run
+    Material* material = nullptr;
+    for(const auto& draw : m_batcher.GetDraws()){
+        if(draw.material != material){
+            material = draw.material;
+            material->OnRender();
+        }
+        draw.mesh->OnRender(draw.firstInstance, draw.instanceCount);
     }
 }
 
@@ -107,26 +328,9 @@ CameraNode::CameraNode(uint32_t nodeIndex, SceneNode* pParentNode)
     , m_fov(0.30f * 3.1415926535f)
 {
     m_proj = GeoMath::Matrix4f::Perspective(m_fov, m_aspect, m_nearZ, m_farZ);
-}
-
-void CameraNode::OnUpdate(){
-
-    if(m_isDirty == true){
-        m_toWorld = r;
-        m_isDirty = false;
-        m_dirtyCount = FrameCount;
-    }
-
-    if(m_isVisible){
-        for(const auto& comp : m_components){
-            comp->Execute();
-        }
-    }
-
-    for(const auto& node : m_childNodes){
-        node->OnUpdate();
-    }
 
+    // cameras move in world space, the parent only owns them
+    m_scene->GetHierarchy().SetParent(m_slot, SceneHierarchy::NoParent);
 }
 
 void CameraNode::Input(const uint16_t input, const int16_t x, const int16_t y){
@@ -135,50 +339,30 @@ void CameraNode::Input(const uint16_t input, const int16_t x, const int16_t y){
         case 'W':
         case 'w':
         {
-            if(m_isUseSingleMatrix){
-                r[3] += r[2];
-            }
-            else{
-                t[3] += r[2];
-            }
+            m_toParent[3] += m_toParent[2];
             break;
         }
         case 'S':
         case 's':
         {
-            if(m_isUseSingleMatrix){
-                r[3] -= r[2];
-            }
-            else{
-                t[3] -= r[2];
-            }
+            m_toParent[3] -= m_toParent[2];
             break;
         }
         case 'D':
         case 'd':
         {
-            if(m_isUseSingleMatrix){
-                r[3] += r[0];
-            }
-            else{
-                t[3] += r[0];
-            }
+            m_toParent[3] += m_toParent[0];
             break;
         }
         case 'A':
         case 'a':
         {
-            if(m_isUseSingleMatrix){
-                r[3] -= r[0];
-            }
-            else{
-                t[3] -= r[0];
-            }
+            m_toParent[3] -= m_toParent[0];
             break;
         }
         case WM_MOUSEMOVE:
         {
-            r = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * r;
+            m_toParent = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * m_toParent;
             break;
         }
         default:
@@ -187,19 +371,21 @@ void CameraNode::Input(const uint16_t input, const int16_t x, const int16_t y){
         }
     }
 
-    Pollute();
+    UpdateLocal();
 }
 
-void CameraNode::SetMatrix(
-    const GeoMath::Matrix4f* S,
-    const GeoMath::Matrix4f* R,
-    const GeoMath::Matrix4f* T
-){
-    m_isUseSingleMatrix = true;
-    if(R != nullptr) r = *R;
-    if(T != nullptr) t = *T;
-    r *= t;
-    Pollute();
+void CameraNode::SetTransform(const GeoMath::Transform& local){
+    // cameras move through m_toParent, the scale is dropped
+    SetMatrix(local.ToRigidMatrix());
+}
+
+void CameraNode::SetMatrix(const GeoMath::Matrix4f& toParent){
+    m_toParent = toParent;
+    UpdateLocal();
+}
+
+void CameraNode::UpdateLocal(){
+    SceneNode::SetMatrix(m_toParent);
 }
 
 void CameraNode::SetLens(
@@ -211,12 +397,12 @@ void CameraNode::SetLens(
     if(fovY   != nullptr) m_fov    = *fovY;
     if(aspect != nullptr) m_aspect = *aspect;
 
-    m_proj       = GeoMath::Matrix4f::Perspective(m_fov, m_aspect, m_nearZ, m_farZ);
-    m_dirtyCount = FrameCount;
+    m_proj = GeoMath::Matrix4f::Perspective(m_fov, m_aspect, m_nearZ, m_farZ);
+    Touch();
 }
 
 GeoMath::Matrix4f CameraNode::GetView() const{
-    return m_toWorld.Inverse();
+    return GetToWorld().Inverse(GetTransformType());
 }
 
 const GeoMath::Matrix4f& CameraNode::GetProj() const{
@@ -231,7 +417,7 @@ void FirstPersonCamera::Input(const uint16_t input, const int16_t x, const int16
     switch(input){
         case WM_MOUSEMOVE:
         {
-            r = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * r;
+            m_toParent = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * m_toParent;
             break;
         }
         default:
@@ -240,7 +426,7 @@ void FirstPersonCamera::Input(const uint16_t input, const int16_t x, const int16
         }
     }
 
-    Pollute();
+    UpdateLocal();
 }
 
 void FirstPersonCamera::SetParentVisibility(const bool isVisible){
@@ -252,24 +438,18 @@ ThirdPersonCamera::ThirdPersonCamera(uint32_t nodeIndex,SceneNode* pParentNode)
     , m_distance(20)
     , m_minDistance(20)
     , m_maxDistance(1000)
-{}
-
-void ThirdPersonCamera::OnUpdate(){
-    if(m_isVisible){
-        for(const auto& comp : m_components){
-            comp->Execute();
-        }
-    }
-
-    if(m_isDirty == true){
-        t = GeoMath::Matrix4f::Translation(0.0f, 0.0f, -m_distance);
-        m_toWorld = t * r * m_parentNode->GetTransform();
-        m_isDirty = false;
-        m_dirtyCount = FrameCount;
-    }
+{
+    // orbits its parent without taking on its scale or the flip of the scene, so it stays out of the
+    // hierarchy below the parent and follows the parent's rigid transform every update
+    m_scene->AddFollower(this);
+    UpdateLocal();
+}
 
-    for(const auto& node : m_childNodes){
-        node->OnUpdate();
+void ThirdPersonCamera::UpdateLocal(){
+    GeoMath::Matrix4f local = GeoMath::Matrix4f::Translation(0.0f, 0.0f, -m_distance) * m_toParent * m_parentNode->GetTransform();
+    // a still camera is not a change, it would keep a scene rendered on demand redrawing
+    if(memcmp(&local, &m_scene->GetHierarchy().GetLocal(m_slot), sizeof(local)) != 0){
+        SceneNode::SetMatrix(local);
     }
 }
 
@@ -277,7 +457,7 @@ void ThirdPersonCamera::Input(const uint16_t input, const int16_t x, const int16
     switch(input){
         case WM_MOUSEMOVE:
         {
-            r = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * r;
+            m_toParent = GeoMath::Matrix4f::Rotation(y * 0.001f, x * 0.001f, 0.0f) * m_toParent;
             break;
         }
         case WM_MOUSEWHEEL:
@@ -292,5 +472,5 @@ void ThirdPersonCamera::Input(const uint16_t input, const int16_t x, const int16
             break;
         }
     }
-    Pollute();
+    UpdateLocal();
 }
\ No newline at end of file
@@ -2,49 +2,84 @@
 #include "DxUtility.hpp"
 #include "Mesh.hpp"
 #include "GeoMath.hpp"
+#include "CullingSet.hpp"
+#include "BoundsTree.hpp"
+#include "Animation.hpp"
+#include "InstanceBatcher.hpp"
+#include "ComponentStore.hpp"
+#include "SceneHierarchy.hpp"
 
 #include <vector>
 
+class Scene;
+
 class SceneNode{
+    friend class Scene;
+
 public:
     SceneNode(uint32_t nodeIndex, SceneNode* pParentNode);
 
-    virtual void OnUpdate();
+    // the world matrix changed in this update
+    virtual void OnTransformChanged();
+    // the node changed since the frame resource being filled last saw it
+    virtual void OnUpload(){}
     virtual void OnRender()   = 0;
     virtual void OnTraceRay() = 0;
+    // called before the transforms are propagated, on the nodes given to Scene::AddFollower
+    virtual void OnFollow(){}
 
     virtual void AddChild(std::unique_ptr<SceneNode>&& childNode);
-    virtual void AddComponent(std::shared_ptr<IComponent>& component);
-
-    virtual void SetMatrix(
-        const GeoMath::Matrix4f* S, 
-        const GeoMath::Matrix4f* R,
-        const GeoMath::Matrix4f* T
-    );
+    // meshes are drawn and culled, any other component is executed every frame
+    virtual void AddComponent(const std::shared_ptr<StaticMesh>& mesh);
+    virtual void AddComponent(const std::shared_ptr<IComponent>& component);
 
+    virtual void SetTransform(const GeoMath::Transform& local);
     virtual void SetMatrix(const GeoMath::Matrix4f& toParent);
 
-    virtual GeoMath::Matrix4f GetTransform() const;
+    // the matrices live in the scene's hierarchy, the node is a handle on its slot
+    const GeoMath::Transform& GetLocal() const { return m_local; }
+    inline const GeoMath::Matrix4f& GetToWorld() const;
+    inline GeoMath::TransformType   GetTransformType() const;
+    // to world without the scale of any transform on the way, single matrices are taken as they are.
+    // Walks the parents, for the few nodes that follow another without its scale
+    GeoMath::Matrix4f GetTransform() const;
 
-    const GeoMath::Matrix4f& GetT()         const { return t; }
-    const GeoMath::Matrix4f& GetToWorld()   const { return m_toWorld; }
+    uint32_t GetSlot() const { return m_slot; }
 
     bool IsVisible() const { return m_isVisible; }
-    bool IsDirty()   const { return m_isDirty; }
+    // world matrix changed in the last Scene::OnUpdate
+    inline bool IsDirty() const;
+    // result of the last Scene::Cull, nodes without meshes always pass
+    bool IsInFrustum() const;
 
     void SetVisibility(const bool isVisible){ m_isVisible = isVisible; }
+    // bounds of the meshes as deformed, culled and picked with in place of the bounds they were loaded with
+    void SetDeformedBounds(const GeoMath::BoundingBox& localBounds);
     void Pollute();
+    // uploads the node again without moving it
+    void Touch();
 
 protected:
+    // world box of the local bounds into the culling set and the bounds tree
+    void UpdateBounds();
+
     bool     m_isVisible;
-    bool     m_isDirty;
     bool     m_isUseSingleMatrix;
-    uint8_t  m_dirtyCount;
+    bool     m_isDeformed;
     uint32_t m_nodeIndex;
+    uint32_t m_slot;
+    // scene generation of the last change, frame resources compare it against their own
+    uint64_t m_changedGeneration;
+
+    // scale, rotation, translation of the node, unused when it is given a single matrix
+    GeoMath::Transform m_local;
 
-    GeoMath::Matrix4f s, r, t;
-    GeoMath::Matrix4f m_toWorld;
+    // bounds of the attached meshes, their world box lives in the scene's culling set and bounds tree
+    GeoMath::BoundingBox m_localBounds;
+    GeoMath::BoundingBox m_deformedBounds;
+    uint32_t             m_boundsIndex;
 
+    Scene*     m_scene;
     SceneNode* m_parentNode;
 
     using SceneNodeList = std::vector<std::unique_ptr<SceneNode>>;
@@ -53,30 +88,138 @@ protected:
     ComponentList m_components;
 
     inline static uint8_t FrameCount = 1;
+    inline static const uint32_t NoBounds = 0xFFFFFFFF;
 };
 
 class Scene : public SceneNode{
+    friend class SceneNode;
+
 public:
-    Scene() : SceneNode(0, nullptr){};
+    Scene() : SceneNode(0, nullptr){ m_scene = this; m_slot = m_hierarchy.Add(SceneHierarchy::NoParent, this); m_hierarchy.KeepPreviousWorlds(); };
 
-    virtual void OnUpdate() override;
+    // walks only what changed: the dirty subtrees, the touched nodes and the nodes with components.
+    // Animations move deltaTime seconds forward before the transforms are propagated.
+    void OnUpdate(float deltaTime);
+    // whether an OnUpdate could change anything: an animation is playing, a component runs every update,
+    // a node was set since the last one, or the last one moved nodes that are still shown blended
+    bool IsUpdateNeeded() const;
+    // folds the visible meshes into instanced draws, uploads their instance data and draws them
     virtual void OnRender() override;
     virtual void OnTraceRay() override;
 
-    virtual GeoMath::Matrix4f GetTransform() const override { return m_isUseSingleMatrix ? r : r * t; }
+    // frames rendered between two OnUpdate show the nodes that moved in the last one factor of the way
+    // from their world before it to their world after it, until the next OnUpdate goes on from the latter
+    void Interpolate(float factor);
+
+    // calls OnUpload on every node changed after generation, then moves generation to the current one.
+    // Called once per frame with the generation kept by the frame resource being filled.
+    void Sync(uint64_t& generation);
+    uint64_t GetGeneration() const { return m_generation; }
+    // generation of the last update that changed a node, the scene looks the same while it holds
+    uint64_t GetChangeGeneration() const { return m_changeGeneration; }
+
+    // a draw for every mesh of every node that passed the last Cull, keyed by state and view depth
+    void CollectDraws(InstanceBatcher& batcher) const;
+    // view matrix the draw keys take their depth from
+    void SetView(const GeoMath::Matrix4f& view);
+    // binds the last OnRender cost
+    const RenderQueue::StateChanges& GetStateChanges() const { return m_batcher.GetStateChanges(); }
+
+    // tests the world bounds of every node with meshes against the frustum
+    void Cull(const GeoMath::Frustum& frustum);
+    void DisableCulling();
+
+    CullingSet&       GetCullingSet()       { return m_cullingSet; }
+    const CullingSet& GetCullingSet() const { return m_cullingSet; }
+
+    // world bounds of the nodes with meshes keyed by slot, for picking and other spatial queries
+    BoundsTree&       GetBoundsTree()       { return m_boundsTree; }
+    const BoundsTree& GetBoundsTree() const { return m_boundsTree; }
+    // node whose world bounds the ray enters first, nullptr when it hits none
+    SceneNode* Pick(const BoundsTree::Ray& ray) const;
+
+    SceneHierarchy&       GetHierarchy()       { return m_hierarchy; }
+    const SceneHierarchy& GetHierarchy() const { return m_hierarchy; }
+
+    ComponentStore&       GetComponents()       { return m_componentStore; }
+    const ComponentStore& GetComponents() const { return m_componentStore; }
+
+    // plays clip on the nodes its channels target, returns the playback for the animator
+    uint32_t PlayAnimation(const std::shared_ptr<const AnimationClip>& clip, bool loop = true, float speed = 1.0f);
+    Animator&       GetAnimator()       { return m_animator; }
+    const Animator& GetAnimator() const { return m_animator; }
+
+    // palettes follow the joints in every OnUpdate
+    void AddSkin(const std::shared_ptr<Skin>& skin){ m_skins.emplace_back(skin); }
+    const std::vector<std::shared_ptr<Skin>>& GetSkins() const { return m_skins; }
+    // mesh is skinned to skin before every OnRender in which the skin's mesh node passed the cull,
+    // which tests the bounds of the pose rather than the bind pose
+    void AddSkinnedMesh(const std::shared_ptr<Skin>& skin, Mesh* mesh){ m_deformedMeshes.push_back({skin.get(), mesh, skin->GetMeshNode()}); }
+    // mesh takes its blend shape weights before every OnRender in which the node at slot passed the cull
+    void AddMorphedMesh(uint32_t slot, Mesh* mesh){ m_deformedMeshes.push_back({nullptr, mesh, slot}); }
+    // node derives its local matrix from other nodes, OnFollow is called at the start of every OnUpdate
+    void AddFollower(SceneNode* node){ m_followers.push_back(node); }
+
+protected:
+    // the per instance data of the batched draws, in the order of batcher.GetInstances()
+    virtual void OnUploadInstances(const InstanceBatcher& batcher){}
+
+    void LogChange(SceneNode* node);
+
+    CullingSet      m_cullingSet;
+    BoundsTree      m_boundsTree;
+    SceneHierarchy  m_hierarchy;
+    ComponentStore  m_componentStore;
+    InstanceBatcher m_batcher;
+    Animator        m_animator;
+
+    std::vector<std::shared_ptr<Skin>> m_skins;
+
+    struct DeformedMesh{
+        const Skin* skin;
+        Mesh*       mesh;
+        uint32_t    slot;
+    };
+    std::vector<DeformedMesh> m_deformedMeshes;
+    std::vector<SceneNode*>   m_followers;
+
+    // worlds of the nodes the last OnUpdate moved, and the factor the hierarchy holds them at
+    struct Interpolated{
+        GeoMath::Matrix4f previous;
+        GeoMath::Matrix4f current;
+        uint32_t          slot;
+    };
+    std::vector<Interpolated> m_interpolated;
+    std::vector<Skin*>        m_interpolatedSkins;
+    float                     m_interpolation = 1.0f;
+
+    // view space z of a world position as a dot product, x y z w of the view matrix's third column
+    GeoMath::Vector4f m_depthRow{0.0f, 0.0f, 1.0f, 0.0f};
+
+    struct Change{
+        uint64_t   generation;
+        SceneNode* node;
+    };
+
+    // changes no frame resource has synced yet, complete for generations after m_logStart
+    uint64_t                m_generation       = 0;
+    uint64_t                m_logStart         = 0;
+    uint64_t                m_changeGeneration = 0;
+    std::vector<Change>     m_changeLog;
+    std::vector<SceneNode*> m_touchedNodes;
 };
 
+const GeoMath::Matrix4f& SceneNode::GetToWorld() const { return m_scene->GetHierarchy().GetWorld(m_slot); }
+GeoMath::TransformType SceneNode::GetTransformType() const { return m_scene->GetHierarchy().GetWorldType(m_slot); }
+bool SceneNode::IsDirty() const { return m_scene->GetHierarchy().IsChanged(m_slot); }
+
 class CameraNode : public SceneNode{
 public:
     explicit CameraNode(uint32_t nodeIndex, SceneNode* pParentNode);
-    virtual void OnUpdate() override;
     virtual void Input(const uint16_t input, const int16_t x = 0, const int16_t y = 0);
 
-    virtual void SetMatrix(
-        const GeoMath::Matrix4f* S, 
-        const GeoMath::Matrix4f* R,
-        const GeoMath::Matrix4f* T
-    ) override;
+    virtual void SetTransform(const GeoMath::Transform& local) override;
+    virtual void SetMatrix(const GeoMath::Matrix4f& toParent) override;
 
     void SetLens(
         const float* zNear, const float* zFar,
@@ -87,11 +230,15 @@ public:
     const GeoMath::Matrix4f& GetProj() const;
 
 protected:
+    // hands the camera's local matrix to the hierarchy after m_toParent moved
+    virtual void UpdateLocal();
+
     float m_nearZ;
     float m_farZ;
     float m_aspect;
     float m_fov;
 
+    GeoMath::Matrix4f m_toParent;
     GeoMath::Matrix4f m_proj;
 };
 
@@ -107,10 +254,13 @@ public:
 class ThirdPersonCamera : public CameraNode{
 public:
     explicit ThirdPersonCamera(uint32_t nodeIndex, SceneNode* pParentNode);
-    virtual void OnUpdate() override;
     virtual void Input(const uint16_t input, const int16_t x = 0, const int16_t y = 0) override;
 
+    virtual void OnFollow() override { UpdateLocal(); }
+
 protected:
+    virtual void UpdateLocal() override;
+
     float m_distance;
     float m_minDistance;
     float m_maxDistance;
@@ -0,0 +1,47 @@
+#include "ScenePackage.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+ScenePackage::ScenePackage(const char* fileName)
+    : m_file(fileName)
+{
+    if(!m_file.IsOpen() || m_file.GetSize() < sizeof(Header)) return;
+
+    const Header* header = reinterpret_cast<const Header*>(m_file.GetData());
+    if(header->magic != Magic || header->version != Version || header->fileSize != m_file.GetSize()) return;
+
+    for(const auto& range : header->sections){
+        if(range.offset % PitchAlignment != 0 || range.offset > header->fileSize || range.size > header->fileSize - range.offset) return;
+    }
+    m_header = header;
+}
+
+bool ScenePackage::Write(const char* fileName, const std::vector<uint8_t> (&sections)[SectionCount]){
+    Header header = {};
+    header.magic   = Magic;
+    header.version = Version;
+
+    uint64_t offset = sizeof(Header);
+    for(uint32_t s = 0; s < SectionCount; s++){
+        offset = (offset + PitchAlignment - 1) / PitchAlignment * PitchAlignment;
+        header.sections[s] = {offset, sections[s].size()};
+        offset += sections[s].size();
+    }
+    header.fileSize = offset;
+
+    FILE* file = fopen(fileName, "wb");
+    if(file == nullptr) return false;
+
+    bool isWritten = fwrite(&header, sizeof(Header), 1, file) == 1;
+    uint64_t written = sizeof(Header);
+    const uint8_t padding[PitchAlignment] = {};
+    for(uint32_t s = 0; s < SectionCount && isWritten; s++){
+        const size_t gap = static_cast<size_t>(header.sections[s].offset - written);
+        isWritten = fwrite(padding, 1, gap, file) == gap;
+        isWritten = isWritten && (sections[s].empty() || fwrite(sections[s].data(), 1, sections[s].size(), file) == sections[s].size());
+        written = header.sections[s].offset + sections[s].size();
+    }
+
+    return fclose(file) == 0 && isWritten;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "BlockCompressor.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// A scene converted offline into the layouts the renderer uploads, written by AssetCooker and mapped
+// at load. The file is a header holding the range of every section, then the sections, each a flat
+// array of the records below or of raw bytes, so the loader hands them to upload buffers as they are.
+class ScenePackage{
+public:
+    inline static const uint32_t Magic   = 0x4B505352;    // "RSPK"
+    // bumped with every change of a record or a section, older packages are rejected and cooked again
+    inline static const uint32_t Version = 3;
+    // sections start at multiples of this, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+    inline static const uint32_t PitchAlignment = 256;
+    // stride of the material constants, constant buffer views start at multiples of 256 bytes
+    inline static const uint32_t ConstantStride = 256;
+
+    enum Section : uint32_t{
+        Textures,           // Texture
+        Texels,             // mip chain of every texture in the BlockCompressor layout of its format
+        Materials,          // Material
+        MaterialConstants,  // a MaterialConstant every ConstantStride bytes
+        Meshes,             // Mesh
+        Primitives,         // Primitive
+        RayTraceInfos,      // RayTraceInfo of every mesh
+        Vertices,           // SoA streams of every primitive in the Vertex0 or Vertex1 layout
+        Indices,            // uint32 indices of every primitive
+        Nodes,              // Node
+        Children,           // uint32 node indices
+        Roots,              // uint32 node indices of the scene
+        SectionCount
+    };
+
+    using TextureFormat = Utility::BlockCompressor::Format;
+
+    struct Range{
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Header{
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        Range    sections[SectionCount];
+    };
+
+    struct Texture{
+        TextureFormat format;
+        uint32_t      width;
+        uint32_t      height;
+        uint32_t      mipLevels;
+        uint64_t      texelOffset;    // in Texels, BlockCompressor::GetLayout gives the levels and their size
+    };
+
+    struct Material{
+        uint32_t textureIndex;        // diffuse texture, 0 without one
+        uint32_t isDoubleSided;
+    };
+
+    // the acceleration structure inputs of a glTF mesh, counts of its last primitive like the glTF loader
+    struct Mesh{
+        uint32_t firstPrimitive;
+        uint32_t primitiveCount;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t textureIndex;
+    };
+
+    // the layout of RayTraceMeshInfo, offsets are into the Vertices and Indices sections
+    struct RayTraceInfo{
+        uint32_t indexOffsetBytes    = 0;
+        uint32_t positionOffsetBytes = 0;
+        uint32_t normalOffsetBytes   = 0;
+        uint32_t tangentOffsetBytes  = 0;
+        uint32_t uvOffsetBytes       = 0;
+        uint32_t matIndex            = 0;
+        float    positionCenter[3]   = {0.0f, 0.0f, 0.0f};
+        float    positionExtent[3]   = {1.0f, 1.0f, 1.0f};
+    };
+
+    enum class Layout : uint32_t{ PositionNormal, PositionNormalTangentTexCoord };
+
+    struct Primitive{
+        Layout   layout;
+        uint32_t material;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint64_t vertexOffset;        // in Vertices
+        uint64_t indexOffset;         // in Indices
+        // quantization bounds of the positions, then the culling bounds when the glTF gave them
+        float    center[3];
+        float    extent[3];
+        float    boundsMin[3];
+        float    boundsMax[3];
+        uint32_t hasBounds;
+    };
+
+    struct Node{
+        int32_t  mesh;                // -1 without one
+        uint32_t firstChild;          // in Children
+        uint32_t childCount;
+        uint32_t hasMatrix;
+        float    translation[3];
+        float    rotation[4];
+        float    scale[3];
+        float    matrix[16];          // replaces the transform when hasMatrix is set
+    };
+
+    // maps fileName, IsValid tells whether it is a package of this version
+    explicit ScenePackage(const char* fileName);
+
+    bool IsValid() const { return m_header != nullptr; }
+
+    const uint8_t* GetData(Section section) const { return m_file.GetData() + m_header->sections[section].offset; }
+    uint64_t       GetSize(Section section) const { return m_header->sections[section].size; }
+
+    template<typename T>
+    const T* Get(Section section) const { return reinterpret_cast<const T*>(GetData(section)); }
+    template<typename T>
+    size_t   GetCount(Section section) const { return static_cast<size_t>(GetSize(section) / sizeof(T)); }
+
+    // writes the sections after a header, each at a multiple of PitchAlignment
+    static bool Write(const char* fileName, const std::vector<uint8_t> (&sections)[SectionCount]);
+
+protected:
+    Utility::MappedFile m_file;
+    const Header*       m_header = nullptr;
+};
@@ -0,0 +1,86 @@
+#include "Skinning.hpp"
+
+#include <cassert>
+
+SkinnedGeometry::SkinnedGeometry(
+    const float* positions, const float* normals, const float* tangents,
+    const uint16_t* joints, const float* weights, uint32_t vertexCount
+)
+    : m_vertexCount(vertexCount)
+    , m_maxJoint(0)
+    , m_bindPose(vertexCount * 9, 0.0f)
+    , m_deformed(vertexCount * 9, 0.0f)
+    , m_joints(vertexCount * 4)
+    , m_weights(vertexCount * 4)
+{
+    float* position = m_bindPose.data();
+    float* normal   = position + vertexCount * 3;
+    float* tangent  = normal   + vertexCount * 3;
+
+    for(uint32_t v = 0; v < vertexCount; v++){
+        for(uint32_t k = 0; k < 3; k++){
+            position[k * vertexCount + v] = positions[v * 3 + k];
+            normal[k * vertexCount + v]   = normals[v * 3 + k];
+        }
+    }
+
+    if(tangents != nullptr){
+        m_tangentSigns.resize(vertexCount);
+        for(uint32_t v = 0; v < vertexCount; v++){
+            for(uint32_t k = 0; k < 3; k++){
+                tangent[k * vertexCount + v] = tangents[v * 4 + k];
+            }
+            m_tangentSigns[v] = tangents[v * 4 + 3];
+        }
+    }
+
+    for(uint32_t v = 0; v < vertexCount; v++){
+        float sum = 0.0f;
+        for(uint32_t i = 0; i < 4; i++) sum += weights[v * 4 + i];
+        // unweighted vertices follow the first joint
+        float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+
+        for(uint32_t i = 0; i < 4; i++){
+            uint16_t joint = joints[v * 4 + i];
+            m_joints[i * vertexCount + v]  = joint;
+            m_weights[i * vertexCount + v] = sum > 0.0f ? weights[v * 4 + i] * scale : (i == 0 ? 1.0f : 0.0f);
+            m_maxJoint = joint > m_maxJoint ? joint : m_maxJoint;
+        }
+    }
+}
+
+GeoMath::ConstSkinVertexStream SkinnedGeometry::GetStreams(const float* data) const{
+    const uint32_t n = m_vertexCount;
+    const float* tangent = HasTangents() ? data + n * 6 : nullptr;
+    return GeoMath::ConstSkinVertexStream{
+        GeoMath::ConstVector3fStream(data, data + n, data + n * 2),
+        GeoMath::ConstVector3fStream(data + n * 3, data + n * 4, data + n * 5),
+        GeoMath::ConstVector3fStream(tangent, tangent != nullptr ? tangent + n : nullptr, tangent != nullptr ? tangent + n * 2 : nullptr)
+    };
+}
+
+void SkinnedGeometry::Deform(const Skin& skin, const GeoMath::ConstSkinVertexStream& src){
+    assert(m_maxJoint < skin.GetPalette().size());
+
+    const uint32_t n = m_vertexCount;
+    float* out = m_deformed.data();
+    float* tangent = HasTangents() ? out + n * 6 : nullptr;
+    GeoMath::SkinVertexStream dst{
+        {out, out + n, out + n * 2},
+        {out + n * 3, out + n * 4, out + n * 5},
+        {tangent, tangent != nullptr ? tangent + n : nullptr, tangent != nullptr ? tangent + n * 2 : nullptr}
+    };
+
+    const GeoMath::ConstSkinWeightStream weights{
+        {m_joints.data(), m_joints.data() + n, m_joints.data() + n * 2, m_joints.data() + n * 3},
+        {m_weights.data(), m_weights.data() + n, m_weights.data() + n * 2, m_weights.data() + n * 3}
+    };
+
+    if(skin.GetMethod() == Skin::Method::DualQuaternion){
+        assert(m_maxJoint < skin.GetDualQuaternions().size());
+        GeoMath::SkinDualQuaternion(skin.GetDualQuaternions().data(), weights, src, dst, n);
+    }
+    else{
+        GeoMath::SkinLinear(skin.GetPalette().data(), weights, src, dst, n);
+    }
+}
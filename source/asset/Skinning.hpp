@@ -0,0 +1,46 @@
+#pragma once
+#include "Animation.hpp"
+#include "GeoMathBatch.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Bind pose of a skinned mesh as SoA streams with the 4 joints and weights of every vertex,
+// and the streams it is skinned into. The renderer packs the result into its vertex layout.
+class SkinnedGeometry{
+public:
+    // glTF layouts: positions and normals xyz, tangents xyzw or null, joints and weights 4 per vertex.
+    // The weights of every vertex are normalized to sum to 1.
+    SkinnedGeometry(
+        const float* positions, const float* normals, const float* tangents,
+        const uint16_t* joints, const float* weights, uint32_t vertexCount
+    );
+
+    // skins the bind pose with the current palette of skin, linear or dual quaternion as the skin asks
+    void Deform(const Skin& skin){ Deform(skin, GetBindPose()); }
+    // skins src instead, the bind pose moved by blend shapes
+    void Deform(const Skin& skin, const GeoMath::ConstSkinVertexStream& src);
+
+    uint32_t GetVertexCount() const { return m_vertexCount; }
+    bool     HasTangents()    const { return !m_tangentSigns.empty(); }
+
+    GeoMath::ConstSkinVertexStream GetBindPose() const { return GetStreams(m_bindPose.data()); }
+    // result of the last Deform
+    GeoMath::ConstSkinVertexStream GetDeformed() const { return GetStreams(m_deformed.data()); }
+    // handedness of the tangents, skinning keeps it
+    const float* GetTangentSigns() const { return m_tangentSigns.data(); }
+
+protected:
+    GeoMath::ConstSkinVertexStream GetStreams(const float* data) const;
+
+    uint32_t m_vertexCount;
+    uint16_t m_maxJoint;
+
+    // x, y, z streams of the positions, normals and tangents one after another
+    std::vector<float>    m_bindPose;
+    std::vector<float>    m_deformed;
+    std::vector<float>    m_tangentSigns;
+    // one stream per influence
+    std::vector<uint16_t> m_joints;
+    std::vector<float>    m_weights;
+};
@@ -11,6 +11,7 @@ public:
     );
 
     virtual void OnRender();
+    virtual uint64_t GetPipelineFlag() const override { return m_matFlag; }
 
 protected:
     uint64_t                     m_matFlag;
@@ -1,8 +1,12 @@
 #include "Dx12Mesh.hpp"
+#include "PackedVertex.hpp"
+
+#include <cassert>
 
 Dx12Mesh::Dx12Mesh(
     UploadBuffer& vertexBuffer, size_t vertexCount,
     UploadBuffer& indexBuffer, size_t indexCount,
+    const GeoMath::BoundingBox& positionBounds,
     const PipelineStateFlag flag, const std::shared_ptr<Material>& material,
     const ComPtr<ID3D12Device8>& device
 ) 
@@ -11,6 +15,8 @@ Dx12Mesh::Dx12Mesh(
     , m_meshFlag(flag)
     , m_graphicsMgr(Dx12GraphicsManager::GetInstance())
 {
+    m_meshConst.positionCenter = GeoMath::Vector4f(positionBounds.center, 0.0f);
+    m_meshConst.positionExtent = GeoMath::Vector4f(positionBounds.extent, 0.0f);
 
     auto GetSOA = [](uint64_t flag) -> Dx12SOA&{
         switch(flag){
@@ -54,14 +60,124 @@ Dx12Mesh::Dx12Mesh(
     m_graphicsMgr->ExecuteCommandList(cmdList);
 }
 
-void Dx12Mesh::OnRender(){
+void Dx12Mesh::SetSkinnedGeometry(std::unique_ptr<SkinnedGeometry> geometry, const ComPtr<ID3D12Device8>& device){
+    const bool hasTangents = geometry->HasTangents();
+    m_skinned = std::move(geometry);
+    CreateStaging(hasTangents, device);
+}
+
+void Dx12Mesh::SetMorphTargets(std::unique_ptr<MorphTargets> targets, const float* weights, const ComPtr<ID3D12Device8>& device){
+    const bool hasTangents = targets->HasTangents();
+    m_morph = std::move(targets);
+    m_morphWeights.assign(weights, weights + m_morph->GetTargetCount());
+    // the initial weights are applied by the first OnDeform
+    m_morphVersion = 1;
+    CreateStaging(hasTangents, device);
+}
+
+void Dx12Mesh::CreateStaging(bool hasTangents, const ComPtr<ID3D12Device8>& device){
+    // positions, normals and tangents lead both vertex layouts
+    const size_t viewCount = hasTangents ? 3 : 2;
+    assert(viewCount <= m_vertexBufferView.size());
+    assert(m_staging.empty() || viewCount == m_deformedViewCount);
+    m_deformedViewCount = viewCount;
+
+    uint32_t byteSize = 0;
+    for(size_t index = 0; index < m_deformedViewCount; index++){
+        byteSize += m_vertexBufferView[index].SizeInBytes;
+    }
+
+    // every frame starts from the vertices as loaded, version 0 is a skin never posed
+    m_deformedSkinVersion  = 0;
+    m_deformedMorphVersion = 0;
+    m_staging.resize(m_graphicsMgr->GetFrameCount());
+    for(uint32_t frame = 0; frame < m_staging.size(); frame++){
+        auto& staging = m_staging[frame];
+        if(staging.buffer == nullptr){
+            staging.buffer = std::make_unique<UploadBuffer>(device, byteSize, 1);
+            staging.data   = staging.buffer->Map();
+        }
+        staging.skinVersion  = 0;
+        staging.morphVersion = 0;
+        PackDeformed(frame);
+    }
+}
+
+void Dx12Mesh::SetMorphWeights(const float* weights, size_t count){
+    if(m_morph == nullptr) return;
+    assert(count == m_morphWeights.size());
+    m_morphWeights.assign(weights, weights + count);
+    m_morphVersion++;
+}
+
+void Dx12Mesh::OnDeform(const Skin* skin){
+    const uint64_t skinVersion = skin != nullptr ? skin->GetVersion() : 0;
+    const uint32_t frameIndex  = m_graphicsMgr->GetFrameIndex();
+
+    auto& staging = m_staging[frameIndex];
+    if(staging.skinVersion == skinVersion && staging.morphVersion == m_morphVersion) return;
+
+    // the other frames may have deformed to these versions already
+    if(m_deformedSkinVersion != skinVersion || m_deformedMorphVersion != m_morphVersion){
+        // blend shapes move the bind pose the skin starts from
+        if(m_morph != nullptr) m_morph->Apply(m_morphWeights.data());
+        if(m_skinned != nullptr && skinVersion != 0){
+            m_skinned->Deform(*skin, m_morph != nullptr ? m_morph->GetMorphed() : m_skinned->GetBindPose());
+        }
+        m_deformedSkinVersion  = skinVersion;
+        m_deformedMorphVersion = m_morphVersion;
+    }
+    PackDeformed(frameIndex);
+    staging.skinVersion  = skinVersion;
+    staging.morphVersion = m_morphVersion;
+}
+
+void Dx12Mesh::PackDeformed(uint32_t frameIndex){
+    auto& staging = m_staging[frameIndex];
+
+    GeoMath::ConstSkinVertexStream vertices = m_morph != nullptr ? m_morph->GetMorphed() : m_skinned->GetBindPose();
+    const float* tangentSigns = m_morph != nullptr ? m_morph->GetTangentSigns() : m_skinned->GetTangentSigns();
+    const uint32_t vertexCount = m_morph != nullptr ? m_morph->GetVertexCount() : m_skinned->GetVertexCount();
+    if(m_skinned != nullptr && m_deformedSkinVersion != 0){
+        vertices = m_skinned->GetDeformed();
+    }
+    assert(vertexCount == m_vertexBufferView.front().SizeInBytes / m_vertexBufferView.front().StrideInBytes);
 
-    m_material->OnRender();
+    uint8_t* data = staging.data;
+    GeoMath::BoundingBox bounds = GeoMath::PackPositions(vertices.position, vertexCount, reinterpret_cast<GeoMath::SNorm16x4*>(data));
+    data += m_vertexBufferView[0].SizeInBytes;
+    GeoMath::PackNormals(vertices.normal, vertexCount, reinterpret_cast<GeoMath::SNorm16x2*>(data));
+    data += m_vertexBufferView[1].SizeInBytes;
+    if(m_deformedViewCount == 3){
+        GeoMath::PackTangents(vertices.tangent, tangentSigns, vertexCount, reinterpret_cast<GeoMath::SNorm16x4*>(data));
+    }
+
+    staging.meshConst.positionCenter = GeoMath::Vector4f(bounds.center, 0.0f);
+    staging.meshConst.positionExtent = GeoMath::Vector4f(bounds.extent, 0.0f);
+}
+
+void Dx12Mesh::OnRender(uint32_t firstInstance, uint32_t instanceCount){
+
+    // the material is bound by the scene once per run of draws sharing it
     m_graphicsMgr->SetPipelineStateFlag(m_meshFlag, 0x7, true);
 
+    const MeshConstants* meshConst = &m_meshConst;
+    if(!m_staging.empty()){
+        const auto& staging = m_staging[m_graphicsMgr->GetFrameIndex()];
+        D3D12_GPU_VIRTUAL_ADDRESS address = staging.buffer->GetGpuVirtualAddress();
+        for(size_t index = 0; index < m_deformedViewCount; index++){
+            m_vertexBufferView[index].BufferLocation = address;
+            address += m_vertexBufferView[index].SizeInBytes;
+        }
+        meshConst = &staging.meshConst;
+    }
+
     auto cmdList = m_graphicsMgr->GetCommandList();
     cmdList->IASetVertexBuffers(0, m_vertexBufferView.size(), m_vertexBufferView.data());
     cmdList->IASetIndexBuffer(&m_indexBufferView);
-    cmdList->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);
+    cmdList->SetGraphicsRoot32BitConstants(5, sizeof(MeshConstants) / 4, meshConst, 0);
+    // SV_InstanceID starts at 0 whatever the start location, the shader adds firstInstance itself
+    cmdList->SetGraphicsRoot32BitConstant(6, firstInstance, 0);
+    cmdList->DrawIndexedInstanced(m_indexCount, instanceCount, 0, 0, 0);
 
 }
\ No newline at end of file
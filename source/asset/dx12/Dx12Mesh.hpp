@@ -5,25 +5,69 @@
 #include "Dx12Material.hpp"
 #include "Dx12Struct.hpp"
 #include "GraphicsManager.hpp"
+#include "Skinning.hpp"
+#include "MorphTargets.hpp"
 
 class Dx12Mesh : public Mesh{
 public:
     Dx12Mesh(
         UploadBuffer& vertexBuffer, size_t vertexCount, 
         UploadBuffer& indexBuffer, size_t indexCount,
+        const GeoMath::BoundingBox& positionBounds,
         const PipelineStateFlag flag, const std::shared_ptr<Material>& material,
         const ComPtr<ID3D12Device8>& device
     );
     
-    virtual void OnRender() override;
+    virtual void OnRender(uint32_t firstInstance, uint32_t instanceCount) override;
+    virtual uint64_t GetPipelineFlag() const override { return m_meshFlag; }
+
+    // skinned or morphed on the cpu into a staging buffer per frame resource, the position, normal
+    // and tangent views then point there instead of the bind pose uploaded by the constructor
+    void SetSkinnedGeometry(std::unique_ptr<SkinnedGeometry> geometry, const ComPtr<ID3D12Device8>& device);
+    // weights are the initial ones, one per target
+    void SetMorphTargets(std::unique_ptr<MorphTargets> targets, const float* weights, const ComPtr<ID3D12Device8>& device);
+    bool IsSkinned() const { return m_skinned != nullptr; }
+    bool IsMorphed() const { return m_morph != nullptr; }
+
+    virtual void OnDeform(const Skin* skin) override;
+    virtual void SetMorphWeights(const float* weights, size_t count) override;
+    virtual uint32_t GetMorphTargetCount() const override { return m_morph != nullptr ? m_morph->GetTargetCount() : 0; }
 
 protected:
+    // one staging buffer per frame resource, each starting from the current vertices
+    void CreateStaging(bool hasTangents, const ComPtr<ID3D12Device8>& device);
+    // packs the deformed vertices into the staging buffer of the given frame
+    void PackDeformed(uint32_t frameIndex);
+
     size_t                                m_indexCount;
     std::unique_ptr<DefaultBuffer>        m_vertexBuffer;
     std::unique_ptr<DefaultBuffer>        m_indexBuffer;
 
     std::vector<D3D12_VERTEX_BUFFER_VIEW> m_vertexBufferView;
     D3D12_INDEX_BUFFER_VIEW               m_indexBufferView;
+    MeshConstants                         m_meshConst;
+
+    struct DeformStaging{
+        std::unique_ptr<UploadBuffer> buffer;
+        // mapped for the lifetime of the buffer
+        uint8_t*                      data;
+        // skin and weight versions the buffer was packed from
+        uint64_t                      skinVersion;
+        uint64_t                      morphVersion;
+        MeshConstants                 meshConst;
+    };
+    std::unique_ptr<SkinnedGeometry>      m_skinned;
+    std::unique_ptr<MorphTargets>         m_morph;
+    std::vector<float>                    m_morphWeights;
+    // moves on with every change of the weights
+    uint64_t                              m_morphVersion = 0;
+
+    std::vector<DeformStaging>            m_staging;
+    size_t                                m_deformedViewCount = 0;
+    // versions the cpu results of m_skinned and m_morph were computed from
+    uint64_t                              m_deformedSkinVersion  = 0;
+    uint64_t                              m_deformedMorphVersion = 0;
+
 
     uint64_t                              m_meshFlag;
     Dx12GraphicsManager* const            m_graphicsMgr;
@@ -1,68 +1,32 @@
 #include "Dx12Model.hpp"
 #include "GraphicsManager.hpp"
 
-Dx12Model::Dx12Model(const char* fileName)
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+Dx12Model::Dx12Model(const char* fileName, const TextureCompression& compression)
     : Model(fileName)
     , m_graphicsMgr(Dx12GraphicsManager::GetInstance())
 {
 
     auto dxDevice = m_graphicsMgr->GetDevice();
     auto cmdList  = m_graphicsMgr->GetTempCommandList();
-    uint8_t  frameCount = m_graphicsMgr->GetFrameCount();
-    uint32_t numObjectPerFrame = m_model.nodes.size() + 1;
-    uint32_t svvDescriptorSize = dxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-    // Create Resource Heap
-    {
-        // Create Constant buffer descriptorHeap
-        D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc = {};
-        cbvHeapDesc.NumDescriptors = frameCount * numObjectPerFrame + m_model.materials.size();
-        cbvHeapDesc.Type  = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        ThrowIfFailed(dxDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&cbvHeap)));
-
-        // Create Perframe Resource
-        {
-
-            constexpr uint32_t mainConstByteSize = Utility::CalcAlignment<256>(sizeof(MainConstBuffer));
-            constexpr uint32_t objectConstByteSize = Utility::CalcAlignment<256>(sizeof(ObjectConstBuffer));
-    
-            D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-            for(size_t index = 0; index < frameCount; index++){
-
-                auto& frameResource = m_graphicsMgr->GetFrameResource(index);
-                CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHandle(cbvHeap->GetCPUDescriptorHandleForHeapStart());
-
-                // Create Main Constant buffer and view
-                frameResource.mainConst = std::make_unique<UploadBuffer>(dxDevice, 1, mainConstByteSize);
-
-                cbvHandle.Offset(index * numObjectPerFrame, svvDescriptorSize);
-                cbvDesc.BufferLocation = frameResource.mainConst->GetGpuVirtualAddress();
-                cbvDesc.SizeInBytes = mainConstByteSize;
-
-                dxDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
-
-                frameResource.objectConst = std::make_unique<UploadBuffer>(dxDevice, numObjectPerFrame, objectConstByteSize);
-
-                // Create Object Constant buffer and view
-                size_t virtualAddress = frameResource.objectConst->GetGpuVirtualAddress();
-                for(size_t offset = 0; offset < numObjectPerFrame; offset++){
 
-                    cbvHandle.Offset(1, svvDescriptorSize);
-                    cbvDesc.BufferLocation = virtualAddress;
-                    cbvDesc.SizeInBytes = objectConstByteSize;
-
-                    dxDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
-                    virtualAddress += objectConstByteSize;
-                }
-            }
-        }
+    // every primitive of every node can be drawn in the same frame
+    uint32_t numInstancePerFrame = 1;
+    for(const auto& node : m_model.nodes){
+        if(node.mesh >= 0) numInstancePerFrame += m_model.meshes[node.mesh].primitives.size();
     }
+    CreateResourceHeap(static_cast<uint32_t>(m_model.materials.size()), numInstancePerFrame);
 
     // Create Texture Resource
     {
 
-        auto GetFormat = [&](tinygltf::Image image) -> DXGI_FORMAT{
+        auto GetFormat = [&](size_t imageIndex) -> DXGI_FORMAT{
+            const auto& image = m_model.images[imageIndex];
+            if(m_imageFormats[imageIndex] != Utility::BlockCompressor::Format::RGBA8) return GetTextureFormat(m_imageFormats[imageIndex]);
+
             switch(image.component){
                 case 4:
                 {
@@ -72,46 +36,48 @@ Dx12Model::Dx12Model(const char* fileName)
                             return DXGI_FORMAT_R8G8B8A8_UNORM;
                         }
                         default:
-                            throw std::runtime_error("");
+                            throw std::runtime_error("image " + std::to_string(imageIndex) + " " + image.uri + " has " + std::to_string(image.bits) + " bit channels, only 8 are supported");
                     }
                     break;
                 }
                 default:
-                    throw std::runtime_error("");
+                    throw std::runtime_error("image " + std::to_string(imageIndex) + " " + image.uri + " has " + std::to_string(image.component) + " channels, only RGBA is supported");
             }
         };
 
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = -1;
-        srvDesc.Texture2D.MostDetailedMip = 0;
-        srvDesc.Texture2D.PlaneSlice = 0;
-        srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-
-        CD3DX12_CPU_DESCRIPTOR_HANDLE cpuSrvHandle = m_graphicsMgr->GetTexCpuHandle();
-        for(auto& tex : m_model.textures){
-            auto& image  = m_model.images[tex.source];
-            auto  format = GetFormat(image);
-            uint64_t srcPitchSize = image.width * 4;
-            uint64_t dstPicthSize = Utility::CalcAlignment<D3D12_TEXTURE_DATA_PITCH_ALIGNMENT>(srcPitchSize);
-
-            auto& uploadBuffer = m_uploadBuffers.emplace_back(dxDevice, 1, image.height * dstPicthSize);
-
-            uint64_t srcOffset = 0;
-            uint64_t dstOffset = 0;
-            for(int row = 0; row < image.height; row++){
-                uploadBuffer.CopyData(image.image.data() + srcOffset, srcPitchSize, dstOffset);
-
-                srcOffset += srcPitchSize;
-                dstOffset += dstPicthSize;
+        // images decode on the worker pool, the textures of each one upload as soon as it is done.
+        // A texture without an image the loader reads samples a white texel
+        textures.reserve(m_model.textures.size());
+        std::vector<std::vector<uint32_t>> texturesOfImage(m_model.images.size());
+        for(uint32_t index = 0; index < m_model.textures.size(); index++){
+            const int imageIndex = GetTextureImage(index);
+            if(imageIndex >= 0){
+                texturesOfImage[imageIndex].emplace_back(index);
+                continue;
             }
+            OutputDebugString(("Texture " + std::to_string(index) + " has no image to load, a white one is bound\n").c_str());
+            const auto fallback = MakeFallbackChain();
+            CreateTexture(cmdList, index, fallback.data.data(), fallback.data.size(), fallback.levels, DXGI_FORMAT_R8G8B8A8_UNORM);
+        }
 
-            auto& texture = textures.emplace_back(dxDevice, cmdList, uploadBuffer, format, image.width, image.height);
-
-            srvDesc.Format = format;
-            dxDevice->CreateShaderResourceView(texture.GetResource(), &srvDesc, cpuSrvHandle);
-            cpuSrvHandle.Offset(1, svvDescriptorSize);
+        std::vector<bool> isDecoded(m_model.images.size(), false);
+        DecodeImages(compression, [&](size_t imageIndex){
+            isDecoded[imageIndex] = true;
+            auto& image = m_model.images[imageIndex];
+            auto& mips  = m_mipChains[imageIndex];
+            for(auto index : texturesOfImage[imageIndex]){
+                CreateTexture(cmdList, index, mips.data.data(), mips.data.size(), mips.levels, GetFormat(imageIndex));
+            }
+            // the upload buffers hold the texels from here on
+            std::vector<unsigned char>().swap(image.image);
+            mips = Utility::MipGenerator::MipChain();
+        });
+
+        // a texture whose image failed to decode
+        for(size_t imageIndex = 0; imageIndex < isDecoded.size(); imageIndex++){
+            if(!isDecoded[imageIndex] && !texturesOfImage[imageIndex].empty()){
+                throw std::runtime_error("image " + std::to_string(imageIndex) + " " + m_model.images[imageIndex].uri + " failed to decode");
+            }
         }
 
     }
@@ -120,7 +86,8 @@ Dx12Model::Dx12Model(const char* fileName)
     std::vector<uint32_t> texIndex(m_model.materials.size(), 0);
     {
         constexpr uint32_t matConstByteSize = Utility::CalcAlignment<256>(sizeof(MaterialConstant));
-        m_uploadBuffers.emplace_back(dxDevice, m_model.materials.size(), matConstByteSize);
+        std::vector<uint8_t> matConsts(m_model.materials.size() * matConstByteSize, 0);
+        std::vector<ScenePackage::Material> materials(m_model.materials.size());
 
         MaterialConstant matConst;
         for(size_t index = 0; index < m_model.materials.size(); index++){
@@ -153,51 +120,20 @@ Dx12Model::Dx12Model(const char* fileName)
                 );
 
                 matConst.glossinessFactor = static_cast<float>(glossiness.GetNumberAsDouble());
-            }
-            else{
-                auto& pbrParam = mat.pbrMetallicRoughness;
-            }
-
-            m_uploadBuffers.back().CopyData(
-                reinterpret_cast<uint8_t*>(&matConst),
-                matConstByteSize, index * matConstByteSize
-            );
-
-        }
-
-        matConstBuffer = std::make_unique<DefaultBuffer>(dxDevice, cmdList, m_uploadBuffers.back());
-        m_materials.reserve(m_model.materials.size());
-
-        CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHandle(
-            cbvHeap->GetCPUDescriptorHandleForHeapStart(),
-            numObjectPerFrame * frameCount, svvDescriptorSize
-        );
-
-        D3D12_GPU_VIRTUAL_ADDRESS virtualAddress = matConstBuffer->GetGpuVirtualAddress();
-        for(uint32_t index = 0; index < m_model.materials.size(); index++){
-            auto& mat = m_model.materials[index];
-            D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {virtualAddress, matConstByteSize};
-            dxDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
-
-            D3D12_GPU_DESCRIPTOR_HANDLE texHandle = m_graphicsMgr->GetTexGpuHandle();
 
-            if(mat.extensions.find("KHR_materials_pbrSpecularGlossiness") != mat.extensions.end()){
-                auto& pbrParam = mat.extensions["KHR_materials_pbrSpecularGlossiness"];
                 if(pbrParam.Has("diffuseTexture")){
                     texIndex[index] = pbrParam.Get("diffuseTexture").Get("index").GetNumberAsInt();
-                    texHandle.ptr += svvDescriptorSize * texIndex[index];
                 }
             }
             else{
-
+                auto& pbrParam = mat.pbrMetallicRoughness;
             }
-            
-            m_materials.emplace_back(new Dx12Material(virtualAddress, texHandle, mat.doubleSided));
-            
-            virtualAddress += matConstByteSize;
-            cbvHandle.Offset(1, svvDescriptorSize);
+
+            memcpy(matConsts.data() + index * matConstByteSize, &matConst, sizeof(MaterialConstant));
+            materials[index] = {texIndex[index], mat.doubleSided ? 1u : 0u};
         }
 
+        CreateMaterials(cmdList, matConsts.data(), materials.data(), materials.size());
     }
 
     // Create Mesh 
@@ -214,10 +150,14 @@ Dx12Model::Dx12Model(const char* fileName)
 
         for(const auto& primitive : mesh.primitives){
             uint32_t vertexCount = 0;
-            uint8_t* position = nullptr;
-            uint8_t* normal   = nullptr;
-            uint8_t* tangent  = nullptr;
-            uint8_t* texcoord = nullptr;
+            const uint8_t* position = nullptr;
+            const uint8_t* normal   = nullptr;
+            const uint8_t* tangent  = nullptr;
+            const uint8_t* texcoord = nullptr;
+            const uint8_t* joints   = nullptr;
+            const uint8_t* weights  = nullptr;
+            int jointType  = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+            int weightType = TINYGLTF_COMPONENT_TYPE_FLOAT;
             
             assert(primitive.mode == TINYGLTF_MODE_TRIANGLES);
 
@@ -225,12 +165,22 @@ Dx12Model::Dx12Model(const char* fileName)
                 const std::string attrName = attributes.first;
                 auto& accessor = m_model.accessors[attributes.second];
 
-                assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                // joints and weights may also be stored as integers, attributes the layouts have no place for are skipped
+                const bool isVertexAttribute = attrName == "POSITION" || attrName == "NORMAL" || attrName == "TANGENT" || attrName == "TEXCOORD_0";
+                assert(!isVertexAttribute || accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
 
                 if(attrName == "POSITION"){
                     assert(accessor.type == TINYGLTF_TYPE_VEC3);
 
                     position = GetBuffer(accessor.bufferView) + accessor.byteOffset;
+
+                    // glTF requires min and max on positions, they give the culling bounds
+                    if(accessor.minValues.size() == 3 && accessor.maxValues.size() == 3){
+                        staticMesh->AddBounds(GeoMath::BoundingBox::FromMinMax(
+                            GeoMath::Vector3f(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]),
+                            GeoMath::Vector3f(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2])
+                        ));
+                    }
                 }
                 else if(attrName == "NORMAL"){
                     assert(accessor.type == TINYGLTF_TYPE_VEC3);
@@ -245,6 +195,16 @@ Dx12Model::Dx12Model(const char* fileName)
                     assert(accessor.type == TINYGLTF_TYPE_VEC2);
                     texcoord = GetBuffer(accessor.bufferView) + accessor.byteOffset;
                 }
+                else if(attrName == "JOINTS_0"){
+                    assert(accessor.type == TINYGLTF_TYPE_VEC4);
+                    joints    = GetBuffer(accessor.bufferView) + accessor.byteOffset;
+                    jointType = accessor.componentType;
+                }
+                else if(attrName == "WEIGHTS_0"){
+                    assert(accessor.type == TINYGLTF_TYPE_VEC4);
+                    weights    = GetBuffer(accessor.bufferView) + accessor.byteOffset;
+                    weightType = accessor.componentType;
+                }
                 vertexCount = accessor.count;
 
             }
@@ -265,7 +225,43 @@ Dx12Model::Dx12Model(const char* fileName)
             m_indexBuffers.back().CopyData(GetBuffer(accessor.bufferView) + accessor.byteOffset, indexBufferByteSize);
 
             assert(position != nullptr && normal != nullptr);
-            switch(primitive.attributes.size()){
+
+            // compact attributes, positions are quantized inside their own bounds
+            std::vector<GeoMath::SNorm16x4> packedPosition(vertexCount);
+            std::vector<GeoMath::SNorm16x2> packedNormal(vertexCount);
+            GeoMath::BoundingBox positionBounds = GeoMath::PackPositions(
+                reinterpret_cast<const float*>(position), vertexCount, packedPosition.data()
+            );
+            GeoMath::PackNormals(reinterpret_cast<const float*>(normal), vertexCount, packedNormal.data());
+            meshInfo.positionCenter = positionBounds.center;
+            meshInfo.positionExtent = positionBounds.extent;
+
+            // 4 influences per vertex as uint16 joints and float weights, the layout SkinnedGeometry takes
+            const bool isSkinned = joints != nullptr && weights != nullptr;
+            std::vector<uint16_t> skinJoints;
+            std::vector<float>    skinWeights;
+            if(isSkinned){
+                skinJoints.resize(vertexCount * 4);
+                skinWeights.resize(vertexCount * 4);
+                for(size_t i = 0; i < skinJoints.size(); i++){
+                    skinJoints[i] = jointType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ? joints[i] : reinterpret_cast<const uint16_t*>(joints)[i];
+
+                    switch(weightType){
+                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                            skinWeights[i] = weights[i] / 255.0f;
+                            break;
+                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                            skinWeights[i] = reinterpret_cast<const uint16_t*>(weights)[i] / 65535.0f;
+                            break;
+                        default:
+                            skinWeights[i] = reinterpret_cast<const float*>(weights)[i];
+                            break;
+                    }
+                }
+            }
+
+            const size_t attributeCount = (position != nullptr) + (normal != nullptr) + (tangent != nullptr) + (texcoord != nullptr);
+            switch(attributeCount){
                 case 2:
                 case 3:
                 {
@@ -273,17 +269,17 @@ Dx12Model::Dx12Model(const char* fileName)
                     std::unique_ptr<uint8_t[]> data = std::make_unique<uint8_t[]>(vertexBufferByteSize);
 
                     meshInfo.positionOffsetBytes = totalVertexBufferByteSize;
-                    vertex0.position.CopyToBuffer(data.get(), position, vertexCount);
+                    vertex0.position.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedPosition.data()), vertexCount);
 
-                    meshInfo.normalOffsetBytes = meshInfo.positionOffsetBytes + 12 * vertexCount;
-                    vertex0.normal.CopyToBuffer(data.get(), normal, vertexCount);
+                    meshInfo.normalOffsetBytes = meshInfo.positionOffsetBytes + sizeof(GeoMath::SNorm16x4) * vertexCount;
+                    vertex0.normal.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedNormal.data()), vertexCount);
 
                     m_vertexBuffers.emplace_back(dxDevice, vertexBufferByteSize, 1);
                     m_vertexBuffers.back().CopyData(data.get(), vertexBufferByteSize);
 
                     staticMesh->CreateNewMesh(asInfos.size(), new Dx12Mesh(
                         m_vertexBuffers.back(), vertexCount,
-                        m_indexBuffers.back(), accessor.count,
+                        m_indexBuffers.back(), accessor.count, positionBounds,
                         PipelineStateFlag::PIPELINE_STATE_SHADER_COMB_0,
                         m_materials[primitive.material], dxDevice
                     ));
@@ -297,24 +293,29 @@ Dx12Model::Dx12Model(const char* fileName)
 
                     std::unique_ptr<uint8_t[]> data = std::make_unique<uint8_t[]>(vertexBufferByteSize);
 
+                    std::vector<GeoMath::SNorm16x4> packedTangent(vertexCount);
+                    std::vector<GeoMath::Half2>     packedTexCoord(vertexCount);
+                    GeoMath::PackTangents(reinterpret_cast<const float*>(tangent), vertexCount, packedTangent.data());
+                    GeoMath::PackTexCoords(reinterpret_cast<const float*>(texcoord), vertexCount, packedTexCoord.data());
+
                     meshInfo.positionOffsetBytes = totalVertexBufferByteSize;
-                    vertex1.position.CopyToBuffer(data.get(), position, vertexCount);
+                    vertex1.position.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedPosition.data()), vertexCount);
                     
-                    meshInfo.normalOffsetBytes = meshInfo.positionOffsetBytes + 12 * vertexCount;
-                    vertex1.normal.CopyToBuffer(data.get(), normal, vertexCount);
+                    meshInfo.normalOffsetBytes = meshInfo.positionOffsetBytes + sizeof(GeoMath::SNorm16x4) * vertexCount;
+                    vertex1.normal.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedNormal.data()), vertexCount);
 
-                    meshInfo.tangentOffsetBytes = meshInfo.normalOffsetBytes + 12 * vertexCount;
-                    vertex1.tangent.CopyToBuffer(data.get(), tangent, vertexCount);
+                    meshInfo.tangentOffsetBytes = meshInfo.normalOffsetBytes + sizeof(GeoMath::SNorm16x2) * vertexCount;
+                    vertex1.tangent.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedTangent.data()), vertexCount);
 
-                    meshInfo.uvOffsetBytes = meshInfo.tangentOffsetBytes + 16 * vertexCount;
-                    vertex1.texCoord.CopyToBuffer(data.get(), texcoord, vertexCount);
+                    meshInfo.uvOffsetBytes = meshInfo.tangentOffsetBytes + sizeof(GeoMath::SNorm16x4) * vertexCount;
+                    vertex1.texCoord.CopyToBuffer(data.get(), reinterpret_cast<uint8_t*>(packedTexCoord.data()), vertexCount);
 
                     m_vertexBuffers.emplace_back(dxDevice, vertexBufferByteSize, 1);
                     m_vertexBuffers.back().CopyData(data.get(), vertexBufferByteSize);
 
                     staticMesh->CreateNewMesh(asInfos.size(), new Dx12Mesh(
                         m_vertexBuffers.back(), vertexCount,
-                        m_indexBuffers.back(), accessor.count,
+                        m_indexBuffers.back(), accessor.count, positionBounds,
                         PipelineStateFlag::PIPELINE_STATE_SHADER_COMB_1,
                         m_materials[primitive.material], dxDevice
                     ));
@@ -327,6 +328,58 @@ Dx12Model::Dx12Model(const char* fileName)
                     break;
                 }
             }
+            // the comb 0 layout has no tangents to skin or morph
+            auto dx12Mesh = static_cast<Dx12Mesh*>(staticMesh->GetMeshes().back().get());
+            const float* deformedTangent = attributeCount == 4 ? reinterpret_cast<const float*>(tangent) : nullptr;
+            if(isSkinned){
+                dx12Mesh->SetSkinnedGeometry(std::make_unique<SkinnedGeometry>(
+                    reinterpret_cast<const float*>(position), reinterpret_cast<const float*>(normal), deformedTangent,
+                    skinJoints.data(), skinWeights.data(), vertexCount
+                ), dxDevice);
+            }
+
+            if(!primitive.targets.empty()){
+                auto targets = std::make_unique<MorphTargets>(
+                    reinterpret_cast<const float*>(position), reinterpret_cast<const float*>(normal), deformedTangent, vertexCount
+                );
+
+                // culling bounds for weights in [0, 1], every target at the side of its deltas that grows the box
+                float lo[3] = {positionBounds.center.x - positionBounds.extent.x, positionBounds.center.y - positionBounds.extent.y, positionBounds.center.z - positionBounds.extent.z};
+                float hi[3] = {positionBounds.center.x + positionBounds.extent.x, positionBounds.center.y + positionBounds.extent.y, positionBounds.center.z + positionBounds.extent.z};
+
+                const char* attributeNames[3] = {"POSITION", "NORMAL", "TANGENT"};
+                for(const auto& target : primitive.targets){
+                    std::vector<float> deltas[3];
+                    for(int a = 0; a < 3; a++){
+                        auto it = target.find(attributeNames[a]);
+                        if(it == target.end()) continue;
+
+                        const auto& accessor = m_model.accessors[it->second];
+                        assert(accessor.type == TINYGLTF_TYPE_VEC3 && accessor.count == vertexCount);
+                        deltas[a] = ReadFloats(accessor, 3);
+
+                        if(a == 0 && accessor.minValues.size() == 3 && accessor.maxValues.size() == 3){
+                            for(int k = 0; k < 3; k++){
+                                lo[k] += accessor.minValues[k] < 0.0 ? static_cast<float>(accessor.minValues[k]) : 0.0f;
+                                hi[k] += accessor.maxValues[k] > 0.0 ? static_cast<float>(accessor.maxValues[k]) : 0.0f;
+                            }
+                        }
+                    }
+                    targets->AddTarget(
+                        deltas[0].empty() ? nullptr : deltas[0].data(),
+                        deltas[1].empty() ? nullptr : deltas[1].data(),
+                        deltas[2].empty() ? nullptr : deltas[2].data()
+                    );
+                }
+                staticMesh->AddBounds(GeoMath::BoundingBox::FromMinMax(GeoMath::Vector3f(lo[0], lo[1], lo[2]), GeoMath::Vector3f(hi[0], hi[1], hi[2])));
+
+                // default weights of the mesh, zero for targets it gives none
+                std::vector<float> morphWeights(primitive.targets.size(), 0.0f);
+                for(size_t t = 0; t < morphWeights.size() && t < mesh.weights.size(); t++){
+                    morphWeights[t] = static_cast<float>(mesh.weights[t]);
+                }
+                dx12Mesh->SetMorphTargets(std::move(targets), morphWeights.data(), dxDevice);
+            }
             meshInfo.matIndex = primitive.material;
             asInfo.texIndex = texIndex[primitive.material];
         }
@@ -336,21 +389,319 @@ Dx12Model::Dx12Model(const char* fileName)
         asInfos.emplace_back(asInfo);
     }
 
+    CreateRayTraceResources(
+        cmdList, rayTraceMeshInfos.data(), asInfos.data(), static_cast<uint32_t>(asInfos.size()),
+        totalIndexBufferByteSize, totalVertexBufferByteSize
+    );
+
+    // Create Node
+    root = std::make_unique<Dx12Scene>();
+    m_nodeSlots.assign(m_model.nodes.size(), SceneHierarchy::NoNode);
+    for(auto nodeIndex : m_model.scenes[0].nodes){
+        root->AddChild(BuildNode(nodeIndex, root.get()));
+    }
+
+    // Create Animation
+    // the skinned meshes of a node follow its skin, a mesh shared by several skinned nodes the first one
+    std::unordered_set<Mesh*> deformedMeshes;
+    for(auto& skin : LoadSkins()){
+        root->AddSkin(skin);
+
+        const size_t nodeIndex = std::find(m_nodeSlots.begin(), m_nodeSlots.end(), skin->GetMeshNode()) - m_nodeSlots.begin();
+        for(const auto& mesh : m_meshes[m_model.nodes[nodeIndex].mesh]->GetMeshes()){
+            if(static_cast<Dx12Mesh*>(mesh.get())->IsSkinned() && deformedMeshes.insert(mesh.get()).second){
+                root->AddSkinnedMesh(skin, mesh.get());
+            }
+        }
+    }
+
+    // morphed meshes without a skin are deformed with the first node drawing them, weights of a node replace those of its mesh
+    for(size_t nodeIndex = 0; nodeIndex < m_model.nodes.size(); nodeIndex++){
+        const auto& node = m_model.nodes[nodeIndex];
+        if(node.mesh < 0 || m_nodeSlots[nodeIndex] == SceneHierarchy::NoNode) continue;
+
+        for(const auto& mesh : m_meshes[node.mesh]->GetMeshes()){
+            if(mesh->GetMorphTargetCount() == 0) continue;
+
+            if(node.weights.size() == mesh->GetMorphTargetCount()){
+                std::vector<float> morphWeights(node.weights.begin(), node.weights.end());
+                mesh->SetMorphWeights(morphWeights.data(), morphWeights.size());
+            }
+            if(deformedMeshes.insert(mesh.get()).second){
+                root->AddMorphedMesh(m_nodeSlots[nodeIndex], mesh.get());
+            }
+        }
+    }
+    animations = LoadAnimations();
+    if(!animations.empty()){
+        root->PlayAnimation(animations.front());
+    }
+
+    m_graphicsMgr->ExecuteCommandList(cmdList);
+    m_graphicsMgr->Flush();
+}
+
+Dx12Model::Dx12Model(const ScenePackage& package)
+    : m_graphicsMgr(Dx12GraphicsManager::GetInstance())
+{
+
+    auto dxDevice = m_graphicsMgr->GetDevice();
+    auto cmdList  = m_graphicsMgr->GetTempCommandList();
+
+    const auto*  nodes         = package.Get<ScenePackage::Node>(ScenePackage::Nodes);
+    const size_t nodeCount     = package.GetCount<ScenePackage::Node>(ScenePackage::Nodes);
+    const auto*  meshes        = package.Get<ScenePackage::Mesh>(ScenePackage::Meshes);
+    const size_t meshCount     = package.GetCount<ScenePackage::Mesh>(ScenePackage::Meshes);
+    const auto*  primitives    = package.Get<ScenePackage::Primitive>(ScenePackage::Primitives);
+    const size_t materialCount = package.GetCount<ScenePackage::Material>(ScenePackage::Materials);
+
+    // every primitive of every node can be drawn in the same frame
+    uint32_t numInstancePerFrame = 1;
+    for(size_t i = 0; i < nodeCount; i++){
+        if(nodes[i].mesh >= 0) numInstancePerFrame += meshes[nodes[i].mesh].primitiveCount;
+    }
+    CreateResourceHeap(static_cast<uint32_t>(materialCount), numInstancePerFrame);
+
+    // mip chains are laid out for the copies already, each texture is a single upload
+    const auto* texels = package.GetData(ScenePackage::Texels);
+    std::vector<Utility::MipGenerator::Level> levels;
+    for(size_t i = 0; i < package.GetCount<ScenePackage::Texture>(ScenePackage::Textures); i++){
+        const auto& texture  = package.Get<ScenePackage::Texture>(ScenePackage::Textures)[i];
+        const uint64_t bytes = Utility::BlockCompressor::GetLayout(texture.format, texture.width, texture.height, texture.mipLevels, levels);
+        CreateTexture(cmdList, static_cast<uint32_t>(i), texels + texture.texelOffset, bytes, levels, GetTextureFormat(texture.format));
+    }
+
+    CreateMaterials(
+        cmdList, package.GetData(ScenePackage::MaterialConstants),
+        package.Get<ScenePackage::Material>(ScenePackage::Materials), materialCount
+    );
+
+    // Create Mesh
+    const auto* vertices = package.GetData(ScenePackage::Vertices);
+    const auto* indices  = package.GetData(ScenePackage::Indices);
+    std::vector<AccelerationStructerInfo> asInfos(meshCount);
+    m_meshes.reserve(meshCount);
+    for(size_t meshIndex = 0; meshIndex < meshCount; meshIndex++){
+        const auto& mesh = meshes[meshIndex];
+        asInfos[meshIndex] = {mesh.vertexCount, mesh.indexCount, mesh.textureIndex};
+
+        StaticMesh* staticMesh = new StaticMesh;
+        for(uint32_t p = 0; p < mesh.primitiveCount; p++){
+            const auto& primitive = primitives[mesh.firstPrimitive + p];
+            const bool  hasTangents = primitive.layout == ScenePackage::Layout::PositionNormalTangentTexCoord;
+            const size_t vertexBufferByteSize = (hasTangents ? vertex1 : vertex0).GetStructSize() * primitive.vertexCount;
+            const size_t indexBufferByteSize  = sizeof(uint32_t) * primitive.indexCount;
+
+            m_indexBuffers.emplace_back(dxDevice, indexBufferByteSize, 1);
+            m_indexBuffers.back().CopyData(indices + primitive.indexOffset, indexBufferByteSize);
+            m_vertexBuffers.emplace_back(dxDevice, vertexBufferByteSize, 1);
+            m_vertexBuffers.back().CopyData(vertices + primitive.vertexOffset, vertexBufferByteSize);
+
+            if(primitive.hasBounds){
+                staticMesh->AddBounds(GeoMath::BoundingBox::FromMinMax(
+                    GeoMath::Vector3f(primitive.boundsMin[0], primitive.boundsMin[1], primitive.boundsMin[2]),
+                    GeoMath::Vector3f(primitive.boundsMax[0], primitive.boundsMax[1], primitive.boundsMax[2])
+                ));
+            }
+
+            staticMesh->CreateNewMesh(meshIndex, new Dx12Mesh(
+                m_vertexBuffers.back(), primitive.vertexCount,
+                m_indexBuffers.back(), primitive.indexCount,
+                GeoMath::BoundingBox(
+                    GeoMath::Vector3f(primitive.center[0], primitive.center[1], primitive.center[2]),
+                    GeoMath::Vector3f(primitive.extent[0], primitive.extent[1], primitive.extent[2])
+                ),
+                hasTangents ? PipelineStateFlag::PIPELINE_STATE_SHADER_COMB_1 : PipelineStateFlag::PIPELINE_STATE_SHADER_COMB_0,
+                m_materials[primitive.material], dxDevice
+            ));
+        }
+        m_meshes.emplace_back(staticMesh);
+    }
+
+    static_assert(sizeof(ScenePackage::RayTraceInfo) == sizeof(RayTraceMeshInfo));
+    CreateRayTraceResources(
+        cmdList, package.Get<RayTraceMeshInfo>(ScenePackage::RayTraceInfos), asInfos.data(), static_cast<uint32_t>(meshCount),
+        static_cast<uint32_t>(package.GetSize(ScenePackage::Indices)), static_cast<uint32_t>(package.GetSize(ScenePackage::Vertices))
+    );
+
+    // Create Node
+    root = std::make_unique<Dx12Scene>();
+    m_nodeSlots.assign(nodeCount, SceneHierarchy::NoNode);
+    const auto* roots = package.Get<uint32_t>(ScenePackage::Roots);
+    for(size_t i = 0; i < package.GetCount<uint32_t>(ScenePackage::Roots); i++){
+        root->AddChild(BuildNode(package, roots[i], root.get()));
+    }
+
+    m_graphicsMgr->ExecuteCommandList(cmdList);
+    m_graphicsMgr->Flush();
+}
+
+void Dx12Model::CreateResourceHeap(uint32_t materialCount, uint32_t numInstancePerFrame){
+
+    auto dxDevice = m_graphicsMgr->GetDevice();
+    uint8_t  frameCount = m_graphicsMgr->GetFrameCount();
+    uint32_t svvDescriptorSize = dxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    // Create Constant buffer descriptorHeap
+    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc = {};
+    cbvHeapDesc.NumDescriptors = frameCount + materialCount;
+    cbvHeapDesc.Type  = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    ThrowIfFailed(dxDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&cbvHeap)));
+
+    // Create Perframe Resource
+    {
+
+        constexpr uint32_t mainConstByteSize = Utility::CalcAlignment<256>(sizeof(MainConstBuffer));
+
+        D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+        for(size_t index = 0; index < frameCount; index++){
+
+            auto& frameResource = m_graphicsMgr->GetFrameResource(index);
+            CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHandle(cbvHeap->GetCPUDescriptorHandleForHeapStart());
+
+            // Create Main Constant buffer and view
+            frameResource.mainConst = std::make_unique<UploadBuffer>(dxDevice, 1, mainConstByteSize);
+
+            cbvHandle.Offset(index, svvDescriptorSize);
+            cbvDesc.BufferLocation = frameResource.mainConst->GetGpuVirtualAddress();
+            cbvDesc.SizeInBytes = mainConstByteSize;
+
+            dxDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
+
+            // Create Instance buffer, read as a root structured buffer
+            frameResource.instanceData = std::make_unique<UploadBuffer>(dxDevice, numInstancePerFrame, sizeof(ObjectConstBuffer));
+        }
+    }
+}
+
+DXGI_FORMAT Dx12Model::GetTextureFormat(Utility::BlockCompressor::Format format){
+    switch(format){
+        case Utility::BlockCompressor::Format::RGBA8: return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case Utility::BlockCompressor::Format::BC1:   return DXGI_FORMAT_BC1_UNORM;
+        case Utility::BlockCompressor::Format::BC3:   return DXGI_FORMAT_BC3_UNORM;
+        case Utility::BlockCompressor::Format::BC4:   return DXGI_FORMAT_BC4_UNORM;
+        case Utility::BlockCompressor::Format::BC5:   return DXGI_FORMAT_BC5_UNORM;
+        case Utility::BlockCompressor::Format::BC7:   return DXGI_FORMAT_BC7_UNORM;
+        default:
+            throw std::runtime_error("texture format " + std::to_string(static_cast<uint32_t>(format)) + " has no DXGI format");
+    }
+}
+
+void Dx12Model::CreateTexture(
+    const ComPtr<ID3D12GraphicsCommandList4>& cmdList, uint32_t textureIndex, const uint8_t* texels, uint64_t byteSize,
+    const std::vector<Utility::MipGenerator::Level>& levels, DXGI_FORMAT format
+){
+    auto dxDevice = m_graphicsMgr->GetDevice();
+    uint32_t svvDescriptorSize = dxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = -1;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.PlaneSlice = 0;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+    // the chain is laid out the way the copies read it, rows of texels or of blocks, so all levels go up in one copy
+    const uint32_t width  = levels[0].width;
+    const uint32_t height = levels[0].height;
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(levels.size());
+    dxDevice->GetCopyableFootprints(
+        &CD3DX12_RESOURCE_DESC::Tex2D(format, width, height, 1, static_cast<UINT16>(levels.size())),
+        0, static_cast<UINT>(levels.size()), 0, footprints.data(), nullptr, nullptr, nullptr
+    );
+    for(size_t i = 0; i < levels.size(); i++){
+        if(footprints[i].Offset != levels[i].offset || footprints[i].Footprint.RowPitch != levels[i].rowPitch){
+            throw std::runtime_error("texture " + std::to_string(textureIndex) + ": level " + std::to_string(i) + " is not laid out for the copy");
+        }
+    }
+
+    // sized by the chain, which also holds the padding after the last row
+    auto& uploadBuffer = m_uploadBuffers.emplace_back(dxDevice, 1, static_cast<uint32_t>(byteSize));
+    uploadBuffer.CopyData(texels, byteSize);
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuSrvHandle(m_graphicsMgr->GetTexCpuHandle(), textureIndex, svvDescriptorSize);
+    auto& texture = textures.emplace_back(dxDevice, cmdList, uploadBuffer, format, width, height, footprints);
+    dxDevice->CreateShaderResourceView(texture.GetResource(), &srvDesc, cpuSrvHandle);
+}
+
+void Dx12Model::CreateMaterials(
+    const ComPtr<ID3D12GraphicsCommandList4>& cmdList, const uint8_t* matConsts,
+    const ScenePackage::Material* materials, size_t materialCount
+){
+    auto dxDevice = m_graphicsMgr->GetDevice();
+    uint8_t  frameCount = m_graphicsMgr->GetFrameCount();
+    uint32_t svvDescriptorSize = dxDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    constexpr uint32_t matConstByteSize = Utility::CalcAlignment<256>(sizeof(MaterialConstant));
+    static_assert(matConstByteSize == ScenePackage::ConstantStride);
+
+    m_uploadBuffers.emplace_back(dxDevice, materialCount, matConstByteSize);
+    m_uploadBuffers.back().CopyData(matConsts, materialCount * matConstByteSize);
+
+    matConstBuffer = std::make_unique<DefaultBuffer>(dxDevice, cmdList, m_uploadBuffers.back());
+    m_materials.reserve(materialCount);
+
+    CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHandle(
+        cbvHeap->GetCPUDescriptorHandleForHeapStart(),
+        frameCount, svvDescriptorSize
+    );
+
+    D3D12_GPU_VIRTUAL_ADDRESS virtualAddress = matConstBuffer->GetGpuVirtualAddress();
+    for(size_t index = 0; index < materialCount; index++){
+        D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {virtualAddress, matConstByteSize};
+        dxDevice->CreateConstantBufferView(&cbvDesc, cbvHandle);
+
+        D3D12_GPU_DESCRIPTOR_HANDLE texHandle = m_graphicsMgr->GetTexGpuHandle();
+        texHandle.ptr += svvDescriptorSize * materials[index].textureIndex;
+
+        m_materials.emplace_back(new Dx12Material(virtualAddress, texHandle, materials[index].isDoubleSided != 0));
+
+        virtualAddress += matConstByteSize;
+        cbvHandle.Offset(1, svvDescriptorSize);
+    }
+}
+
+void Dx12Model::CreateRayTraceResources(
+    const ComPtr<ID3D12GraphicsCommandList4>& cmdList, const RayTraceMeshInfo* rayTraceMeshInfos,
+    const AccelerationStructerInfo* asInfos, uint32_t meshCount,
+    uint32_t totalIndexBufferByteSize, uint32_t totalVertexBufferByteSize
+){
+    auto dxDevice = m_graphicsMgr->GetDevice();
+    uint8_t frameCount = m_graphicsMgr->GetFrameCount();
+
     rayTraceIndexBuffer  = std::make_unique<DefaultBuffer>(dxDevice, cmdList, totalIndexBufferByteSize, m_indexBuffers, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
     rayTraceVertexBuffer = std::make_unique<DefaultBuffer>(dxDevice, cmdList, totalVertexBufferByteSize, m_vertexBuffers, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
 
-    auto& meshInfo = m_uploadBuffers.emplace_back(dxDevice, rayTraceMeshInfos.size(), sizeof(RayTraceMeshInfo));
-    meshInfo.CopyData(reinterpret_cast<uint8_t*>(rayTraceMeshInfos.data()), meshInfo.GetByteSize());
+    auto& meshInfo = m_uploadBuffers.emplace_back(dxDevice, meshCount, sizeof(RayTraceMeshInfo));
+    meshInfo.CopyData(reinterpret_cast<const uint8_t*>(rayTraceMeshInfos), meshInfo.GetByteSize());
     rayTraceMeshInfoGpu = std::make_unique<DefaultBuffer>(dxDevice, cmdList, meshInfo, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
 
     // Build Raytracing AS
     {
-        uint32_t infoNum = rayTraceMeshInfos.size();
+        uint32_t infoNum = meshCount;
         ComPtr<ID3D12Resource> scrachBuffer;
         std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs(infoNum);
         std::vector<D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC> blasDescs(infoNum);
         std::vector<D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO> bottomLevelPrebuildInfos(infoNum);
         uint64_t neededByteSize = std::numeric_limits<uint64_t>::lowest();
+
+        // dequantization of the snorm16 positions, one row major 3x4 per mesh
+        std::vector<float> dequant(infoNum * 12, 0.0f);
+        for(size_t i = 0; i < infoNum; i++){
+            const auto& meshInfo = rayTraceMeshInfos[i];
+            float* m = dequant.data() + i * 12;
+            m[0]  = meshInfo.positionExtent.x;
+            m[3]  = meshInfo.positionCenter.x;
+            m[5]  = meshInfo.positionExtent.y;
+            m[7]  = meshInfo.positionCenter.y;
+            m[10] = meshInfo.positionExtent.z;
+            m[11] = meshInfo.positionCenter.z;
+        }
+        auto& dequantBuffer = m_uploadBuffers.emplace_back(dxDevice, infoNum, sizeof(float) * 12);
+        dequantBuffer.CopyData(reinterpret_cast<uint8_t*>(dequant.data()), dequantBuffer.GetByteSize());
         
         for(size_t i = 0; i < infoNum; i++){
 
@@ -362,14 +713,14 @@ Dx12Model::Dx12Model(const char* fileName)
             desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE; 
             
             D3D12_RAYTRACING_GEOMETRY_TRIANGLES_DESC& trianglesDesc = desc.Triangles;
-            trianglesDesc.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+            trianglesDesc.VertexFormat = DXGI_FORMAT_R16G16B16A16_SNORM;
             trianglesDesc.VertexCount  = asInfo.vertexCount;
             trianglesDesc.VertexBuffer.StartAddress = rayTraceVertexBuffer->GetGpuVirtualAddress() + meshInfo.positionOffsetBytes;
-            trianglesDesc.VertexBuffer.StrideInBytes = sizeof(GeoMath::Vector3f);
+            trianglesDesc.VertexBuffer.StrideInBytes = sizeof(GeoMath::SNorm16x4);
             trianglesDesc.IndexBuffer = rayTraceIndexBuffer->GetGpuVirtualAddress() + meshInfo.indexOffsetBytes;
             trianglesDesc.IndexCount  = asInfo.indexCount;
             trianglesDesc.IndexFormat = DXGI_FORMAT_R32_UINT;
-            trianglesDesc.Transform3x4 = 0;
+            trianglesDesc.Transform3x4 = dequantBuffer.GetGpuVirtualAddress(i);
         
             D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC& blasDesc = blasDescs[i];
             blasDesc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
@@ -469,40 +820,34 @@ Dx12Model::Dx12Model(const char* fileName)
         }
     
     }
-
-    // Create Node
-    root = std::make_unique<Scene>();
-    for(auto nodeIndex : m_model.scenes[0].nodes){
-        root->AddChild(BuildNode(nodeIndex, root.get()));
-    }
-
-    m_graphicsMgr->ExecuteCommandList(cmdList);
-    m_graphicsMgr->Flush();
 }
 
 std::unique_ptr<SceneNode> Dx12Model::BuildNode(size_t nodeIndex, SceneNode* pParentNode){
 
     auto glNode = m_model.nodes[nodeIndex];
     std::unique_ptr<SceneNode> sceneNode(new Dx12SceneNode(nodeIndex, pParentNode));
+    m_nodeSlots[nodeIndex] = sceneNode->GetSlot();
 
-    GeoMath::Matrix4f S, R, T;
+    GeoMath::Transform local;
 
     auto& scale = glNode.scale;
     if(scale.size() > 0){
-        S = GeoMath::Matrix4f::Scale(scale[0], scale[1], scale[2]);
+        local.scale = GeoMath::Vector3f(scale[0], scale[1], scale[2]);
     }
 
     auto& rotation = glNode.rotation;
     if(rotation.size() > 0){
-        R = GeoMath::Matrix4f::Rotation(rotation[0], rotation[1], rotation[2], rotation[3]);
+        for(size_t i = 0; i < 4; i++){
+            local.rotation[i] = static_cast<float>(rotation[i]);
+        }
     }
 
     auto& translation = glNode.translation;
     if(translation.size() > 0){
-        T = GeoMath::Matrix4f::Translation(translation[0], translation[1], translation[2]);
+        local.translation = GeoMath::Vector3f(translation[0], translation[1], translation[2]);
     }
    
-    sceneNode->SetMatrix(&S, &R, &T);
+    sceneNode->SetTransform(local);
 
     auto& matrix = glNode.matrix;
 
@@ -532,3 +877,38 @@ std::unique_ptr<SceneNode> Dx12Model::BuildNode(size_t nodeIndex, SceneNode* pPa
     return sceneNode;
 }
 
+std::unique_ptr<SceneNode> Dx12Model::BuildNode(const ScenePackage& package, size_t nodeIndex, SceneNode* pParentNode){
+
+    const auto& node = package.Get<ScenePackage::Node>(ScenePackage::Nodes)[nodeIndex];
+    std::unique_ptr<SceneNode> sceneNode(new Dx12SceneNode(nodeIndex, pParentNode));
+    m_nodeSlots[nodeIndex] = sceneNode->GetSlot();
+
+    GeoMath::Transform local;
+    local.translation = GeoMath::Vector3f(node.translation[0], node.translation[1], node.translation[2]);
+    for(size_t i = 0; i < 4; i++){
+        local.rotation[i] = node.rotation[i];
+    }
+    local.scale = GeoMath::Vector3f(node.scale[0], node.scale[1], node.scale[2]);
+    sceneNode->SetTransform(local);
+
+    if(node.hasMatrix){
+        const float* m = node.matrix;
+        sceneNode->SetMatrix(GeoMath::Matrix4f(
+            m[0],  m[1],  m[2],  m[3],
+            m[4],  m[5],  m[6],  m[7],
+            m[8],  m[9],  m[10], m[11],
+            m[12], m[13], m[14], m[15]
+        ));
+    }
+
+    if(node.mesh >= 0){
+        sceneNode->AddComponent(m_meshes[node.mesh]);
+    }
+
+    const auto* children = package.Get<uint32_t>(ScenePackage::Children) + node.firstChild;
+    for(uint32_t i = 0; i < node.childCount; i++){
+        sceneNode->AddChild(BuildNode(package, children[i], sceneNode.get()));
+    }
+
+    return sceneNode;
+}
@@ -4,6 +4,7 @@
 #include "Texture2D.hpp"
 #include "DxUtility.hpp"
 #include "Model.hpp"
+#include "ScenePackage.hpp"
 
 struct AccelerationStructerInfo{
     uint32_t vertexCount = 0;
@@ -13,9 +14,14 @@ struct AccelerationStructerInfo{
 
 struct Dx12Model final : public Model{
 public:
-    Dx12Model(const char* fileName);
+    // textures are block compressed at load when compression is enabled
+    Dx12Model(const char* fileName, const TextureCompression& compression = TextureCompression());
+    // a cooked scene, the sections are uploaded as they are mapped
+    explicit Dx12Model(const ScenePackage& package);
     
     std::unique_ptr<Scene>                    root;
+    // clips of the model, the first one plays on load
+    std::vector<std::shared_ptr<AnimationClip>> animations;
     std::unique_ptr<DefaultBuffer>            matConstBuffer;
 
     ComPtr<ID3D12DescriptorHeap>              cbvHeap;
@@ -35,10 +41,31 @@ private:
     std::vector<UploadBuffer>                 m_indexBuffers;
     std::vector<UploadBuffer>                 m_uploadBuffers;
 
-    std::vector<std::shared_ptr<IComponent>>  m_meshes;
+    std::vector<std::shared_ptr<StaticMesh>>  m_meshes;
     std::vector<std::shared_ptr<Material>>    m_materials;
 
+    // the descriptor heap with the per frame constants in front of the material constants
+    void CreateResourceHeap(uint32_t materialCount, uint32_t numInstancePerFrame);
+    static DXGI_FORMAT GetTextureFormat(Utility::BlockCompressor::Format format);
+    // a mip chain of byteSize bytes placed at levels, appended to textures, its view at textureIndex in the texture descriptors
+    void CreateTexture(
+        const ComPtr<ID3D12GraphicsCommandList4>& cmdList, uint32_t textureIndex, const uint8_t* texels, uint64_t byteSize,
+        const std::vector<Utility::MipGenerator::Level>& levels, DXGI_FORMAT format
+    );
+    // matConsts holds a MaterialConstant every 256 bytes
+    void CreateMaterials(
+        const ComPtr<ID3D12GraphicsCommandList4>& cmdList, const uint8_t* matConsts,
+        const ScenePackage::Material* materials, size_t materialCount
+    );
+    // gathers m_indexBuffers and m_vertexBuffers for ray tracing and builds the acceleration structures
+    void CreateRayTraceResources(
+        const ComPtr<ID3D12GraphicsCommandList4>& cmdList, const RayTraceMeshInfo* rayTraceMeshInfos,
+        const AccelerationStructerInfo* asInfos, uint32_t meshCount,
+        uint32_t totalIndexBufferByteSize, uint32_t totalVertexBufferByteSize
+    );
+
     std::unique_ptr<SceneNode> BuildNode(size_t nodeIndex, SceneNode* pParentNode);
+    std::unique_ptr<SceneNode> BuildNode(const ScenePackage& package, size_t nodeIndex, SceneNode* pParentNode);
 
 };
 
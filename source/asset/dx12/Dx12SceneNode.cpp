@@ -1,56 +1,32 @@
 #include "Dx12SceneNode.hpp"
 
-void Dx12SceneNode::OnUpdate(){
-    SceneNode::OnUpdate();
-    if(m_dirtyCount > 0){
-        
-        auto& currFrameRes = m_graphicsMgr->GetFrameResource();
-        
-        static ObjectConstBuffer objConst;
-        objConst.toWorld = m_toWorld.Transpose();
-        objConst.toLocal = m_toWorld.Inverse().Transpose();
-        objConst.objectIndex = m_nodeIndex;
-
-        currFrameRes.objectConst->CopyData(
-            reinterpret_cast<uint8_t*>(&objConst), sizeof(ObjectConstBuffer), 
-            m_nodeIndex * Utility::CalcAlignment<256>(sizeof(ObjectConstBuffer))
-        );
-
-        for(auto comp : m_components){
-            if(dynamic_cast<StaticMesh*>(comp.get()) != nullptr){
-                for(auto index : dynamic_cast<StaticMesh*>(comp.get())->GetIndices()){
-                    currFrameRes.rayTraceInstanceDesc->CopyData(
-                        reinterpret_cast<uint8_t*>(&m_toWorld.Transpose()), sizeof(GeoMath::Vector4f) * 3,
-                        index * sizeof(D3D12_RAYTRACING_INSTANCE_DESC)
-                    );
-                }
-            }
-        }
-
-        currFrameRes.isAccelerationStructureDitry = true;
-        m_dirtyCount--;
-    }
-
+// the instance data is packed from here every frame the node is drawn
+void Dx12SceneNode::OnTransformChanged(){
+    SceneNode::OnTransformChanged();
+    if(m_scene->GetComponents().meshes.Has(m_slot) == false) return;
+
+    const GeoMath::Matrix4f& toWorld = GetToWorld();
+    m_objConst.toWorld = toWorld.Transpose();
+    m_objConst.toLocal = toWorld.NormalMatrix(GetTransformType());
+    m_objConst.objectIndex = m_nodeIndex;
 }
 
-void Dx12SceneNode::OnRender(){
+void Dx12SceneNode::OnUpload(){
 
     auto& currFrameRes = m_graphicsMgr->GetFrameResource();
-    auto  cmdList      = m_graphicsMgr->GetCommandList();
 
-    if(m_components.size() > 0){
-        cmdList->SetGraphicsRootConstantBufferView(
-            0, currFrameRes.objectConst->GetGpuVirtualAddress(m_nodeIndex)
-        );
-    }
+    const GeoMath::Matrix4f& toWorld = GetToWorld();
 
-    for(auto comp : m_components){
-        if(dynamic_cast<StaticMesh*>(comp.get()) != nullptr) comp->Execute();
-    }
+    m_scene->GetComponents().meshes.ForEachOf(m_slot, [&](const StaticMesh& mesh){
+        for(auto index : mesh.GetIndices()){
+            currFrameRes.rayTraceInstanceDesc->CopyData(
+                reinterpret_cast<uint8_t*>(&toWorld.Transpose()), sizeof(GeoMath::Vector4f) * 3,
+                index * sizeof(D3D12_RAYTRACING_INSTANCE_DESC)
+            );
+        }
+    });
 
-    for(const auto& node : m_childNodes){
-        node->OnRender();
-    }
+    currFrameRes.isAccelerationStructureDitry = true;
 
 }
 
@@ -60,22 +36,39 @@ void Dx12SceneNode::OnTraceRay(){
     }
 }
 
-void Dx12Camera::OnUpdate(){
-    CameraNode::OnUpdate();
-
-    if(m_dirtyCount > 0){
-        auto& framResource = m_graphicsMgr->GetFrameResource();
-        
-        MainConstBuffer& mainConst = m_graphicsMgr->GetMainConstBuffer();
+void Dx12Scene::OnUploadInstances(const InstanceBatcher& batcher){
 
-        mainConst.model = m_toWorld.Transpose();
-        mainConst.preView = mainConst.view;
-        mainConst.view  = m_toWorld.Inverse().Transpose(); 
-        mainConst.proj  = m_proj.Transpose();
-        mainConst.cameraPosition = m_toWorld[3];
-        mainConst.fov  = m_fov;
+    auto& currFrameRes = m_graphicsMgr->GetFrameResource();
+    auto  cmdList      = m_graphicsMgr->GetCommandList();
 
-        m_dirtyCount--;
+    // only Dx12SceneNodes hold meshes
+    const auto& nodes = m_hierarchy.GetNodes();
+    m_instanceData.resize(batcher.GetInstances().size());
+    batcher.Pack(m_instanceData.data(), [&nodes](uint32_t node) -> const ObjectConstBuffer& {
+        return static_cast<const Dx12SceneNode*>(nodes[node])->GetObjectConst();
+    });
+
+    if(!m_instanceData.empty()){
+        assert(m_instanceData.size() * sizeof(ObjectConstBuffer) <= currFrameRes.instanceData->GetByteSize());
+        currFrameRes.instanceData->CopyData(
+            reinterpret_cast<uint8_t*>(m_instanceData.data()), m_instanceData.size() * sizeof(ObjectConstBuffer)
+        );
     }
+    cmdList->SetGraphicsRootShaderResourceView(0, currFrameRes.instanceData->GetGpuVirtualAddress());
+
+}
+
+void Dx12Camera::OnUpload(){
+
+    MainConstBuffer& mainConst = m_graphicsMgr->GetMainConstBuffer();
+
+    const GeoMath::Matrix4f& toWorld = GetToWorld();
+
+    mainConst.model = toWorld.Transpose();
+    mainConst.preView = mainConst.view;
+    mainConst.view  = GetView().Transpose();
+    mainConst.proj  = m_proj.Transpose();
+    mainConst.cameraPosition = toWorld[3];
+    mainConst.fov  = m_fov;
 
 }
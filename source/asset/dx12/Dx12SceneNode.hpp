@@ -13,12 +13,33 @@ public:
         FrameCount = m_graphicsMgr->GetFrameCount();
     }
 
-    virtual void OnUpdate() override;
-    virtual void OnRender() override;
+    virtual void OnTransformChanged() override;
+    virtual void OnUpload() override;
+    // drawn through the instance batches of Dx12Scene
+    virtual void OnRender() override {};
     virtual void OnTraceRay() override;
 
+    // instance data of the node, follows the world matrix
+    const ObjectConstBuffer& GetObjectConst() const { return m_objConst; }
+
 protected:
     Dx12GraphicsManager* const m_graphicsMgr;
+    ObjectConstBuffer          m_objConst;
+};
+
+// Packs the instance data of the batched draws into the frame resource's instance buffer
+class Dx12Scene : public Scene{
+public:
+    Dx12Scene() 
+        : Scene()
+        , m_graphicsMgr(Dx12GraphicsManager::GetInstance())
+    {}
+
+protected:
+    virtual void OnUploadInstances(const InstanceBatcher& batcher) override;
+
+    Dx12GraphicsManager* const     m_graphicsMgr;
+    std::vector<ObjectConstBuffer> m_instanceData;
 };
 
 class Dx12Camera : public CameraNode{
@@ -28,7 +49,7 @@ public:
         , m_graphicsMgr(Dx12GraphicsManager::GetInstance())
     {}
 
-    virtual void OnUpdate()   override;
+    virtual void OnUpload()   override;
     virtual void OnRender()   override {};
     virtual void OnTraceRay() override {};
 
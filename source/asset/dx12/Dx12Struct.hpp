@@ -1,6 +1,7 @@
 #pragma once
 #include "ReflectableStruct.hpp"
 #include "GeoMath.hpp"
+#include "PackedVertex.hpp"
 
 template<>
 struct rtti::Var<GeoMath::Vector2f> : public rtti::VarType<GeoMath::Vector2f>{
@@ -17,6 +18,21 @@ struct rtti::Var<GeoMath::Vector4f> : public rtti::VarType<GeoMath::Vector4f>{
     Var(char const* semantic, uint8_t semanticIndex) : VarType<GeoMath::Vector4f>(rtti::VarTypeData{rtti::VarTypeData::ScaleType::Float, 4, semanticIndex, semantic}){};
 };
 
+template<>
+struct rtti::Var<GeoMath::Half2> : public rtti::VarType<GeoMath::Half2>{
+    Var(char const* semantic, uint8_t semanticIndex) : VarType<GeoMath::Half2>(rtti::VarTypeData{rtti::VarTypeData::ScaleType::Half, 2, semanticIndex, semantic}){};
+};
+
+template<>
+struct rtti::Var<GeoMath::SNorm16x2> : public rtti::VarType<GeoMath::SNorm16x2>{
+    Var(char const* semantic, uint8_t semanticIndex) : VarType<GeoMath::SNorm16x2>(rtti::VarTypeData{rtti::VarTypeData::ScaleType::SNorm16, 2, semanticIndex, semantic}){};
+};
+
+template<>
+struct rtti::Var<GeoMath::SNorm16x4> : public rtti::VarType<GeoMath::SNorm16x4>{
+    Var(char const* semantic, uint8_t semanticIndex) : VarType<GeoMath::SNorm16x4>(rtti::VarTypeData{rtti::VarTypeData::ScaleType::SNorm16, 4, semanticIndex, semantic}){};
+};
+
 struct Dx12SOA : public rtti::SOA{
     std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout;
 protected:
@@ -64,6 +80,40 @@ protected:
                         default:
                             return DXGI_FORMAT_UNKNOWN;
                     }
+                // there are no three component 16 bit formats
+                case rtti::VarTypeData::ScaleType::Half:
+                    switch(typeData.dimension){
+                        case 1:
+                            return DXGI_FORMAT_R16_FLOAT;
+                        case 2:
+                            return DXGI_FORMAT_R16G16_FLOAT;
+                        case 4:
+                            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+                        default:
+                            return DXGI_FORMAT_UNKNOWN;
+                    }
+                case rtti::VarTypeData::ScaleType::SNorm16:
+                    switch(typeData.dimension){
+                        case 1:
+                            return DXGI_FORMAT_R16_SNORM;
+                        case 2:
+                            return DXGI_FORMAT_R16G16_SNORM;
+                        case 4:
+                            return DXGI_FORMAT_R16G16B16A16_SNORM;
+                        default:
+                            return DXGI_FORMAT_UNKNOWN;
+                    }
+                case rtti::VarTypeData::ScaleType::UNorm16:
+                    switch(typeData.dimension){
+                        case 1:
+                            return DXGI_FORMAT_R16_UNORM;
+                        case 2:
+                            return DXGI_FORMAT_R16G16_UNORM;
+                        case 4:
+                            return DXGI_FORMAT_R16G16B16A16_UNORM;
+                        default:
+                            return DXGI_FORMAT_UNKNOWN;
+                    }
 
                 default:
                     return DXGI_FORMAT_UNKNOWN;
@@ -87,22 +137,24 @@ protected:
 
 };
 
+// Positions are snorm16 inside the mesh bounds (MeshConstants), normals octahedral snorm16,
+// tangents snorm16 and uvs half. See PackedVertex.hpp for the encoders.
 struct Vertex0 : public Dx12SOA{
     Vertex0(){
         GetInputLayout();
     }
-    const rtti::Var<GeoMath::Vector3f> position = {"POSITION", 0};
-    const rtti::Var<GeoMath::Vector3f> normal   = {"NORMAL",   0};
+    const rtti::Var<GeoMath::SNorm16x4> position = {"POSITION", 0};
+    const rtti::Var<GeoMath::SNorm16x2> normal   = {"NORMAL",   0};
 };
 
 struct Vertex1 : public Dx12SOA{
     Vertex1(){
         GetInputLayout();
     }
-    const rtti::Var<GeoMath::Vector3f> position = {"POSITION", 0};
-    const rtti::Var<GeoMath::Vector3f> normal   = {"NORMAL",   0};
-    const rtti::Var<GeoMath::Vector4f> tangent  = {"TANGENT",  0};
-    const rtti::Var<GeoMath::Vector2f> texCoord = {"TEXCOORD", 0};
+    const rtti::Var<GeoMath::SNorm16x4> position = {"POSITION", 0};
+    const rtti::Var<GeoMath::SNorm16x2> normal   = {"NORMAL",   0};
+    const rtti::Var<GeoMath::SNorm16x4> tangent  = {"TANGENT",  0};
+    const rtti::Var<GeoMath::Half2>     texCoord = {"TEXCOORD", 0};
 };
 
 struct MainConstBuffer{
@@ -131,6 +183,13 @@ struct ObjectConstBuffer{
 };
 static_assert(sizeof(ObjectConstBuffer) == 144);
 
+// root constants of each draw, dequantize positions as q * extent + center
+struct MeshConstants{
+    GeoMath::Vector4f positionCenter;
+    GeoMath::Vector4f positionExtent;
+};
+static_assert(sizeof(MeshConstants) == 32);
+
 struct RayTraceMeshInfo{
     uint32_t indexOffsetBytes    = 0;
     uint32_t positionOffsetBytes = 0;
@@ -138,8 +197,10 @@ struct RayTraceMeshInfo{
     uint32_t tangentOffsetBytes  = 0;
     uint32_t uvOffsetBytes       = 0;
     uint32_t matIndex            = 0;
+    GeoMath::Vector3f positionCenter{0.0f, 0.0f, 0.0f};
+    GeoMath::Vector3f positionExtent{1.0f, 1.0f, 1.0f};
 };
-static_assert(sizeof(RayTraceMeshInfo) == 24);
+static_assert(sizeof(RayTraceMeshInfo) == 48);
 
 inline Vertex0 vertex0;
 inline Vertex1 vertex1;
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "Animation.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    void RandomRotation(float* q, std::default_random_engine& e){
+        std::normal_distribution<float> n(0.0f, 1.0f);
+        float x = n(e), y = n(e), z = n(e), w = n(e);
+        float length = std::sqrt(x * x + y * y + z * z + w * w);
+        q[0] = x / length;
+        q[1] = y / length;
+        q[2] = z / length;
+        q[3] = w / length;
+    }
+
+    // textbook slerp in double along the shorter arc
+    void ReferenceSlerp(const float* a, const float* b, float t, double* out){
+        double cosine = 0.0;
+        for(int i = 0; i < 4; i++) cosine += double(a[i]) * b[i];
+        double sign = cosine < 0.0 ? -1.0 : 1.0;
+        cosine *= sign;
+
+        double wa = 1.0 - t, wb = t;
+        if(cosine < 0.9999){
+            double angle = std::acos(cosine);
+            wa = std::sin((1.0 - t) * angle) / std::sin(angle);
+            wb = std::sin(t * angle) / std::sin(angle);
+        }
+        double length = 0.0;
+        for(int i = 0; i < 4; i++){
+            out[i] = wa * a[i] + sign * wb * b[i];
+            length += out[i] * out[i];
+        }
+        for(int i = 0; i < 4; i++) out[i] /= std::sqrt(length);
+    }
+
+    // largest error of cubic spline translation and weight channels against t^3, which Hermite keys with
+    // the derivative as tangents reproduce exactly, sampled between and outside the keys
+    double CubicSplineError(){
+        const float times[3] = {0.0f, 0.5f, 1.0f};
+        std::vector<float> translations, weights;
+        for(float t : times){
+            const float value = t * t * t, tangent = 3.0f * t * t;
+            for(float v : {tangent, value, tangent}){
+                translations.insert(translations.end(), {v, -v, 2.0f * v});
+                weights.insert(weights.end(), {v, -0.5f * v});
+            }
+        }
+
+        auto clip = std::make_shared<AnimationClip>();
+        clip->AddChannel(0, AnimationClip::Path::Translation, AnimationClip::Interpolation::CubicSpline, times, translations.data(), 3);
+        clip->AddWeightChannel(0, AnimationClip::Interpolation::CubicSpline, times, weights.data(), 3, 2);
+
+        Animator animator;
+        animator.Play(clip, [](uint32_t){ return GeoMath::Transform(); }, false);
+
+        double error = 0.0;
+        float  time  = 0.0f;
+        for(float next : {0.1f, 0.3f, 0.5f, 0.77f, 1.0f, 1.2f}){
+            animator.Update(next - time);
+            time = next > 1.0f ? 1.0f : next;
+            const double expected = double(time) * time * time;
+            const GeoMath::Vector3f& t = animator.GetPoses()[0].translation;
+            const std::vector<float>& w = animator.GetMorphWeights(0);
+            for(double e : {t.x - expected, t.y + expected, t.z - 2.0 * expected, w[0] - expected, w[1] + 0.5 * expected}){
+                error = std::abs(e) > error ? std::abs(e) : error;
+            }
+        }
+        return error;
+    }
+
+}
+
+// usage: AnimationBenchmark [animated nodes] [keys per channel] [joints per skin]
+int main(int argc, char** argv){
+
+    const uint32_t count  = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 10000;
+    const uint32_t keys   = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 30;
+    const uint32_t joints = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 64;
+    const int      repeat = 10;
+    const float    step   = 1.0f / 60.0f;
+
+    std::default_random_engine e(7);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+    // chains of joints, one skin per chain
+    SceneHierarchy hierarchy;
+    std::vector<Skin> skins;
+    for(uint32_t first = 0; first < count; first += joints){
+        std::vector<uint32_t> chain;
+        uint32_t parent = SceneHierarchy::NoParent;
+        for(uint32_t j = first; j < count && j < first + joints; j++){
+            parent = hierarchy.Add(parent, nullptr);
+            chain.emplace_back(parent);
+        }
+        skins.emplace_back(chain.front(), chain, std::vector<GeoMath::Matrix4f>(chain.size()));
+    }
+
+    // one clip driving translation, rotation and scale of every node, 1 second long
+    auto clip = std::make_shared<AnimationClip>();
+    std::vector<float> times(keys), translations(keys * 3), rotations(keys * 4), scales(keys * 3);
+    for(uint32_t k = 0; k < keys; k++) times[k] = keys > 1 ? float(k) / float(keys - 1) : 0.0f;
+    for(uint32_t node = 0; node < count; node++){
+        for(auto& v : translations) v = u(e);
+        for(auto& v : scales)       v = 1.0f + 0.2f * u(e);
+        for(uint32_t k = 0; k < keys; k++) RandomRotation(rotations.data() + k * 4, e);
+
+        clip->AddChannel(node, AnimationClip::Path::Translation, AnimationClip::Interpolation::Linear, times.data(), translations.data(), keys);
+        clip->AddChannel(node, AnimationClip::Path::Rotation,    AnimationClip::Interpolation::Linear, times.data(), rotations.data(), keys);
+        clip->AddChannel(node, AnimationClip::Path::Scale,       AnimationClip::Interpolation::Linear, times.data(), scales.data(), keys);
+    }
+
+    // the batched slerp against the textbook one over every key pair of the clip
+    {
+        const float* values[4] = {clip->GetValues(0), clip->GetValues(1), clip->GetValues(2), clip->GetValues(3)};
+        double maxAngle = 0.0;
+        const auto& channels = clip->GetChannels();
+        for(uint32_t c = clip->GetPathBegin(AnimationClip::Path::Rotation); c < clip->GetPathEnd(AnimationClip::Path::Rotation); c++){
+            for(uint32_t k = 0; k + 1 < channels[c].keyCount; k++){
+                uint32_t key = channels[c].firstKey + k;
+                float a[4], b[4], t[4] = {0.1f, 0.37f, 0.5f, 0.83f}, out[4][4];
+                float ax[4], ay[4], az[4], aw[4], bx[4], by[4], bz[4], bw[4];
+                for(int i = 0; i < 4; i++){
+                    a[i] = values[i][key];
+                    b[i] = values[i][key + 1];
+                }
+                for(int i = 0; i < 4; i++){
+                    ax[i] = a[0]; ay[i] = a[1]; az[i] = a[2]; aw[i] = a[3];
+                    bx[i] = b[0]; by[i] = b[1]; bz[i] = b[2]; bw[i] = b[3];
+                }
+                GeoMath::SlerpQuaternions(
+                    GeoMath::ConstQuaternionStream(ax, ay, az, aw), GeoMath::ConstQuaternionStream(bx, by, bz, bw),
+                    t, GeoMath::QuaternionStream{out[0], out[1], out[2], out[3]}, 4
+                );
+                for(int i = 0; i < 4; i++){
+                    double ref[4], dot = 0.0;
+                    ReferenceSlerp(a, b, t[i], ref);
+                    for(int j = 0; j < 4; j++) dot += ref[j] * out[j][i];
+                    dot = std::abs(dot) > 1.0 ? 1.0 : std::abs(dot);
+                    double angle = 2.0 * std::acos(dot);
+                    maxAngle = angle > maxAngle ? angle : maxAngle;
+                }
+            }
+        }
+        printf("slerp max error %g radians\n", maxAngle);
+    }
+
+    const double cubicError = CubicSplineError();
+    printf("cubic spline max error %g %s\n", cubicError, cubicError < 1e-5 ? "" : "FAILED");
+
+    printf("%u animated nodes, %u keys per channel, %zu skins of %u joints\n", count, keys, skins.size(), joints);
+
+    const Utility::SimdLevel cpuLevel = Utility::GetCpuSimdLevel();
+    for(int level = 0; level <= static_cast<int>(cpuLevel); level++){
+        GeoMath::SetBatchLevel(static_cast<Utility::SimdLevel>(level));
+        const char* levelName = Utility::GetSimdLevelName(GeoMath::GetBatchLevel());
+
+        Animator animator;
+        animator.Play(clip, [](uint32_t){ return GeoMath::Transform(); });
+
+        // a frame advances the cursors by a key at most, a seek jumps back to the start
+        double frameMs = Measure([&](){ animator.Update(step); }, repeat * 10);
+        double seekMs  = Measure([&](){ animator.Update(0.97f); animator.Update(-0.97f); }, repeat) * 0.5;
+
+        double applyMs = Measure([&](){
+            animator.Update(step);
+            const auto& targets = animator.GetTargets();
+            const auto& poses   = animator.GetPoses();
+            for(auto pose : animator.GetChanged()){
+                hierarchy.SetLocal(targets[pose], poses[pose].ToMatrix(), poses[pose].Classify());
+            }
+            hierarchy.Update();
+        }, repeat);
+
+        double paletteMs = Measure([&](){
+            for(auto& skin : skins) skin.UpdatePalette(hierarchy);
+        }, repeat);
+
+        printf("%-8s sample %8.3f ms (%6.1f ns per channel), after seek %8.3f ms, to world %8.3f ms, palettes %8.3f ms\n",
+            levelName, frameMs, frameMs * 1e6 / clip->GetChannels().size(), seekMs, applyMs, paletteMs);
+    }
+
+    return cubicError < 1e-5 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace Benchmark{
+
+    // best of repeat runs in milliseconds, the slower ones are taken for noise of the system
+    template<typename Func>
+    double Measure(Func&& func, int repeat){
+        double best = 1e30;
+        for(int i = 0; i < repeat; i++){
+            auto start = std::chrono::steady_clock::now();
+            func();
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            best = ms < best ? ms : best;
+        }
+        return best;
+    }
+
+    // one line of time and throughput, count items of unit processed in ms
+    inline void Report(const char* name, size_t count, double ms, const char* unit = "vec"){
+        printf("%-36s %10.3f ms %10.1f M%s/s\n", name, ms, count / (ms * 1000.0), unit);
+    }
+
+}
@@ -0,0 +1,142 @@
+#include "BlockCompressor.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace{
+
+    using Clock = std::chrono::steady_clock;
+    using Utility::BlockCompressor;
+    using Utility::MipGenerator;
+
+    struct TestImage{
+        const char*            name;
+        BlockCompressor::Usage usage;
+        std::vector<uint8_t>   texels;
+    };
+
+    // albedo like gradients under noise, a cutout, a normal map of a bumpy height field and occlusion
+    std::vector<TestImage> MakeImages(uint32_t size){
+        std::vector<TestImage> images = {
+            {"albedo",    BlockCompressor::Usage::Color,         {}},
+            {"cutout",    BlockCompressor::Usage::Color,         {}},
+            {"normal",    BlockCompressor::Usage::Normal,        {}},
+            {"occlusion", BlockCompressor::Usage::SingleChannel, {}},
+        };
+        for(auto& image : images) image.texels.resize(size_t(size) * size * 4);
+
+        uint32_t state = 1;
+        for(uint32_t y = 0; y < size; y++){
+            for(uint32_t x = 0; x < size; x++){
+                state = state * 1664525u + 1013904223u;
+                const int    noise  = static_cast<int>(state >> 28) - 8;
+                const size_t i      = (size_t(y) * size + x) * 4;
+                const float  height = std::sin(x * 0.05f) * std::cos(y * 0.07f);
+
+                uint8_t* albedo = images[0].texels.data() + i;
+                albedo[0] = static_cast<uint8_t>(120.0f + 100.0f * std::sin(x * 0.013f) + noise);
+                albedo[1] = static_cast<uint8_t>(100.0f + 80.0f * std::cos(y * 0.021f) + noise);
+                albedo[2] = static_cast<uint8_t>(60.0f + 50.0f * std::sin((x + y) * 0.007f) + noise);
+                albedo[3] = 255;
+
+                uint8_t* cutout = images[1].texels.data() + i;
+                cutout[0] = albedo[1];
+                cutout[1] = albedo[0];
+                cutout[2] = albedo[2];
+                cutout[3] = std::fabs(std::sin(x * 0.19f + std::sin(y * 0.013f) * 3.0f)) > 0.85f ? 255 : 0;
+
+                const float nx = -0.05f * 12.0f * std::cos(x * 0.05f) * std::cos(y * 0.07f);
+                const float ny =  0.07f * 12.0f * std::sin(x * 0.05f) * std::sin(y * 0.07f);
+                const float nz = 1.0f / std::sqrt(1.0f + nx * nx + ny * ny);
+                uint8_t* normal = images[2].texels.data() + i;
+                normal[0] = static_cast<uint8_t>(127.5f + 127.5f * nx * nz);
+                normal[1] = static_cast<uint8_t>(127.5f + 127.5f * ny * nz);
+                normal[2] = static_cast<uint8_t>(127.5f + 127.5f * nz);
+                normal[3] = 255;
+
+                uint8_t* occlusion = images[3].texels.data() + i;
+                occlusion[0] = occlusion[1] = occlusion[2] = static_cast<uint8_t>(180.0f + 70.0f * height);
+                occlusion[3] = 255;
+            }
+        }
+        return images;
+    }
+
+    // channels a format keeps, the ones PSNR is measured over
+    int GetChannelCount(BlockCompressor::Format format){
+        switch(format){
+            case BlockCompressor::Format::BC4: return 1;
+            case BlockCompressor::Format::BC5: return 2;
+            case BlockCompressor::Format::BC1: return 3;
+            default:                           return 4;
+        }
+    }
+
+    // of the top level against the source, -1 when a block does not decode
+    double GetPsnr(const TestImage& image, uint32_t size, BlockCompressor::Format format, const MipGenerator::MipChain& chain){
+        const auto& level    = chain.levels[0];
+        const int   channels = GetChannelCount(format);
+        const uint32_t blockSize = BlockCompressor::GetBlockSize(format);
+
+        double  error = 0.0;
+        uint8_t decoded[64];
+        for(uint32_t by = 0; by < size / 4; by++){
+            for(uint32_t bx = 0; bx < size / 4; bx++){
+                if(!BlockCompressor::DecodeBlock(format, chain.data.data() + level.offset + size_t(by) * level.rowPitch + bx * blockSize, decoded)) return -1.0;
+                for(uint32_t i = 0; i < 16; i++){
+                    const uint8_t* source = image.texels.data() + ((size_t(by) * 4 + i / 4) * size + bx * 4 + i % 4) * 4;
+                    for(int c = 0; c < channels; c++){
+                        const double d = double(decoded[i * 4 + c]) - source[c];
+                        error += d * d;
+                    }
+                }
+            }
+        }
+        const double mse = error / (double(size) * size * channels);
+        return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+    }
+
+}
+
+// usage: BlockCompressionBenchmark, 1024x1024 test images through every preset on one thread and on all of them
+int main(){
+    const uint32_t size       = 1024;
+    const auto     images     = MakeImages(size);
+    const uint32_t maxThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    const char*    formatNames[]  = {"RGBA8", "BC1", "BC3", "BC4", "BC5", "BC7"};
+    const char*    qualityNames[] = {"fast", "normal", "high"};
+
+    Utility::WorkerPool pool(maxThreads);
+    bool isValid = true;
+    for(const auto& image : images){
+        MipGenerator::Settings settings;
+        settings.isSrgb = image.usage == BlockCompressor::Usage::Color;
+        const auto chain = MipGenerator::Generate(image.texels.data(), size, size, size * 4, settings);
+        double pixels = 0.0;
+        for(const auto& level : chain.levels) pixels += double(level.width) * level.height;
+
+        for(int q = 0; q < 3; q++){
+            const auto quality = static_cast<BlockCompressor::Quality>(q);
+            const auto format  = BlockCompressor::SelectFormat(image.usage, quality, BlockCompressor::IsOpaque(image.texels.data(), size, size, size * 4));
+
+            Clock::time_point begin = Clock::now();
+            const auto serial = BlockCompressor::Compress(chain, format, quality);
+            const double serialTime = std::chrono::duration<double>(Clock::now() - begin).count();
+
+            begin = Clock::now();
+            const auto parallel = BlockCompressor::Compress(chain, format, quality, &pool);
+            const double parallelTime = std::chrono::duration<double>(Clock::now() - begin).count();
+
+            const double psnr = GetPsnr(image, size, format, parallel);
+            isValid = isValid && psnr > 30.0 && serial.data == parallel.data;
+            printf("%-10s %-6s %-4s %8.2f ms, %2u threads %8.2f ms, %6.1f Mpixel/s, %5.2f:1, PSNR %6.2f dB\n",
+                image.name, qualityNames[q], formatNames[static_cast<int>(format)], serialTime * 1e3, maxThreads, parallelTime * 1e3,
+                pixels / parallelTime * 1e-6, double(chain.data.size()) / parallel.data.size(), psnr);
+        }
+    }
+
+    return isValid ? 0 : 1;
+}
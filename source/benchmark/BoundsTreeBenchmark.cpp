@@ -0,0 +1,197 @@
+#include "BoundsTree.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    bool Overlaps(const GeoMath::BoundingBox& a, const GeoMath::BoundingBox& b){
+        for(int i = 0; i < 3; i++){
+            if(std::abs(a.center.data[i] - b.center.data[i]) > a.extent.data[i] + b.extent.data[i]) return false;
+        }
+        return true;
+    }
+
+    bool Overlaps(const GeoMath::BoundingBox& box, const GeoMath::Vector3f& center, float radius){
+        float distance = 0.0f;
+        for(int i = 0; i < 3; i++){
+            float d = std::abs(center.data[i] - box.center.data[i]) - box.extent.data[i];
+            distance += d > 0.0f ? d * d : 0.0f;
+        }
+        return distance <= radius * radius;
+    }
+
+    bool Overlaps(const GeoMath::BoundingBox& box, const GeoMath::Frustum& frustum){
+        for(const auto& plane : frustum.planes){
+            float radius = std::abs(plane.x) * box.extent.x + std::abs(plane.y) * box.extent.y + std::abs(plane.z) * box.extent.z;
+            if(plane.x * box.center.x + plane.y * box.center.y + plane.z * box.center.z + plane.w + radius < 0.0f) return false;
+        }
+        return true;
+    }
+
+    float Enter(const GeoMath::BoundingBox& box, const BoundsTree::Ray& ray){
+        float tMin = 0.0f, tMax = ray.maxDistance;
+        for(int i = 0; i < 3; i++){
+            float inv = 1.0f / ray.direction.data[i];
+            float t0  = (box.center.data[i] - box.extent.data[i] - ray.origin.data[i]) * inv;
+            float t1  = (box.center.data[i] + box.extent.data[i] - ray.origin.data[i]) * inv;
+            if(t1 < t0) std::swap(t0, t1);
+            tMin = t0 > tMin ? t0 : tMin;
+            tMax = t1 < tMax ? t1 : tMax;
+        }
+        return tMin <= tMax ? tMin : -1.0f;
+    }
+
+    // same keys in any order
+    bool SameKeys(std::vector<uint32_t> a, std::vector<uint32_t> b){
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    }
+
+}
+
+// usage: BoundsTreeBenchmark [leaf count] [query count]
+int main(int argc, char** argv){
+
+    const uint32_t count   = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000;
+    const uint32_t queries = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 1000;
+    const int      repeat  = 5;
+
+    std::default_random_engine e(7);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    auto randomBox = [&](){
+        return GeoMath::BoundingBox(
+            GeoMath::Vector3f(position(e), position(e), position(e)),
+            GeoMath::Vector3f(size(e), size(e), size(e))
+        );
+    };
+
+    std::vector<GeoMath::BoundingBox> boxes(count);
+    for(auto& box : boxes) box = randomBox();
+
+    BoundsTree tree;
+    double insert = Measure([&](){
+        tree = BoundsTree();
+        for(uint32_t key = 0; key < count; key++) tree.Insert(key, boxes[key]);
+    }, 1);
+    float insertCost = tree.GetCost();
+    double rebuild = Measure([&](){ tree.Rebuild(); }, repeat);
+    printf("%u leaves\n", count);
+    printf("%-14s %10.3f ms, cost %.1f\n", "insert", insert, insertCost);
+    printf("%-14s %10.3f ms, cost %.1f\n", "rebuild", rebuild, tree.GetCost());
+
+    // a few leaves moved per frame, the refit has to cost what moved and not the leaf count
+    std::uniform_int_distribution<uint32_t> pick(0, count - 1);
+    for(uint32_t moved : {1u, 100u, 10000u}){
+        double ms = Measure([&](){
+            for(uint32_t i = 0; i < moved; i++){
+                uint32_t key = pick(e);
+                GeoMath::BoundingBox& box = boxes[key];
+                box.center = box.center + GeoMath::Vector3f(unit(e), unit(e), unit(e));
+                tree.Update(key, box);
+            }
+            tree.Refit();
+        }, repeat);
+        printf("%5u moved     %10.3f ms, cost %.1f\n", moved, ms, tree.GetCost());
+    }
+
+    // every query against the brute force answer
+    std::vector<GeoMath::BoundingBox> queryBoxes(queries);
+    std::vector<GeoMath::Vector3f>    centers(queries);
+    std::vector<float>                radii(queries);
+    std::vector<BoundsTree::Ray>      rays(queries);
+    for(uint32_t i = 0; i < queries; i++){
+        queryBoxes[i] = GeoMath::BoundingBox(
+            GeoMath::Vector3f(position(e), position(e), position(e)),
+            GeoMath::Vector3f(50.0f, 50.0f, 50.0f)
+        );
+        centers[i] = GeoMath::Vector3f(position(e), position(e), position(e));
+        radii[i]   = 50.0f;
+        rays[i].origin      = GeoMath::Vector3f(position(e), position(e), position(e));
+        rays[i].direction   = GeoMath::Vector3f(unit(e), unit(e), unit(e)).Normalized();
+        rays[i].maxDistance = 3000.0f;
+    }
+
+    const uint32_t frustumCount = 16;
+    std::vector<GeoMath::Frustum> frustums(frustumCount);
+    for(auto& frustum : frustums){
+        GeoMath::Vector3f eye(position(e), position(e), position(e));
+        GeoMath::Matrix4f view = GeoMath::Matrix4f::Rotation(unit(e), 3.0f * unit(e), 0.0f)
+                               * GeoMath::Matrix4f::Translation(eye.x, eye.y, eye.z);
+        frustum = GeoMath::Frustum::FromMatrix(
+            view.Inverse(GeoMath::TransformType::Rigid) * GeoMath::Matrix4f::Perspective(0.3f * 3.1415926f, 1.8f, 0.1f, 500.0f)
+        );
+    }
+
+    size_t mismatch = 0;
+    std::vector<uint32_t> keys, expected;
+    for(uint32_t i = 0; i < queries; i++){
+        keys.clear();
+        expected.clear();
+        tree.QueryBox(queryBoxes[i], keys);
+        for(uint32_t key = 0; key < count; key++){
+            if(Overlaps(boxes[key], queryBoxes[i])) expected.emplace_back(key);
+        }
+        mismatch += SameKeys(keys, expected) ? 0 : 1;
+
+        keys.clear();
+        expected.clear();
+        tree.QuerySphere(centers[i], radii[i], keys);
+        for(uint32_t key = 0; key < count; key++){
+            if(Overlaps(boxes[key], centers[i], radii[i])) expected.emplace_back(key);
+        }
+        mismatch += SameKeys(keys, expected) ? 0 : 1;
+
+        float nearest = rays[i].maxDistance;
+        for(uint32_t key = 0; key < count; key++){
+            float t = Enter(boxes[key], rays[i]);
+            if(t >= 0.0f && t < nearest) nearest = t;
+        }
+        BoundsTree::RayHit hit = tree.RayCast(rays[i]);
+        mismatch += (hit.key == BoundsTree::NoKey ? rays[i].maxDistance : hit.distance) == nearest ? 0 : 1;
+    }
+    for(const auto& frustum : frustums){
+        keys.clear();
+        expected.clear();
+        tree.QueryFrustum(frustum, keys);
+        for(uint32_t key = 0; key < count; key++){
+            if(Overlaps(boxes[key], frustum)) expected.emplace_back(key);
+        }
+        mismatch += SameKeys(keys, expected) ? 0 : 1;
+    }
+    printf("%zu of %u queries differ from brute force\n", mismatch, queries * 3 + frustumCount);
+
+    std::vector<std::vector<uint32_t>> results(queries);
+    std::vector<BoundsTree::RayHit>    hits(queries);
+    Utility::WorkerPool& pool = Utility::WorkerPool::GetInstance();
+
+    double boxMs = Measure([&](){ tree.QueryBoxes(queryBoxes.data(), queries, results.data()); }, repeat);
+    double sphereMs = Measure([&](){ tree.QuerySpheres(centers.data(), radii.data(), queries, results.data()); }, repeat);
+    double rayMs = Measure([&](){ tree.RayCasts(rays.data(), queries, hits.data()); }, repeat);
+    double rayPoolMs = Measure([&](){ tree.RayCasts(rays.data(), queries, hits.data(), &pool); }, repeat);
+    double frustumMs = Measure([&](){ tree.QueryFrustums(frustums.data(), frustumCount, results.data()); }, repeat);
+    double bruteMs = Measure([&](){
+        for(uint32_t key = 0; key < count; key++){
+            if(Overlaps(boxes[key], frustums[0])) expected.emplace_back(key);
+        }
+        expected.clear();
+    }, repeat);
+
+    printf("%-14s %10.4f ms per query\n", "box", boxMs / queries);
+    printf("%-14s %10.4f ms per query\n", "sphere", sphereMs / queries);
+    printf("%-14s %10.4f ms per query\n", "ray", rayMs / queries);
+    printf("%-14s %10.4f ms per query, %u threads\n", "ray pooled", rayPoolMs / queries, pool.GetThreadCount());
+    printf("%-14s %10.4f ms per query, brute force %.4f ms\n", "frustum", frustumMs / frustumCount, bruteMs);
+
+    return mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include "FrameScheduler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace{
+
+    using Clock = Utility::FrameScheduler::Clock;
+
+    // seconds the process spent on a cpu
+    double ProcessCpuTime(){
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+        auto ToSeconds = [](const FILETIME& t){
+            return double((uint64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+        };
+        return ToSeconds(kernel) + ToSeconds(user);
+#else
+        return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+    }
+
+    // stands in for update and render, keeps the cpu busy for the given time
+    void Work(double seconds){
+        const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        volatile uint32_t sink = 0;
+        while(Clock::now() < end) sink = sink + 1;
+    }
+
+    struct Result{
+        double cpuShare;
+        double meanInterval;
+        double meanError;
+        double maxError;
+    };
+
+    template<typename Loop>
+    Result Run(Loop&& loop, uint32_t frameCount, double frameTime){
+        std::vector<Clock::time_point> starts;
+        starts.reserve(frameCount);
+
+        const double cpuBegin = ProcessCpuTime();
+        const Clock::time_point begin = Clock::now();
+        loop(starts);
+        const double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+        const double cpu  = ProcessCpuTime() - cpuBegin;
+
+        // deviation of the frame intervals from the target
+        Result result{cpu / wall, 0.0, 0.0, 0.0};
+        for(size_t i = 1; i < starts.size(); i++){
+            double interval = std::chrono::duration<double>(starts[i] - starts[i - 1]).count();
+            double error    = std::abs(interval - frameTime);
+            result.meanInterval += interval;
+            result.meanError    += error;
+            result.maxError      = error > result.maxError ? error : result.maxError;
+        }
+        result.meanInterval /= double(starts.size() - 1);
+        result.meanError    /= double(starts.size() - 1);
+        return result;
+    }
+
+    void Print(const char* name, const Result& result){
+        printf("%-12s cpu %5.1f%% of a core, interval %7.3f ms, error mean %6.3f ms max %6.3f ms\n", name,
+            result.cpuShare * 100.0, result.meanInterval * 1e3, result.meanError * 1e3, result.maxError * 1e3);
+    }
+
+}
+
+// usage: FrameSchedulerBenchmark [frames per second] [work per frame in ms] [frames]
+int main(int argc, char** argv){
+
+    const double   frameRate  = argc > 1 ? atof(argv[1]) : 60.0;
+    const double   work       = argc > 2 ? atof(argv[2]) * 1e-3 : 4e-3;
+    const uint32_t frameCount = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 300;
+    const double   frameTime  = 1.0 / frameRate;
+
+    printf("%u frames at %.1f Hz, %.2f ms of work per frame\n", frameCount, frameRate, work * 1e3);
+
+    // the loop the scheduler replaces, polls the clock until the frame is due
+    Result poll = Run([&](std::vector<Clock::time_point>& starts){
+        const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frameTime));
+        Clock::time_point last = Clock::now() - interval;
+        while(starts.size() < frameCount){
+            Clock::time_point now = Clock::now();
+            if(now - last > interval){
+                last = now;
+                starts.emplace_back(now);
+                Work(work);
+            }
+        }
+    }, frameCount, frameTime);
+    Print("busy poll", poll);
+
+    Utility::FrameScheduler::Settings settings;
+    settings.frameTime = frameTime;
+    Utility::FrameScheduler scheduler(settings);
+    Result paced = Run([&](std::vector<Clock::time_point>& starts){
+        while(starts.size() < frameCount){
+            if(!scheduler.IsFrameDue()){
+                scheduler.WaitForFrame();
+                continue;
+            }
+            scheduler.BeginFrame();
+            starts.emplace_back(Clock::now());
+            Work(work);
+            scheduler.EndFrame();
+        }
+    }, frameCount, frameTime);
+    Print("scheduler", paced);
+
+    const auto& average = scheduler.GetAverage();
+    printf("scheduler    cpu %.3f ms, slack %.3f ms, sleep %.3f ms, yield %.3f ms, %.2f steps per frame\n",
+        average.cpuTime * 1e3, average.slack * 1e3, average.sleepTime * 1e3, average.yieldTime * 1e3, average.steps);
+
+    // the scheduler has to keep the pace of the poll loop on a fraction of its cpu time
+    return paced.cpuShare < poll.cpuShare && std::abs(paced.meanInterval - frameTime) < frameTime * 0.05 ? 0 : 1;
+}
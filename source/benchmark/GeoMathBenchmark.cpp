@@ -0,0 +1,183 @@
+#include "GeoMathBatch.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+    using Benchmark::Report;
+
+    float MaxError(const float* a, const float* b, size_t count){
+        float error = 0.0f;
+        for(size_t i = 0; i < count; i++){
+            float diff = std::abs(a[i] - b[i]);
+            error = diff > error ? diff : error;
+        }
+        return error;
+    }
+
+}
+
+int main(int argc, char** argv){
+
+    const size_t count  = argc > 1 ? static_cast<size_t>(atoll(argv[1])) : 1 << 20;
+    const int    repeat = 10;
+
+    std::default_random_engine e(7);
+    std::uniform_real_distribution<float> u(-100.0f, 100.0f);
+
+    GeoMath::Matrix4f m =
+        GeoMath::Matrix4f::Scale(1.5f, 0.5f, 2.0f) *
+        GeoMath::Matrix4f::Rotation(0.3f, 1.1f, -0.7f) *
+        GeoMath::Matrix4f::Translation(3.0f, -2.0f, 8.0f);
+
+    std::vector<GeoMath::Vector3f> points(count);
+    std::vector<GeoMath::Vector4f> vectors(count);
+    std::vector<float> x(count), y(count), z(count);
+    for(size_t i = 0; i < count; i++){
+        points[i]  = GeoMath::Vector3f(u(e), u(e), u(e));
+        vectors[i] = GeoMath::Vector4f(points[i], 1.0f);
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+        z[i] = points[i].z;
+    }
+
+    // boxes spread in front of a camera at the origin, about half of them inside the frustum
+    GeoMath::Frustum frustum = GeoMath::Frustum::FromMatrix(
+        GeoMath::Matrix4f::Perspective(0.3f * 3.1415926f, 1.8f, 0.1f, 200.0f)
+    );
+    std::uniform_real_distribution<float> extent(0.1f, 4.0f);
+    std::vector<float> box[6];
+    for(auto& stream : box) stream.resize(count);
+    for(size_t i = 0; i < count; i++){
+        box[0][i] = u(e);
+        box[1][i] = u(e);
+        box[2][i] = u(e) + 100.0f;
+        box[3][i] = extent(e);
+        box[4][i] = extent(e);
+        box[5][i] = extent(e);
+    }
+    GeoMath::ConstBoxStream boxes{box[0].data(), box[1].data(), box[2].data(), box[3].data(), box[4].data(), box[5].data()};
+    std::vector<uint32_t> refVisible((count + 31) / 32), outVisible((count + 31) / 32);
+
+    // unit normals and uv-like values for the packed attribute converters
+    std::normal_distribution<float> gauss;
+    std::uniform_real_distribution<float> uv(-4.0f, 4.0f);
+    std::vector<float> normals(count * 3), texCoords(count * 2);
+    for(size_t i = 0; i < count; i++){
+        float nx = gauss(e), ny = gauss(e), nz = gauss(e);
+        float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        normals[i * 3]     = nx / length;
+        normals[i * 3 + 1] = ny / length;
+        normals[i * 3 + 2] = nz / length;
+        texCoords[i * 2]     = uv(e);
+        texCoords[i * 2 + 1] = uv(e);
+    }
+    std::vector<uint16_t> refHalf(count * 2), outHalf(count * 2);
+    std::vector<int16_t>  refOct(count * 2), outOct(count * 2);
+    std::vector<float>    refDecoded(count * 3), outDecoded(count * 3);
+
+    std::vector<GeoMath::Vector3f> refPoints(count), outPoints(count);
+    std::vector<GeoMath::Vector4f> refVectors(count), outVectors(count);
+    std::vector<float> rx(count), ry(count), rz(count);
+    std::vector<float> ox(count), oy(count), oz(count);
+
+    const Utility::SimdLevel cpuLevel = Utility::GetCpuSimdLevel();
+    printf("transform %zu vectors, cpu level %s\n", count, Utility::GetSimdLevelName(cpuLevel));
+
+    Report("Vector4f * Matrix4f", count, Measure([&](){
+        for(size_t i = 0; i < count; i++){
+            outVectors[i] = vectors[i] * m;
+        }
+    }, repeat));
+
+    // scalar kernels are the reference every SIMD level is checked against
+    GeoMath::SetBatchLevel(Utility::SimdLevel::Scalar);
+    GeoMath::TransformHomogeneous(vectors.data(), refVectors.data(), count, m);
+    GeoMath::TransformPoints(points.data(), refPoints.data(), count, m);
+    GeoMath::TransformPoints(
+        GeoMath::ConstVector3fStream(x.data(), y.data(), z.data()),
+        GeoMath::Vector3fStream{rx.data(), ry.data(), rz.data()}, count, m
+    );
+    GeoMath::CullBoxes(frustum, boxes, count, refVisible.data());
+    GeoMath::ConvertFloatToHalf(texCoords.data(), refHalf.data(), count * 2);
+    GeoMath::EncodeOctahedral(normals.data(), refOct.data(), count);
+    GeoMath::DecodeOctahedral(refOct.data(), refDecoded.data(), count);
+
+    for(int level = 0; level <= static_cast<int>(cpuLevel); level++){
+        GeoMath::SetBatchLevel(static_cast<Utility::SimdLevel>(level));
+        const char* levelName = Utility::GetSimdLevelName(GeoMath::GetBatchLevel());
+        char name[64];
+
+        snprintf(name, sizeof(name), "TransformHomogeneous %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::TransformHomogeneous(vectors.data(), outVectors.data(), count, m);
+        }, repeat));
+
+        snprintf(name, sizeof(name), "TransformPoints AoS %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::TransformPoints(points.data(), outPoints.data(), count, m);
+        }, repeat));
+
+        snprintf(name, sizeof(name), "TransformPoints SoA %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::TransformPoints(
+                GeoMath::ConstVector3fStream(x.data(), y.data(), z.data()),
+                GeoMath::Vector3fStream{ox.data(), oy.data(), oz.data()}, count, m
+            );
+        }, repeat));
+
+        snprintf(name, sizeof(name), "CullBoxes %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::CullBoxes(frustum, boxes, count, outVisible.data());
+        }, repeat));
+
+        snprintf(name, sizeof(name), "ConvertFloatToHalf %s", levelName);
+        Report(name, count * 2, Measure([&](){
+            GeoMath::ConvertFloatToHalf(texCoords.data(), outHalf.data(), count * 2);
+        }, repeat));
+
+        snprintf(name, sizeof(name), "EncodeOctahedral %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::EncodeOctahedral(normals.data(), outOct.data(), count);
+        }, repeat));
+
+        snprintf(name, sizeof(name), "DecodeOctahedral %s", levelName);
+        Report(name, count, Measure([&](){
+            GeoMath::DecodeOctahedral(refOct.data(), outDecoded.data(), count);
+        }, repeat));
+
+        size_t packMismatch = 0;
+        for(size_t i = 0; i < count * 2; i++){
+            packMismatch += refHalf[i] != outHalf[i] ? 1 : 0;
+            packMismatch += refOct[i] != outOct[i] ? 1 : 0;
+        }
+        float decodeError = MaxError(refDecoded.data(), outDecoded.data(), count * 3);
+
+        size_t visible = 0, cullMismatch = 0;
+        for(size_t i = 0; i < count; i++){
+            uint32_t ref = (refVisible[i >> 5] >> (i & 31)) & 1u;
+            uint32_t out = (outVisible[i >> 5] >> (i & 31)) & 1u;
+            visible      += out;
+            cullMismatch += ref != out ? 1 : 0;
+        }
+
+        float vecError = MaxError(refVectors[0].data, outVectors[0].data, count * 4);
+        float aosError = MaxError(refPoints[0].data, outPoints[0].data, count * 3);
+        float soaError = MaxError(rx.data(), ox.data(), count);
+        soaError = std::max(soaError, MaxError(ry.data(), oy.data(), count));
+        soaError = std::max(soaError, MaxError(rz.data(), oz.data(), count));
+
+        printf("%s max error vs scalar: Homogeneous %g, AoS %g, SoA %g\n", levelName, vecError, aosError, soaError);
+        printf("%s culling: %zu visible, %zu differ from scalar\n", levelName, visible, cullMismatch);
+        printf("%s packing: %zu encoded values differ from scalar, octahedral decode error %g\n\n", levelName, packMismatch, decodeError);
+    }
+
+    return 0;
+}
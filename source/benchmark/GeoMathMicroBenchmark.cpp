@@ -0,0 +1,549 @@
+#include "GeoMath.hpp"
+#include "CpuFeature.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// DirectXMath ships with the Windows SDK, the baseline is only built where it is found
+#if defined(_WIN32) && defined(__has_include)
+#if __has_include(<DirectXMath.h>)
+#include <DirectXMath.h>
+#define GEOMATH_BENCHMARK_DIRECTXMATH 1
+#endif
+#endif
+
+// Every GeoMath vector and matrix operation in two modes:
+//   latency    - each call takes the previous result, ns per call on the dependency chain
+//   throughput - independent calls over a small array, ns per call with the pipeline full
+// next to a plain float reference (and DirectXMath when available). Results go out as JSON,
+// to stdout or the file given as first argument.
+namespace{
+
+    // plain C++ reference, same layout and formulas as GeoMath
+    namespace Ref{
+
+        struct Vec3{
+            float x, y, z;
+        };
+
+        struct Vec4{
+            float v[4];
+        };
+
+        struct Mat4{
+            float m[4][4];
+        };
+
+        inline Vec3 Add(const Vec3& a, const Vec3& b){ return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+        inline Vec3 Mul(const Vec3& a, const Vec3& b){ return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+        inline float Dot(const Vec3& a, const Vec3& b){ return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+        inline Vec3 Cross(const Vec3& a, const Vec3& b){
+            return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+        }
+
+        inline Vec3 Normalized(const Vec3& a){
+            float inv = 1.0f / std::sqrt(Dot(a, a));
+            return {a.x * inv, a.y * inv, a.z * inv};
+        }
+
+        inline Vec4 Add(const Vec4& a, const Vec4& b){
+            Vec4 r;
+            for(int i = 0; i < 4; i++) r.v[i] = a.v[i] + b.v[i];
+            return r;
+        }
+
+        inline Vec4 Mul(const Vec4& a, const Vec4& b){
+            Vec4 r;
+            for(int i = 0; i < 4; i++) r.v[i] = a.v[i] * b.v[i];
+            return r;
+        }
+
+        inline Vec4 Normalized(const Vec4& a){
+            float inv = 1.0f / std::sqrt(a.v[0] * a.v[0] + a.v[1] * a.v[1] + a.v[2] * a.v[2] + a.v[3] * a.v[3]);
+            Vec4 r;
+            for(int i = 0; i < 4; i++) r.v[i] = a.v[i] * inv;
+            return r;
+        }
+
+        inline Vec4 Cross(const Vec4& a, const Vec4& b){
+            return {{
+                a.v[1] * b.v[2] - a.v[2] * b.v[1],
+                a.v[2] * b.v[0] - a.v[0] * b.v[2],
+                a.v[0] * b.v[1] - a.v[1] * b.v[0],
+                0.0f
+            }};
+        }
+
+        inline Vec4 Transform(const Vec4& a, const Mat4& m){
+            Vec4 r;
+            for(int j = 0; j < 4; j++){
+                r.v[j] = a.v[0] * m.m[0][j] + a.v[1] * m.m[1][j] + a.v[2] * m.m[2][j] + a.v[3] * m.m[3][j];
+            }
+            return r;
+        }
+
+        inline Mat4 Mul(const Mat4& a, const Mat4& b){
+            Mat4 r;
+            for(int i = 0; i < 4; i++){
+                for(int j = 0; j < 4; j++){
+                    r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+                }
+            }
+            return r;
+        }
+
+        inline Mat4 Transpose(const Mat4& a){
+            Mat4 r;
+            for(int i = 0; i < 4; i++){
+                for(int j = 0; j < 4; j++) r.m[i][j] = a.m[j][i];
+            }
+            return r;
+        }
+
+        // cofactors through the 2x2 sub determinants of the upper and lower row pairs
+        inline Mat4 Inverse(const Mat4& a){
+            const float (*m)[4] = a.m;
+            float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+            float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+            float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+            float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+            float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+            float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+            float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+            float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+            float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+            float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+            float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+            float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+            float inv = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+            Mat4 r;
+            r.m[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv;
+            r.m[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv;
+            r.m[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv;
+            r.m[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv;
+
+            r.m[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv;
+            r.m[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv;
+            r.m[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv;
+            r.m[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv;
+
+            r.m[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv;
+            r.m[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv;
+            r.m[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv;
+            r.m[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv;
+
+            r.m[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv;
+            r.m[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv;
+            r.m[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv;
+            r.m[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv;
+            return r;
+        }
+
+        inline Mat4 Rotation(float x, float y, float z){
+            float s1 = std::sin(x), c1 = std::cos(x);
+            float s2 = std::sin(y), c2 = std::cos(y);
+            float s3 = std::sin(z), c3 = std::cos(z);
+            return {{
+                {c2 * c3,                 -c2 * s3,                 s2,       0.0f},
+                {c1 * s3 + s1 * s2 * c3,  c1 * c3 - s1 * s2 * s3,   -s1 * c2, 0.0f},
+                {s1 * s3 - c1 * s2 * c3,  s1 * c3 + c1 * s2 * s3,   c1 * c2,  0.0f},
+                {0.0f,                    0.0f,                     0.0f,     1.0f}
+            }};
+        }
+
+        inline Mat4 Rotation(float x, float y, float z, float w){
+            float x2 = 2.0f * x * x, y2 = 2.0f * y * y, z2 = 2.0f * z * z;
+            float xy = 2.0f * x * y, yz = 2.0f * y * z, xz = 2.0f * x * z;
+            float xw = 2.0f * x * w, yw = 2.0f * y * w, zw = 2.0f * z * w;
+            return {{
+                {1.0f - y2 - z2, xy - zw,        xz + yw,        0.0f},
+                {xy + zw,        1.0f - x2 - z2, yz - xw,        0.0f},
+                {xz - yw,        yz + xw,        1.0f - x2 - y2, 0.0f},
+                {0.0f,           0.0f,           0.0f,           1.0f}
+            }};
+        }
+
+        inline Mat4 Perspective(float fovY, float aspect, float nearZ, float farZ){
+            float height    = 1.0f / std::tan(0.5f * fovY);
+            float width     = height / aspect;
+            float viewRange = farZ / (farZ - nearZ);
+            return {{
+                {width, 0.0f,   0.0f,               0.0f},
+                {0.0f,  height, 0.0f,               0.0f},
+                {0.0f,  0.0f,   viewRange,          1.0f},
+                {0.0f,  0.0f,   -viewRange * nearZ, 0.0f}
+            }};
+        }
+
+    }
+
+    template<typename To, typename From>
+    To BitCast(const From& from){
+        static_assert(sizeof(To) == sizeof(From));
+        To to;
+        memcpy(static_cast<void*>(&to), &from, sizeof(To));
+        return to;
+    }
+
+    // forces results to memory between repetitions so no pass over the array can be dropped
+    inline void ClobberMemory(){
+    #if defined(_MSC_VER)
+        _ReadWriteBarrier();
+    #else
+        asm volatile("" ::: "memory");
+    #endif
+    }
+
+    template<typename T>
+    inline void Consume(const T& value){
+        static volatile unsigned char sink;
+        sink = reinterpret_cast<const unsigned char*>(&value)[0];
+        (void)sink;
+    }
+
+    // hides the value from the optimizer, for chains it could otherwise cancel out
+    template<typename T>
+    inline T Opaque(T value){
+    #if defined(_MSC_VER)
+        _ReadWriteBarrier();
+    #else
+        asm volatile("" : "+m"(value));
+    #endif
+        return value;
+    }
+
+    struct Result{
+        std::string op;
+        std::string impl;
+        std::string mode;
+        double      nsPerOp;
+    };
+
+    struct Check{
+        std::string op;
+        float       maxError;
+    };
+
+    class Suite{
+    public:
+        Suite(size_t iterations, int repeat)
+            : m_iterations(iterations), m_repeat(repeat){}
+
+        // step maps a State to the next one, bounded so long chains stay out of denormals
+        template<typename State, typename Step>
+        void Run(const char* op, const char* impl, const std::vector<State>& inputs, std::vector<State>& outputs, Step step){
+            using Clock = std::chrono::steady_clock;
+
+            double best = 1e30;
+            State state = inputs[0];
+            for(int r = 0; r < m_repeat; r++){
+                auto start = Clock::now();
+                for(size_t i = 0; i < m_iterations; i++){
+                    state = step(state);
+                }
+                std::chrono::duration<double, std::nano> time = Clock::now() - start;
+                best = time.count() < best ? time.count() : best;
+            }
+            Consume(state);
+            m_results.push_back({op, impl, "latency", best / m_iterations});
+
+            outputs.resize(inputs.size());
+            const size_t passes = (m_iterations + inputs.size() - 1) / inputs.size();
+            best = 1e30;
+            for(int r = 0; r < m_repeat; r++){
+                auto start = Clock::now();
+                for(size_t p = 0; p < passes; p++){
+                    for(size_t i = 0; i < inputs.size(); i++){
+                        outputs[i] = step(inputs[i]);
+                    }
+                    ClobberMemory();
+                }
+                std::chrono::duration<double, std::nano> time = Clock::now() - start;
+                best = time.count() < best ? time.count() : best;
+            }
+            Consume(outputs[0]);
+            m_results.push_back({op, impl, "throughput", best / (passes * inputs.size())});
+        }
+
+        // largest component difference of the GeoMath throughput outputs against the reference
+        template<typename A, typename B>
+        void Compare(const char* op, const std::vector<A>& geoMath, const std::vector<B>& reference){
+            static_assert(sizeof(A) == sizeof(B));
+            const size_t count = geoMath.size() * sizeof(A) / sizeof(float);
+            const float* a = reinterpret_cast<const float*>(geoMath.data());
+            const float* b = reinterpret_cast<const float*>(reference.data());
+
+            float error = 0.0f;
+            for(size_t i = 0; i < count; i++){
+                float diff = std::abs(a[i] - b[i]);
+                error = diff > error ? diff : error;
+            }
+            m_checks.push_back({op, error});
+        }
+
+        void WriteJson(FILE* file) const{
+            fprintf(file, "{\n");
+            fprintf(file, "  \"suite\": \"GeoMath\",\n");
+            fprintf(file, "  \"version\": 1,\n");
+            fprintf(file, "  \"compiler\": \"%s\",\n", CompilerName().c_str());
+            fprintf(file, "  \"cpu_simd_level\": \"%s\",\n", Utility::GetSimdLevelName(Utility::GetCpuSimdLevel()));
+            fprintf(file, "  \"iterations\": %zu,\n", m_iterations);
+            fprintf(file, "  \"repeat\": %d,\n", m_repeat);
+
+            fprintf(file, "  \"results\": [\n");
+            for(size_t i = 0; i < m_results.size(); i++){
+                const Result& r = m_results[i];
+                fprintf(file, "    {\"op\": \"%s\", \"impl\": \"%s\", \"mode\": \"%s\", \"ns_per_op\": %.4f}%s\n",
+                    r.op.c_str(), r.impl.c_str(), r.mode.c_str(), r.nsPerOp, i + 1 < m_results.size() ? "," : "");
+            }
+            fprintf(file, "  ],\n");
+
+            fprintf(file, "  \"checks\": [\n");
+            for(size_t i = 0; i < m_checks.size(); i++){
+                const Check& c = m_checks[i];
+                fprintf(file, "    {\"op\": \"%s\", \"max_abs_error\": %g}%s\n",
+                    c.op.c_str(), c.maxError, i + 1 < m_checks.size() ? "," : "");
+            }
+            fprintf(file, "  ]\n");
+            fprintf(file, "}\n");
+        }
+
+    private:
+        static std::string CompilerName(){
+            char name[64];
+        #if defined(_MSC_VER) && !defined(__clang__)
+            snprintf(name, sizeof(name), "msvc %d", _MSC_FULL_VER);
+        #elif defined(__clang__)
+            snprintf(name, sizeof(name), "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+        #elif defined(__GNUC__)
+            snprintf(name, sizeof(name), "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+        #else
+            snprintf(name, sizeof(name), "unknown");
+        #endif
+            return name;
+        }
+
+        size_t m_iterations;
+        int    m_repeat;
+        std::vector<Result> m_results;
+        std::vector<Check>  m_checks;
+    };
+
+}
+
+int main(int argc, char** argv){
+
+    const size_t inputCount = 1024;
+    const size_t iterations = 1 << 22;
+    const int    repeat     = 5;
+
+    // inputs come from a runtime seed so no chain can be folded at compile time
+    std::default_random_engine e(static_cast<unsigned>(argc) * 7u);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+
+    using GeoMath::Vector3f;
+    using GeoMath::Vector4f;
+    using GeoMath::Matrix4f;
+
+    std::vector<Vector3f> vec3(inputCount);
+    std::vector<Vector4f> vec4(inputCount);
+    std::vector<Matrix4f> mat4(inputCount);
+    for(size_t i = 0; i < inputCount; i++){
+        vec3[i] = Vector3f(u(e), u(e), u(e));
+        vec4[i] = Vector4f(u(e), u(e), u(e), u(e));
+        mat4[i] =
+            Matrix4f::Scale(1.5f + u(e), 1.5f + u(e), 1.5f + u(e)) *
+            Matrix4f::Rotation(angle(e), angle(e), angle(e)) *
+            Matrix4f::Translation(u(e) * 10.0f, u(e) * 10.0f, u(e) * 10.0f);
+    }
+
+    // second operands: k3 flips signs so products stay bounded, avg3 averages for dot chains,
+    // axis3 is a unit axis for cross chains, rot is orthonormal
+    const Vector3f k3(1.0f, -1.0f, 1.0f);
+    const Vector3f avg3(1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f);
+    const Vector3f axis3 = Vector3f(u(e), u(e), 1.0f).Normalized();
+    const Vector4f k4(1.0f, -1.0f, 1.0f, -1.0f);
+    const Vector4f axis4(axis3, 0.0f);
+    const Matrix4f rot = Matrix4f::Rotation(angle(e), angle(e), angle(e));
+
+    std::vector<Ref::Vec3> refVec3(inputCount);
+    std::vector<Ref::Vec4> refVec4(inputCount);
+    std::vector<Ref::Mat4> refMat4(inputCount);
+    for(size_t i = 0; i < inputCount; i++){
+        refVec3[i] = BitCast<Ref::Vec3>(vec3[i]);
+        refVec4[i] = BitCast<Ref::Vec4>(vec4[i]);
+        refMat4[i] = BitCast<Ref::Mat4>(mat4[i]);
+    }
+    const Ref::Vec3 refK3    = BitCast<Ref::Vec3>(k3);
+    const Ref::Vec3 refAvg3  = BitCast<Ref::Vec3>(avg3);
+    const Ref::Vec3 refAxis3 = BitCast<Ref::Vec3>(axis3);
+    const Ref::Vec4 refK4    = BitCast<Ref::Vec4>(k4);
+    const Ref::Vec4 refAxis4 = BitCast<Ref::Vec4>(axis4);
+    const Ref::Mat4 refRot   = BitCast<Ref::Mat4>(rot);
+
+    Suite suite(iterations, repeat);
+    std::vector<Vector3f>  outVec3;
+    std::vector<Vector4f>  outVec4;
+    std::vector<Matrix4f>  outMat4;
+    std::vector<Ref::Vec3> outRefVec3;
+    std::vector<Ref::Vec4> outRefVec4;
+    std::vector<Ref::Mat4> outRefMat4;
+
+    // Vector3f
+    suite.Run("Vector3f::operator+", "GeoMath", vec3, outVec3, [&](const Vector3f& v){ return Vector3f(v + k3); });
+    suite.Run("Vector3f::operator+", "Scalar", refVec3, outRefVec3, [&](const Ref::Vec3& v){ return Ref::Add(v, refK3); });
+    suite.Compare("Vector3f::operator+", outVec3, outRefVec3);
+
+    suite.Run("Vector3f::operator*", "GeoMath", vec3, outVec3, [&](const Vector3f& v){ return Vector3f(v * k3); });
+    suite.Run("Vector3f::operator*", "Scalar", refVec3, outRefVec3, [&](const Ref::Vec3& v){ return Ref::Mul(v, refK3); });
+    suite.Compare("Vector3f::operator*", outVec3, outRefVec3);
+
+    suite.Run("Vector3f::Dot", "GeoMath", vec3, outVec3, [&](const Vector3f& v){ return Vector3f(v.y, v.z, v.Dot(avg3)); });
+    suite.Run("Vector3f::Dot", "Scalar", refVec3, outRefVec3, [&](const Ref::Vec3& v){ return Ref::Vec3{v.y, v.z, Ref::Dot(v, refAvg3)}; });
+    suite.Compare("Vector3f::Dot", outVec3, outRefVec3);
+
+    suite.Run("Vector3f::Cross", "GeoMath", vec3, outVec3, [&](const Vector3f& v){ return Vector3f(v.Cross(axis3)); });
+    suite.Run("Vector3f::Cross", "Scalar", refVec3, outRefVec3, [&](const Ref::Vec3& v){ return Ref::Cross(v, refAxis3); });
+    suite.Compare("Vector3f::Cross", outVec3, outRefVec3);
+
+    suite.Run("Vector3f::Normalized", "GeoMath", vec3, outVec3, [&](const Vector3f& v){ return Vector3f(v.Normalized()); });
+    suite.Run("Vector3f::Normalized", "Scalar", refVec3, outRefVec3, [&](const Ref::Vec3& v){ return Ref::Normalized(v); });
+    suite.Compare("Vector3f::Normalized", outVec3, outRefVec3);
+
+    // Vector4f
+    suite.Run("Vector4f::operator+", "GeoMath", vec4, outVec4, [&](const Vector4f& v){ return v + k4; });
+    suite.Run("Vector4f::operator+", "Scalar", refVec4, outRefVec4, [&](const Ref::Vec4& v){ return Ref::Add(v, refK4); });
+    suite.Compare("Vector4f::operator+", outVec4, outRefVec4);
+
+    suite.Run("Vector4f::operator*", "GeoMath", vec4, outVec4, [&](const Vector4f& v){ return v * k4; });
+    suite.Run("Vector4f::operator*", "Scalar", refVec4, outRefVec4, [&](const Ref::Vec4& v){ return Ref::Mul(v, refK4); });
+    suite.Compare("Vector4f::operator*", outVec4, outRefVec4);
+
+    suite.Run("Vector4f::Cross", "GeoMath", vec4, outVec4, [&](const Vector4f& v){ return v.Cross(axis4); });
+    suite.Run("Vector4f::Cross", "Scalar", refVec4, outRefVec4, [&](const Ref::Vec4& v){ return Ref::Cross(v, refAxis4); });
+    suite.Compare("Vector4f::Cross", outVec4, outRefVec4);
+
+    suite.Run("Vector4f::Normalized", "GeoMath", vec4, outVec4, [&](const Vector4f& v){ return v.Normalized(); });
+    suite.Run("Vector4f::Normalized", "Scalar", refVec4, outRefVec4, [&](const Ref::Vec4& v){ return Ref::Normalized(v); });
+    suite.Compare("Vector4f::Normalized", outVec4, outRefVec4);
+
+    suite.Run("Vector4f*Matrix4f", "GeoMath", vec4, outVec4, [&](const Vector4f& v){ return v * rot; });
+    suite.Run("Vector4f*Matrix4f", "Scalar", refVec4, outRefVec4, [&](const Ref::Vec4& v){ return Ref::Transform(v, refRot); });
+    suite.Compare("Vector4f*Matrix4f", outVec4, outRefVec4);
+
+    // Matrix4f
+    suite.Run("Matrix4f::operator*", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){ return m * rot; });
+    suite.Run("Matrix4f::operator*", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){ return Ref::Mul(m, refRot); });
+    suite.Compare("Matrix4f::operator*", outMat4, outRefMat4);
+
+    suite.Run("Matrix4f::Inverse", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){ return m.Inverse(); });
+    suite.Run("Matrix4f::Inverse", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){ return Ref::Inverse(m); });
+    suite.Compare("Matrix4f::Inverse", outMat4, outRefMat4);
+
+    // two transposes cancel, the chain goes through memory so they are not folded into register swaps
+    suite.Run("Matrix4f::Transpose", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){ return Opaque(m).Transpose(); });
+    suite.Run("Matrix4f::Transpose", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){ return Ref::Transpose(Opaque(m)); });
+    suite.Compare("Matrix4f::Transpose", outMat4, outRefMat4);
+
+    // the next angles come from entries of the previous rotation, all within [-1, 1]
+    suite.Run("Matrix4f::Rotation(euler)", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){
+        return Matrix4f::Rotation(m.data[0][1], m.data[1][2], m.data[2][0]);
+    });
+    suite.Run("Matrix4f::Rotation(euler)", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){
+        return Ref::Rotation(m.m[0][1], m.m[1][2], m.m[2][0]);
+    });
+    suite.Compare("Matrix4f::Rotation(euler)", outMat4, outRefMat4);
+
+    suite.Run("Matrix4f::Rotation(quaternion)", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){
+        return Matrix4f::Rotation(m.data[0][1] * 0.25f, m.data[1][2] * 0.25f, m.data[2][0] * 0.25f, 0.9f);
+    });
+    suite.Run("Matrix4f::Rotation(quaternion)", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){
+        return Ref::Rotation(m.m[0][1] * 0.25f, m.m[1][2] * 0.25f, m.m[2][0] * 0.25f, 0.9f);
+    });
+    suite.Compare("Matrix4f::Rotation(quaternion)", outMat4, outRefMat4);
+
+    suite.Run("Matrix4f::Perspective", "GeoMath", mat4, outMat4, [&](const Matrix4f& m){
+        return Matrix4f::Perspective(0.8f + 0.1f * std::abs(m.data[0][0]) / (1.0f + std::abs(m.data[0][0])), 1.8f, 0.1f, 100.0f);
+    });
+    suite.Run("Matrix4f::Perspective", "Scalar", refMat4, outRefMat4, [&](const Ref::Mat4& m){
+        return Ref::Perspective(0.8f + 0.1f * std::abs(m.m[0][0]) / (1.0f + std::abs(m.m[0][0])), 1.8f, 0.1f, 100.0f);
+    });
+    suite.Compare("Matrix4f::Perspective", outMat4, outRefMat4);
+
+#if defined(GEOMATH_BENCHMARK_DIRECTXMATH)
+    {
+        using namespace DirectX;
+
+        std::vector<XMVECTOR> dxVec3(inputCount), dxVec4(inputCount), outDxVec;
+        std::vector<XMMATRIX> dxMat4(inputCount), outDxMat;
+        for(size_t i = 0; i < inputCount; i++){
+            dxVec3[i] = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vec3[i].data));
+            dxVec4[i] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(vec4[i].data));
+            dxMat4[i] = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(mat4[i].data));
+        }
+        const XMVECTOR dxK3    = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(k3.data));
+        const XMVECTOR dxAvg3  = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(avg3.data));
+        const XMVECTOR dxAxis3 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(axis3.data));
+        const XMVECTOR dxK4    = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(k4.data));
+        const XMMATRIX dxRot   = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(rot.data));
+
+        suite.Run("Vector3f::operator+", "DirectXMath", dxVec3, outDxVec, [&](FXMVECTOR v){ return XMVectorAdd(v, dxK3); });
+        suite.Run("Vector3f::operator*", "DirectXMath", dxVec3, outDxVec, [&](FXMVECTOR v){ return XMVectorMultiply(v, dxK3); });
+        suite.Run("Vector3f::Dot", "DirectXMath", dxVec3, outDxVec, [&](FXMVECTOR v){
+            return XMVectorPermute<XM_PERMUTE_0Y, XM_PERMUTE_0Z, XM_PERMUTE_1X, XM_PERMUTE_1W>(v, XMVector3Dot(v, dxAvg3));
+        });
+        suite.Run("Vector3f::Cross", "DirectXMath", dxVec3, outDxVec, [&](FXMVECTOR v){ return XMVector3Cross(v, dxAxis3); });
+        suite.Run("Vector3f::Normalized", "DirectXMath", dxVec3, outDxVec, [&](FXMVECTOR v){ return XMVector3Normalize(v); });
+
+        suite.Run("Vector4f::operator+", "DirectXMath", dxVec4, outDxVec, [&](FXMVECTOR v){ return XMVectorAdd(v, dxK4); });
+        suite.Run("Vector4f::operator*", "DirectXMath", dxVec4, outDxVec, [&](FXMVECTOR v){ return XMVectorMultiply(v, dxK4); });
+        suite.Run("Vector4f::Cross", "DirectXMath", dxVec4, outDxVec, [&](FXMVECTOR v){ return XMVector3Cross(v, dxAxis3); });
+        suite.Run("Vector4f::Normalized", "DirectXMath", dxVec4, outDxVec, [&](FXMVECTOR v){ return XMVector4Normalize(v); });
+        suite.Run("Vector4f*Matrix4f", "DirectXMath", dxVec4, outDxVec, [&](FXMVECTOR v){ return XMVector4Transform(v, dxRot); });
+
+        suite.Run("Matrix4f::operator*", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){ return XMMatrixMultiply(m, dxRot); });
+        suite.Run("Matrix4f::Inverse", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){ return XMMatrixInverse(nullptr, m); });
+        suite.Run("Matrix4f::Transpose", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){ return XMMatrixTranspose(Opaque(m)); });
+        suite.Run("Matrix4f::Rotation(euler)", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){
+            return XMMatrixRotationRollPitchYaw(XMVectorGetY(m.r[0]), XMVectorGetZ(m.r[1]), XMVectorGetX(m.r[2]));
+        });
+        suite.Run("Matrix4f::Rotation(quaternion)", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){
+            return XMMatrixRotationQuaternion(XMVectorSet(
+                XMVectorGetY(m.r[0]) * 0.25f, XMVectorGetZ(m.r[1]) * 0.25f, XMVectorGetX(m.r[2]) * 0.25f, 0.9f
+            ));
+        });
+        suite.Run("Matrix4f::Perspective", "DirectXMath", dxMat4, outDxMat, [&](FXMMATRIX m){
+            float m00 = std::abs(XMVectorGetX(m.r[0]));
+            return XMMatrixPerspectiveFovLH(0.8f + 0.1f * m00 / (1.0f + m00), 1.8f, 0.1f, 100.0f);
+        });
+    }
+#endif
+
+    FILE* file = stdout;
+    if(argc > 1){
+        file = fopen(argv[1], "w");
+        if(file == nullptr){
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    suite.WriteJson(file);
+    if(file != stdout) fclose(file);
+
+    return 0;
+}
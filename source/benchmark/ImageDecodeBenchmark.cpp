@@ -0,0 +1,106 @@
+#include "ImageDecoder.hpp"
+#include "stb_image_write.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace{
+
+    using Clock = std::chrono::steady_clock;
+
+    using Encoded = std::vector<uint8_t>;
+
+    void AppendBytes(void* context, void* data, int size){
+        auto* encoded = static_cast<Encoded*>(context);
+        encoded->insert(encoded->end(), static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
+    }
+
+    // smooth gradients under noise, compresses about as well as photographed albedo
+    Encoded MakeImage(uint32_t size, uint32_t seed, bool isJpg){
+        std::vector<uint8_t> texels(size_t(size) * size * 4);
+        uint32_t state = seed * 2654435761u + 1;
+        for(uint32_t y = 0; y < size; y++){
+            for(uint32_t x = 0; x < size; x++){
+                state = state * 1664525u + 1013904223u;
+                uint8_t noise = static_cast<uint8_t>(state >> 28);
+                uint8_t* t = texels.data() + (size_t(y) * size + x) * 4;
+                t[0] = static_cast<uint8_t>(127.5f + 127.5f * std::sin((x + seed) * 0.02f)) ^ noise;
+                t[1] = static_cast<uint8_t>(127.5f + 127.5f * std::cos((y + seed) * 0.03f)) ^ noise;
+                t[2] = static_cast<uint8_t>((x ^ y) + seed);
+                t[3] = 255;
+            }
+        }
+
+        Encoded encoded;
+        if(isJpg) stbi_write_jpg_to_func(AppendBytes, &encoded, size, size, 4, texels.data(), 90);
+        else      stbi_write_png_to_func(AppendBytes, &encoded, size, size, 4, texels.data(), size * 4);
+        return encoded;
+    }
+
+    Encoded ReadFile(const char* fileName){
+        Encoded encoded;
+        FILE* file = fopen(fileName, "rb");
+        if(file == nullptr) return encoded;
+
+        fseek(file, 0, SEEK_END);
+        encoded.resize(static_cast<size_t>(ftell(file)));
+        fseek(file, 0, SEEK_SET);
+        encoded.resize(fread(encoded.data(), 1, encoded.size(), file));
+        fclose(file);
+        return encoded;
+    }
+
+}
+
+// usage: ImageDecodeBenchmark [image files...], without files 64 generated 1024x1024 images, half PNG and half JPG
+int main(int argc, char** argv){
+
+    std::vector<Encoded> images;
+    for(int i = 1; i < argc; i++){
+        images.emplace_back(ReadFile(argv[i]));
+    }
+    if(images.empty()){
+        for(uint32_t i = 0; i < 64; i++){
+            images.emplace_back(MakeImage(1024, i, i % 2 == 1));
+        }
+    }
+
+    size_t encodedBytes = 0;
+    for(const auto& image : images) encodedBytes += image.size();
+    printf("%zu images, %.1f MB encoded\n", images.size(), double(encodedBytes) / (1 << 20));
+
+    const uint32_t maxThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    double serialTime = 0.0;
+    bool   isDecoded  = true;
+    for(uint32_t threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads){
+        Utility::WorkerPool pool(threads);
+        ImageDecoder decoder(&pool);
+        for(size_t i = 0; i < images.size(); i++){
+            decoder.Add(i, images[i].data(), images[i].size());
+        }
+
+        // first image handed on and the last one, the upload of a loader would start at the first
+        double   firstTime = 0.0;
+        size_t   decoded   = 0;
+        uint64_t pixels    = 0;
+        const Clock::time_point begin = Clock::now();
+        decoder.Decode([&](size_t, ImageDecoder::Image& image){
+            if(decoded++ == 0) firstTime = std::chrono::duration<double>(Clock::now() - begin).count();
+            pixels += uint64_t(image.width) * image.height;
+        });
+        const double time = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        serialTime = threads == 1 ? time : serialTime;
+        isDecoded  = isDecoded && pixels > 0 && decoded == images.size();
+        printf("%2u threads: %8.2f ms, first image %7.2f ms, %7.1f images/s, %7.1f Mpixel/s, speedup %5.2f\n",
+            threads, time * 1e3, firstTime * 1e3, decoded / time, pixels / time * 1e-6, serialTime / time);
+
+        if(threads == maxThreads) break;
+    }
+
+    return isDecoded ? 0 : 1;
+}
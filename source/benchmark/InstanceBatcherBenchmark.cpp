@@ -0,0 +1,138 @@
+#include "InstanceBatcher.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    // the batcher only compares the pointers, distinct addresses stand in for meshes and materials
+    std::vector<char> meshStorage(1 << 16), materialStorage(1 << 16);
+
+    Mesh*     MakeMesh(uint32_t index)     { return reinterpret_cast<Mesh*>(meshStorage.data() + index); }
+    Material* MakeMaterial(uint32_t index) { return reinterpret_cast<Material*>(materialStorage.data() + index); }
+
+    struct Node{
+        uint64_t  key;
+        Material* material;
+        Mesh*     mesh;
+    };
+
+    // draws and instances of a group by (state, material, mesh), instances in key order then in the order they were added
+    void GroupBy(const std::vector<Node>& nodes, std::vector<InstanceBatcher::Draw>& draws, std::vector<uint32_t>& instances){
+        std::map<std::tuple<uint64_t, Material*, Mesh*>, std::vector<uint32_t>> groups;
+        for(uint32_t node = 0; node < nodes.size(); node++){
+            groups[std::make_tuple(RenderQueue::GetStateKey(nodes[node].key), nodes[node].material, nodes[node].mesh)].push_back(node);
+        }
+
+        draws.clear();
+        instances.clear();
+        for(auto& group : groups){
+            auto& members = group.second;
+            std::stable_sort(members.begin(), members.end(), [&](uint32_t a, uint32_t b){ return nodes[a].key < nodes[b].key; });
+
+            const Node& first = nodes[members[0]];
+            draws.push_back({first.key, first.material, first.mesh, static_cast<uint32_t>(instances.size()), static_cast<uint32_t>(members.size())});
+            instances.insert(instances.end(), members.begin(), members.end());
+        }
+    }
+
+    bool IsSameDraw(const InstanceBatcher::Draw& a, const InstanceBatcher::Draw& b){
+        return a.key == b.key && a.material == b.material && a.mesh == b.mesh
+            && a.firstInstance == b.firstInstance && a.instanceCount == b.instanceCount;
+    }
+
+    void Submit(InstanceBatcher& batcher, const std::vector<Node>& nodes){
+        batcher.Clear();
+        for(uint32_t node = 0; node < nodes.size(); node++){
+            batcher.Add(nodes[node].key, nodes[node].material, nodes[node].mesh, node);
+        }
+        batcher.Build();
+    }
+
+}
+
+// usage: InstanceBatcherBenchmark [node count] [mesh count]
+int main(int argc, char** argv){
+
+    const uint32_t count  = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000;
+    const uint32_t meshes = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 500;
+    const int      repeat = 5;
+    bool isValid = true;
+
+    // every mesh keeps one material and pipeline, random depths so the instances of a draw get reordered
+    std::default_random_engine e(11);
+    std::uniform_int_distribution<uint32_t> pickMesh(0, meshes - 1);
+    std::uniform_real_distribution<float>   depth(0.1f, 500.0f);
+
+    std::vector<uint32_t> meshPipeline(meshes), meshMaterial(meshes);
+    for(uint32_t mesh = 0; mesh < meshes; mesh++){
+        meshPipeline[mesh] = e() % 4 | 0x20;
+        meshMaterial[mesh] = e() % 64;
+    }
+
+    std::vector<Node> nodes(count);
+    for(auto& node : nodes){
+        uint32_t mesh = pickMesh(e);
+        node.key      = RenderQueue::MakeKey(RenderQueue::GeometryPass, meshPipeline[mesh], meshMaterial[mesh], mesh, depth(e));
+        node.material = MakeMaterial(meshMaterial[mesh]);
+        node.mesh     = MakeMesh(mesh);
+    }
+
+    InstanceBatcher batcher;
+    const double buildMs = Measure([&](){ Submit(batcher, nodes); }, repeat);
+
+    // draws and instance layout against the group by
+    std::vector<InstanceBatcher::Draw> expectedDraws;
+    std::vector<uint32_t>              expectedInstances;
+    GroupBy(nodes, expectedDraws, expectedInstances);
+
+    size_t drawMismatch = batcher.GetDraws().size() == expectedDraws.size() ? 0 : 1;
+    for(size_t i = 0; i < expectedDraws.size() && i < batcher.GetDraws().size(); i++){
+        drawMismatch += IsSameDraw(batcher.GetDraws()[i], expectedDraws[i]) ? 0 : 1;
+    }
+    const bool isSameInstances = batcher.GetInstances() == expectedInstances;
+
+    // Pack writes the record of every instance in GetInstances order
+    std::vector<uint64_t> packed(batcher.GetInstances().size());
+    batcher.Pack(packed.data(), [&](uint32_t node){ return nodes[node].key ^ (uint64_t(node) << 32); });
+    size_t packMismatch = 0;
+    for(size_t i = 0; i < packed.size(); i++){
+        const uint32_t node = batcher.GetInstances()[i];
+        packMismatch += packed[i] == (nodes[node].key ^ (uint64_t(node) << 32)) ? 0 : 1;
+    }
+
+    isValid = isValid && drawMismatch == 0 && isSameInstances && packMismatch == 0;
+    printf("%u nodes, %u meshes: %zu draws in %.3f ms\n", count, meshes, batcher.GetDraws().size(), buildMs);
+    printf("%zu draws differ from the group by, instances %s, %zu packed records misplaced\n",
+        drawMismatch, isSameInstances ? "match" : "differ", packMismatch);
+
+    // the ids in the key are truncated, two meshes with the same id must still get draws of their own
+    std::vector<Node> aliased;
+    for(uint32_t i = 0; i < 64; i++){
+        const uint32_t mesh = i % 2 == 0 ? 5 : 5 + (1u << RenderQueue::MeshBits);
+        aliased.push_back({RenderQueue::MakeKey(RenderQueue::GeometryPass, 0x20, 1, mesh, 1.0f + i), MakeMaterial(1), MakeMesh(i % 2)});
+    }
+    Submit(batcher, aliased);
+
+    uint32_t instances = 0;
+    bool     isSplit   = true;
+    for(const auto& draw : batcher.GetDraws()){
+        isSplit = isSplit && draw.firstInstance == instances;
+        for(uint32_t i = draw.firstInstance; i < draw.firstInstance + draw.instanceCount; i++){
+            isSplit = isSplit && aliased[batcher.GetInstances()[i]].mesh == draw.mesh;
+        }
+        instances += draw.instanceCount;
+    }
+    isSplit = isSplit && instances == aliased.size();
+    printf("aliased mesh ids: %zu draws, %s\n", batcher.GetDraws().size(), isSplit ? "split by mesh" : "merged");
+
+    return isValid && isSplit ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include "MipGenerator.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace{
+
+    using Clock = std::chrono::steady_clock;
+    using Utility::MipGenerator;
+
+    // blades of grass on a transparent background, thin enough that plain filtering erodes them
+    std::vector<uint8_t> MakeFoliage(uint32_t size){
+        std::vector<uint8_t> texels(size_t(size) * size * 4);
+        for(uint32_t y = 0; y < size; y++){
+            for(uint32_t x = 0; x < size; x++){
+                float blade = std::fabs(std::sin(x * 0.19f + std::sin(y * 0.013f) * 3.0f));
+                uint8_t* t = texels.data() + (size_t(y) * size + x) * 4;
+                t[0] = static_cast<uint8_t>(40 + (x * 7 + y * 3) % 60);
+                t[1] = static_cast<uint8_t>(120 + (x ^ y) % 100);
+                t[2] = 30;
+                t[3] = blade > 0.85f ? 255 : 0;
+            }
+        }
+        return texels;
+    }
+
+    void Run(const char* name, const std::vector<uint8_t>& texels, uint32_t size, const MipGenerator::Settings& settings, float cutoff){
+        const int iterations = 5;
+        MipGenerator::MipChain chain;
+        const Clock::time_point begin = Clock::now();
+        for(int i = 0; i < iterations; i++){
+            chain = MipGenerator::Generate(texels.data(), size, size, size * 4, settings);
+        }
+        const double time = std::chrono::duration<double>(Clock::now() - begin).count() / iterations;
+
+        printf("%-24s %8.2f ms, %7.1f Mpixel/s, coverage", name, time * 1e3, double(size) * size / time * 1e-6);
+        for(size_t l = 0; l < chain.levels.size() && l < 8; l++){
+            const auto& level = chain.levels[l];
+            printf(" %.3f", MipGenerator::GetAlphaCoverage(chain.data.data() + level.offset, level.width, level.height, level.rowPitch, cutoff));
+        }
+        printf("\n");
+    }
+
+}
+
+// usage: MipGeneratorBenchmark, a 2048x2048 cutout texture through every filter with and without coverage preservation
+int main(){
+    const uint32_t size   = 2048;
+    const float    cutoff = 0.5f;
+    const auto     texels = MakeFoliage(size);
+
+    MipGenerator::Settings settings;
+    settings.filter = MipGenerator::Filter::Box;
+    Run("box", texels, size, settings, cutoff);
+    settings.filter = MipGenerator::Filter::Kaiser;
+    Run("kaiser", texels, size, settings, cutoff);
+
+    settings.alphaCutoff = cutoff;
+    settings.filter = MipGenerator::Filter::Box;
+    Run("box, coverage kept", texels, size, settings, cutoff);
+    settings.filter = MipGenerator::Filter::Kaiser;
+    Run("kaiser, coverage kept", texels, size, settings, cutoff);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "MorphTargets.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    // dense deltas of one target, a few regions of the mesh in vertex order with scattered still vertices,
+    // as the expression shapes of a face
+    std::vector<float> MakeTarget(uint32_t vertexCount, float coverage, std::default_random_engine& e){
+        std::uniform_real_distribution<float> u(-0.01f, 0.01f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<float> deltas(vertexCount * 3, 0.0f);
+
+        const uint32_t regionCount = 4;
+        const uint32_t regionSize  = static_cast<uint32_t>(vertexCount * coverage / regionCount);
+        std::uniform_int_distribution<uint32_t> pickStart(0, vertexCount - regionSize);
+        for(uint32_t r = 0; r < regionCount; r++){
+            const uint32_t start = pickStart(e);
+            for(uint32_t v = start; v < start + regionSize; v++){
+                if(unit(e) < 0.2f) continue;
+                for(int k = 0; k < 3; k++) deltas[v * 3 + k] = u(e);
+            }
+        }
+        return deltas;
+    }
+
+}
+
+// usage: MorphTargetsBenchmark [vertices] [targets] [active targets] [coverage of a target]
+int main(int argc, char** argv){
+
+    const uint32_t vertexCount = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 30000;
+    const uint32_t targetCount = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 64;
+    const uint32_t activeCount = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 8;
+    const float    coverage    = argc > 4 ? static_cast<float>(atof(argv[4])) : 0.05f;
+    const int      repeat      = 20;
+
+    std::default_random_engine e(11);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+    std::vector<float> positions(vertexCount * 3), normals(vertexCount * 3), tangents(vertexCount * 4);
+    for(auto& x : positions) x = u(e);
+    for(auto& x : normals)   x = u(e);
+    for(auto& x : tangents)  x = u(e);
+
+    // every target moves positions and normals, every other one tangents too
+    MorphTargets morph(positions.data(), normals.data(), tangents.data(), vertexCount);
+    std::vector<std::vector<float>> targets[3];
+    for(uint32_t t = 0; t < targetCount; t++){
+        targets[0].emplace_back(MakeTarget(vertexCount, coverage, e));
+        targets[1].emplace_back(MakeTarget(vertexCount, coverage, e));
+        targets[2].emplace_back(t % 2 == 0 ? MakeTarget(vertexCount, coverage, e) : std::vector<float>());
+        morph.AddTarget(targets[0][t].data(), targets[1][t].data(), targets[2][t].empty() ? nullptr : targets[2][t].data());
+    }
+
+    printf("%u vertices, %u targets, %u active, a target moves %.0f%% of the vertices, its merged spans cover %.1f%%\n",
+        vertexCount, targetCount, activeCount, coverage * 100.0f, double(morph.GetDeltaCount()) / vertexCount * 100.0 / targetCount);
+
+    // two weight sets that differ in which targets are active, as consecutive frames of an animation
+    std::vector<float> weights[2];
+    std::uniform_int_distribution<uint32_t> pickTarget(0, targetCount - 1);
+    std::uniform_real_distribution<float>   pickWeight(0.1f, 1.0f);
+    for(auto& w : weights){
+        w.assign(targetCount, 0.0f);
+        for(uint32_t i = 0; i < activeCount; i++) w[pickTarget(e)] = pickWeight(e);
+    }
+
+    // dense reference, every target over every vertex
+    std::vector<float> reference(vertexCount * 9);
+    auto Dense = [&](const std::vector<float>& w){
+        const uint32_t n = vertexCount;
+        for(uint32_t v = 0; v < n; v++){
+            for(int k = 0; k < 3; k++){
+                reference[k * n + v]       = positions[v * 3 + k];
+                reference[(3 + k) * n + v] = normals[v * 3 + k];
+                reference[(6 + k) * n + v] = tangents[v * 4 + k];
+            }
+        }
+        for(uint32_t t = 0; t < targetCount; t++){
+            for(int a = 0; a < 3; a++){
+                if(targets[a][t].empty()) continue;
+                for(uint32_t v = 0; v < n; v++){
+                    for(int k = 0; k < 3; k++) reference[(a * 3 + k) * n + v] += w[t] * targets[a][t][v * 3 + k];
+                }
+            }
+        }
+    };
+    double denseMs = Measure([&](){ Dense(weights[0]); }, repeat);
+    printf("%-8s dense %8.3f ms\n", "scalar", denseMs);
+
+    bool isValid = true;
+    const Utility::SimdLevel cpuLevel = Utility::GetCpuSimdLevel();
+    for(int level = 0; level <= static_cast<int>(cpuLevel); level++){
+        GeoMath::SetBatchLevel(static_cast<Utility::SimdLevel>(level));
+        const char* levelName = Utility::GetSimdLevelName(GeoMath::GetBatchLevel());
+
+        // alternating weights, so every Apply first restores what the previous one moved
+        int frame = 0;
+        double ms = Measure([&](){
+            morph.Apply(weights[frame & 1].data());
+            frame++;
+        }, repeat);
+
+        float error = 0.0f;
+        for(int i = 0; i < 2; i++){
+            morph.Apply(weights[i].data());
+            Dense(weights[i]);
+            GeoMath::ConstSkinVertexStream morphed = morph.GetMorphed();
+            const float* result = morphed.position.x;
+            for(size_t j = 0; j < reference.size(); j++){
+                float d = std::abs(result[j] - reference[j]);
+                error = d > error ? d : error;
+            }
+        }
+        isValid = isValid && error < 1e-5f;
+
+        printf("%-8s sparse %8.3f ms, %6.1fx the dense sum (error %.2g)\n", levelName, ms, denseMs / ms, error);
+    }
+
+    return isValid ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include "RedrawTracker.hpp"
+
+#include <cstdio>
+
+namespace{
+
+    using Utility::RedrawTracker;
+
+    // the history weight multiplied down frame by frame, the count the closed form has to match
+    uint32_t CountFrames(float alpha, float threshold){
+        if(alpha >= 1.0f || alpha <= 0.0f) return 1;
+
+        double   weight = 1.0;
+        uint32_t frames = 0;
+        while(weight > threshold && frames < RedrawTracker::MaxFrames){
+            weight *= 1.0 - double(alpha);
+            frames++;
+        }
+        return frames;
+    }
+
+    // frames a tracker renders after a change until it reports the picture settled
+    uint32_t RenderUntilSettled(RedrawTracker& tracker){
+        uint32_t frames = 0;
+        while(tracker.IsRedrawNeeded() && frames <= RedrawTracker::MaxFrames){
+            tracker.OnFrameRendered();
+            frames++;
+        }
+        return frames;
+    }
+
+    bool Check(bool isValid, const char* what){
+        printf("%-56s %s\n", what, isValid ? "ok" : "FAILED");
+        return isValid;
+    }
+
+}
+
+// usage: RedrawTrackerBenchmark, frames to converge of the accumulation blends and the invalidation of a tracker
+int main(){
+    bool isValid = true;
+
+    // alpha, frames, both ends settle in one frame and slow blends stop at the cap
+    struct Case{ float alpha; uint32_t frames; };
+    const Case cases[] = {
+        {-0.5f,   1}, {0.0f, 1}, {0.05f, 109}, {0.1f, 53}, {0.5f, 8},
+        {0.001f, RedrawTracker::MaxFrames}, {1.0f, 1}, {1.5f, 1},
+    };
+    for(const auto& c : cases){
+        const uint32_t frames = RedrawTracker::FramesToConverge(c.alpha, RedrawTracker::Threshold);
+        const bool     isSame = frames == c.frames && frames == CountFrames(c.alpha, RedrawTracker::Threshold);
+        printf("alpha %6.3f: %3u frames, expected %3u %s\n", c.alpha, frames, c.frames, isSame ? "" : "FAILED");
+        isValid = isValid && isSame;
+    }
+
+    uint32_t formMismatch = 0;
+    for(uint32_t i = 1; i < 1000; i++){
+        const float alpha = i / 1000.0f;
+        formMismatch += RedrawTracker::FramesToConverge(alpha, RedrawTracker::Threshold) == CountFrames(alpha, RedrawTracker::Threshold) ? 0 : 1;
+    }
+    isValid = Check(formMismatch == 0, "closed form against the multiplied weight, alpha (0, 1)") && isValid;
+
+    // a fresh tracker draws the first frame, without accumulation a change costs one frame
+    RedrawTracker tracker;
+    isValid = Check(RenderUntilSettled(tracker) == 1, "first frame") && isValid;
+    tracker.Invalidate();
+    isValid = Check(RenderUntilSettled(tracker) == 1, "change without accumulation") && isValid;
+
+    tracker.SetAccumulation(true, 0.1f);
+    tracker.Invalidate();
+    isValid = Check(RenderUntilSettled(tracker) == 53 && !tracker.IsRedrawNeeded(), "change with alpha 0.1") && isValid;
+
+    // a change halfway through converging restarts the whole count
+    tracker.Invalidate();
+    for(int i = 0; i < 30; i++) tracker.OnFrameRendered();
+    tracker.Invalidate();
+    isValid = Check(tracker.GetFramesSinceChange() == 0 && RenderUntilSettled(tracker) == 53, "change while converging") && isValid;
+
+    // the count stops at the cap however long the scene stays still
+    tracker.SetAccumulation(true, 0.0001f);
+    tracker.Invalidate();
+    const uint32_t capped = RenderUntilSettled(tracker);
+    for(uint32_t i = 0; i < 2 * RedrawTracker::MaxFrames; i++) tracker.OnFrameRendered();
+    isValid = Check(capped == RedrawTracker::MaxFrames && tracker.GetFramesSinceChange() == RedrawTracker::MaxFrames && !tracker.IsRedrawNeeded(),
+        "slow blend stops at the cap") && isValid;
+
+    // turning accumulation off after a change leaves nothing to render
+    tracker.SetAccumulation(true, 0.1f);
+    tracker.Invalidate();
+    tracker.OnFrameRendered();
+    tracker.SetAccumulation(false, 0.1f);
+    isValid = Check(!tracker.IsRedrawNeeded(), "accumulation turned off while converging") && isValid;
+
+    return isValid ? 0 : 1;
+}
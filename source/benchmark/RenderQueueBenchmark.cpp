@@ -0,0 +1,80 @@
+#include "RenderQueue.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    void PrintChanges(const char* name, const RenderQueue::StateChanges& changes){
+        printf("%-14s %8u pipelines %8u materials %8u meshes\n", name, changes.pipelines, changes.materials, changes.meshes);
+    }
+
+}
+
+// usage: RenderQueueBenchmark [draw count] [pipeline count] [material count] [mesh count]
+int main(int argc, char** argv){
+
+    const uint32_t count     = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000;
+    const uint32_t pipelines = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 4;
+    const uint32_t materials = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 200;
+    const uint32_t meshes    = argc > 4 ? static_cast<uint32_t>(atoi(argv[4])) : 1000;
+    const int      repeat    = 5;
+
+    // every mesh keeps one material and pipeline, the draws arrive in traversal order
+    std::default_random_engine e(7);
+    std::uniform_int_distribution<uint32_t> pickPipeline(0, pipelines - 1);
+    std::uniform_int_distribution<uint32_t> pickMaterial(0, materials - 1);
+    std::uniform_int_distribution<uint32_t> pickMesh(0, meshes - 1);
+    std::uniform_real_distribution<float>   depth(0.1f, 500.0f);
+
+    std::vector<uint32_t> meshPipeline(meshes), meshMaterial(meshes);
+    for(uint32_t mesh = 0; mesh < meshes; mesh++){
+        meshPipeline[mesh] = pickPipeline(e) | 0x20;
+        meshMaterial[mesh] = pickMaterial(e);
+    }
+
+    std::vector<uint64_t> keys(count);
+    for(auto& key : keys){
+        uint32_t mesh = pickMesh(e);
+        key = RenderQueue::MakeKey(RenderQueue::GeometryPass, meshPipeline[mesh], meshMaterial[mesh], mesh, depth(e));
+    }
+
+    RenderQueue queue;
+    queue.Reserve(count);
+    auto fill = [&](){
+        queue.Clear();
+        for(uint32_t i = 0; i < count; i++) queue.Add(keys[i], i);
+    };
+
+    double fillMs  = Measure(fill, repeat);
+    double radixMs = Measure([&](){ fill(); queue.Sort(); }, repeat) - fillMs;
+
+    // the radix sort is stable, so it has to match a stable sort of the keys exactly
+    std::vector<uint32_t> order(count);
+    double stdMs = Measure([&](){
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return keys[a] < keys[b]; });
+    }, repeat);
+
+    size_t mismatch = 0;
+    for(uint32_t i = 0; i < count; i++){
+        mismatch += queue.GetValues()[i] == order[i] && queue.GetKeys()[i] == keys[order[i]] ? 0 : 1;
+    }
+
+    printf("%u draws, %u pipelines, %u materials, %u meshes\n", count, pipelines, materials, meshes);
+    printf("%-14s %10.3f ms\n", "radix sort", radixMs);
+    printf("%-14s %10.3f ms\n", "stable_sort", stdMs);
+    printf("%zu of %u draws differ from stable_sort\n", mismatch, count);
+
+    PrintChanges("traversal", RenderQueue::CountStateChanges(keys.data(), count));
+    PrintChanges("sorted", RenderQueue::CountStateChanges(queue.GetKeys().data(), count));
+
+    return mismatch == 0 ? 0 : 1;
+}
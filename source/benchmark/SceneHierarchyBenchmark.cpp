@@ -0,0 +1,107 @@
+#include "SceneHierarchy.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    // depth first like a loaded glTF, every node gets fanout children until the depth is reached
+    void BuildTree(SceneHierarchy& hierarchy, uint32_t parent, uint32_t depth, uint32_t fanout, std::default_random_engine& e){
+        std::uniform_real_distribution<float> angle(-3.1415926f, 3.1415926f);
+        std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+
+        for(uint32_t i = 0; i < fanout; i++){
+            uint32_t node = hierarchy.Add(parent, nullptr);
+
+            GeoMath::Transform local;
+            local.scale       = GeoMath::Vector3f(scale(e), scale(e), scale(e));
+            local.translation = GeoMath::Vector3f(offset(e), offset(e), offset(e));
+            GeoMath::Vector3f axis = GeoMath::Vector3f(offset(e), offset(e), offset(e)).Normalized();
+            float half = 0.5f * angle(e);
+            local.rotation[0] = axis.x * std::sin(half);
+            local.rotation[1] = axis.y * std::sin(half);
+            local.rotation[2] = axis.z * std::sin(half);
+            local.rotation[3] = std::cos(half);
+            hierarchy.SetLocal(node, local.ToMatrix(), local.Classify());
+
+            if(depth > 1) BuildTree(hierarchy, node, depth - 1, fanout, e);
+        }
+    }
+
+}
+
+// usage: SceneHierarchyBenchmark [fanout] [depth] [max threads]
+int main(int argc, char** argv){
+
+    const uint32_t fanout = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 16;
+    const uint32_t depth  = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 5;
+    const int      repeat = 10;
+
+    std::default_random_engine e(7);
+
+    SceneHierarchy hierarchy;
+    uint32_t root = hierarchy.Add(SceneHierarchy::NoParent, nullptr);
+    BuildTree(hierarchy, root, depth, fanout, e);
+
+    const size_t count = hierarchy.GetSize();
+    printf("%zu nodes, fanout %u, depth %u\n", count, fanout, depth);
+
+    // serial pass is the reference, every thread count has to match it bit for bit
+    hierarchy.Update();
+    std::vector<GeoMath::Matrix4f> reference(count);
+    for(size_t i = 0; i < count; i++){
+        reference[i] = hierarchy.GetWorld(static_cast<uint32_t>(i));
+    }
+
+    double serial = Measure([&](){
+        hierarchy.Pollute(root);
+        hierarchy.Update();
+    }, repeat);
+    printf("%-12s %10.3f ms\n", "serial", serial);
+
+    const uint32_t hardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    const uint32_t maxThreads      = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : hardwareThreads;
+    for(uint32_t threads = 1; ; threads *= 2){
+        threads = threads < maxThreads ? threads : maxThreads;
+        Utility::WorkerPool pool(threads);
+
+        double ms = Measure([&](){
+            hierarchy.Pollute(root);
+            hierarchy.Update(&pool);
+        }, repeat);
+
+        size_t mismatch = 0;
+        for(size_t i = 0; i < count; i++){
+            mismatch += memcmp(&reference[i], &hierarchy.GetWorld(static_cast<uint32_t>(i)), sizeof(GeoMath::Matrix4f)) != 0 ? 1 : 0;
+        }
+
+        printf("%2u threads   %10.3f ms %6.2fx, %zu differ from serial\n", threads, ms, serial / ms, mismatch);
+        if(threads == maxThreads) break;
+    }
+
+    // a few nodes moved per frame, the update has to cost what changed and not the scene size
+    std::uniform_int_distribution<uint32_t> pick(1, static_cast<uint32_t>(count - 1));
+    for(uint32_t moved : {0u, 1u, 100u, 10000u}){
+        std::vector<uint32_t> nodes(moved);
+        for(auto& node : nodes) node = pick(e);
+
+        size_t changed = 0;
+        double ms = Measure([&](){
+            for(auto node : nodes) hierarchy.Pollute(node);
+            hierarchy.Update();
+            changed = hierarchy.GetChanged().size();
+        }, repeat);
+        printf("%5u moved  %10.3f ms, %zu nodes recomputed\n", moved, ms, changed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "Skinning.hpp"
+#include "PackedVertex.hpp"
+#include "WorkerPool.hpp"
+#include "BenchmarkUtil.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace{
+
+    using Benchmark::Measure;
+
+    void RandomUnit(float* v, int count, std::default_random_engine& e){
+        std::normal_distribution<float> n(0.0f, 1.0f);
+        float length = 0.0f;
+        for(int k = 0; k < count; k++){
+            v[k] = n(e);
+            length += v[k] * v[k];
+        }
+        length = std::sqrt(length);
+        for(int k = 0; k < count; k++) v[k] /= length;
+    }
+
+    // synthetic skinned mesh, 4 influences of random weight per vertex, every eighth vertex on one joint
+    std::unique_ptr<SkinnedGeometry> MakeGeometry(uint32_t vertexCount, uint32_t jointCount, std::default_random_engine& e){
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        std::uniform_int_distribution<uint32_t> pickJoint(0, jointCount - 1);
+
+        std::vector<float>    positions(vertexCount * 3), normals(vertexCount * 3), tangents(vertexCount * 4), weights(vertexCount * 4);
+        std::vector<uint16_t> joints(vertexCount * 4);
+        for(uint32_t v = 0; v < vertexCount; v++){
+            for(int k = 0; k < 3; k++) positions[v * 3 + k] = u(e);
+            RandomUnit(&normals[v * 3], 3, e);
+            RandomUnit(&tangents[v * 4], 3, e);
+            tangents[v * 4 + 3] = u(e) < 0.0f ? -1.0f : 1.0f;
+
+            const bool isRigid = v % 8 == 0;
+            for(int i = 0; i < 4; i++){
+                joints[v * 4 + i]  = static_cast<uint16_t>(pickJoint(e));
+                weights[v * 4 + i] = isRigid ? (i == 0 ? 1.0f : 0.0f) : u(e) * 0.5f + 0.5f;
+            }
+        }
+        return std::make_unique<SkinnedGeometry>(positions.data(), normals.data(), tangents.data(), joints.data(), weights.data(), vertexCount);
+    }
+
+    // joints of one chain with random rigid local transforms
+    std::shared_ptr<Skin> MakeSkin(SceneHierarchy& hierarchy, uint32_t jointCount, std::default_random_engine& e){
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+        uint32_t meshNode = hierarchy.Add(SceneHierarchy::NoParent, nullptr);
+        std::vector<uint32_t> joints;
+        uint32_t parent = meshNode;
+        for(uint32_t j = 0; j < jointCount; j++){
+            parent = hierarchy.Add(parent, nullptr);
+            float q[4];
+            RandomUnit(q, 4, e);
+            GeoMath::Transform local(GeoMath::Vector4f(q[0], q[1], q[2], q[3]), GeoMath::Vector3f(u(e), u(e), u(e)));
+            hierarchy.SetLocal(parent, local.ToMatrix(), local.Classify());
+            joints.emplace_back(parent);
+        }
+        return std::make_shared<Skin>(meshNode, joints, std::vector<GeoMath::Matrix4f>(jointCount));
+    }
+
+    float MaxDifference(const GeoMath::ConstSkinVertexStream& a, const GeoMath::ConstSkinVertexStream& b, uint32_t count, uint32_t step = 1){
+        const GeoMath::ConstVector3fStream* sa[3] = {&a.position, &a.normal, &a.tangent};
+        const GeoMath::ConstVector3fStream* sb[3] = {&b.position, &b.normal, &b.tangent};
+        float result = 0.0f;
+        for(int s = 0; s < 3; s++){
+            for(uint32_t v = 0; v < count; v += step){
+                float d[3] = {sa[s]->x[v] - sb[s]->x[v], sa[s]->y[v] - sb[s]->y[v], sa[s]->z[v] - sb[s]->z[v]};
+                for(float x : d) result = std::abs(x) > result ? std::abs(x) : result;
+            }
+        }
+        return result;
+    }
+
+    // largest distance a vertex lies outside of bounds, 0 when they hold every one
+    float MaxOutside(const GeoMath::ConstVector3fStream& positions, uint32_t count, const GeoMath::BoundingBox& bounds){
+        float result = 0.0f;
+        for(uint32_t v = 0; v < count; v++){
+            float d[3] = {
+                std::abs(positions.x[v] - bounds.center.x) - bounds.extent.x,
+                std::abs(positions.y[v] - bounds.center.y) - bounds.extent.y,
+                std::abs(positions.z[v] - bounds.center.z) - bounds.extent.z,
+            };
+            for(float x : d) result = x > result ? x : result;
+        }
+        return result;
+    }
+
+    // the deformed vertices in the compact layout of the renderer, as Dx12Mesh writes its staging memory
+    void Pack(const SkinnedGeometry& geometry, uint8_t* staging){
+        const uint32_t count = geometry.GetVertexCount();
+        GeoMath::ConstSkinVertexStream deformed = geometry.GetDeformed();
+        GeoMath::PackPositions(deformed.position, count, reinterpret_cast<GeoMath::SNorm16x4*>(staging));
+        staging += sizeof(GeoMath::SNorm16x4) * count;
+        GeoMath::PackNormals(deformed.normal, count, reinterpret_cast<GeoMath::SNorm16x2*>(staging));
+        staging += sizeof(GeoMath::SNorm16x2) * count;
+        GeoMath::PackTangents(deformed.tangent, geometry.GetTangentSigns(), count, reinterpret_cast<GeoMath::SNorm16x4*>(staging));
+    }
+
+}
+
+// usage: SkinningBenchmark [meshes] [vertices per mesh] [joints per skin]
+int main(int argc, char** argv){
+
+    const uint32_t meshCount   = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 32;
+    const uint32_t vertexCount = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 20000;
+    const uint32_t jointCount  = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 64;
+    const int      repeat      = 5;
+
+    std::default_random_engine e(7);
+
+    SceneHierarchy hierarchy;
+    std::vector<std::shared_ptr<Skin>>            skins;
+    std::vector<std::unique_ptr<SkinnedGeometry>> meshes;
+    for(uint32_t m = 0; m < meshCount; m++){
+        skins.emplace_back(MakeSkin(hierarchy, jointCount, e));
+        meshes.emplace_back(MakeGeometry(vertexCount, jointCount, e));
+    }
+    hierarchy.Update();
+    for(auto& skin : skins) skin->UpdatePalette(hierarchy);
+
+    const size_t stagingSize = (sizeof(GeoMath::SNorm16x4) * 2 + sizeof(GeoMath::SNorm16x2)) * vertexCount;
+    std::vector<std::vector<uint8_t>> staging(meshCount, std::vector<uint8_t>(stagingSize));
+
+    const double totalVertices = double(meshCount) * vertexCount;
+    printf("%u meshes of %u vertices, %u joints per skin, 4 influences\n", meshCount, vertexCount, jointCount);
+
+    // every level against the scalar reference, and the two methods against each other on rigid vertices
+    SkinnedGeometry& probe = *meshes.front();
+    std::vector<float> reference[2];
+    const Skin::Method methods[2] = {Skin::Method::LinearBlend, Skin::Method::DualQuaternion};
+    const char*        names[2]   = {"linear", "dual quat"};
+
+    GeoMath::SetBatchLevel(Utility::SimdLevel::Scalar);
+    for(int method = 0; method < 2; method++){
+        skins.front()->SetMethod(methods[method]);
+        probe.Deform(*skins.front());
+        GeoMath::ConstSkinVertexStream deformed = probe.GetDeformed();
+        reference[method].assign(deformed.position.x, deformed.position.x + vertexCount * 9);
+    }
+    auto Streams = [&](const std::vector<float>& data){
+        const float* p = data.data();
+        const uint32_t n = vertexCount;
+        return GeoMath::ConstSkinVertexStream{{p, p + n, p + n * 2}, {p + n * 3, p + n * 4, p + n * 5}, {p + n * 6, p + n * 7, p + n * 8}};
+    };
+    printf("%-8s rigid vertices differ by %g between the methods\n", "scalar", MaxDifference(Streams(reference[0]), Streams(reference[1]), vertexCount, 8));
+
+    // the scene culls skinned nodes with the pose bounds of their bind box, every vertex has to stay inside
+    const GeoMath::BoundingBox bindBounds(GeoMath::Vector3f(0.0f, 0.0f, 0.0f), GeoMath::Vector3f(1.0f, 1.0f, 1.0f));
+    float outside[2];
+    for(int method = 0; method < 2; method++){
+        skins.front()->SetMethod(methods[method]);
+        outside[method] = MaxOutside(Streams(reference[method]).position, vertexCount, skins.front()->GetPoseBounds(bindBounds));
+    }
+    printf("%-8s vertices outside the pose bounds by %g linear, %g dual quat\n", "scalar", outside[0], outside[1]);
+
+    bool isValid = outside[0] < 1e-4f && outside[1] < 1e-4f;
+    const Utility::SimdLevel cpuLevel = Utility::GetCpuSimdLevel();
+    for(int level = 0; level <= static_cast<int>(cpuLevel); level++){
+        GeoMath::SetBatchLevel(static_cast<Utility::SimdLevel>(level));
+        const char* levelName = Utility::GetSimdLevelName(GeoMath::GetBatchLevel());
+
+        double mvps[2], packMvps = 0.0;
+        float  error[2];
+        for(int method = 0; method < 2; method++){
+            for(auto& skin : skins) skin->SetMethod(methods[method]);
+
+            probe.Deform(*skins.front());
+            error[method] = MaxDifference(probe.GetDeformed(), Streams(reference[method]), vertexCount);
+            isValid = isValid && error[method] < 1e-4f;
+
+            double ms = Measure([&](){
+                for(uint32_t m = 0; m < meshCount; m++) meshes[m]->Deform(*skins[m]);
+            }, repeat);
+            mvps[method] = totalVertices / ms * 1e-3;
+
+            if(method == 0){
+                double packMs = Measure([&](){
+                    for(uint32_t m = 0; m < meshCount; m++) Pack(*meshes[m], staging[m].data());
+                }, repeat);
+                packMvps = totalVertices / packMs * 1e-3;
+            }
+        }
+
+        printf("%-8s %s %8.1f Mvertices/s (error %.2g), %s %8.1f Mvertices/s (error %.2g), pack %8.1f Mvertices/s\n",
+            levelName, names[0], mvps[0], error[0], names[1], mvps[1], error[1], packMvps);
+    }
+
+    // skin and pack on every thread, one mesh per task as the scene does
+    Utility::WorkerPool& pool = Utility::WorkerPool::GetInstance();
+    for(int method = 0; method < 2; method++){
+        for(auto& skin : skins) skin->SetMethod(methods[method]);
+        double ms = Measure([&](){
+            pool.ParallelFor(meshCount, 1, [&](size_t begin, size_t end){
+                for(size_t m = begin; m < end; m++){
+                    meshes[m]->Deform(*skins[m]);
+                    Pack(*meshes[m], staging[m].data());
+                }
+            });
+        }, repeat);
+        printf("%u threads %s skin and pack %8.3f ms, %8.1f Mvertices/s\n",
+            pool.GetThreadCount(), names[method], ms, totalVertices / ms * 1e-3);
+    }
+
+    return isValid ? 0 : 1;
+}
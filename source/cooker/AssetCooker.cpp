@@ -0,0 +1,53 @@
+#include "SceneCooker.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// usage: AssetCooker <scene.gltf|scene.glb> <scene.pak> [none|fast|normal|high], textures are block compressed
+// with the normal preset unless told otherwise
+int main(int argc, char** argv){
+
+    TextureCompression compression{true};
+    const char* preset = argc > 3 ? argv[3] : "normal";
+    if     (strcmp(preset, "none")   == 0) compression.isEnabled = false;
+    else if(strcmp(preset, "fast")   == 0) compression.quality   = Utility::BlockCompressor::Quality::Fast;
+    else if(strcmp(preset, "normal") == 0) compression.quality   = Utility::BlockCompressor::Quality::Normal;
+    else if(strcmp(preset, "high")   == 0) compression.quality   = Utility::BlockCompressor::Quality::High;
+    else argc = 0;
+
+    if(argc < 3){
+        printf("usage: AssetCooker <scene.gltf|scene.glb> <scene.pak> [none|fast|normal|high]\n");
+        return 1;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    SceneCooker cooker(argv[1], compression);
+    if(!cooker.Cook()){
+        printf("%s: %s\n", argv[1], cooker.GetError().c_str());
+        return 1;
+    }
+    if(!cooker.Write(argv[2])){
+        printf("%s: failed to write\n", argv[2]);
+        return 1;
+    }
+
+    // the package only loads when it was written by the version of the runtime reading it
+    const ScenePackage package(argv[2]);
+    if(!package.IsValid()){
+        printf("%s: written package does not load\n", argv[2]);
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("%s: %zu textures, %zu materials, %zu meshes, %zu nodes, %.1f MB in %.2f s\n", argv[2],
+        package.GetCount<ScenePackage::Texture>(ScenePackage::Textures),
+        package.GetCount<ScenePackage::Material>(ScenePackage::Materials),
+        package.GetCount<ScenePackage::Mesh>(ScenePackage::Meshes),
+        package.GetCount<ScenePackage::Node>(ScenePackage::Nodes),
+        double(package.GetSize(ScenePackage::Texels) + package.GetSize(ScenePackage::Vertices) + package.GetSize(ScenePackage::Indices)) / (1 << 20),
+        seconds
+    );
+    return 0;
+}
@@ -182,11 +182,15 @@ void Dx12GraphicsManager::OnResize(uint16_t width, uint16_t height){
     m_frameIndex      = (m_dxgiSwapChain->GetCurrentBackBufferIndex() + m_frameCount - 1) % m_frameCount;
 }
 
-void Dx12GraphicsManager::OnUpdate(){
+void Dx12GraphicsManager::NextFrame(){
 
     // Get New Frame Resource
     m_frameIndex = (m_frameIndex + 1) % m_frameCount;
     m_commandQueue->WaitForFenceValue(m_frameResources[m_frameIndex].fence);
+}
+
+void Dx12GraphicsManager::OnUpdate(){
+
     m_cmdList = m_commandQueue->GetCommandList();
 
     auto& currFrame = m_frameResources[m_frameIndex];
@@ -10,15 +10,19 @@
 struct FrameResource{
     FrameResource() 
         : fence{0}
+        , sceneGeneration{0}
         , isAccelerationStructureDitry{true}
         , tlasDesc{}
     {}
 
     uint64_t                      fence;
+    // scene changes up to this generation are in the buffers below
+    uint64_t                      sceneGeneration;
     bool                          isAccelerationStructureDitry;
 
     std::unique_ptr<UploadBuffer> mainConst;
-    std::unique_ptr<UploadBuffer> objectConst;
+    // ObjectConstBuffer of every instance drawn this frame, in draw order
+    std::unique_ptr<UploadBuffer> instanceData;
     std::unique_ptr<PrePass>      gbuffer;
     
     ComPtr<ID3D12Resource>        renderTarget;
@@ -82,6 +86,9 @@ public:
 
     void OnInit(HWND hWnd, uint8_t frameCount, uint16_t width, uint16_t height);
     void OnResize(uint16_t width, uint16_t height);
+    // moves on to the next frame resource once the gpu is done with it, the scene fills it before OnUpdate
+    void NextFrame();
+    // rebuilds the acceleration structure of the frame resource if it was changed, uploads the main constants
     void OnUpdate();
 
     void OnRender(){
@@ -106,6 +113,7 @@ public:
     FrameResource& GetPreFrameResource() const { return m_frameResources[(m_frameIndex+m_frameCount-1)%m_frameCount]; }
     
     uint8_t           GetFrameCount() const { return m_frameCount; };
+    uint8_t           GetFrameIndex() const { return m_frameIndex; };
     MainConstBuffer&  GetMainConstBuffer(){ return m_mainConstBuffer; };
 
     CD3DX12_CPU_DESCRIPTOR_HANDLE GetTexCpuHandle() const{
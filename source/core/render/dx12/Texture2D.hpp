@@ -1,6 +1,7 @@
 #pragma once
 #include "GpuResource.hpp"
 #include "DxUtility.hpp"
+#include <vector>
 
 class Texture2D : public GpuResource{
 public:
@@ -65,6 +66,38 @@ public:
         ChangeState(cmdList, D3D12_RESOURCE_STATE_COMMON);
     }
 
+    // every mip level from the upload buffer, footprints[i] is where level i sits in it
+    Texture2D(
+        const ComPtr<ID3D12Device8>& device,
+        const ComPtr<ID3D12GraphicsCommandList2>& cmdList, UploadBuffer& uploadBuffer,
+        const DXGI_FORMAT format, const uint32_t width, const uint32_t height,
+        const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& footprints
+    ) : GpuResource()
+      , m_format(format)
+      , m_width(width)
+      , m_height(height)
+    {
+
+		ThrowIfFailed(device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Tex2D(
+                format, width, height, 1, static_cast<UINT16>(footprints.size()), 1, 0,
+                D3D12_RESOURCE_FLAG_NONE
+            ), m_usageState, nullptr, IID_PPV_ARGS(m_resource.GetAddressOf()))
+		);
+
+        ChangeState(cmdList, D3D12_RESOURCE_STATE_COPY_DEST);
+
+        for(uint32_t level = 0; level < footprints.size(); level++){
+            cmdList->CopyTextureRegion(
+                &CD3DX12_TEXTURE_COPY_LOCATION( m_resource.Get(), level ), 0, 0, 0,
+                &CD3DX12_TEXTURE_COPY_LOCATION( uploadBuffer.GetResource(), footprints[level]), nullptr
+            );
+        }
+
+        ChangeState(cmdList, D3D12_RESOURCE_STATE_COMMON);
+    }
+
     void ChangeState(const ComPtr<ID3D12GraphicsCommandList2>& cmdList, D3D12_RESOURCE_STATES state){
         if(m_transitioningState != state){
             cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
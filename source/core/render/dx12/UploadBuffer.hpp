@@ -37,4 +37,13 @@ public:
 		m_resource->Unmap(0, &range);
 	}
 
+	// upload heaps may stay mapped while the gpu reads them, the cpu writes straight into the pointer
+	uint8_t* Map() const {
+		void* mappedData;
+
+		D3D12_RANGE range{0, 0};
+		ThrowIfFailed(m_resource->Map(0, &range, &mappedData));
+		return reinterpret_cast<uint8_t*>(mappedData);
+	}
+
 };
\ No newline at end of file
@@ -0,0 +1,622 @@
+#include "BlockCompressor.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace Utility{
+
+    namespace{
+
+        // 16 texels of a block, RGBA in 0..255
+        using Texels = float[16][4];
+
+        // interpolation weights of 4 bit BC7 indices, out of 64
+        const int Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        int Clamp(int v, int lo, int hi){
+            return v < lo ? lo : (v > hi ? hi : v);
+        }
+
+        int Round(float v){
+            return static_cast<int>(std::floor(v + 0.5f));
+        }
+
+        uint32_t Align(uint32_t size, uint32_t alignment){
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        // endpoints at the extremes of the texels along their principal axis, over the first n channels
+        void PrincipalAxis(const Texels& px, int n, float lo[4], float hi[4]){
+            float mean[4] = {};
+            for(int i = 0; i < 16; i++){
+                for(int c = 0; c < n; c++) mean[c] += px[i][c] / 16.0f;
+            }
+
+            float cov[4][4] = {};
+            for(int i = 0; i < 16; i++){
+                for(int a = 0; a < n; a++){
+                    for(int b = 0; b < n; b++) cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+                }
+            }
+
+            // power iteration from the channel that varies the most
+            float axis[4] = {};
+            int   widest  = 0;
+            for(int c = 1; c < n; c++) widest = cov[c][c] > cov[widest][widest] ? c : widest;
+            axis[widest] = 1.0f;
+            for(int k = 0; k < 8; k++){
+                float next[4] = {}, length = 0.0f;
+                for(int a = 0; a < n; a++){
+                    for(int b = 0; b < n; b++) next[a] += cov[a][b] * axis[b];
+                    length += next[a] * next[a];
+                }
+                if(length < 1e-12f) break;
+                length = 1.0f / std::sqrt(length);
+                for(int c = 0; c < n; c++) axis[c] = next[c] * length;
+            }
+
+            float tMin = 0.0f, tMax = 0.0f;
+            for(int i = 0; i < 16; i++){
+                float t = 0.0f;
+                for(int c = 0; c < n; c++) t += (px[i][c] - mean[c]) * axis[c];
+                tMin = t < tMin ? t : tMin;
+                tMax = t > tMax ? t : tMax;
+            }
+            for(int c = 0; c < n; c++){
+                float l = mean[c] + axis[c] * tMin, h = mean[c] + axis[c] * tMax;
+                lo[c] = l < 0.0f ? 0.0f : (l > 255.0f ? 255.0f : l);
+                hi[c] = h < 0.0f ? 0.0f : (h > 255.0f ? 255.0f : h);
+            }
+        }
+
+        // least squares endpoints for fixed indices, w[i] is where texel i sits between e0 and e1
+        bool FitEndpoints(const Texels& px, int n, const float w[16], float e0[4], float e1[4]){
+            float a = 0.0f, b = 0.0f, c = 0.0f, d0[4] = {}, d1[4] = {};
+            for(int i = 0; i < 16; i++){
+                const float u = 1.0f - w[i];
+                a += u * u;
+                b += u * w[i];
+                c += w[i] * w[i];
+                for(int k = 0; k < n; k++){
+                    d0[k] += u * px[i][k];
+                    d1[k] += w[i] * px[i][k];
+                }
+            }
+
+            const float det = a * c - b * b;
+            if(std::fabs(det) < 1e-6f) return false;
+            for(int k = 0; k < n; k++){
+                float l = (c * d0[k] - b * d1[k]) / det, h = (a * d1[k] - b * d0[k]) / det;
+                e0[k] = l < 0.0f ? 0.0f : (l > 255.0f ? 255.0f : l);
+                e1[k] = h < 0.0f ? 0.0f : (h > 255.0f ? 255.0f : h);
+            }
+            return true;
+        }
+
+        int GetIterations(BlockCompressor::Quality quality){
+            return quality == BlockCompressor::Quality::Fast ? 0 : (quality == BlockCompressor::Quality::Normal ? 1 : 8);
+        }
+
+        class BitWriter{
+        public:
+            explicit BitWriter(uint8_t* block) : m_block(block), m_position(0) { memset(block, 0, 16); }
+
+            void Write(uint32_t value, uint32_t bits){
+                for(uint32_t i = 0; i < bits; i++, m_position++){
+                    m_block[m_position >> 3] |= ((value >> i) & 1) << (m_position & 7);
+                }
+            }
+
+        private:
+            uint8_t* m_block;
+            uint32_t m_position;
+        };
+
+        class BitReader{
+        public:
+            explicit BitReader(const uint8_t* block) : m_block(block), m_position(0) {}
+
+            uint32_t Read(uint32_t bits){
+                uint32_t value = 0;
+                for(uint32_t i = 0; i < bits; i++, m_position++){
+                    value |= ((m_block[m_position >> 3] >> (m_position & 7)) & 1) << i;
+                }
+                return value;
+            }
+
+        private:
+            const uint8_t* m_block;
+            uint32_t       m_position;
+        };
+
+        // BC1 color
+
+        uint16_t Quantize565(const float c[3]){
+            return static_cast<uint16_t>(Clamp(Round(c[0] * 31.0f / 255.0f), 0, 31) << 11 | Clamp(Round(c[1] * 63.0f / 255.0f), 0, 63) << 5 | Clamp(Round(c[2] * 31.0f / 255.0f), 0, 31));
+        }
+
+        void Expand565(uint16_t c, int rgb[3]){
+            const int r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+            rgb[0] = r << 3 | r >> 2;
+            rgb[1] = g << 2 | g >> 4;
+            rgb[2] = b << 3 | b >> 2;
+        }
+
+        // 4 color palette, or 3 colors and transparent black when c0 <= c1 outside BC3
+        void BuildColorPalette(uint16_t c0, uint16_t c1, bool isFourColor, int palette[4][4]){
+            Expand565(c0, palette[0]);
+            Expand565(c1, palette[1]);
+            palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+            for(int c = 0; c < 3; c++){
+                if(isFourColor){
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+                }
+                else{
+                    palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            if(!isFourColor) palette[3][3] = 0;
+        }
+
+        float IndexColor(const Texels& px, uint16_t c0, uint16_t c1, uint8_t indices[16]){
+            int palette[4][4];
+            BuildColorPalette(c0, c1, true, palette);
+
+            float error = 0.0f;
+            for(int i = 0; i < 16; i++){
+                float best = 1e30f;
+                for(int p = 0; p < 4; p++){
+                    float d = 0.0f;
+                    for(int c = 0; c < 3; c++) d += (px[i][c] - palette[p][c]) * (px[i][c] - palette[p][c]);
+                    if(d < best){
+                        best       = d;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        // always in 4 color mode, c0 > c1 unless the block is a single color
+        void EncodeColor(const Texels& px, BlockCompressor::Quality quality, uint8_t* block){
+            const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+            float e0[4], e1[4];
+            PrincipalAxis(px, 3, e1, e0);
+
+            uint16_t bestC0 = 0, bestC1 = 0;
+            uint8_t  bestIndices[16] = {}, indices[16];
+            float    bestError = 1e30f;
+            for(int iteration = 0; iteration <= GetIterations(quality); iteration++){
+                uint16_t c0 = Quantize565(e0), c1 = Quantize565(e1);
+                if(c0 < c1){
+                    uint16_t t = c0;
+                    c0 = c1;
+                    c1 = t;
+                }
+
+                const float error = c0 == c1 ? 1e30f : IndexColor(px, c0, c1, indices);
+                if(c0 == c1 && iteration == 0){
+                    bestC0 = bestC1 = c0;
+                    memset(bestIndices, 0, sizeof(bestIndices));
+                    break;
+                }
+                if(error >= bestError) break;
+
+                bestError = error;
+                bestC0    = c0;
+                bestC1    = c1;
+                memcpy(bestIndices, indices, sizeof(indices));
+
+                float w[16];
+                for(int i = 0; i < 16; i++) w[i] = weights[indices[i]];
+                if(!FitEndpoints(px, 3, w, e0, e1)) break;
+            }
+
+            block[0] = static_cast<uint8_t>(bestC0);
+            block[1] = static_cast<uint8_t>(bestC0 >> 8);
+            block[2] = static_cast<uint8_t>(bestC1);
+            block[3] = static_cast<uint8_t>(bestC1 >> 8);
+            uint32_t bits = 0;
+            for(int i = 0; i < 16; i++) bits |= uint32_t(bestIndices[i]) << (i * 2);
+            memcpy(block + 4, &bits, 4);
+        }
+
+        void DecodeColor(const uint8_t* block, bool isBC1, uint8_t texels[64]){
+            const uint16_t c0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+            const uint16_t c1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+            int palette[4][4];
+            BuildColorPalette(c0, c1, !isBC1 || c0 > c1, palette);
+
+            uint32_t bits;
+            memcpy(&bits, block + 4, 4);
+            for(int i = 0; i < 16; i++){
+                const int* color = palette[(bits >> (i * 2)) & 3];
+                for(int c = 0; c < 4; c++) texels[i * 4 + c] = static_cast<uint8_t>(color[c]);
+            }
+        }
+
+        // BC4 single channel, 8 value mode
+
+        void BuildValuePalette(int r0, int r1, int palette[8]){
+            palette[0] = r0;
+            palette[1] = r1;
+            if(r0 > r1){
+                for(int i = 2; i < 8; i++) palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+            }
+            else{
+                for(int i = 2; i < 6; i++) palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        float IndexValue(const Texels& px, int channel, int r0, int r1, uint8_t indices[16]){
+            int palette[8];
+            BuildValuePalette(r0, r1, palette);
+
+            float error = 0.0f;
+            for(int i = 0; i < 16; i++){
+                float best = 1e30f;
+                for(int p = 0; p < 8; p++){
+                    float d = (px[i][channel] - palette[p]) * (px[i][channel] - palette[p]);
+                    if(d < best){
+                        best       = d;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        void EncodeValue(const Texels& px, int channel, BlockCompressor::Quality quality, uint8_t* block){
+            float lo = 255.0f, hi = 0.0f;
+            for(int i = 0; i < 16; i++){
+                lo = px[i][channel] < lo ? px[i][channel] : lo;
+                hi = px[i][channel] > hi ? px[i][channel] : hi;
+            }
+
+            int     bestR0 = Round(hi), bestR1 = Round(lo);
+            uint8_t bestIndices[16] = {}, indices[16];
+            if(bestR0 != bestR1){
+                float e0[4] = {hi}, e1[4] = {lo}, bestError = 1e30f;
+                Texels values;
+                for(int i = 0; i < 16; i++) values[i][0] = px[i][channel];
+
+                for(int iteration = 0; iteration <= GetIterations(quality); iteration++){
+                    int r0 = Round(e0[0]), r1 = Round(e1[0]);
+                    if(r0 < r1){
+                        int t = r0;
+                        r0 = r1;
+                        r1 = t;
+                    }
+                    if(r0 == r1) break;
+
+                    const float error = IndexValue(values, 0, r0, r1, indices);
+                    if(error >= bestError) break;
+
+                    bestError = error;
+                    bestR0    = r0;
+                    bestR1    = r1;
+                    memcpy(bestIndices, indices, sizeof(indices));
+
+                    float w[16];
+                    for(int i = 0; i < 16; i++) w[i] = indices[i] == 0 ? 0.0f : (indices[i] == 1 ? 1.0f : (indices[i] - 1) / 7.0f);
+                    if(!FitEndpoints(values, 1, w, e0, e1)) break;
+                }
+            }
+
+            block[0] = static_cast<uint8_t>(bestR0);
+            block[1] = static_cast<uint8_t>(bestR1);
+            uint64_t bits = 0;
+            for(int i = 0; i < 16; i++) bits |= uint64_t(bestIndices[i]) << (i * 3);
+            for(int i = 0; i < 6; i++) block[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+        }
+
+        void DecodeValue(const uint8_t* block, int channel, uint8_t texels[64]){
+            int palette[8];
+            BuildValuePalette(block[0], block[1], palette);
+
+            uint64_t bits = 0;
+            for(int i = 0; i < 6; i++) bits |= uint64_t(block[2 + i]) << (i * 8);
+            for(int i = 0; i < 16; i++) texels[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+        }
+
+        // BC7 mode 6
+
+        // 8 bit endpoint with p as its lowest bit
+        void QuantizeMode6(const float e[4], int p, int q[4]){
+            for(int c = 0; c < 4; c++) q[c] = Clamp(Round((e[c] - p) * 0.5f), 0, 127) << 1 | p;
+        }
+
+        float QuantizationError(const float e[4], const int q[4]){
+            float error = 0.0f;
+            for(int c = 0; c < 4; c++) error += (e[c] - q[c]) * (e[c] - q[c]);
+            return error;
+        }
+
+        float IndexMode6(const Texels& px, const int q0[4], const int q1[4], uint8_t indices[16]){
+            int palette[16][4];
+            for(int p = 0; p < 16; p++){
+                for(int c = 0; c < 4; c++) palette[p][c] = ((64 - Weights4[p]) * q0[c] + Weights4[p] * q1[c] + 32) >> 6;
+            }
+
+            float axis[4], length = 0.0f;
+            for(int c = 0; c < 4; c++){
+                axis[c] = float(q1[c] - q0[c]);
+                length += axis[c] * axis[c];
+            }
+            length = length > 0.0f ? 1.0f / length : 0.0f;
+
+            // the projection lands next to the nearest entry, the weights are not quite even
+            float error = 0.0f;
+            for(int i = 0; i < 16; i++){
+                float t = 0.0f;
+                for(int c = 0; c < 4; c++) t += (px[i][c] - q0[c]) * axis[c];
+                const int guess = Clamp(Round(t * length * 15.0f), 0, 15);
+
+                float best = 1e30f;
+                for(int p = guess > 0 ? guess - 1 : 0; p <= (guess < 15 ? guess + 1 : 15); p++){
+                    float d = 0.0f;
+                    for(int c = 0; c < 4; c++) d += (px[i][c] - palette[p][c]) * (px[i][c] - palette[p][c]);
+                    if(d < best){
+                        best       = d;
+                        indices[i] = static_cast<uint8_t>(p);
+                    }
+                }
+                error += best;
+            }
+            return error;
+        }
+
+        void EncodeMode6(const Texels& px, BlockCompressor::Quality quality, uint8_t* block){
+            float e0[4], e1[4];
+            PrincipalAxis(px, 4, e0, e1);
+
+            int     best0[4] = {}, best1[4] = {}, q0[4], q1[4];
+            uint8_t bestIndices[16] = {}, indices[16];
+            float   bestError = 1e30f;
+            for(int iteration = 0; iteration <= GetIterations(quality); iteration++){
+                float error = 1e30f;
+                if(quality == BlockCompressor::Quality::High){
+                    // every pair of p-bits against the whole block
+                    int t0[4], t1[4];
+                    uint8_t t[16];
+                    for(int p = 0; p < 4; p++){
+                        QuantizeMode6(e0, p & 1, t0);
+                        QuantizeMode6(e1, p >> 1, t1);
+                        float e = IndexMode6(px, t0, t1, t);
+                        if(e < error){
+                            error = e;
+                            memcpy(q0, t0, sizeof(t0));
+                            memcpy(q1, t1, sizeof(t1));
+                            memcpy(indices, t, sizeof(t));
+                        }
+                    }
+                }
+                else{
+                    // the p-bit closest to each endpoint on its own
+                    int a[4], b[4];
+                    QuantizeMode6(e0, 0, a);
+                    QuantizeMode6(e0, 1, b);
+                    memcpy(q0, QuantizationError(e0, a) <= QuantizationError(e0, b) ? a : b, sizeof(a));
+                    QuantizeMode6(e1, 0, a);
+                    QuantizeMode6(e1, 1, b);
+                    memcpy(q1, QuantizationError(e1, a) <= QuantizationError(e1, b) ? a : b, sizeof(a));
+                    error = IndexMode6(px, q0, q1, indices);
+                }
+                if(error >= bestError) break;
+
+                bestError = error;
+                memcpy(best0, q0, sizeof(q0));
+                memcpy(best1, q1, sizeof(q1));
+                memcpy(bestIndices, indices, sizeof(indices));
+
+                float w[16];
+                for(int i = 0; i < 16; i++) w[i] = Weights4[indices[i]] / 64.0f;
+                if(!FitEndpoints(px, 4, w, e0, e1)) break;
+            }
+
+            // the first index drops its top bit, swapping the endpoints clears it
+            if(bestIndices[0] & 8){
+                for(int c = 0; c < 4; c++){
+                    int t = best0[c];
+                    best0[c] = best1[c];
+                    best1[c] = t;
+                }
+                for(int i = 0; i < 16; i++) bestIndices[i] = static_cast<uint8_t>(15 - bestIndices[i]);
+            }
+
+            BitWriter writer(block);
+            writer.Write(1 << 6, 7);
+            for(int c = 0; c < 4; c++){
+                writer.Write(best0[c] >> 1, 7);
+                writer.Write(best1[c] >> 1, 7);
+            }
+            writer.Write(best0[0] & 1, 1);
+            writer.Write(best1[0] & 1, 1);
+            writer.Write(bestIndices[0], 3);
+            for(int i = 1; i < 16; i++) writer.Write(bestIndices[i], 4);
+        }
+
+        bool DecodeMode6(const uint8_t* block, uint8_t texels[64]){
+            BitReader reader(block);
+            if(reader.Read(7) != 1 << 6) return false;
+
+            int q0[4], q1[4];
+            for(int c = 0; c < 4; c++){
+                q0[c] = reader.Read(7) << 1;
+                q1[c] = reader.Read(7) << 1;
+            }
+            const int p0 = reader.Read(1), p1 = reader.Read(1);
+            for(int c = 0; c < 4; c++){
+                q0[c] |= p0;
+                q1[c] |= p1;
+            }
+
+            for(int i = 0; i < 16; i++){
+                const int w = Weights4[reader.Read(i == 0 ? 3 : 4)];
+                for(int c = 0; c < 4; c++) texels[i * 4 + c] = static_cast<uint8_t>(((64 - w) * q0[c] + w * q1[c] + 32) >> 6);
+            }
+            return true;
+        }
+
+        void EncodeBlock(BlockCompressor::Format format, const Texels& px, BlockCompressor::Quality quality, uint8_t* block){
+            switch(format){
+                case BlockCompressor::Format::BC1:
+                    EncodeColor(px, quality, block);
+                    break;
+                case BlockCompressor::Format::BC3:
+                    EncodeValue(px, 3, quality, block);
+                    EncodeColor(px, quality, block + 8);
+                    break;
+                case BlockCompressor::Format::BC4:
+                    EncodeValue(px, 0, quality, block);
+                    break;
+                case BlockCompressor::Format::BC5:
+                    EncodeValue(px, 0, quality, block);
+                    EncodeValue(px, 1, quality, block + 8);
+                    break;
+                case BlockCompressor::Format::BC7:
+                    EncodeMode6(px, quality, block);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    }
+
+    BlockCompressor::Format BlockCompressor::SelectFormat(Usage usage, Quality quality, bool isOpaque){
+        switch(usage){
+            case Usage::Color:
+                if(quality != Quality::Fast) return Format::BC7;
+                return isOpaque ? Format::BC1 : Format::BC3;
+            case Usage::SingleChannel:
+                return Format::BC4;
+            default:
+                return Format::BC7;
+        }
+    }
+
+    uint32_t BlockCompressor::GetBlockSize(Format format){
+        switch(format){
+            case Format::BC1:
+            case Format::BC4:
+                return 8;
+            case Format::BC3:
+            case Format::BC5:
+            case Format::BC7:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    uint64_t BlockCompressor::GetLayout(Format format, uint32_t width, uint32_t height, uint32_t levelCount, std::vector<MipGenerator::Level>& levels){
+        if(format == Format::RGBA8) return MipGenerator::GetLayout(width, height, levelCount, levels);
+
+        levels.resize(levelCount);
+        uint64_t offset = 0;
+        for(uint32_t i = 0; i < levelCount; i++){
+            const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+            auto& level    = levels[i];
+            level.width    = width;
+            level.height   = height;
+            level.rowPitch = Align(blocksX * GetBlockSize(format), MipGenerator::PitchAlignment);
+            level.offset   = (offset + MipGenerator::PlacementAlignment - 1) / MipGenerator::PlacementAlignment * MipGenerator::PlacementAlignment;
+            offset = level.offset + uint64_t(level.rowPitch) * blocksY;
+
+            width  = width  > 1 ? width  / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return offset;
+    }
+
+    MipGenerator::MipChain BlockCompressor::Compress(const MipGenerator::MipChain& chain, Format format, Quality quality, WorkerPool* pool){
+        if(format == Format::RGBA8 || chain.levels.empty()) return chain;
+
+        MipGenerator::MipChain compressed;
+        const auto& top = chain.levels[0];
+        compressed.data.resize(GetLayout(format, top.width, top.height, static_cast<uint32_t>(chain.levels.size()), compressed.levels), 0);
+
+        // block rows of every level as one list, the small levels would leave most of the pool idle on their own
+        struct Row{
+            uint32_t level;
+            uint32_t y;
+        };
+        std::vector<Row> rows;
+        for(uint32_t l = 0; l < chain.levels.size(); l++){
+            for(uint32_t y = 0; y < (chain.levels[l].height + 3) / 4; y++) rows.push_back({l, y});
+        }
+
+        const uint32_t blockSize = GetBlockSize(format);
+        auto EncodeRows = [&](size_t begin, size_t end){
+            Texels px;
+            for(size_t r = begin; r < end; r++){
+                const auto& src = chain.levels[rows[r].level];
+                const auto& dst = compressed.levels[rows[r].level];
+                uint8_t* out = compressed.data.data() + dst.offset + size_t(rows[r].y) * dst.rowPitch;
+
+                for(uint32_t bx = 0; bx < (src.width + 3) / 4; bx++){
+                    // texels past the edge of levels under 4 texels repeat the last ones
+                    for(uint32_t i = 0; i < 16; i++){
+                        uint32_t x = bx * 4 + i % 4, y = rows[r].y * 4 + i / 4;
+                        x = x < src.width  ? x : src.width  - 1;
+                        y = y < src.height ? y : src.height - 1;
+                        const uint8_t* texel = chain.data.data() + src.offset + size_t(y) * src.rowPitch + x * 4;
+                        for(int c = 0; c < 4; c++) px[i][c] = texel[c];
+                    }
+                    EncodeBlock(format, px, quality, out + bx * blockSize);
+                }
+            }
+        };
+
+        if(pool != nullptr) pool->ParallelFor(rows.size(), 4, EncodeRows);
+        else                EncodeRows(0, rows.size());
+        return compressed;
+    }
+
+    bool BlockCompressor::DecodeBlock(Format format, const uint8_t* block, uint8_t texels[64]){
+        for(int i = 0; i < 16; i++){
+            texels[i * 4 + 0] = texels[i * 4 + 1] = texels[i * 4 + 2] = 0;
+            texels[i * 4 + 3] = 255;
+        }
+
+        switch(format){
+            case Format::BC1:
+                DecodeColor(block, true, texels);
+                return true;
+            case Format::BC3:
+                DecodeColor(block + 8, false, texels);
+                DecodeValue(block, 3, texels);
+                return true;
+            case Format::BC4:
+                DecodeValue(block, 0, texels);
+                return true;
+            case Format::BC5:
+                DecodeValue(block, 0, texels);
+                DecodeValue(block + 8, 1, texels);
+                return true;
+            case Format::BC7:
+                return DecodeMode6(block, texels);
+            default:
+                return false;
+        }
+    }
+
+    bool BlockCompressor::IsOpaque(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t pitch){
+        for(uint32_t y = 0; y < height; y++){
+            const uint8_t* row = texels + size_t(y) * pitch;
+            for(uint32_t x = 0; x < width; x++){
+                if(row[x * 4 + 3] != 255) return false;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "MipGenerator.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utility{
+
+    // Encodes RGBA8 mip chains into the BC formats the GPU samples directly, 4x4 texels a block.
+    // Endpoints come from the principal axis of each block and are refined by least squares, the
+    // presets trade how long that goes on against quality. BC7 only writes mode 6, one subset with
+    // 7 bit RGBA endpoints and 4 bit indices, which does well on albedo and keeps the encoder simple.
+    // Compressed levels are laid out like MipGenerator lays out RGBA8 ones, a row of blocks per row.
+    class BlockCompressor{
+    public:
+        // same values as the texture formats of scene packages
+        enum class Format : uint32_t{
+            RGBA8,      // uncompressed
+            BC1,        // RGB, 4 bits a texel
+            BC3,        // RGBA, BC1 color with a BC4 alpha block
+            BC4,        // R, 4 bits a texel
+            BC5,        // RG, two BC4 blocks, not selected for any usage yet
+            BC7         // RGBA, 8 bits a texel
+        };
+
+        enum class Quality{
+            Fast,       // principal axis endpoints only, BC1 and BC3 for color
+            Normal,     // one least squares pass, BC7 for color
+            High        // refined until it stops improving, every p-bit pair of BC7 tried
+        };
+
+        // how the materials sample an image, picks the format
+        enum class Usage{
+            Color,          // base color, diffuse and emissive
+            Normal,         // tangent space normals, kept in BC7 with z since no shader rebuilds it from a BC5 x and y
+            SingleChannel,  // occlusion, read from red
+            Data            // metallic roughness and anything else, every channel kept
+        };
+
+        static Format   SelectFormat(Usage usage, Quality quality, bool isOpaque);
+        // bytes of a 4x4 block, 0 for RGBA8
+        static uint32_t GetBlockSize(Format format);
+        // footprints of levelCount levels in format, returns the bytes they take
+        static uint64_t GetLayout(Format format, uint32_t width, uint32_t height, uint32_t levelCount, std::vector<MipGenerator::Level>& levels);
+
+        // every level of an RGBA8 chain in format, block rows are spread over pool when one is given.
+        // The top level must be a multiple of 4 texels in both directions, smaller levels are padded
+        static MipGenerator::MipChain Compress(const MipGenerator::MipChain& chain, Format format, Quality quality, WorkerPool* pool = nullptr);
+
+        // RGBA8 texels of a block, channels a format lacks read as 0 and alpha as 255. False for
+        // BC7 modes the encoder does not write
+        static bool DecodeBlock(Format format, const uint8_t* block, uint8_t texels[64]);
+
+        static bool IsOpaque(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t pitch);
+    };
+
+}
@@ -0,0 +1,79 @@
+#include "CpuFeature.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace Utility{
+
+    namespace{
+
+        void CpuId(uint32_t leaf, uint32_t subLeaf, uint32_t regs[4]){
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subLeaf));
+            for(int i = 0; i < 4; i++) regs[i] = static_cast<uint32_t>(info[i]);
+#else
+            __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+
+        uint64_t XGetBv(){
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+
+        SimdLevel Detect(){
+            uint32_t regs[4];
+            CpuId(0, 0, regs);
+            const uint32_t maxLeaf = regs[0];
+
+            CpuId(1, 0, regs);
+            const uint32_t ecx1 = regs[2];
+            if((ecx1 & (1u << 19)) == 0) return SimdLevel::Scalar;
+
+            // AVX state has to be enabled by the os as well, OSXSAVE then XCR0 bits 1,2
+            const bool osxsave = (ecx1 & (1u << 27)) != 0;
+            const bool avx     = (ecx1 & (1u << 28)) != 0;
+            const bool fma     = (ecx1 & (1u << 12)) != 0;
+            const bool f16c    = (ecx1 & (1u << 29)) != 0;
+            if(!osxsave || !avx || !fma || !f16c || maxLeaf < 7) return SimdLevel::SSE41;
+
+            const uint64_t xcr0 = XGetBv();
+            if((xcr0 & 0x6) != 0x6) return SimdLevel::SSE41;
+
+            CpuId(7, 0, regs);
+            const uint32_t ebx7 = regs[1];
+            if((ebx7 & (1u << 5)) == 0) return SimdLevel::SSE41;
+
+            // opmask and both halves of zmm0-31, XCR0 bits 5,6,7
+            if((ebx7 & (1u << 16)) == 0 || (xcr0 & 0xE0) != 0xE0) return SimdLevel::AVX2;
+
+            return SimdLevel::AVX512;
+        }
+
+    }
+
+    SimdLevel GetCpuSimdLevel(){
+        static const SimdLevel level = Detect();
+        return level;
+    }
+
+    const char* GetSimdLevelName(SimdLevel level){
+        switch(level){
+            case SimdLevel::Scalar: return "Scalar";
+            case SimdLevel::SSE41:  return "SSE4.1";
+            case SimdLevel::AVX2:   return "AVX2";
+            case SimdLevel::AVX512: return "AVX-512";
+            default:                return "Unknown";
+        }
+    }
+
+}
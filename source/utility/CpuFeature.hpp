@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+namespace Utility{
+
+    // instruction sets the batch kernels are built for, ordered so a higher level implies the lower ones
+    enum class SimdLevel : uint8_t{
+        Scalar = 0,
+        SSE41  = 1,
+        AVX2   = 2,     // with FMA and F16C
+        AVX512 = 3,     // AVX-512F
+    };
+
+    // highest level both the cpu and the os (saved register state) support, detected once
+    SimdLevel GetCpuSimdLevel();
+
+    const char* GetSimdLevelName(SimdLevel level);
+
+}
@@ -0,0 +1,158 @@
+#include "FrameScheduler.hpp"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace Utility{
+
+    namespace{
+
+        double Seconds(FrameScheduler::Clock::duration duration){
+            return std::chrono::duration<double>(duration).count();
+        }
+
+        FrameScheduler::Clock::duration ToDuration(double seconds){
+            return std::chrono::duration_cast<FrameScheduler::Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        void Blend(FrameScheduler::FrameStats& average, const FrameScheduler::FrameStats& frame, double weight){
+            average.cpuTime   += (frame.cpuTime   - average.cpuTime)   * weight;
+            average.slack     += (frame.slack     - average.slack)     * weight;
+            average.sleepTime += (frame.sleepTime - average.sleepTime) * weight;
+            average.yieldTime += (frame.yieldTime - average.yieldTime) * weight;
+            average.steps     += (frame.steps     - average.steps)     * weight;
+        }
+
+    }
+
+    FrameScheduler::FrameScheduler()
+        : FrameScheduler(Settings())
+    {
+    }
+
+    FrameScheduler::FrameScheduler(const Settings& settings)
+        : m_settings(settings)
+        , m_isStarted(false)
+        , m_accumulator(0.0)
+        , m_sleepMargin(MaxSleepMargin)
+        , m_timer(nullptr)
+    {
+#ifdef _WIN32
+        // high resolution timers wake within a fraction of a millisecond, older systems only have the default one
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if(m_timer == nullptr) m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+#endif
+    }
+
+    FrameScheduler::~FrameScheduler(){
+#ifdef _WIN32
+        if(m_timer != nullptr) CloseHandle(m_timer);
+#endif
+    }
+
+    void FrameScheduler::SetSettings(const Settings& settings){
+        m_settings = settings;
+        m_accumulator = m_accumulator < m_settings.stepTime ? m_accumulator : 0.0;
+        m_nextFrame = m_frameBegin + ToDuration(m_settings.frameTime);
+    }
+
+    bool FrameScheduler::IsFrameDue() const{
+        return !m_isStarted || m_settings.frameTime <= 0.0 || Clock::now() >= m_nextFrame;
+    }
+
+    void FrameScheduler::WaitForFrame(){
+        if(IsFrameDue()) return;
+
+        Clock::time_point now  = Clock::now();
+        Clock::time_point wake = m_nextFrame - ToDuration(m_sleepMargin);
+        if(now < wake){
+            SleepFor(wake - now);
+            Clock::time_point woke = Clock::now();
+
+            // the margin jumps up to a late wake at once and decays slowly after it
+            double late = Seconds(woke - wake);
+            m_sleepMargin = late > m_sleepMargin ? late : m_sleepMargin + (late - m_sleepMargin) / 16.0;
+            m_sleepMargin = m_sleepMargin < MinSleepMargin ? MinSleepMargin : m_sleepMargin;
+            m_sleepMargin = m_sleepMargin > MaxSleepMargin ? MaxSleepMargin : m_sleepMargin;
+
+            m_waited.sleepTime += Seconds(woke - now);
+            now = woke;
+        }
+
+        Clock::time_point yieldBegin = now;
+        while(now < m_nextFrame){
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+        m_waited.yieldTime += Seconds(now - yieldBegin);
+    }
+
+    uint32_t FrameScheduler::BeginFrame(){
+        Clock::time_point now = Clock::now();
+        if(!m_isStarted){
+            // the first frame shows one simulated step
+            m_isStarted   = true;
+            m_frameBegin  = now;
+            m_nextFrame   = now;
+            m_accumulator = m_settings.stepTime;
+        }
+
+        m_accumulator += Seconds(now - m_frameBegin);
+        m_frameBegin = now;
+
+        uint32_t steps = static_cast<uint32_t>(m_accumulator / m_settings.stepTime);
+        if(steps > m_settings.maxStepsPerFrame){
+            steps = m_settings.maxStepsPerFrame;
+            m_accumulator = 0.0;
+        }
+        else{
+            m_accumulator -= steps * m_settings.stepTime;
+        }
+
+        // frames keep their cadence, unless one started so late that catching up would bunch the next ones
+        m_nextFrame += ToDuration(m_settings.frameTime);
+        if(m_nextFrame <= now) m_nextFrame = now + ToDuration(m_settings.frameTime);
+
+        m_lastFrame = m_waited;
+        m_lastFrame.steps = steps;
+        m_waited = FrameStats();
+        return steps;
+    }
+
+    void FrameScheduler::EndFrame(){
+        Clock::time_point now = Clock::now();
+        m_lastFrame.cpuTime = Seconds(now - m_frameBegin);
+        m_lastFrame.slack   = m_settings.frameTime > 0.0 ? Seconds(m_nextFrame - now) : 0.0;
+
+        Blend(m_average, m_lastFrame, 1.0 / 32.0);
+    }
+
+    double FrameScheduler::GetTimeToNextStep() const{
+        if(!m_isStarted) return 0.0;
+        double time = m_settings.stepTime - m_accumulator - Seconds(Clock::now() - m_frameBegin);
+        return time > 0.0 ? time : 0.0;
+    }
+
+    void FrameScheduler::SleepFor(Clock::duration duration){
+#ifdef _WIN32
+        if(m_timer != nullptr){
+            // relative due time, in 100 ns units
+            LARGE_INTEGER due;
+            due.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100);
+            if(SetWaitableTimerEx(m_timer, &due, 0, nullptr, nullptr, nullptr, 0)){
+                WaitForSingleObject(m_timer, INFINITE);
+                return;
+            }
+        }
+#endif
+        std::this_thread::sleep_for(duration);
+    }
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace Utility{
+
+    // Paces the main loop. The simulation advances in fixed steps while frames are rendered at their own
+    // rate, a frame runs the steps that fell due since the one before and the leftover part of a step is
+    // the interpolation factor between the last two simulated states. The time until the next frame is
+    // slept away, only the last stretch, as long as the timer tends to oversleep, is yielded.
+    class FrameScheduler{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Settings{
+            // simulated seconds per step
+            double   stepTime         = 1.0 / 60.0;
+            // seconds between frames, 0 starts a frame as soon as the last one ended and leaves pacing to present
+            double   frameTime        = 1.0 / 60.0;
+            // after a stall the time beyond this many steps is dropped instead of caught up
+            uint32_t maxStepsPerFrame = 4;
+        };
+
+        // seconds, the averages are moving ones over the last few dozen frames
+        struct FrameStats{
+            // from BeginFrame to EndFrame, waits for the gpu and present included
+            double cpuTime   = 0.0;
+            // left at EndFrame until the next frame is due, negative when the frame ran over
+            double slack     = 0.0;
+            // spent before the frame in sleep and in yielding
+            double sleepTime = 0.0;
+            double yieldTime = 0.0;
+            double steps     = 0.0;
+        };
+
+        FrameScheduler();
+        explicit FrameScheduler(const Settings& settings);
+        ~FrameScheduler();
+
+        FrameScheduler(const FrameScheduler&)            = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        void            SetSettings(const Settings& settings);
+        const Settings& GetSettings() const { return m_settings; }
+
+        bool IsFrameDue() const;
+        // sleeps until the next frame is due, returns at once when it already is
+        void WaitForFrame();
+
+        // starts a frame, returns how many steps to simulate before rendering it
+        uint32_t BeginFrame();
+        void     EndFrame();
+
+        // seconds until the next step falls due, 0 before the first frame and when one is due already
+        double GetTimeToNextStep() const;
+
+        // [0, 1), how far the frame is between the last simulated step and the next one
+        float GetInterpolation() const { return static_cast<float>(m_accumulator / m_settings.stepTime); }
+
+        const FrameStats& GetLastFrame() const { return m_lastFrame; }
+        const FrameStats& GetAverage()   const { return m_average; }
+
+        // bounds of the learned oversleep of the timer
+        inline static const double MinSleepMargin = 0.0001;
+        inline static const double MaxSleepMargin = 0.002;
+
+    protected:
+        void SleepFor(Clock::duration duration);
+
+        Settings          m_settings;
+        bool              m_isStarted;
+
+        Clock::time_point m_frameBegin;
+        Clock::time_point m_nextFrame;
+        // simulated time owed, less than a step after BeginFrame
+        double            m_accumulator;
+        double            m_sleepMargin;
+
+        FrameStats        m_waited;
+        FrameStats        m_lastFrame;
+        FrameStats        m_average;
+
+        // waitable timer on Windows, Sleep only wakes on the system timer tick
+        void*             m_timer;
+    };
+
+}
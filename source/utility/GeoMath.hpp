@@ -2,6 +2,7 @@
 #include"SSE_Helper.hpp"
 
 #include<immintrin.h>
+#include<cassert>
 #include<cstring>
 #include<cstdint>
 #include<cmath>
@@ -37,11 +38,63 @@ namespace GeoMath{
         };
     };
     
+    template<> class Vector2<float>;
+    template<> class Vector3<float>;
+
+    // Register resident 2/3 component vectors returned by Vector2f/Vector3f arithmetic,
+    // chains of operations stay in xmm registers until assigned back to a vector.
+    // Unused lanes are always zero.
+    class alignas(16) Vector2fReg{
+    public:
+        Vector2fReg(const __m128 v) 
+            : sse(v){}
+        inline Vector2fReg(const Vector2<float>& v);
+
+        inline Vector2fReg operator+(const Vector2fReg&) const;
+        inline Vector2fReg operator-(const Vector2fReg&) const;
+        inline Vector2fReg operator*(const Vector2fReg&) const;
+        inline Vector2fReg operator*(const float) const;
+        inline Vector2fReg operator/(const float) const;
+
+        inline Vector2fReg Normalized() const;
+        inline float Norm() const;
+        inline float Dot(const Vector2fReg&) const;
+
+        operator const __m128& () const { return sse; }
+
+        __m128 sse;
+    };
+
+    class alignas(16) Vector3fReg{
+    public:
+        Vector3fReg(const __m128 v) 
+            : sse(v){}
+        inline Vector3fReg(const Vector3<float>& v);
+
+        inline Vector3fReg operator+(const Vector3fReg&) const;
+        inline Vector3fReg operator-(const Vector3fReg&) const;
+        inline Vector3fReg operator*(const Vector3fReg&) const;
+        inline Vector3fReg operator*(const float) const;
+        inline Vector3fReg operator/(const float) const;
+
+        inline Vector3fReg Normalized() const;
+        inline float Norm() const;
+        inline float Dot(const Vector3fReg&) const;
+        inline Vector3fReg Cross(const Vector3fReg&) const;
+
+        operator const __m128& () const { return sse; }
+
+        __m128 sse;
+    };
+
     template<>
     class Vector2<float>{
     public:
         Vector2(float _x = 0.0f, float _y = 0.0f) 
             : x(_x), y(_y) {}
+        Vector2(const Vector2fReg& v){
+            Store(v);
+        }
         union{
             struct{ float r, g; };
             struct{ float x, y; };
@@ -52,11 +105,20 @@ namespace GeoMath{
         inline Vector2(const Vector2<float>&);
 
         inline void operator=(const Vector2<float>&);
-        inline const Vector2<float>& operator+(const Vector2<float>&);
-        inline const Vector2<float>& operator-(const Vector2<float>&);
-        inline const Vector2<float>& operator*(const Vector2<float>&);
-        inline const Vector2<float>& operator*(const float);
-        inline const Vector2<float>& operator/(const float);
+        inline void operator=(const Vector2fReg&);
+
+        inline Vector2fReg Load() const;
+        inline void Store(const Vector2fReg&);
+
+        inline Vector2fReg operator+(const Vector2fReg&) const;
+        inline Vector2fReg operator-(const Vector2fReg&) const;
+        inline Vector2fReg operator*(const Vector2fReg&) const;
+        inline Vector2fReg operator*(const float) const;
+        inline Vector2fReg operator/(const float) const;
+
+        inline Vector2fReg Normalized() const;
+        inline float Norm() const;
+        inline float Dot(const Vector2fReg&) const;
     };
 
     Vector2<float>::Vector2(const Vector2<float>& v){
@@ -67,24 +129,84 @@ namespace GeoMath{
         memcpy(data, v.data, sizeof(float) * 2);
     }
 
-    const Vector2<float>& Vector2<float>::operator+(const Vector2<float>& v){
-        return Vector2<float>(x + v.x, y + v.y);
+    void Vector2<float>::operator=(const Vector2fReg& v){
+        Store(v);
+    }
+
+    Vector2fReg Vector2<float>::Load() const{
+        return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(data)));
+    }
+
+    void Vector2<float>::Store(const Vector2fReg& v){
+        _mm_storel_pi(reinterpret_cast<__m64*>(data), v.sse);
+    }
+
+    Vector2fReg Vector2<float>::operator+(const Vector2fReg& v) const{
+        return Load() + v;
+    }
+
+    Vector2fReg Vector2<float>::operator-(const Vector2fReg& v) const{
+        return Load() - v;
+    }
+
+    Vector2fReg Vector2<float>::operator*(const Vector2fReg& v) const{
+        return Load() * v;
     }
 
-    const Vector2<float>& Vector2<float>::operator-(const Vector2<float>& v){
-        return Vector2<float>(x - v.x, y - v.y);
+    Vector2fReg Vector2<float>::operator*(const float scalar) const{
+        return Load() * scalar;
     }
 
-    const Vector2<float>& Vector2<float>::operator*(const Vector2<float>& v){
-        return Vector2<float>(x * v.x, y * v.y);
+    Vector2fReg Vector2<float>::operator/(const float scalar) const{
+        return Load() / scalar;
     }
 
-    const Vector2<float>& Vector2<float>::operator/(const float scalar){
-        return Vector2<float>(x / scalar, y / scalar);
+    Vector2fReg Vector2<float>::Normalized() const{
+        return Load().Normalized();
     }
 
-    const Vector2<float>& Vector2<float>::operator*(const float scalar){
-        return Vector2<float>(x * scalar, y * scalar);
+    float Vector2<float>::Norm() const{
+        return Load().Norm();
+    }
+
+    float Vector2<float>::Dot(const Vector2fReg& v) const{
+        return Load().Dot(v);
+    }
+
+    Vector2fReg::Vector2fReg(const Vector2<float>& v)
+        : sse(v.Load()){}
+
+    Vector2fReg Vector2fReg::operator+(const Vector2fReg& v) const{
+        return _mm_add_ps(sse, v.sse);
+    }
+
+    Vector2fReg Vector2fReg::operator-(const Vector2fReg& v) const{
+        return _mm_sub_ps(sse, v.sse);
+    }
+
+    Vector2fReg Vector2fReg::operator*(const Vector2fReg& v) const{
+        return _mm_mul_ps(sse, v.sse);
+    }
+
+    Vector2fReg Vector2fReg::operator*(const float scalar) const{
+        return _mm_mul_ps(sse, _mm_set1_ps(scalar));
+    }
+
+    Vector2fReg Vector2fReg::operator/(const float scalar) const{
+        // keep the unused lanes zero even for a zero scalar
+        return _mm_div_ps(sse, _mm_setr_ps(scalar, scalar, 1.0f, 1.0f));
+    }
+
+    Vector2fReg Vector2fReg::Normalized() const{
+        return _mm_mul_ps(sse, VecRsqrtNR(_mm_dp_ps(sse, sse, 0x3F)));
+    }
+
+    float Vector2fReg::Norm() const{
+        return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(sse, sse, 0x31)));
+    }
+
+    float Vector2fReg::Dot(const Vector2fReg& v) const{
+        return _mm_cvtss_f32(_mm_dp_ps(sse, v.sse, 0x31));
     }
 
     template<>
@@ -92,6 +214,9 @@ namespace GeoMath{
     public:
         Vector3(float _x = 0.0f, float _y = 0.0f, float _z = 0.0f) 
             : x(_x), y(_y), z(_z) {}
+        Vector3(const Vector3fReg& v){
+            Store(v);
+        }
         union{
             struct{ float r, g, b; };
             struct{ float x, y, z; };
@@ -101,17 +226,21 @@ namespace GeoMath{
 
         inline Vector3(const Vector3<float>&);
         inline void operator=(const Vector3<float>&);
+        inline void operator=(const Vector3fReg&);
+
+        inline Vector3fReg Load() const;
+        inline void Store(const Vector3fReg&);
 
-        inline Vector3<float> operator+(const Vector3<float>&) const;
-        inline Vector3<float> operator-(const Vector3<float>&) const;
-        inline Vector3<float> operator*(const Vector3<float>&) const;
-        inline Vector3<float> operator*(const float) const;
-        inline Vector3<float> operator/(const float) const;
+        inline Vector3fReg operator+(const Vector3fReg&) const;
+        inline Vector3fReg operator-(const Vector3fReg&) const;
+        inline Vector3fReg operator*(const Vector3fReg&) const;
+        inline Vector3fReg operator*(const float) const;
+        inline Vector3fReg operator/(const float) const;
 
-        inline Vector3<float> Normalized() const;
+        inline Vector3fReg Normalized() const;
         inline float Norm() const;
-        inline float Dot(const Vector3<float>&) const;
-        inline float Cross(const Vector3<float>&) const;
+        inline float Dot(const Vector3fReg&) const;
+        inline Vector3fReg Cross(const Vector3fReg&) const;
     };
 
     Vector3<float>::Vector3(const Vector3<float>& v){
@@ -122,97 +251,99 @@ namespace GeoMath{
         memcpy(data, v.data, sizeof(float) * 3);
     }
 
-    Vector3<float> Vector3<float>::operator+(const Vector3<float>& v) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set_ps(0, v.z, v.y, v.x);
-        v1 = _mm_add_ps(v1, v2);
+    void Vector3<float>::operator=(const Vector3fReg& v){
+        Store(v);
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    Vector3fReg Vector3<float>::Load() const{
+        // 8 + 4 bytes load, never touches memory past z
+        __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(data)));
+        __m128 z  = _mm_load_ss(data + 2);
+        return _mm_movelh_ps(xy, z);
     }
 
-    Vector3<float> Vector3<float>::operator-(const Vector3<float>& v) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set_ps(0, v.z, v.y, v.x);
-        v1 = _mm_sub_ps(v1, v2);
+    void Vector3<float>::Store(const Vector3fReg& v){
+        _mm_storel_pi(reinterpret_cast<__m64*>(data), v.sse);
+        _mm_store_ss(data + 2, _mm_movehl_ps(v.sse, v.sse));
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    Vector3fReg Vector3<float>::operator+(const Vector3fReg& v) const{
+        return Load() + v;
     }
 
-    Vector3<float> Vector3<float>::operator*(const Vector3<float>& v) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set_ps(0, v.z, v.y, v.x);
-        v1 = _mm_mul_ps(v1, v2);
+    Vector3fReg Vector3<float>::operator-(const Vector3fReg& v) const{
+        return Load() - v;
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    Vector3fReg Vector3<float>::operator*(const Vector3fReg& v) const{
+        return Load() * v;
     }
 
-    Vector3<float> Vector3<float>::operator*(const float scalar) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set1_ps(scalar);
-        v1 = _mm_mul_ps(v1, v2);
+    Vector3fReg Vector3<float>::operator*(const float scalar) const{
+        return Load() * scalar;
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    Vector3fReg Vector3<float>::operator/(const float scalar) const{
+        return Load() / scalar;
     }
 
-    Vector3<float> Vector3<float>::operator/(const float scalar) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set1_ps(scalar);
-        v1 = _mm_div_ps(v1, v2);
+    Vector3fReg Vector3<float>::Normalized() const{
+        return Load().Normalized();
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    inline float Vector3<float>::Norm() const{
+        return Load().Norm();
     }
 
-    Vector3<float> Vector3<float>::Normalized() const{
-        __m128 v1, v2;
-        float res[4] = {};
+    inline float Vector3<float>::Dot(const Vector3fReg& v) const{
+        return Load().Dot(v);
+    }
 
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_mul_ps(v1, v1);
-        _mm_store_ps(res, v2);
+    inline Vector3fReg Vector3<float>::Cross(const Vector3fReg& v) const{
+        return Load().Cross(v);
+    }
 
-        float norm = sqrt(res[0] + res[1] + res[2]);
-        v2 = _mm_set1_ps(norm);
-        v1 = _mm_div_ps(v1, v2);
+    Vector3fReg::Vector3fReg(const Vector3<float>& v)
+        : sse(v.Load()){}
 
-        _mm_store_ps(res, v1);
-        return Vector3<float>(res[0], res[1], res[2]);
+    Vector3fReg Vector3fReg::operator+(const Vector3fReg& v) const{
+        return _mm_add_ps(sse, v.sse);
     }
 
-    inline float Vector3<float>::Norm() const{
-        __m128 v1, v2;
-        float res[4] = {};
+    Vector3fReg Vector3fReg::operator-(const Vector3fReg& v) const{
+        return _mm_sub_ps(sse, v.sse);
+    }
 
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_mul_ps(v1, v1);
-        _mm_store_ps(res, v2);
+    Vector3fReg Vector3fReg::operator*(const Vector3fReg& v) const{
+        return _mm_mul_ps(sse, v.sse);
+    }
 
-        return sqrt(res[0] + res[1] + res[2]);
+    Vector3fReg Vector3fReg::operator*(const float scalar) const{
+        return _mm_mul_ps(sse, _mm_set1_ps(scalar));
     }
 
-    inline float Vector3<float>::Dot(const Vector3<float>& v) const{
-        __m128 v1, v2;
-        v1 = _mm_set_ps(0, z, y, x);
-        v2 = _mm_set_ps(0, v.z, v.y, v.x);
-        v1 = _mm_mul_ps(v1, v2);
+    Vector3fReg Vector3fReg::operator/(const float scalar) const{
+        return _mm_div_ps(sse, _mm_setr_ps(scalar, scalar, scalar, 1.0f));
+    }
 
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return res[0] + res[1] + res[2];
+    Vector3fReg Vector3fReg::Normalized() const{
+        // |v|^2 broadcast to every lane, w stays zero after the multiply
+        return _mm_mul_ps(sse, VecRsqrtNR(_mm_dp_ps(sse, sse, 0x7F)));
+    }
+
+    inline float Vector3fReg::Norm() const{
+        return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(sse, sse, 0x71)));
+    }
+
+    inline float Vector3fReg::Dot(const Vector3fReg& v) const{
+        return _mm_cvtss_f32(_mm_dp_ps(sse, v.sse, 0x71));
+    }
+
+    inline Vector3fReg Vector3fReg::Cross(const Vector3fReg& v) const{
+        __m128 a_yzx = VecSwizzle(sse, 1, 2, 0, 3);
+        __m128 b_yzx = VecSwizzle(v.sse, 1, 2, 0, 3);
+        __m128 c = _mm_sub_ps(_mm_mul_ps(sse, b_yzx), _mm_mul_ps(a_yzx, v.sse));
+        return VecSwizzle(c, 1, 2, 0, 3);
     }
 
     template<>
@@ -296,35 +427,19 @@ namespace GeoMath{
     }
 
     Vector4<float> Vector4<float>::Normalized() const{
-        __m128 v1 = _mm_mul_ps(sse, sse);
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return _mm_div_ps(sse, _mm_set1_ps(sqrt(res[0] + res[1] + res[2] + res[3])));
+        return _mm_mul_ps(sse, VecRsqrtNR(_mm_dp_ps(sse, sse, 0xFF)));
     }
 
     Vector4<float> Vector4<float>::Normalized3() const{
-        __m128 v1 = _mm_mul_ps(sse, sse);
-        float res[4] = {};
-        _mm_store_ps(res, v1);
-        return _mm_div_ps(sse, _mm_set1_ps(sqrt(res[0] + res[1] + res[2])));
+        return _mm_mul_ps(sse, VecRsqrtNR(_mm_dp_ps(sse, sse, 0x7F)));
     }
 
     inline float Vector4<float>::Norm() const{
-
-        float res[4] = {};
-        __m128 v = _mm_mul_ps(sse, sse);
-        _mm_store_ps(res, v);
-
-        return sqrt(res[0] + res[1] + res[2] + res[3]);
+        return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(sse, sse, 0xF1)));
     }
 
     inline float Vector4<float>::Norm3() const{
-        
-        float res[4] = {};
-        __m128 v = _mm_mul_ps(sse, sse);
-        _mm_store_ps(res, v);
-
-        return sqrt(res[0] + res[1] + res[2]);
+        return _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(sse, sse, 0x71)));
     }
 
     inline Vector4<float> Vector4<float>::Cross(const Vector4<float>& v) const{
@@ -344,6 +459,18 @@ namespace GeoMath{
     static_assert(sizeof(Vector3f) == 12);
     static_assert(sizeof(Vector4f) == 16);
 
+    // How a matrix maps points, lets inverse-like operations pick a cheaper path.
+    // Ordered from the most to the least specific, combining two transforms keeps the larger one.
+    enum class TransformType : uint8_t{
+        Rigid   = 0,  // orthonormal 3x3 (rotation, reflection) plus translation
+        Affine  = 1,  // any 3x3 plus translation, last column is (0, 0, 0, 1)
+        General = 2
+    };
+
+    inline TransformType Combine(TransformType a, TransformType b){
+        return a > b ? a : b;
+    }
+
     template<typename T>
     class alignas(16) Matrix4{};
 
@@ -374,7 +501,13 @@ namespace GeoMath{
         inline const Vector4<float>& operator[](const uint32_t index) const;
 
         inline Matrix4<float> Inverse() const;
+        inline Matrix4<float> Inverse(TransformType type) const;
+        inline Matrix4<float> InverseAffine() const;
+        inline Matrix4<float> InverseRigid() const;
+        inline Matrix4<float> NormalMatrix() const;
+        inline Matrix4<float> NormalMatrix(TransformType type) const;
         inline Matrix4<float> Transpose() const;
+        inline TransformType Classify(float epsilon = 1e-4f) const;
         inline Matrix4<float> AsMatrix3X4() const;
     public:
         static inline Matrix4<float> Identity();
@@ -384,6 +517,9 @@ namespace GeoMath{
         static inline Matrix4<float> Rotation(float x, float y, float z, float w);
         static inline Matrix4<float> Translation(float x, float y, float z);
         static inline Matrix4<float> Perspective(float fovY, float aspect, float nearZ, float farZ);
+        // between two affine transforms, the rows lerped and brought back to their lerped length, which stays
+        // close to a slerp for the small turns between two simulation steps
+        static inline Matrix4<float> Interpolate(const Matrix4<float>& from, const Matrix4<float>& to, float t);
 
         union{
             Vector4f row[4];
@@ -580,6 +716,119 @@ namespace GeoMath{
         return Matrix4<float>();
     }
 
+    Matrix4<float> Matrix4<float>::Inverse(TransformType type) const{
+        switch(type){
+            case TransformType::Rigid:
+                return InverseRigid();
+            case TransformType::Affine:
+                return InverseAffine();
+            default:
+                return Inverse();
+        }
+    }
+
+    // | A 0 |-1    | A^-1     0 |
+    // | t 1 |    = | -t*A^-1  1 |
+    // A^-1 = adj(A) / |A|, the columns of A^-1 are the cross products of the rows of A
+    Matrix4<float> Matrix4<float>::InverseAffine() const{
+        __m128 c0 = row[1].Cross(row[2]);
+        __m128 c1 = row[2].Cross(row[0]);
+        __m128 c2 = row[0].Cross(row[1]);
+        __m128 c3 = _mm_setzero_ps();
+
+        __m128 rDet = _mm_div_ps(_mm_set1_ps(1.0f), _mm_dp_ps(row[0].sse, c0, 0x7F));
+        c0 = _mm_mul_ps(c0, rDet);
+        c1 = _mm_mul_ps(c1, rDet);
+        c2 = _mm_mul_ps(c2, rDet);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        __m128 t = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(VecSwizzle1(row[3].sse, 0), c0), _mm_mul_ps(VecSwizzle1(row[3].sse, 1), c1)),
+            _mm_mul_ps(VecSwizzle1(row[3].sse, 2), c2)
+        );
+
+        Matrix4<float> r;
+        r.row[0].sse = c0;
+        r.row[1].sse = c1;
+        r.row[2].sse = c2;
+        r.row[3].sse = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), t);
+        return r;
+    }
+
+    // A^-1 = A^T for an orthonormal A
+    Matrix4<float> Matrix4<float>::InverseRigid() const{
+        __m128 r0 = row[0].sse;
+        __m128 r1 = row[1].sse;
+        __m128 r2 = row[2].sse;
+        __m128 r3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        __m128 t = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(VecSwizzle1(row[3].sse, 0), r0), _mm_mul_ps(VecSwizzle1(row[3].sse, 1), r1)),
+            _mm_mul_ps(VecSwizzle1(row[3].sse, 2), r2)
+        );
+
+        Matrix4<float> r;
+        r.row[0].sse = r0;
+        r.row[1].sse = r1;
+        r.row[2].sse = r2;
+        r.row[3].sse = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), t);
+        return r;
+    }
+
+    // upper 3x3 of Inverse().Transpose() for an affine matrix, cofactor(A) / |A|
+    Matrix4<float> Matrix4<float>::NormalMatrix() const{
+        __m128 c0 = row[1].Cross(row[2]);
+        __m128 c1 = row[2].Cross(row[0]);
+        __m128 c2 = row[0].Cross(row[1]);
+
+        __m128 rDet = _mm_div_ps(_mm_set1_ps(1.0f), _mm_dp_ps(row[0].sse, c0, 0x7F));
+
+        Matrix4<float> r;
+        r.row[0].sse = _mm_mul_ps(c0, rDet);
+        r.row[1].sse = _mm_mul_ps(c1, rDet);
+        r.row[2].sse = _mm_mul_ps(c2, rDet);
+        return r;
+    }
+
+    Matrix4<float> Matrix4<float>::NormalMatrix(TransformType type) const{
+        switch(type){
+            case TransformType::Rigid:
+            {
+                const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+                Matrix4<float> r;
+                r.row[0].sse = _mm_and_ps(row[0].sse, mask);
+                r.row[1].sse = _mm_and_ps(row[1].sse, mask);
+                r.row[2].sse = _mm_and_ps(row[2].sse, mask);
+                return r;
+            }
+            case TransformType::Affine:
+                return NormalMatrix();
+            default:
+                return Inverse().Transpose();
+        }
+    }
+
+    TransformType Matrix4<float>::Classify(float epsilon) const{
+        if(std::abs(data[0][3]) > epsilon || std::abs(data[1][3]) > epsilon ||
+           std::abs(data[2][3]) > epsilon || std::abs(data[3][3] - 1.0f) > epsilon){
+            return TransformType::General;
+        }
+
+        float d00 = _mm_cvtss_f32(_mm_dp_ps(row[0].sse, row[0].sse, 0x71));
+        float d11 = _mm_cvtss_f32(_mm_dp_ps(row[1].sse, row[1].sse, 0x71));
+        float d22 = _mm_cvtss_f32(_mm_dp_ps(row[2].sse, row[2].sse, 0x71));
+        float d01 = _mm_cvtss_f32(_mm_dp_ps(row[0].sse, row[1].sse, 0x71));
+        float d02 = _mm_cvtss_f32(_mm_dp_ps(row[0].sse, row[2].sse, 0x71));
+        float d12 = _mm_cvtss_f32(_mm_dp_ps(row[1].sse, row[2].sse, 0x71));
+
+        bool isOrthonormal =
+            std::abs(d00 - 1.0f) <= epsilon && std::abs(d11 - 1.0f) <= epsilon && std::abs(d22 - 1.0f) <= epsilon &&
+            std::abs(d01) <= epsilon && std::abs(d02) <= epsilon && std::abs(d12) <= epsilon;
+
+        return isOrthonormal ? TransformType::Rigid : TransformType::Affine;
+    }
+
     Matrix4<float> Matrix4<float>::Transpose() const{
         return Matrix4<float>(
             data[0][0], data[1][0], data[2][0], data[3][0], 
@@ -660,6 +909,25 @@ namespace GeoMath{
         );
     }
 
+    Matrix4<float> Matrix4<float>::Interpolate(const Matrix4<float>& from, const Matrix4<float>& to, float t){
+        Matrix4<float> result;
+        for(int i = 0; i < 4; i++){
+            float length2 = 0.0f, fromLength2 = 0.0f, toLength2 = 0.0f;
+            for(int j = 0; j < 4; j++){
+                result.data[i][j] = from.data[i][j] + (to.data[i][j] - from.data[i][j]) * t;
+                length2     += result.data[i][j] * result.data[i][j];
+                fromLength2 += from.data[i][j] * from.data[i][j];
+                toLength2   += to.data[i][j] * to.data[i][j];
+            }
+            if(i == 3 || length2 <= 0.0f) continue;
+
+            const float fromLength = std::sqrt(fromLength2);
+            const float scale = (fromLength + (std::sqrt(toLength2) - fromLength) * t) / std::sqrt(length2);
+            for(int j = 0; j < 3; j++) result.data[i][j] *= scale;
+        }
+        return result;
+    }
+
     Matrix4<float> Matrix4<float>::Perspective(float fovY, float aspect, float nearZ, float farZ){
         
         float height = 1.0f / std::tanf(0.5f * fovY);
@@ -694,4 +962,228 @@ namespace GeoMath{
         return _mm_add_ps(a, b);
     }
 
+    // Scale, rotation and translation applied in that order to row vectors,
+    // ToMatrix() equals Matrix4f::Scale(s) * Matrix4f::Rotation(q) * Matrix4f::Translation(t).
+    // a * b applies a first then b, the same order as the matrices; the result is exact
+    // while b has a uniform scale, a non-uniform parent scale would need a shear.
+    class Transform{
+    public:
+        Transform()
+            : rotation{0.0f, 0.0f, 0.0f, 1.0f}, translation(0.0f, 0.0f, 0.0f), scale(1.0f, 1.0f, 1.0f) {}
+        Transform(const Vector4f& q, const Vector3f& t, const Vector3f& s = Vector3f(1.0f, 1.0f, 1.0f))
+            : rotation{q.x, q.y, q.z, q.w}, translation(t), scale(s) {}
+
+        inline Transform operator*(const Transform&) const;
+        // only for a uniform scale, the inverse of a non-uniform one scales along rotated axes and
+        // is no Transform, InverseMatrix() handles any scale
+        inline Transform Inverse() const;
+        inline Matrix4f  InverseMatrix() const;
+        inline bool      IsUniformScale(float epsilon = 1e-4f) const;
+
+        inline Vector3fReg TransformPoint(const Vector3fReg&) const;
+        inline Vector3fReg TransformVector(const Vector3fReg&) const;
+
+        inline Matrix4f ToMatrix() const;
+        // rotation and translation only
+        inline Matrix4f ToRigidMatrix() const;
+        inline TransformType Classify(float epsilon = 1e-4f) const;
+
+        __m128 LoadRotation() const { return _mm_loadu_ps(rotation); }
+        void StoreRotation(const __m128 q){ _mm_storeu_ps(rotation, q); }
+
+        // v * Matrix4f::Rotation(q), which rotates by the conjugate of q
+        static inline __m128 Rotate(const __m128 q, const __m128 v);
+
+        float    rotation[4];
+        Vector3f translation;
+        Vector3f scale;
+    };
+
+    static_assert(sizeof(Transform) == 40);
+
+    __m128 Transform::Rotate(const __m128 q, const __m128 v){
+        // u = -q.xyz, v' = v + w * c + u x c, c = 2 * (u x v)
+        __m128 u = _mm_blend_ps(_mm_sub_ps(_mm_setzero_ps(), q), _mm_setzero_ps(), 0x8);
+        __m128 w = VecSwizzle1(q, 3);
+        Vector3fReg c = Vector3fReg(u).Cross(v);
+        c.sse = _mm_add_ps(c.sse, c.sse);
+        return _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(w, c.sse)), Vector3fReg(u).Cross(c).sse);
+    }
+
+    Transform Transform::operator*(const Transform& parent) const{
+        __m128 parentScale = parent.scale.Load();
+        Transform result;
+        result.StoreRotation(QuatMul(LoadRotation(), parent.LoadRotation()));
+        result.scale = _mm_mul_ps(scale.Load(), parentScale);
+        result.translation = _mm_add_ps(
+            Rotate(parent.LoadRotation(), _mm_mul_ps(translation.Load(), parentScale)),
+            parent.translation.Load()
+        );
+        return result;
+    }
+
+    Transform Transform::Inverse() const{
+        assert(IsUniformScale());
+        const __m128 one = _mm_set1_ps(1.0f);
+        __m128 q = _mm_xor_ps(LoadRotation(), _mm_set_ps(0.0f, -0.0f, -0.0f, -0.0f));
+        __m128 s = _mm_div_ps(one, _mm_blend_ps(scale.Load(), one, 0x8));
+        Transform result;
+        result.StoreRotation(q);
+        result.scale = _mm_blend_ps(s, _mm_setzero_ps(), 0x8);
+        result.translation = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(Rotate(q, translation.Load()), s));
+        return result;
+    }
+
+    Matrix4f Transform::InverseMatrix() const{
+        return IsUniformScale() ? Inverse().ToMatrix() : ToMatrix().InverseAffine();
+    }
+
+    bool Transform::IsUniformScale(float epsilon) const{
+        return std::abs(scale.x - scale.y) <= epsilon * std::abs(scale.x) && std::abs(scale.x - scale.z) <= epsilon * std::abs(scale.x);
+    }
+
+    Vector3fReg Transform::TransformPoint(const Vector3fReg& p) const{
+        return _mm_add_ps(Rotate(LoadRotation(), _mm_mul_ps(p.sse, scale.Load())), translation.Load());
+    }
+
+    Vector3fReg Transform::TransformVector(const Vector3fReg& v) const{
+        return Rotate(LoadRotation(), _mm_mul_ps(v.sse, scale.Load()));
+    }
+
+    Matrix4f Transform::ToMatrix() const{
+        Matrix4f m = ToRigidMatrix();
+        m.row[0].sse = _mm_mul_ps(m.row[0].sse, _mm_set_ps1(scale.x));
+        m.row[1].sse = _mm_mul_ps(m.row[1].sse, _mm_set_ps1(scale.y));
+        m.row[2].sse = _mm_mul_ps(m.row[2].sse, _mm_set_ps1(scale.z));
+        return m;
+    }
+
+    Matrix4f Transform::ToRigidMatrix() const{
+        const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+        float x2 = 2.0f*x*x;
+        float y2 = 2.0f*y*y;
+        float z2 = 2.0f*z*z;
+        float xy = 2.0f*x*y;
+        float yz = 2.0f*y*z;
+        float xz = 2.0f*x*z;
+        float xw = 2.0f*x*w;
+        float yw = 2.0f*y*w;
+        float zw = 2.0f*z*w;
+        return Matrix4f(
+            1.0f-y2-z2,    xy-zw,         xz+yw,         0.0f,
+            xy+zw,         1.0f-x2-z2,    yz-xw,         0.0f, 
+            xz-yw,         yz+xw,         1.0f-x2-y2,    0.0f,
+            translation.x, translation.y, translation.z, 1.0f
+        );
+    }
+
+    TransformType Transform::Classify(float epsilon) const{
+        // rotation is kept unit length, so only the scale can leave the rigid set
+        for(int i = 0; i < 3; i++){
+            if(std::abs(std::abs(scale.data[i]) - 1.0f) > epsilon) return TransformType::Affine;
+        }
+        return TransformType::Rigid;
+    }
+
+    // Axis aligned box kept as center and half extent
+    class BoundingBox{
+    public:
+        BoundingBox()
+            : center(0.0f, 0.0f, 0.0f), extent(-1.0f, -1.0f, -1.0f) {}
+        BoundingBox(const Vector3f& c, const Vector3f& e)
+            : center(c), extent(e) {}
+
+        static inline BoundingBox FromMinMax(const Vector3f& minPoint, const Vector3f& maxPoint);
+
+        // an empty box has a negative extent, merging into it gives the other box
+        bool IsEmpty() const { return extent.x < 0.0f; }
+
+        inline BoundingBox Merge(const BoundingBox&) const;
+        // bounds of the box after v * m
+        inline BoundingBox Transform(const Matrix4f& m) const;
+
+        Vector3f center;
+        Vector3f extent;
+    };
+
+    BoundingBox BoundingBox::FromMinMax(const Vector3f& minPoint, const Vector3f& maxPoint){
+        __m128 lo = minPoint.Load();
+        __m128 hi = maxPoint.Load();
+        __m128 half = _mm_set1_ps(0.5f);
+        return BoundingBox(
+            Vector3fReg(_mm_mul_ps(_mm_add_ps(lo, hi), half)),
+            Vector3fReg(_mm_mul_ps(_mm_sub_ps(hi, lo), half))
+        );
+    }
+
+    BoundingBox BoundingBox::Merge(const BoundingBox& box) const{
+        if(IsEmpty())     return box;
+        if(box.IsEmpty()) return *this;
+
+        __m128 c0 = center.Load(), e0 = extent.Load();
+        __m128 c1 = box.center.Load(), e1 = box.extent.Load();
+        __m128 lo = _mm_min_ps(_mm_sub_ps(c0, e0), _mm_sub_ps(c1, e1));
+        __m128 hi = _mm_max_ps(_mm_add_ps(c0, e0), _mm_add_ps(c1, e1));
+        __m128 half = _mm_set1_ps(0.5f);
+        return BoundingBox(
+            Vector3fReg(_mm_mul_ps(_mm_add_ps(lo, hi), half)),
+            Vector3fReg(_mm_mul_ps(_mm_sub_ps(hi, lo), half))
+        );
+    }
+
+    BoundingBox BoundingBox::Transform(const Matrix4f& m) const{
+        if(IsEmpty()) return *this;
+
+        // center moves as a point, extent spreads over |m| of the upper 3x3
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 c = center.Load();
+        __m128 e = extent.Load();
+
+        __m128 rc = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(VecSwizzle1(c, 0), m.row[0].sse), _mm_mul_ps(VecSwizzle1(c, 1), m.row[1].sse)),
+            _mm_add_ps(_mm_mul_ps(VecSwizzle1(c, 2), m.row[2].sse), m.row[3].sse)
+        );
+        __m128 re = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(VecSwizzle1(e, 0), _mm_and_ps(m.row[0].sse, absMask)),
+                _mm_mul_ps(VecSwizzle1(e, 1), _mm_and_ps(m.row[1].sse, absMask))
+            ),
+            _mm_mul_ps(VecSwizzle1(e, 2), _mm_and_ps(m.row[2].sse, absMask))
+        );
+        return BoundingBox(Vector3fReg(rc), Vector3fReg(re));
+    }
+
+    // Six normalized planes (a, b, c, d) pointing inwards, p is inside when a*x + b*y + c*z + d >= 0
+    class Frustum{
+    public:
+        enum Side{ Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+        // planes of the clip volume of v * viewProj, -w <= x, y <= w and 0 <= z <= w;
+        // with a projection alone they are in view space
+        static inline Frustum FromMatrix(const Matrix4f& viewProj);
+
+        Vector4f planes[Count];
+    };
+
+    Frustum Frustum::FromMatrix(const Matrix4f& viewProj){
+        Matrix4f t = viewProj.Transpose();
+        const __m128 c0 = t.row[0].sse;
+        const __m128 c1 = t.row[1].sse;
+        const __m128 c2 = t.row[2].sse;
+        const __m128 c3 = t.row[3].sse;
+
+        Frustum frustum;
+        frustum.planes[Left].sse   = _mm_add_ps(c3, c0);
+        frustum.planes[Right].sse  = _mm_sub_ps(c3, c0);
+        frustum.planes[Bottom].sse = _mm_add_ps(c3, c1);
+        frustum.planes[Top].sse    = _mm_sub_ps(c3, c1);
+        frustum.planes[Near].sse   = c2;
+        frustum.planes[Far].sse    = _mm_sub_ps(c3, c2);
+
+        for(auto& plane : frustum.planes){
+            plane.sse = _mm_mul_ps(plane.sse, VecRsqrtNR(_mm_dp_ps(plane.sse, plane.sse, 0x7F)));
+        }
+        return frustum;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "GeoMathBatchKernel.hpp"
+
+#include <atomic>
+#include <cmath>
+
+namespace GeoMath{
+
+    namespace{
+
+        const Kernel::BatchTable* GetTable(Utility::SimdLevel level){
+            if(level > Utility::GetCpuSimdLevel()) level = Utility::GetCpuSimdLevel();
+
+            switch(level){
+                case Utility::SimdLevel::AVX512: return &Kernel::AVX512;
+                case Utility::SimdLevel::AVX2:   return &Kernel::AVX2;
+                case Utility::SimdLevel::SSE41:  return &Kernel::SSE41;
+                default:                         return &Kernel::Scalar;
+            }
+        }
+
+        std::atomic<const Kernel::BatchTable*>& CurrentTable(){
+            static std::atomic<const Kernel::BatchTable*> table(GetTable(Utility::GetCpuSimdLevel()));
+            return table;
+        }
+
+        inline const Kernel::BatchTable& Table(){
+            return *CurrentTable().load(std::memory_order_relaxed);
+        }
+
+    }
+
+    Utility::SimdLevel GetBatchLevel(){
+        return Table().level;
+    }
+
+    void SetBatchLevel(Utility::SimdLevel level){
+        CurrentTable().store(GetTable(level), std::memory_order_relaxed);
+    }
+
+    void TransformPoints(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+        Table().transformPoints(src, dst, count, m);
+    }
+
+    void TransformVectors(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+        Table().transformVectors(src, dst, count, m);
+    }
+
+    void TransformHomogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m){
+        Table().transformHomogeneous(src, dst, count, m);
+    }
+
+    void TransformPoints(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+        Table().transformPointsSoA(src, dst, count, m);
+    }
+
+    void TransformVectors(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+        Table().transformVectorsSoA(src, dst, count, m);
+    }
+
+    void LerpFloats(const float* a, const float* b, const float* t, float* out, size_t count){
+        Table().lerpFloats(a, b, t, out, count);
+    }
+
+    void SlerpQuaternions(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count){
+        Table().slerpQuaternions(a, b, t, out, count);
+    }
+
+    void AddScaledFloats(const float* src, float scale, float* dst, size_t count){
+        Table().addScaledFloats(src, scale, dst, count);
+    }
+
+    void ConvertToDualQuaternions(const Matrix4f* src, DualQuaternion* dst, size_t count){
+        // a few per skin, no batch kernel
+        for(size_t index = 0; index < count; index++){
+            const Matrix4f& matrix = src[index];
+
+            float m[3][3];
+            for(int i = 0; i < 3; i++){
+                const float* row = matrix.data[i];
+                float length = std::sqrt(row[0] * row[0] + row[1] * row[1] + row[2] * row[2]);
+                float inv = length > 0.0f ? 1.0f / length : 0.0f;
+                for(int j = 0; j < 3; j++) m[i][j] = row[j] * inv;
+            }
+
+            // v * m rotates v by q, so m is the transposed rotation matrix of q
+            float q[4];
+            float trace = m[0][0] + m[1][1] + m[2][2];
+            if(trace > 0.0f){
+                float s = 0.5f / std::sqrt(trace + 1.0f);
+                q[0] = (m[1][2] - m[2][1]) * s;
+                q[1] = (m[2][0] - m[0][2]) * s;
+                q[2] = (m[0][1] - m[1][0]) * s;
+                q[3] = 0.25f / s;
+            }
+            else if(m[0][0] > m[1][1] && m[0][0] > m[2][2]){
+                float s = 2.0f * std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]);
+                q[0] = 0.25f * s;
+                q[1] = (m[1][0] + m[0][1]) / s;
+                q[2] = (m[2][0] + m[0][2]) / s;
+                q[3] = (m[1][2] - m[2][1]) / s;
+            }
+            else if(m[1][1] > m[2][2]){
+                float s = 2.0f * std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]);
+                q[0] = (m[1][0] + m[0][1]) / s;
+                q[1] = 0.25f * s;
+                q[2] = (m[2][1] + m[1][2]) / s;
+                q[3] = (m[2][0] - m[0][2]) / s;
+            }
+            else{
+                float s = 2.0f * std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]);
+                q[0] = (m[2][0] + m[0][2]) / s;
+                q[1] = (m[2][1] + m[1][2]) / s;
+                q[2] = 0.25f * s;
+                q[3] = (m[0][1] - m[1][0]) / s;
+            }
+
+            float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            for(int k = 0; k < 4; k++) q[k] /= length;
+
+            // dual = 0.5 * (t, 0) * q
+            const float* t = matrix.data[3];
+            DualQuaternion& out = dst[index];
+            out.real[0] = q[0];
+            out.real[1] = q[1];
+            out.real[2] = q[2];
+            out.real[3] = q[3];
+            out.dual[0] = 0.5f * (q[3] * t[0] + (t[1] * q[2] - t[2] * q[1]));
+            out.dual[1] = 0.5f * (q[3] * t[1] + (t[2] * q[0] - t[0] * q[2]));
+            out.dual[2] = 0.5f * (q[3] * t[2] + (t[0] * q[1] - t[1] * q[0]));
+            out.dual[3] = -0.5f * (t[0] * q[0] + t[1] * q[1] + t[2] * q[2]);
+        }
+    }
+
+    void SkinLinear(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+        Table().skinLinear(palette, weights, src, dst, count);
+    }
+
+    void SkinDualQuaternion(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+        Table().skinDualQuaternion(palette, weights, src, dst, count);
+    }
+
+    void CullBoxes(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible){
+        Table().cullBoxes(frustum, boxes, count, visible);
+    }
+
+    void ConvertFloatToHalf(const float* src, uint16_t* dst, size_t count){
+        Table().floatToHalf(src, dst, count);
+    }
+
+    void ConvertHalfToFloat(const uint16_t* src, float* dst, size_t count){
+        Table().halfToFloat(src, dst, count);
+    }
+
+    void ConvertFloatToSNorm16(const float* src, int16_t* dst, size_t count){
+        Table().floatToSNorm16(src, dst, count);
+    }
+
+    void ConvertSNorm16ToFloat(const int16_t* src, float* dst, size_t count){
+        Table().snorm16ToFloat(src, dst, count);
+    }
+
+    void EncodeOctahedral(const float* src, int16_t* dst, size_t count){
+        Table().encodeOctahedral(src, dst, count);
+    }
+
+    void DecodeOctahedral(const int16_t* src, float* dst, size_t count){
+        Table().decodeOctahedral(src, dst, count);
+    }
+
+}
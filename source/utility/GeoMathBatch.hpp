@@ -0,0 +1,142 @@
+#pragma once
+#include "GeoMath.hpp"
+#include "CpuFeature.hpp"
+
+#include <cstddef>
+
+namespace GeoMath{
+
+    // Batched transforms, row vector convention (out = v * m) as operator*(Vector4f, Matrix4f).
+    // src and dst may be the same array, partial overlap is not supported.
+
+    // (x, y, z, 1) * m, the result is not divided by w
+    void TransformPoints(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m);
+
+    // (x, y, z, 0) * m
+    void TransformVectors(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m);
+
+    void TransformHomogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m);
+
+    // SoA streams, one float array per component
+    struct Vector3fStream{
+        float* x;
+        float* y;
+        float* z;
+    };
+
+    struct ConstVector3fStream{
+        ConstVector3fStream(const float* _x, const float* _y, const float* _z)
+            : x(_x), y(_y), z(_z) {}
+        ConstVector3fStream(const Vector3fStream& s)
+            : x(s.x), y(s.y), z(s.z) {}
+
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+
+    void TransformPoints(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m);
+    void TransformVectors(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m);
+
+    // SoA quaternions (x, y, z, w)
+    struct QuaternionStream{
+        float* x;
+        float* y;
+        float* z;
+        float* w;
+    };
+
+    struct ConstQuaternionStream{
+        ConstQuaternionStream(const float* _x, const float* _y, const float* _z, const float* _w)
+            : x(_x), y(_y), z(_z), w(_w) {}
+        ConstQuaternionStream(const QuaternionStream& s)
+            : x(s.x), y(s.y), z(s.z), w(s.w) {}
+
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* w;
+    };
+
+    // Keyframe interpolation with one weight per element, out may be the same array as a or b.
+    // out = a + (b - a) * t
+    void LerpFloats(const float* a, const float* b, const float* t, float* out, size_t count);
+    // unit quaternions along the shorter arc, normalized. The slerp weight is approximated by a
+    // polynomial in t and |dot(a, b)|, the nlerp then stays within 1.5e-3 radians of the slerp
+    // for keys half a turn apart and much closer for nearer keys.
+    void SlerpQuaternions(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count);
+
+    // dst += src * scale, the weighted sum of blend shape deltas
+    void AddScaledFloats(const float* src, float scale, float* dst, size_t count);
+
+    // Vertices of a skinned or morphed mesh as SoA streams, a stream whose x is null is skipped
+    struct SkinVertexStream{
+        Vector3fStream position;
+        Vector3fStream normal;
+        Vector3fStream tangent;
+    };
+
+    struct ConstSkinVertexStream{
+        ConstVector3fStream position;
+        ConstVector3fStream normal;
+        ConstVector3fStream tangent;
+    };
+
+    // 4 influences per vertex, the weights of a vertex sum to 1
+    struct ConstSkinWeightStream{
+        const uint16_t* joint[4];
+        const float*    weight[4];
+    };
+
+    // unit rotation quaternion (x, y, z, w) and its dual part, half the translation times the rotation
+    struct DualQuaternion{
+        float real[4];
+        float dual[4];
+    };
+
+    // rotation and translation of palette matrices, the scale is dropped
+    void ConvertToDualQuaternions(const Matrix4f* src, DualQuaternion* dst, size_t count);
+
+    // Skinning from the bind pose, src and dst must not overlap. Normals and tangents take the
+    // 3x3 part of the blend and are not renormalized, the packers only need their direction.
+    // linear blend, v * sum(weight * palette[joint])
+    void SkinLinear(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count);
+    // normalized blend of the dual quaternions, twisting joints keep their volume
+    void SkinDualQuaternion(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count);
+
+    // SoA boxes, center and half extent of each one
+    struct ConstBoxStream{
+        const float* cx;
+        const float* cy;
+        const float* cz;
+        const float* ex;
+        const float* ey;
+        const float* ez;
+    };
+
+    // bit i of visible[i / 32] is set unless box i lies fully outside one of the planes,
+    // all (count + 31) / 32 words are written
+    void CullBoxes(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible);
+
+    // Packed vertex attribute conversions, rounding to nearest even as the GPU does.
+    // Half keeps infinities, NaN becomes a quiet NaN.
+    void ConvertFloatToHalf(const float* src, uint16_t* dst, size_t count);
+    void ConvertHalfToFloat(const uint16_t* src, float* dst, size_t count);
+
+    // clamped to [-1, 1] and scaled by 32767, the DXGI SNORM mapping
+    void ConvertFloatToSNorm16(const float* src, int16_t* dst, size_t count);
+    void ConvertSNorm16ToFloat(const int16_t* src, float* dst, size_t count);
+
+    // unit vectors (x, y, z) folded onto the octahedron as two snorm16 and back,
+    // decoded vectors are normalized
+    void EncodeOctahedral(const float* src, int16_t* dst, size_t count);
+    void DecodeOctahedral(const int16_t* src, float* dst, size_t count);
+
+    // The kernels above run on the highest instruction set the cpu supports, picked at first use.
+    // SetBatchLevel selects another one (clamped to the cpu), the Scalar level is the plain C++
+    // reference the SIMD paths are validated against. SSE4.1 is the minimum the binary runs on,
+    // the inline GeoMath types need it whatever level the kernels use.
+    Utility::SimdLevel GetBatchLevel();
+    void SetBatchLevel(Utility::SimdLevel level);
+
+}
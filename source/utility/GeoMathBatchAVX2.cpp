@@ -0,0 +1,594 @@
+#include "GeoMathBatchKernel.hpp"
+
+// built with AVX2, FMA and F16C enabled, only reached through the dispatch table
+namespace GeoMath{
+
+    namespace{
+
+        struct MatrixAVX{
+            MatrixAVX() = default;
+            explicit MatrixAVX(const Matrix4f& m){
+                for(int i = 0; i < 4; i++){
+                    for(int j = 0; j < 3; j++){
+                        c[i][j] = _mm256_set1_ps(m.data[i][j]);
+                    }
+                }
+            }
+            __m256 c[4][3];
+        };
+
+        template<bool isPoint>
+        inline void TransformAVX(const MatrixAVX& m, __m256& x, __m256& y, __m256& z){
+            __m256 rx = _mm256_mul_ps(x, m.c[0][0]);
+            __m256 ry = _mm256_mul_ps(x, m.c[0][1]);
+            __m256 rz = _mm256_mul_ps(x, m.c[0][2]);
+
+            rx = _mm256_fmadd_ps(y, m.c[1][0], rx);
+            ry = _mm256_fmadd_ps(y, m.c[1][1], ry);
+            rz = _mm256_fmadd_ps(y, m.c[1][2], rz);
+
+            rx = _mm256_fmadd_ps(z, m.c[2][0], rx);
+            ry = _mm256_fmadd_ps(z, m.c[2][1], ry);
+            rz = _mm256_fmadd_ps(z, m.c[2][2], rz);
+
+            if(isPoint){
+                rx = _mm256_add_ps(rx, m.c[3][0]);
+                ry = _mm256_add_ps(ry, m.c[3][1]);
+                rz = _mm256_add_ps(rz, m.c[3][2]);
+            }
+
+            x = rx;
+            y = ry;
+            z = rz;
+        }
+
+        // 8 packed Vector3f -> SoA, each 128 bit lane holds 4 of them
+        inline void LoadAoS3(const float* p, __m256& x, __m256& y, __m256& z){
+            __m256 m03 = _mm256_castps128_ps256(_mm_loadu_ps(p));
+            __m256 m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+            __m256 m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+            m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+            m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+            m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+            __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+            __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+
+            x = _mm256_shuffle_ps(m03, xy,  _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm256_shuffle_ps(yz,  xy,  _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm256_shuffle_ps(yz,  m25, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline void StoreAoS3(float* p, __m256 x, __m256 y, __m256 z){
+            __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+            __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+            __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+
+            _mm_storeu_ps(p,      _mm256_castps256_ps128(r03));
+            _mm_storeu_ps(p + 4,  _mm256_castps256_ps128(r14));
+            _mm_storeu_ps(p + 8,  _mm256_castps256_ps128(r25));
+            _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r03, 1));
+            _mm_storeu_ps(p + 16, _mm256_extractf128_ps(r14, 1));
+            _mm_storeu_ps(p + 20, _mm256_extractf128_ps(r25, 1));
+        }
+
+        template<bool isPoint>
+        size_t TransformAoS3(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            const float* in  = reinterpret_cast<const float*>(src);
+            float*       out = reinterpret_cast<float*>(dst);
+            const MatrixAVX avx(m);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 x, y, z;
+                LoadAoS3(in + index * 3, x, y, z);
+                TransformAVX<isPoint>(avx, x, y, z);
+                StoreAoS3(out + index * 3, x, y, z);
+            }
+            return index;
+        }
+
+        template<bool isPoint>
+        size_t TransformSoA3(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            const MatrixAVX avx(m);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 x = _mm256_loadu_ps(src.x + index);
+                __m256 y = _mm256_loadu_ps(src.y + index);
+                __m256 z = _mm256_loadu_ps(src.z + index);
+                TransformAVX<isPoint>(avx, x, y, z);
+                _mm256_storeu_ps(dst.x + index, x);
+                _mm256_storeu_ps(dst.y + index, y);
+                _mm256_storeu_ps(dst.z + index, z);
+            }
+            return index;
+        }
+
+        // the remainder (< 8) goes to the SSE4.1 kernels, streams are offset through their
+        // trivial copies so no inline member is called from this unit
+        inline void Advance(ConstVector3fStream& src, Vector3fStream& dst, size_t count){
+            src.x += count; src.y += count; src.z += count;
+            dst.x += count; dst.y += count; dst.z += count;
+        }
+
+        void PointsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            size_t done = TransformAoS3<true>(src, dst, count, m);
+            Kernel::SSE41.transformPoints(src + done, dst + done, count - done, m);
+        }
+
+        void VectorsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            size_t done = TransformAoS3<false>(src, dst, count, m);
+            Kernel::SSE41.transformVectors(src + done, dst + done, count - done, m);
+        }
+
+        void Homogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m){
+            // two vectors per register, splat each component inside its own lane
+            const __m256 r0 = _mm256_broadcast_ps(&m.row[0].sse);
+            const __m256 r1 = _mm256_broadcast_ps(&m.row[1].sse);
+            const __m256 r2 = _mm256_broadcast_ps(&m.row[2].sse);
+            const __m256 r3 = _mm256_broadcast_ps(&m.row[3].sse);
+
+            size_t index = 0;
+            for(; index + 2 <= count; index += 2){
+                __m256 v = _mm256_loadu_ps(src[index].data);
+
+                __m256 a = _mm256_mul_ps(_mm256_permute_ps(v, 0x00), r0);
+                __m256 c = _mm256_mul_ps(_mm256_permute_ps(v, 0xAA), r2);
+                a = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), r1, a);
+                c = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xFF), r3, c);
+
+                _mm256_storeu_ps(dst[index].data, _mm256_add_ps(a, c));
+            }
+            Kernel::SSE41.transformHomogeneous(src + index, dst + index, count - index, m);
+        }
+
+        void PointsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            size_t done = TransformSoA3<true>(src, dst, count, m);
+            ConstVector3fStream tailSrc = src;
+            Vector3fStream      tailDst = dst;
+            Advance(tailSrc, tailDst, done);
+            Kernel::SSE41.transformPointsSoA(tailSrc, tailDst, count - done, m);
+        }
+
+        void VectorsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            size_t done = TransformSoA3<false>(src, dst, count, m);
+            ConstVector3fStream tailSrc = src;
+            Vector3fStream      tailDst = dst;
+            Advance(tailSrc, tailDst, done);
+            Kernel::SSE41.transformVectorsSoA(tailSrc, tailDst, count - done, m);
+        }
+
+        struct PlanesAVX{
+            explicit PlanesAVX(const Frustum& frustum){
+                for(int p = 0; p < Frustum::Count; p++){
+                    const float* plane = frustum.planes[p].data;
+                    for(int k = 0; k < 4; k++) n[p][k] = _mm256_set1_ps(plane[k]);
+                    for(int k = 0; k < 3; k++) a[p][k] = _mm256_set1_ps(plane[k] < 0.0f ? -plane[k] : plane[k]);
+                }
+            }
+            __m256 n[Frustum::Count][4];
+            __m256 a[Frustum::Count][3];
+        };
+
+        // 8 boxes against the six planes, one visibility bit per box
+        inline int CullAVX(const PlanesAVX& pl, const float* const box[6], size_t offset){
+            __m256 cx = _mm256_loadu_ps(box[0] + offset), cy = _mm256_loadu_ps(box[1] + offset), cz = _mm256_loadu_ps(box[2] + offset);
+            __m256 ex = _mm256_loadu_ps(box[3] + offset), ey = _mm256_loadu_ps(box[4] + offset), ez = _mm256_loadu_ps(box[5] + offset);
+
+            __m256 outside = _mm256_setzero_ps();
+            for(int p = 0; p < Frustum::Count; p++){
+                __m256 d = _mm256_fmadd_ps(cx, pl.n[p][0], pl.n[p][3]);
+                d = _mm256_fmadd_ps(cy, pl.n[p][1], d);
+                d = _mm256_fmadd_ps(cz, pl.n[p][2], d);
+                d = _mm256_fmadd_ps(ex, pl.a[p][0], d);
+                d = _mm256_fmadd_ps(ey, pl.a[p][1], d);
+                d = _mm256_fmadd_ps(ez, pl.a[p][2], d);
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+            }
+            return ~_mm256_movemask_ps(outside) & 0xFF;
+        }
+
+        void Lerp(const float* a, const float* b, const float* t, float* out, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 va = _mm256_loadu_ps(a + index);
+                __m256 vb = _mm256_loadu_ps(b + index);
+                _mm256_storeu_ps(out + index, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(vb, va), _mm256_loadu_ps(t + index))));
+            }
+            Kernel::SSE41.lerpFloats(a + index, b + index, t + index, out + index, count - index);
+        }
+
+        void Accumulate(const float* src, float scale, float* dst, size_t count){
+            const __m256 s = _mm256_set1_ps(scale);
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                _mm256_storeu_ps(dst + index, _mm256_fmadd_ps(_mm256_loadu_ps(src + index), s, _mm256_loadu_ps(dst + index)));
+            }
+            Kernel::SSE41.addScaledFloats(src + index, scale, dst + index, count - index);
+        }
+
+        inline void Advance(ConstQuaternionStream& a, ConstQuaternionStream& b, QuaternionStream& out, size_t count){
+            a.x += count;   a.y += count;   a.z += count;   a.w += count;
+            b.x += count;   b.y += count;   b.z += count;   b.w += count;
+            out.x += count; out.y += count; out.z += count; out.w += count;
+        }
+
+        void Slerp(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count){
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+            const __m256 one     = _mm256_set1_ps(1.0f);
+            const __m256 half    = _mm256_set1_ps(0.5f);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 ax = _mm256_loadu_ps(a.x + index), ay = _mm256_loadu_ps(a.y + index);
+                __m256 az = _mm256_loadu_ps(a.z + index), aw = _mm256_loadu_ps(a.w + index);
+                __m256 bx = _mm256_loadu_ps(b.x + index), by = _mm256_loadu_ps(b.y + index);
+                __m256 bz = _mm256_loadu_ps(b.z + index), bw = _mm256_loadu_ps(b.w + index);
+                __m256 vt = _mm256_loadu_ps(t + index);
+
+                __m256 cosine = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz)), _mm256_mul_ps(aw, bw));
+                __m256 d = _mm256_andnot_ps(signBit, cosine);
+
+                // SlerpWeight of the scalar kernel
+                __m256 ka = _mm256_sub_ps(_mm256_set1_ps(3.55645f), _mm256_mul_ps(d, _mm256_set1_ps(1.43519f)));
+                ka = _mm256_add_ps(_mm256_set1_ps(-3.2452f), _mm256_mul_ps(d, ka));
+                ka = _mm256_add_ps(_mm256_set1_ps(1.0904f), _mm256_mul_ps(d, ka));
+                __m256 kb = _mm256_add_ps(_mm256_set1_ps(-1.06021f), _mm256_mul_ps(d, _mm256_set1_ps(0.215638f)));
+                kb = _mm256_add_ps(_mm256_set1_ps(0.848013f), _mm256_mul_ps(d, kb));
+                __m256 h = _mm256_sub_ps(vt, half);
+                __m256 k = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ka, h), h), kb);
+                __m256 wb = _mm256_add_ps(vt, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(vt, h), _mm256_sub_ps(vt, one)), k));
+                __m256 wa = _mm256_sub_ps(one, wb);
+                wb = _mm256_or_ps(wb, _mm256_and_ps(cosine, signBit));
+
+                __m256 x = _mm256_add_ps(_mm256_mul_ps(ax, wa), _mm256_mul_ps(bx, wb));
+                __m256 y = _mm256_add_ps(_mm256_mul_ps(ay, wa), _mm256_mul_ps(by, wb));
+                __m256 z = _mm256_add_ps(_mm256_mul_ps(az, wa), _mm256_mul_ps(bz, wb));
+                __m256 w = _mm256_add_ps(_mm256_mul_ps(aw, wa), _mm256_mul_ps(bw, wb));
+
+                __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)), _mm256_mul_ps(w, w)));
+                _mm256_storeu_ps(out.x + index, _mm256_div_ps(x, length));
+                _mm256_storeu_ps(out.y + index, _mm256_div_ps(y, length));
+                _mm256_storeu_ps(out.z + index, _mm256_div_ps(z, length));
+                _mm256_storeu_ps(out.w + index, _mm256_div_ps(w, length));
+            }
+
+            ConstQuaternionStream tailA = a, tailB = b;
+            QuaternionStream      tailOut = out;
+            Advance(tailA, tailB, tailOut, index);
+            Kernel::SSE41.slerpQuaternions(tailA, tailB, t + index, tailOut, count - index);
+        }
+
+        // float offsets of the palette entries of 8 vertices, entries are 1 << shift floats apart
+        template<int shift>
+        inline __m256i JointOffsets(const uint16_t* joint){
+            __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(joint)));
+            return _mm256_slli_epi32(index, shift);
+        }
+
+        inline void Advance(ConstSkinWeightStream& weights, ConstSkinVertexStream& src, SkinVertexStream& dst, size_t count){
+            for(int i = 0; i < 4; i++){
+                weights.joint[i]  += count;
+                weights.weight[i] += count;
+            }
+            Advance(src.position, dst.position, count);
+            if(src.normal.x != nullptr)  Advance(src.normal, dst.normal, count);
+            if(src.tangent.x != nullptr) Advance(src.tangent, dst.tangent, count);
+        }
+
+        template<bool isPoint>
+        inline void SkinStreamAVX(const MatrixAVX& m, const ConstVector3fStream& src, const Vector3fStream& dst, size_t index){
+            __m256 x = _mm256_loadu_ps(src.x + index);
+            __m256 y = _mm256_loadu_ps(src.y + index);
+            __m256 z = _mm256_loadu_ps(src.z + index);
+            TransformAVX<isPoint>(m, x, y, z);
+            _mm256_storeu_ps(dst.x + index, x);
+            _mm256_storeu_ps(dst.y + index, y);
+            _mm256_storeu_ps(dst.z + index, z);
+        }
+
+        // 8x8 transpose, afterwards r[k] holds element k of the 8 inputs
+        inline void Transpose8x8(__m256 r[8]){
+            __m256 t[8], s[8];
+            for(int i = 0; i < 8; i += 2){
+                t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+                t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+            }
+            for(int i = 0; i < 8; i += 4){
+                s[i]     = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+                s[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+                s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+                s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+            }
+            for(int i = 0; i < 4; i++){
+                r[i]     = _mm256_permute2f128_ps(s[i], s[i + 4], 0x20);
+                r[i + 4] = _mm256_permute2f128_ps(s[i], s[i + 4], 0x31);
+            }
+        }
+
+        void LinearBlend(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            const float* base = reinterpret_cast<const float*>(palette);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                // each matrix is blended as two halves of two rows, the 8 results are then
+                // transposed into the lanes, cheaper than gathering every element
+                __m256 upper[8], lower[8];
+                for(int v = 0; v < 8; v++){
+                    for(int i = 0; i < 4; i++){
+                        const float* joint = base + size_t(weights.joint[i][index + v]) * 16;
+                        const __m256 weight = _mm256_broadcast_ss(weights.weight[i] + index + v);
+                        upper[v] = i == 0 ? _mm256_mul_ps(_mm256_loadu_ps(joint), weight) : _mm256_fmadd_ps(_mm256_loadu_ps(joint), weight, upper[v]);
+                        lower[v] = i == 0 ? _mm256_mul_ps(_mm256_loadu_ps(joint + 8), weight) : _mm256_fmadd_ps(_mm256_loadu_ps(joint + 8), weight, lower[v]);
+                    }
+                }
+                Transpose8x8(upper);
+                Transpose8x8(lower);
+
+                MatrixAVX m;
+                for(int c = 0; c < 3; c++){
+                    m.c[0][c] = upper[c];
+                    m.c[1][c] = upper[c + 4];
+                    m.c[2][c] = lower[c];
+                    m.c[3][c] = lower[c + 4];
+                }
+
+                SkinStreamAVX<true>(m, src.position, dst.position, index);
+                if(src.normal.x != nullptr)  SkinStreamAVX<false>(m, src.normal, dst.normal, index);
+                if(src.tangent.x != nullptr) SkinStreamAVX<false>(m, src.tangent, dst.tangent, index);
+            }
+
+            ConstSkinWeightStream tailWeights = weights;
+            ConstSkinVertexStream tailSrc = src;
+            SkinVertexStream      tailDst = dst;
+            Advance(tailWeights, tailSrc, tailDst, index);
+            Kernel::SSE41.skinLinear(palette, tailWeights, tailSrc, tailDst, count - index);
+        }
+
+        // v + 2 r.xyz x (r.xyz x v + r.w v), r is a unit quaternion
+        inline void RotateAVX(const __m256 r[4], __m256& x, __m256& y, __m256& z){
+            __m256 cx = _mm256_fmadd_ps(r[3], x, _mm256_fmsub_ps(r[1], z, _mm256_mul_ps(r[2], y)));
+            __m256 cy = _mm256_fmadd_ps(r[3], y, _mm256_fmsub_ps(r[2], x, _mm256_mul_ps(r[0], z)));
+            __m256 cz = _mm256_fmadd_ps(r[3], z, _mm256_fmsub_ps(r[0], y, _mm256_mul_ps(r[1], x)));
+
+            const __m256 two = _mm256_set1_ps(2.0f);
+            x = _mm256_fmadd_ps(two, _mm256_fmsub_ps(r[1], cz, _mm256_mul_ps(r[2], cy)), x);
+            y = _mm256_fmadd_ps(two, _mm256_fmsub_ps(r[2], cx, _mm256_mul_ps(r[0], cz)), y);
+            z = _mm256_fmadd_ps(two, _mm256_fmsub_ps(r[0], cy, _mm256_mul_ps(r[1], cx)), z);
+        }
+
+        inline void RotateStreamAVX(const __m256 r[4], const ConstVector3fStream& src, const Vector3fStream& dst, size_t index){
+            __m256 x = _mm256_loadu_ps(src.x + index);
+            __m256 y = _mm256_loadu_ps(src.y + index);
+            __m256 z = _mm256_loadu_ps(src.z + index);
+            RotateAVX(r, x, y, z);
+            _mm256_storeu_ps(dst.x + index, x);
+            _mm256_storeu_ps(dst.y + index, y);
+            _mm256_storeu_ps(dst.z + index, z);
+        }
+
+        void DualQuaternionBlend(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            const float* base = reinterpret_cast<const float*>(palette);
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+            const __m256 two     = _mm256_set1_ps(2.0f);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 first[4], real[4], dual[4];
+                for(int i = 0; i < 4; i++){
+                    const __m256i offset = JointOffsets<3>(weights.joint[i] + index);
+                    __m256 weight = _mm256_loadu_ps(weights.weight[i] + index);
+
+                    __m256 q[4], d[4];
+                    for(int k = 0; k < 4; k++){
+                        q[k] = _mm256_i32gather_ps(base + k, offset, 4);
+                        d[k] = _mm256_i32gather_ps(base + 4 + k, offset, 4);
+                    }
+
+                    // q and -q are the same rotation, every joint is blended on the side of the first
+                    if(i == 0){
+                        for(int k = 0; k < 4; k++) first[k] = q[k];
+                    }
+                    else{
+                        __m256 cosine = _mm256_fmadd_ps(q[3], first[3], _mm256_fmadd_ps(q[2], first[2], _mm256_fmadd_ps(q[1], first[1], _mm256_mul_ps(q[0], first[0]))));
+                        weight = _mm256_xor_ps(weight, _mm256_and_ps(cosine, signBit));
+                    }
+
+                    for(int k = 0; k < 4; k++){
+                        real[k] = i == 0 ? _mm256_mul_ps(q[k], weight) : _mm256_fmadd_ps(q[k], weight, real[k]);
+                        dual[k] = i == 0 ? _mm256_mul_ps(d[k], weight) : _mm256_fmadd_ps(d[k], weight, dual[k]);
+                    }
+                }
+
+                __m256 length = _mm256_fmadd_ps(real[3], real[3], _mm256_fmadd_ps(real[2], real[2], _mm256_fmadd_ps(real[1], real[1], _mm256_mul_ps(real[0], real[0]))));
+                __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length));
+                for(int k = 0; k < 4; k++){
+                    real[k] = _mm256_mul_ps(real[k], inv);
+                    dual[k] = _mm256_mul_ps(dual[k], inv);
+                }
+
+                // translation, the vector part of 2 dual * conjugate(real)
+                __m256 tx = _mm256_fmsub_ps(real[3], dual[0], _mm256_mul_ps(dual[3], real[0]));
+                __m256 ty = _mm256_fmsub_ps(real[3], dual[1], _mm256_mul_ps(dual[3], real[1]));
+                __m256 tz = _mm256_fmsub_ps(real[3], dual[2], _mm256_mul_ps(dual[3], real[2]));
+                tx = _mm256_mul_ps(two, _mm256_add_ps(tx, _mm256_fmsub_ps(real[1], dual[2], _mm256_mul_ps(real[2], dual[1]))));
+                ty = _mm256_mul_ps(two, _mm256_add_ps(ty, _mm256_fmsub_ps(real[2], dual[0], _mm256_mul_ps(real[0], dual[2]))));
+                tz = _mm256_mul_ps(two, _mm256_add_ps(tz, _mm256_fmsub_ps(real[0], dual[1], _mm256_mul_ps(real[1], dual[0]))));
+
+                __m256 x = _mm256_loadu_ps(src.position.x + index);
+                __m256 y = _mm256_loadu_ps(src.position.y + index);
+                __m256 z = _mm256_loadu_ps(src.position.z + index);
+                RotateAVX(real, x, y, z);
+                _mm256_storeu_ps(dst.position.x + index, _mm256_add_ps(x, tx));
+                _mm256_storeu_ps(dst.position.y + index, _mm256_add_ps(y, ty));
+                _mm256_storeu_ps(dst.position.z + index, _mm256_add_ps(z, tz));
+
+                if(src.normal.x != nullptr)  RotateStreamAVX(real, src.normal, dst.normal, index);
+                if(src.tangent.x != nullptr) RotateStreamAVX(real, src.tangent, dst.tangent, index);
+            }
+
+            ConstSkinWeightStream tailWeights = weights;
+            ConstSkinVertexStream tailSrc = src;
+            SkinVertexStream      tailDst = dst;
+            Advance(tailWeights, tailSrc, tailDst, index);
+            Kernel::SSE41.skinDualQuaternion(palette, tailWeights, tailSrc, tailDst, count - index);
+        }
+
+        void BoxesInFrustum(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible){
+            for(size_t word = 0; word < (count + 31) / 32; word++) visible[word] = 0;
+
+            const PlanesAVX pl(frustum);
+            const float* const stream[6] = {boxes.cx, boxes.cy, boxes.cz, boxes.ex, boxes.ey, boxes.ez};
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                visible[index >> 5] |= static_cast<uint32_t>(CullAVX(pl, stream, index)) << (index & 31);
+            }
+
+            if(index < count){
+                // copy the last boxes into zero padded lanes, their bits are masked off
+                size_t rest = count - index;
+                float pad[6][8] = {};
+                for(int k = 0; k < 6; k++){
+                    for(size_t i = 0; i < rest; i++) pad[k][i] = stream[k][index + i];
+                }
+                const float* const padStream[6] = {pad[0], pad[1], pad[2], pad[3], pad[4], pad[5]};
+                uint32_t bits = static_cast<uint32_t>(CullAVX(pl, padStream, 0)) & ((1u << rest) - 1);
+                visible[index >> 5] |= bits << (index & 31);
+            }
+        }
+
+        inline __m256 AbsAVX(__m256 value){
+            return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+        }
+
+        inline __m256i ToSNorm16AVX(__m256 value){
+            value = _mm256_and_ps(value, _mm256_cmp_ps(value, value, _CMP_ORD_Q));
+            value = _mm256_max_ps(_mm256_min_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(-1.0f));
+            return _mm256_cvtps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(32767.0f)));
+        }
+
+        inline __m256 FromSNorm16AVX(__m128i value){
+            __m256 result = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(value)), _mm256_set1_ps(1.0f / 32767.0f));
+            return _mm256_max_ps(result, _mm256_set1_ps(-1.0f));
+        }
+
+        // F16C rounds exactly like the integer path of the other levels
+        void FloatToHalf(const float* src, uint16_t* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + index), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), half);
+            }
+            Kernel::SSE41.floatToHalf(src + index, dst + index, count - index);
+        }
+
+        void HalfToFloat(const uint16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                _mm256_storeu_ps(dst + index, _mm256_cvtph_ps(half));
+            }
+            Kernel::SSE41.halfToFloat(src + index, dst + index, count - index);
+        }
+
+        void FloatToSNorm16(const float* src, int16_t* dst, size_t count){
+            size_t index = 0;
+            for(; index + 16 <= count; index += 16){
+                // in lane pack, the permute restores the element order
+                __m256i value = _mm256_packs_epi32(ToSNorm16AVX(_mm256_loadu_ps(src + index)), ToSNorm16AVX(_mm256_loadu_ps(src + index + 8)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), _mm256_permute4x64_epi64(value, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            Kernel::SSE41.floatToSNorm16(src + index, dst + index, count - index);
+        }
+
+        void SNorm16ToFloat(const int16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                _mm256_storeu_ps(dst + index, FromSNorm16AVX(value));
+            }
+            Kernel::SSE41.snorm16ToFloat(src + index, dst + index, count - index);
+        }
+
+        void OctahedralEncode(const float* src, int16_t* dst, size_t count){
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+            const __m256 one     = _mm256_set1_ps(1.0f);
+
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m256 x, y, z;
+                LoadAoS3(src + index * 3, x, y, z);
+
+                __m256 inv = _mm256_div_ps(one, _mm256_add_ps(_mm256_add_ps(AbsAVX(x), AbsAVX(y)), AbsAVX(z)));
+                x = _mm256_mul_ps(x, inv);
+                y = _mm256_mul_ps(y, inv);
+
+                __m256 fx = _mm256_mul_ps(_mm256_sub_ps(one, AbsAVX(y)), _mm256_or_ps(one, _mm256_and_ps(x, signBit)));
+                __m256 fy = _mm256_mul_ps(_mm256_sub_ps(one, AbsAVX(x)), _mm256_or_ps(one, _mm256_and_ps(y, signBit)));
+                __m256 lower = _mm256_cmp_ps(z, _mm256_setzero_ps(), _CMP_LT_OQ);
+                x = _mm256_blendv_ps(x, fx, lower);
+                y = _mm256_blendv_ps(y, fy, lower);
+
+                // unpack and pack both work inside the 128 bit lanes, so the pairs come out in order
+                __m256i lo = ToSNorm16AVX(_mm256_unpacklo_ps(x, y));
+                __m256i hi = ToSNorm16AVX(_mm256_unpackhi_ps(x, y));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index * 2), _mm256_packs_epi32(lo, hi));
+            }
+            Kernel::SSE41.encodeOctahedral(src + index * 3, dst + index * 2, count - index);
+        }
+
+        void OctahedralDecode(const int16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                const __m128i* in = reinterpret_cast<const __m128i*>(src + index * 2);
+                __m256 a = FromSNorm16AVX(_mm_loadu_si128(in));     // x0 y0 x1 y1 | x2 y2 x3 y3
+                __m256 b = FromSNorm16AVX(_mm_loadu_si128(in + 1)); // x4 y4 x5 y5 | x6 y6 x7 y7
+
+                // x0 x1 x4 x5 | x2 x3 x6 x7, the permute restores x0..x3 | x4..x7 for StoreAoS3
+                __m256 x = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 y = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(x), _MM_SHUFFLE(3, 1, 2, 0)));
+                y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(y), _MM_SHUFFLE(3, 1, 2, 0)));
+
+                __m256 z = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), AbsAVX(x)), AbsAVX(y));
+                __m256 t = _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), z), _mm256_setzero_ps());
+                __m256 negT = _mm256_sub_ps(_mm256_setzero_ps(), t);
+                x = _mm256_add_ps(x, _mm256_blendv_ps(t, negT, _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GE_OQ)));
+                y = _mm256_add_ps(y, _mm256_blendv_ps(t, negT, _mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_GE_OQ)));
+
+                __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+                StoreAoS3(dst + index * 3, _mm256_div_ps(x, length), _mm256_div_ps(y, length), _mm256_div_ps(z, length));
+            }
+            Kernel::SSE41.decodeOctahedral(src + index * 2, dst + index * 3, count - index);
+        }
+
+    }
+
+    const Kernel::BatchTable Kernel::AVX2 = {
+        Utility::SimdLevel::AVX2,
+        PointsAoS,
+        VectorsAoS,
+        Homogeneous,
+        PointsSoA,
+        VectorsSoA,
+        Lerp,
+        Slerp,
+        Accumulate,
+        LinearBlend,
+        DualQuaternionBlend,
+        BoxesInFrustum,
+        FloatToHalf,
+        HalfToFloat,
+        FloatToSNorm16,
+        SNorm16ToFloat,
+        OctahedralEncode,
+        OctahedralDecode
+    };
+
+}
@@ -0,0 +1,318 @@
+#include "GeoMathBatchKernel.hpp"
+
+// built with AVX-512F enabled, only reached through the dispatch table.
+// Nothing here may run during static initialization, the index tables are function local.
+namespace GeoMath{
+
+    namespace{
+
+        struct MatrixAVX512{
+            explicit MatrixAVX512(const Matrix4f& m){
+                for(int i = 0; i < 4; i++){
+                    for(int j = 0; j < 3; j++){
+                        c[i][j] = _mm512_set1_ps(m.data[i][j]);
+                    }
+                }
+            }
+            __m512 c[4][3];
+        };
+
+        template<bool isPoint>
+        inline void TransformAVX512(const MatrixAVX512& m, __m512& x, __m512& y, __m512& z){
+            __m512 rx = _mm512_mul_ps(x, m.c[0][0]);
+            __m512 ry = _mm512_mul_ps(x, m.c[0][1]);
+            __m512 rz = _mm512_mul_ps(x, m.c[0][2]);
+
+            rx = _mm512_fmadd_ps(y, m.c[1][0], rx);
+            ry = _mm512_fmadd_ps(y, m.c[1][1], ry);
+            rz = _mm512_fmadd_ps(y, m.c[1][2], rz);
+
+            rx = _mm512_fmadd_ps(z, m.c[2][0], rx);
+            ry = _mm512_fmadd_ps(z, m.c[2][1], ry);
+            rz = _mm512_fmadd_ps(z, m.c[2][2], rz);
+
+            if(isPoint){
+                rx = _mm512_add_ps(rx, m.c[3][0]);
+                ry = _mm512_add_ps(ry, m.c[3][1]);
+                rz = _mm512_add_ps(rz, m.c[3][2]);
+            }
+
+            x = rx;
+            y = ry;
+            z = rz;
+        }
+
+        // permutex2var indices between 16 packed Vector3f (a | b | c, 48 floats) and x, y, z.
+        // Loading takes two steps per component: a,b -> t, then t,c -> result.
+        // Storing does the same: x,y -> t, then t,z -> output register.
+        struct AoS3Index{
+            AoS3Index(){
+                for(int k = 0; k < 3; k++){
+                    for(int i = 0; i < 16; i++){
+                        int f = 3 * i + k;
+                        load0[k][i] = f < 32 ? f : 0;
+                        load1[k][i] = f < 32 ? i : 16 + f - 32;
+                    }
+                }
+                for(int r = 0; r < 3; r++){
+                    for(int l = 0; l < 16; l++){
+                        int f = 16 * r + l;
+                        int p = f / 3;
+                        int k = f % 3;
+                        store0[r][l] = k == 0 ? p : 16 + p;
+                        store1[r][l] = k == 2 ? 16 + p : l;
+                    }
+                }
+            }
+            alignas(64) int32_t load0[3][16];
+            alignas(64) int32_t load1[3][16];
+            alignas(64) int32_t store0[3][16];
+            alignas(64) int32_t store1[3][16];
+        };
+
+        const AoS3Index& GetAoS3Index(){
+            static const AoS3Index index;
+            return index;
+        }
+
+        // the index tables held in registers for a whole batch
+        struct AoS3Permute{
+            explicit AoS3Permute(const AoS3Index& idx){
+                for(int k = 0; k < 3; k++){
+                    load0[k]  = _mm512_load_si512(idx.load0[k]);
+                    load1[k]  = _mm512_load_si512(idx.load1[k]);
+                    store0[k] = _mm512_load_si512(idx.store0[k]);
+                    store1[k] = _mm512_load_si512(idx.store1[k]);
+                }
+            }
+            __m512i load0[3], load1[3], store0[3], store1[3];
+        };
+
+        inline __mmask16 TailMask(size_t count){
+            return count >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << count) - 1);
+        }
+
+        inline void LoadAoS3(const AoS3Permute& idx, __m512 a, __m512 b, __m512 c, __m512& x, __m512& y, __m512& z){
+            x = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, idx.load0[0], b), idx.load1[0], c);
+            y = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, idx.load0[1], b), idx.load1[1], c);
+            z = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, idx.load0[2], b), idx.load1[2], c);
+        }
+
+        inline __m512 StoreAoS3(const AoS3Permute& idx, int r, __m512 x, __m512 y, __m512 z){
+            return _mm512_permutex2var_ps(_mm512_permutex2var_ps(x, idx.store0[r], y), idx.store1[r], z);
+        }
+
+        template<bool isPoint>
+        void TransformAoS3(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            const float* in  = reinterpret_cast<const float*>(src);
+            float*       out = reinterpret_cast<float*>(dst);
+            const MatrixAVX512 avx(m);
+            const AoS3Permute  idx(GetAoS3Index());
+
+            size_t index = 0;
+            for(; index + 16 <= count; index += 16){
+                const float* p = in + index * 3;
+                float*       q = out + index * 3;
+                __m512 x, y, z;
+                LoadAoS3(idx, _mm512_loadu_ps(p), _mm512_loadu_ps(p + 16), _mm512_loadu_ps(p + 32), x, y, z);
+                TransformAVX512<isPoint>(avx, x, y, z);
+                _mm512_storeu_ps(q,      StoreAoS3(idx, 0, x, y, z));
+                _mm512_storeu_ps(q + 16, StoreAoS3(idx, 1, x, y, z));
+                _mm512_storeu_ps(q + 32, StoreAoS3(idx, 2, x, y, z));
+            }
+
+            if(index < count){
+                // masked so nothing past the last Vector3f is touched
+                const float* p = in + index * 3;
+                float*       q = out + index * 3;
+                size_t floats = (count - index) * 3;
+                __mmask16 ma = TailMask(floats);
+                __mmask16 mb = TailMask(floats > 16 ? floats - 16 : 0);
+                __mmask16 mc = TailMask(floats > 32 ? floats - 32 : 0);
+
+                __m512 x, y, z;
+                LoadAoS3(idx, _mm512_maskz_loadu_ps(ma, p), _mm512_maskz_loadu_ps(mb, p + 16), _mm512_maskz_loadu_ps(mc, p + 32), x, y, z);
+                TransformAVX512<isPoint>(avx, x, y, z);
+                _mm512_mask_storeu_ps(q,      ma, StoreAoS3(idx, 0, x, y, z));
+                _mm512_mask_storeu_ps(q + 16, mb, StoreAoS3(idx, 1, x, y, z));
+                _mm512_mask_storeu_ps(q + 32, mc, StoreAoS3(idx, 2, x, y, z));
+            }
+        }
+
+        template<bool isPoint>
+        void TransformSoA3(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            const MatrixAVX512 avx(m);
+
+            size_t index = 0;
+            for(; index + 16 <= count; index += 16){
+                __m512 x = _mm512_loadu_ps(src.x + index);
+                __m512 y = _mm512_loadu_ps(src.y + index);
+                __m512 z = _mm512_loadu_ps(src.z + index);
+                TransformAVX512<isPoint>(avx, x, y, z);
+                _mm512_storeu_ps(dst.x + index, x);
+                _mm512_storeu_ps(dst.y + index, y);
+                _mm512_storeu_ps(dst.z + index, z);
+            }
+
+            if(index < count){
+                __mmask16 mask = TailMask(count - index);
+                __m512 x = _mm512_maskz_loadu_ps(mask, src.x + index);
+                __m512 y = _mm512_maskz_loadu_ps(mask, src.y + index);
+                __m512 z = _mm512_maskz_loadu_ps(mask, src.z + index);
+                TransformAVX512<isPoint>(avx, x, y, z);
+                _mm512_mask_storeu_ps(dst.x + index, mask, x);
+                _mm512_mask_storeu_ps(dst.y + index, mask, y);
+                _mm512_mask_storeu_ps(dst.z + index, mask, z);
+            }
+        }
+
+        void PointsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<true>(src, dst, count, m);
+        }
+
+        void VectorsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<false>(src, dst, count, m);
+        }
+
+        void Homogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m){
+            // four vectors per register, splat each component inside its own 128 bit lane
+            const __m512 r0 = _mm512_broadcast_f32x4(m.row[0].sse);
+            const __m512 r1 = _mm512_broadcast_f32x4(m.row[1].sse);
+            const __m512 r2 = _mm512_broadcast_f32x4(m.row[2].sse);
+            const __m512 r3 = _mm512_broadcast_f32x4(m.row[3].sse);
+
+            const float* in  = reinterpret_cast<const float*>(src);
+            float*       out = reinterpret_cast<float*>(dst);
+            auto transform = [&](__m512 v){
+                __m512 a = _mm512_mul_ps(_mm512_permute_ps(v, 0x00), r0);
+                __m512 c = _mm512_mul_ps(_mm512_permute_ps(v, 0xAA), r2);
+                a = _mm512_fmadd_ps(_mm512_permute_ps(v, 0x55), r1, a);
+                c = _mm512_fmadd_ps(_mm512_permute_ps(v, 0xFF), r3, c);
+                return _mm512_add_ps(a, c);
+            };
+
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                _mm512_storeu_ps(out + index * 4, transform(_mm512_loadu_ps(in + index * 4)));
+            }
+
+            if(index < count){
+                __mmask16 mask = TailMask((count - index) * 4);
+                _mm512_mask_storeu_ps(out + index * 4, mask, transform(_mm512_maskz_loadu_ps(mask, in + index * 4)));
+            }
+        }
+
+        void PointsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<true>(src, dst, count, m);
+        }
+
+        void VectorsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<false>(src, dst, count, m);
+        }
+
+        // the keyframe kernels are bound by memory at 256 bit already, reuse the AVX2 kernels
+        void Lerp(const float* a, const float* b, const float* t, float* out, size_t count){
+            Kernel::AVX2.lerpFloats(a, b, t, out, count);
+        }
+
+        void Slerp(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count){
+            Kernel::AVX2.slerpQuaternions(a, b, t, out, count);
+        }
+
+        void Accumulate(const float* src, float scale, float* dst, size_t count){
+            Kernel::AVX2.addScaledFloats(src, scale, dst, count);
+        }
+
+        // skinning is bound by fetching the palette entries of every vertex, 512 bit lanes do not fetch them faster
+        void LinearBlend(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            Kernel::AVX2.skinLinear(palette, weights, src, dst, count);
+        }
+
+        void DualQuaternionBlend(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            Kernel::AVX2.skinDualQuaternion(palette, weights, src, dst, count);
+        }
+
+        // 16 boxes against the six planes, the compare masks are the visibility bits
+        void BoxesInFrustum(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible){
+            __m512 n[Frustum::Count][4];
+            __m512 a[Frustum::Count][3];
+            for(int p = 0; p < Frustum::Count; p++){
+                const float* plane = frustum.planes[p].data;
+                for(int k = 0; k < 4; k++) n[p][k] = _mm512_set1_ps(plane[k]);
+                for(int k = 0; k < 3; k++) a[p][k] = _mm512_set1_ps(plane[k] < 0.0f ? -plane[k] : plane[k]);
+            }
+
+            for(size_t word = 0; word < (count + 31) / 32; word++) visible[word] = 0;
+
+            for(size_t index = 0; index < count; index += 16){
+                __mmask16 mask = TailMask(count - index);
+                __m512 cx = _mm512_maskz_loadu_ps(mask, boxes.cx + index);
+                __m512 cy = _mm512_maskz_loadu_ps(mask, boxes.cy + index);
+                __m512 cz = _mm512_maskz_loadu_ps(mask, boxes.cz + index);
+                __m512 ex = _mm512_maskz_loadu_ps(mask, boxes.ex + index);
+                __m512 ey = _mm512_maskz_loadu_ps(mask, boxes.ey + index);
+                __m512 ez = _mm512_maskz_loadu_ps(mask, boxes.ez + index);
+
+                __mmask16 inside = mask;
+                for(int p = 0; p < Frustum::Count; p++){
+                    __m512 d = _mm512_fmadd_ps(cx, n[p][0], n[p][3]);
+                    d = _mm512_fmadd_ps(cy, n[p][1], d);
+                    d = _mm512_fmadd_ps(cz, n[p][2], d);
+                    d = _mm512_fmadd_ps(ex, a[p][0], d);
+                    d = _mm512_fmadd_ps(ey, a[p][1], d);
+                    d = _mm512_fmadd_ps(ez, a[p][2], d);
+                    inside = _mm512_mask_cmp_ps_mask(inside, d, _mm512_setzero_ps(), _CMP_GE_OQ);
+                }
+                visible[index >> 5] |= static_cast<uint32_t>(inside) << (index & 31);
+            }
+        }
+
+        // the attribute conversions are bound by memory at 256 bit already, reuse the AVX2 kernels
+        void FloatToHalf(const float* src, uint16_t* dst, size_t count){
+            Kernel::AVX2.floatToHalf(src, dst, count);
+        }
+
+        void HalfToFloat(const uint16_t* src, float* dst, size_t count){
+            Kernel::AVX2.halfToFloat(src, dst, count);
+        }
+
+        void FloatToSNorm16(const float* src, int16_t* dst, size_t count){
+            Kernel::AVX2.floatToSNorm16(src, dst, count);
+        }
+
+        void SNorm16ToFloat(const int16_t* src, float* dst, size_t count){
+            Kernel::AVX2.snorm16ToFloat(src, dst, count);
+        }
+
+        void OctahedralEncode(const float* src, int16_t* dst, size_t count){
+            Kernel::AVX2.encodeOctahedral(src, dst, count);
+        }
+
+        void OctahedralDecode(const int16_t* src, float* dst, size_t count){
+            Kernel::AVX2.decodeOctahedral(src, dst, count);
+        }
+
+    }
+
+    const Kernel::BatchTable Kernel::AVX512 = {
+        Utility::SimdLevel::AVX512,
+        PointsAoS,
+        VectorsAoS,
+        Homogeneous,
+        PointsSoA,
+        VectorsSoA,
+        Lerp,
+        Slerp,
+        Accumulate,
+        LinearBlend,
+        DualQuaternionBlend,
+        BoxesInFrustum,
+        FloatToHalf,
+        HalfToFloat,
+        FloatToSNorm16,
+        SNorm16ToFloat,
+        OctahedralEncode,
+        OctahedralDecode
+    };
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "GeoMathBatch.hpp"
+
+namespace GeoMath{
+
+    // One table per instruction set, each defined in its own translation unit built with that
+    // instruction set enabled. The AVX2 and AVX-512 units only touch plain data of the GeoMath
+    // types and never call their inline members, so no wider copy of a shared inline function
+    // can be picked by the linker for the baseline code.
+    namespace Kernel{
+
+        struct BatchTable{
+            Utility::SimdLevel level;
+
+            void (*transformPoints)(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m);
+            void (*transformVectors)(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m);
+            void (*transformHomogeneous)(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m);
+
+            void (*transformPointsSoA)(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m);
+            void (*transformVectorsSoA)(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m);
+
+            void (*lerpFloats)(const float* a, const float* b, const float* t, float* out, size_t count);
+            void (*slerpQuaternions)(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count);
+            void (*addScaledFloats)(const float* src, float scale, float* dst, size_t count);
+
+            void (*skinLinear)(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count);
+            void (*skinDualQuaternion)(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count);
+
+            void (*cullBoxes)(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible);
+
+            void (*floatToHalf)(const float* src, uint16_t* dst, size_t count);
+            void (*halfToFloat)(const uint16_t* src, float* dst, size_t count);
+            void (*floatToSNorm16)(const float* src, int16_t* dst, size_t count);
+            void (*snorm16ToFloat)(const int16_t* src, float* dst, size_t count);
+            void (*encodeOctahedral)(const float* src, int16_t* dst, size_t count);
+            void (*decodeOctahedral)(const int16_t* src, float* dst, size_t count);
+        };
+
+        extern const BatchTable Scalar;
+        extern const BatchTable SSE41;
+        extern const BatchTable AVX2;
+        extern const BatchTable AVX512;
+
+    }
+
+}
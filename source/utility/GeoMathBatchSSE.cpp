@@ -0,0 +1,542 @@
+#include "GeoMathBatchKernel.hpp"
+
+namespace GeoMath{
+
+    namespace{
+
+        template<bool isPoint>
+        inline Vector3f TransformOne(const Vector3f& v, const Matrix4f& m){
+            return Vector4f(v, isPoint ? 1.0f : 0.0f) * m;
+        }
+
+        // broadcast the upper 4x3 part of the matrix once per batch
+        struct MatrixSSE{
+            explicit MatrixSSE(const Matrix4f& m){
+                for(int i = 0; i < 4; i++){
+                    for(int j = 0; j < 3; j++){
+                        c[i][j] = _mm_set1_ps(m.data[i][j]);
+                    }
+                }
+            }
+            __m128 c[4][3];
+        };
+
+        template<bool isPoint>
+        inline void TransformSSE(const MatrixSSE& m, __m128& x, __m128& y, __m128& z){
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m.c[0][0]), _mm_mul_ps(y, m.c[1][0])), _mm_mul_ps(z, m.c[2][0]));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m.c[0][1]), _mm_mul_ps(y, m.c[1][1])), _mm_mul_ps(z, m.c[2][1]));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m.c[0][2]), _mm_mul_ps(y, m.c[1][2])), _mm_mul_ps(z, m.c[2][2]));
+
+            if(isPoint){
+                rx = _mm_add_ps(rx, m.c[3][0]);
+                ry = _mm_add_ps(ry, m.c[3][1]);
+                rz = _mm_add_ps(rz, m.c[3][2]);
+            }
+
+            x = rx;
+            y = ry;
+            z = rz;
+        }
+
+        // (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) -> (x0..x3), (y0..y3), (z0..z3)
+        inline void LoadAoS3(const float* p, __m128& x, __m128& y, __m128& z){
+            __m128 a = _mm_loadu_ps(p);
+            __m128 b = _mm_loadu_ps(p + 4);
+            __m128 c = _mm_loadu_ps(p + 8);
+
+            __m128 t = VecShuffle(b, c, 2, 3, 0, 1); // x2 y2 z2 x3
+            __m128 u = VecShuffle(a, b, 1, 2, 0, 1); // y0 z0 y1 z1
+            __m128 v = VecShuffle(t, c, 1, 2, 2, 3); // y2 z2 y3 z3
+
+            x = VecShuffle(a, t, 0, 3, 0, 3);
+            y = VecShuffle(u, v, 0, 2, 0, 2);
+            z = VecShuffle(u, v, 1, 3, 1, 3);
+        }
+
+        inline void StoreAoS3(float* p, __m128 x, __m128 y, __m128 z){
+            __m128 u = _mm_unpacklo_ps(y, z);        // y0 z0 y1 z1
+            __m128 v = _mm_unpackhi_ps(y, z);        // y2 z2 y3 z3
+            __m128 s = VecShuffle(x, u, 0, 1, 0, 1); // x0 x1 y0 z0
+            __m128 q = VecShuffle(x, v, 2, 2, 0, 0); // x2 x2 y2 y2
+            __m128 r = VecShuffle(v, x, 1, 1, 3, 3); // z2 z2 x3 x3
+
+            _mm_storeu_ps(p,     VecShuffle(s, s, 0, 2, 3, 1));
+            _mm_storeu_ps(p + 4, VecShuffle(u, q, 2, 3, 0, 2));
+            _mm_storeu_ps(p + 8, VecShuffle(r, v, 0, 2, 2, 3));
+        }
+
+        template<bool isPoint>
+        void TransformAoS3(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            const float* in  = reinterpret_cast<const float*>(src);
+            float*       out = reinterpret_cast<float*>(dst);
+            size_t index = 0;
+
+            const MatrixSSE sse(m);
+            for(; index + 4 <= count; index += 4){
+                __m128 x, y, z;
+                LoadAoS3(in + index * 3, x, y, z);
+                TransformSSE<isPoint>(sse, x, y, z);
+                StoreAoS3(out + index * 3, x, y, z);
+            }
+
+            for(; index < count; index++){
+                dst[index] = TransformOne<isPoint>(src[index], m);
+            }
+        }
+
+        template<bool isPoint>
+        void TransformSoA3(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            size_t index = 0;
+
+            const MatrixSSE sse(m);
+            for(; index + 4 <= count; index += 4){
+                __m128 x = _mm_loadu_ps(src.x + index);
+                __m128 y = _mm_loadu_ps(src.y + index);
+                __m128 z = _mm_loadu_ps(src.z + index);
+                TransformSSE<isPoint>(sse, x, y, z);
+                _mm_storeu_ps(dst.x + index, x);
+                _mm_storeu_ps(dst.y + index, y);
+                _mm_storeu_ps(dst.z + index, z);
+            }
+
+            for(; index < count; index++){
+                Vector3f v = TransformOne<isPoint>(Vector3f(src.x[index], src.y[index], src.z[index]), m);
+                dst.x[index] = v.x;
+                dst.y[index] = v.y;
+                dst.z[index] = v.z;
+            }
+        }
+
+        void PointsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<true>(src, dst, count, m);
+        }
+
+        void VectorsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<false>(src, dst, count, m);
+        }
+
+        void Homogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m){
+            for(size_t index = 0; index < count; index++){
+                __m128 v = src[index].sse;
+
+                __m128 a = _mm_mul_ps(VecSwizzle1(v, 0), m.row[0].sse);
+                __m128 b = _mm_mul_ps(VecSwizzle1(v, 1), m.row[1].sse);
+                __m128 c = _mm_mul_ps(VecSwizzle1(v, 2), m.row[2].sse);
+                __m128 d = _mm_mul_ps(VecSwizzle1(v, 3), m.row[3].sse);
+
+                dst[index].sse = _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d));
+            }
+        }
+
+        void PointsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<true>(src, dst, count, m);
+        }
+
+        void VectorsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<false>(src, dst, count, m);
+        }
+
+        struct PlanesSSE{
+            explicit PlanesSSE(const Frustum& frustum){
+                for(int p = 0; p < Frustum::Count; p++){
+                    const float* plane = frustum.planes[p].data;
+                    for(int k = 0; k < 4; k++) n[p][k] = _mm_set1_ps(plane[k]);
+                    for(int k = 0; k < 3; k++) a[p][k] = _mm_set1_ps(std::abs(plane[k]));
+                }
+            }
+            __m128 n[Frustum::Count][4];
+            __m128 a[Frustum::Count][3];
+        };
+
+        // one visibility bit per box, a box is dropped when center distance + projected radius < 0
+        inline int CullSSE(const PlanesSSE& pl, const float* const box[6], size_t offset){
+            __m128 cx = _mm_loadu_ps(box[0] + offset), cy = _mm_loadu_ps(box[1] + offset), cz = _mm_loadu_ps(box[2] + offset);
+            __m128 ex = _mm_loadu_ps(box[3] + offset), ey = _mm_loadu_ps(box[4] + offset), ez = _mm_loadu_ps(box[5] + offset);
+
+            __m128 outside = _mm_setzero_ps();
+            for(int p = 0; p < Frustum::Count; p++){
+                __m128 d = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(cx, pl.n[p][0]), _mm_mul_ps(cy, pl.n[p][1])),
+                    _mm_add_ps(_mm_mul_ps(cz, pl.n[p][2]), pl.n[p][3])
+                );
+                __m128 r = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(ex, pl.a[p][0]), _mm_mul_ps(ey, pl.a[p][1])),
+                    _mm_mul_ps(ez, pl.a[p][2])
+                );
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+            }
+            return ~_mm_movemask_ps(outside) & 0xF;
+        }
+
+        void Lerp(const float* a, const float* b, const float* t, float* out, size_t count){
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128 va = _mm_loadu_ps(a + index);
+                __m128 vb = _mm_loadu_ps(b + index);
+                _mm_storeu_ps(out + index, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_loadu_ps(t + index))));
+            }
+            Kernel::Scalar.lerpFloats(a + index, b + index, t + index, out + index, count - index);
+        }
+
+        void Accumulate(const float* src, float scale, float* dst, size_t count){
+            const __m128 s = _mm_set1_ps(scale);
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                _mm_storeu_ps(dst + index, _mm_add_ps(_mm_loadu_ps(dst + index), _mm_mul_ps(_mm_loadu_ps(src + index), s)));
+            }
+            Kernel::Scalar.addScaledFloats(src + index, scale, dst + index, count - index);
+        }
+
+        inline void Advance(ConstQuaternionStream& a, ConstQuaternionStream& b, QuaternionStream& out, size_t count){
+            a.x += count;   a.y += count;   a.z += count;   a.w += count;
+            b.x += count;   b.y += count;   b.z += count;   b.w += count;
+            out.x += count; out.y += count; out.z += count; out.w += count;
+        }
+
+        void Slerp(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count){
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+            const __m128 one     = _mm_set1_ps(1.0f);
+            const __m128 half    = _mm_set1_ps(0.5f);
+
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128 ax = _mm_loadu_ps(a.x + index), ay = _mm_loadu_ps(a.y + index);
+                __m128 az = _mm_loadu_ps(a.z + index), aw = _mm_loadu_ps(a.w + index);
+                __m128 bx = _mm_loadu_ps(b.x + index), by = _mm_loadu_ps(b.y + index);
+                __m128 bz = _mm_loadu_ps(b.z + index), bw = _mm_loadu_ps(b.w + index);
+                __m128 vt = _mm_loadu_ps(t + index);
+
+                __m128 cosine = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz)), _mm_mul_ps(aw, bw));
+                __m128 d = _mm_andnot_ps(signBit, cosine);
+
+                // SlerpWeight of the scalar kernel
+                __m128 ka = _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)));
+                ka = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, ka));
+                ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, ka));
+                __m128 kb = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)));
+                kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, kb));
+                __m128 h = _mm_sub_ps(vt, half);
+                __m128 k = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ka, h), h), kb);
+                __m128 wb = _mm_add_ps(vt, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(vt, h), _mm_sub_ps(vt, one)), k));
+                __m128 wa = _mm_sub_ps(one, wb);
+                wb = _mm_or_ps(wb, _mm_and_ps(cosine, signBit));
+
+                __m128 x = _mm_add_ps(_mm_mul_ps(ax, wa), _mm_mul_ps(bx, wb));
+                __m128 y = _mm_add_ps(_mm_mul_ps(ay, wa), _mm_mul_ps(by, wb));
+                __m128 z = _mm_add_ps(_mm_mul_ps(az, wa), _mm_mul_ps(bz, wb));
+                __m128 w = _mm_add_ps(_mm_mul_ps(aw, wa), _mm_mul_ps(bw, wb));
+
+                __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w)));
+                _mm_storeu_ps(out.x + index, _mm_div_ps(x, length));
+                _mm_storeu_ps(out.y + index, _mm_div_ps(y, length));
+                _mm_storeu_ps(out.z + index, _mm_div_ps(z, length));
+                _mm_storeu_ps(out.w + index, _mm_div_ps(w, length));
+            }
+
+            ConstQuaternionStream tailA = a, tailB = b;
+            QuaternionStream      tailOut = out;
+            Advance(tailA, tailB, tailOut, index);
+            Kernel::Scalar.slerpQuaternions(tailA, tailB, t + index, tailOut, count - index);
+        }
+
+        inline __m128 LoadVertex(const ConstVector3fStream& s, size_t index){
+            return _mm_setr_ps(s.x[index], s.y[index], s.z[index], 0.0f);
+        }
+
+        inline void StoreVertex(const Vector3fStream& s, size_t index, __m128 v){
+            _mm_store_ss(s.x + index, v);
+            _mm_store_ss(s.y + index, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_store_ss(s.z + index, _mm_movehl_ps(v, v));
+        }
+
+        inline __m128 Splat(__m128 v, int k){
+            switch(k){
+                case 0:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+                case 1:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+                case 2:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+                default: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+        }
+
+        // without gathers 4 vertices at a time cost more shuffles than they save, so one vertex
+        // per iteration with the palette rows as they are in memory
+        void LinearBlend(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            for(size_t index = 0; index < count; index++){
+                __m128 row[4];
+                for(int i = 0; i < 4; i++){
+                    const Matrix4f& joint = palette[weights.joint[i][index]];
+                    const __m128 weight = _mm_set1_ps(weights.weight[i][index]);
+                    for(int r = 0; r < 4; r++){
+                        __m128 value = _mm_mul_ps(joint.row[r].sse, weight);
+                        row[r] = i == 0 ? value : _mm_add_ps(row[r], value);
+                    }
+                }
+
+                __m128 p = LoadVertex(src.position, index);
+                StoreVertex(dst.position, index, _mm_add_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(Splat(p, 0), row[0]), _mm_mul_ps(Splat(p, 1), row[1])), _mm_mul_ps(Splat(p, 2), row[2])), row[3]
+                ));
+                if(src.normal.x != nullptr){
+                    __m128 n = LoadVertex(src.normal, index);
+                    StoreVertex(dst.normal, index,
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(Splat(n, 0), row[0]), _mm_mul_ps(Splat(n, 1), row[1])), _mm_mul_ps(Splat(n, 2), row[2]))
+                    );
+                }
+                if(src.tangent.x != nullptr){
+                    __m128 t = LoadVertex(src.tangent, index);
+                    StoreVertex(dst.tangent, index,
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(Splat(t, 0), row[0]), _mm_mul_ps(Splat(t, 1), row[1])), _mm_mul_ps(Splat(t, 2), row[2]))
+                    );
+                }
+            }
+        }
+
+        // a x b of the xyz parts, w is 0 when a.w or b.w is
+        inline __m128 Cross(__m128 a, __m128 b){
+            __m128 ab = _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1)));
+            __m128 ba = _mm_mul_ps(b, _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)));
+            __m128 c  = _mm_sub_ps(ab, ba);
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        // v + 2 r.xyz x (r.xyz x v + r.w v), v.w is 0
+        inline __m128 Rotate(__m128 r, __m128 rw, __m128 v){
+            __m128 c = _mm_add_ps(Cross(r, v), _mm_mul_ps(rw, v));
+            __m128 u = Cross(r, c);
+            return _mm_add_ps(v, _mm_add_ps(u, u));
+        }
+
+        void DualQuaternionBlend(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+            const __m128 xyz     = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+            for(size_t index = 0; index < count; index++){
+                const __m128 first = _mm_loadu_ps(palette[weights.joint[0][index]].real);
+
+                __m128 real = _mm_setzero_ps(), dual = _mm_setzero_ps();
+                for(int i = 0; i < 4; i++){
+                    const DualQuaternion& joint = palette[weights.joint[i][index]];
+                    __m128 q = _mm_loadu_ps(joint.real);
+                    // q and -q are the same rotation, every joint is blended on the side of the first
+                    __m128 weight = _mm_xor_ps(_mm_set1_ps(weights.weight[i][index]), _mm_and_ps(_mm_dp_ps(q, first, 0xFF), signBit));
+                    real = _mm_add_ps(real, _mm_mul_ps(q, weight));
+                    dual = _mm_add_ps(dual, _mm_mul_ps(_mm_loadu_ps(joint.dual), weight));
+                }
+
+                __m128 length = _mm_sqrt_ps(_mm_dp_ps(real, real, 0xFF));
+                real = _mm_div_ps(real, length);
+                dual = _mm_div_ps(dual, length);
+
+                const __m128 rw = Splat(real, 3);
+                const __m128 rv = _mm_and_ps(real, xyz);
+
+                // translation, the vector part of 2 dual * conjugate(real)
+                __m128 t = _mm_sub_ps(_mm_mul_ps(rw, dual), _mm_mul_ps(Splat(dual, 3), rv));
+                t = _mm_and_ps(_mm_add_ps(t, Cross(rv, dual)), xyz);
+                t = _mm_add_ps(t, t);
+
+                StoreVertex(dst.position, index, _mm_add_ps(Rotate(rv, rw, LoadVertex(src.position, index)), t));
+                if(src.normal.x != nullptr){
+                    StoreVertex(dst.normal, index, Rotate(rv, rw, LoadVertex(src.normal, index)));
+                }
+                if(src.tangent.x != nullptr){
+                    StoreVertex(dst.tangent, index, Rotate(rv, rw, LoadVertex(src.tangent, index)));
+                }
+            }
+        }
+
+        void BoxesInFrustum(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible){
+            memset(visible, 0, (count + 31) / 32 * sizeof(uint32_t));
+
+            const PlanesSSE pl(frustum);
+            const float* const stream[6] = {boxes.cx, boxes.cy, boxes.cz, boxes.ex, boxes.ey, boxes.ez};
+
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                visible[index >> 5] |= static_cast<uint32_t>(CullSSE(pl, stream, index)) << (index & 31);
+            }
+
+            if(index < count){
+                // copy the last boxes into zero padded lanes, their bits are masked off
+                size_t rest = count - index;
+                float pad[6][4] = {};
+                for(int k = 0; k < 6; k++){
+                    for(size_t i = 0; i < rest; i++) pad[k][i] = stream[k][index + i];
+                }
+                const float* const padStream[6] = {pad[0], pad[1], pad[2], pad[3], pad[4], pad[5]};
+                uint32_t bits = static_cast<uint32_t>(CullSSE(pl, padStream, 0)) & ((1u << rest) - 1);
+                visible[index >> 5] |= bits << (index & 31);
+            }
+        }
+
+        // same integer rounding as the scalar reference, 4 floats -> 4 halves in the low 16 bits
+        inline __m128i ToHalfSSE(__m128 value){
+            const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+            __m128i bits = _mm_castps_si128(value);
+            __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+            bits = _mm_xor_si128(bits, sign);
+
+            __m128i infNaN  = _mm_cmpgt_epi32(bits, _mm_set1_epi32(((127 + 16) << 23) - 1));
+            __m128i special = _mm_blendv_epi8(
+                _mm_set1_epi32(0x7C00), _mm_set1_epi32(0x7E00), _mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7F800000))
+            );
+
+            __m128i denormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(113 << 23));
+            __m128i aligned  = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(denormMagic)));
+            __m128i small    = _mm_sub_epi32(aligned, denormMagic);
+
+            __m128i mantOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+            __m128i normal  = _mm_add_epi32(bits, _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu)));
+            normal = _mm_srli_epi32(_mm_add_epi32(normal, mantOdd), 13);
+
+            __m128i half = _mm_blendv_epi8(normal, small, denormal);
+            half = _mm_blendv_epi8(half, special, infNaN);
+            return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+        }
+
+        inline __m128 FromHalfSSE(__m128i value){
+            const __m128i shiftedExp = _mm_set1_epi32(0x7C00 << 13);
+
+            __m128i bits = _mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x7FFF)), 13);
+            __m128i exp  = _mm_and_si128(bits, shiftedExp);
+            bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+            __m128i infNaN = _mm_cmpeq_epi32(exp, shiftedExp);
+            bits = _mm_add_epi32(bits, _mm_and_si128(infNaN, _mm_set1_epi32((128 - 16) << 23)));
+
+            __m128i denormal = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+            __m128  renormal = _mm_sub_ps(
+                _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23))
+            );
+            __m128 result = _mm_blendv_ps(_mm_castsi128_ps(bits), renormal, _mm_castsi128_ps(denormal));
+
+            __m128i sign = _mm_slli_epi32(_mm_and_si128(value, _mm_set1_epi32(0x8000)), 16);
+            return _mm_or_ps(result, _mm_castsi128_ps(sign));
+        }
+
+        // clamped and scaled, NaN lanes are zeroed before the clamp
+        inline __m128i ToSNorm16SSE(__m128 value){
+            value = _mm_and_ps(value, _mm_cmpord_ps(value, value));
+            value = _mm_max_ps(_mm_min_ps(value, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+            return _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(32767.0f)));
+        }
+
+        inline __m128 FromSNorm16SSE(__m128i value){
+            __m128 result = _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(1.0f / 32767.0f));
+            return _mm_max_ps(result, _mm_set1_ps(-1.0f));
+        }
+
+        inline __m128 AbsSSE(__m128 value){
+            return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+        }
+
+        void FloatToHalf(const float* src, uint16_t* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m128i lo = ToHalfSSE(_mm_loadu_ps(src + index));
+                __m128i hi = ToHalfSSE(_mm_loadu_ps(src + index + 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packus_epi32(lo, hi));
+            }
+            Kernel::Scalar.floatToHalf(src + index, dst + index, count - index);
+        }
+
+        void HalfToFloat(const uint16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128i half = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + index)));
+                _mm_storeu_ps(dst + index, FromHalfSSE(half));
+            }
+            Kernel::Scalar.halfToFloat(src + index, dst + index, count - index);
+        }
+
+        void FloatToSNorm16(const float* src, int16_t* dst, size_t count){
+            size_t index = 0;
+            for(; index + 8 <= count; index += 8){
+                __m128i lo = ToSNorm16SSE(_mm_loadu_ps(src + index));
+                __m128i hi = ToSNorm16SSE(_mm_loadu_ps(src + index + 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_packs_epi32(lo, hi));
+            }
+            Kernel::Scalar.floatToSNorm16(src + index, dst + index, count - index);
+        }
+
+        void SNorm16ToFloat(const int16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128i value = _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + index)));
+                _mm_storeu_ps(dst + index, FromSNorm16SSE(value));
+            }
+            Kernel::Scalar.snorm16ToFloat(src + index, dst + index, count - index);
+        }
+
+        void OctahedralEncode(const float* src, int16_t* dst, size_t count){
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+            const __m128 one     = _mm_set1_ps(1.0f);
+
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128 x, y, z;
+                LoadAoS3(src + index * 3, x, y, z);
+
+                __m128 inv = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(AbsSSE(x), AbsSSE(y)), AbsSSE(z)));
+                x = _mm_mul_ps(x, inv);
+                y = _mm_mul_ps(y, inv);
+
+                __m128 fx = _mm_mul_ps(_mm_sub_ps(one, AbsSSE(y)), _mm_or_ps(one, _mm_and_ps(x, signBit)));
+                __m128 fy = _mm_mul_ps(_mm_sub_ps(one, AbsSSE(x)), _mm_or_ps(one, _mm_and_ps(y, signBit)));
+                __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+                x = _mm_blendv_ps(x, fx, lower);
+                y = _mm_blendv_ps(y, fy, lower);
+
+                __m128i lo = ToSNorm16SSE(_mm_unpacklo_ps(x, y));
+                __m128i hi = ToSNorm16SSE(_mm_unpackhi_ps(x, y));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index * 2), _mm_packs_epi32(lo, hi));
+            }
+            Kernel::Scalar.encodeOctahedral(src + index * 3, dst + index * 2, count - index);
+        }
+
+        void OctahedralDecode(const int16_t* src, float* dst, size_t count){
+            size_t index = 0;
+            for(; index + 4 <= count; index += 4){
+                __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index * 2));
+                __m128 a = FromSNorm16SSE(_mm_cvtepi16_epi32(packed));                      // x0 y0 x1 y1
+                __m128 b = FromSNorm16SSE(_mm_cvtepi16_epi32(_mm_srli_si128(packed, 8)));   // x2 y2 x3 y3
+                __m128 x = VecShuffle(a, b, 0, 2, 0, 2);
+                __m128 y = VecShuffle(a, b, 1, 3, 1, 3);
+
+                __m128 z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), AbsSSE(x)), AbsSSE(y));
+                __m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+                __m128 negT = _mm_sub_ps(_mm_setzero_ps(), t);
+                x = _mm_add_ps(x, _mm_blendv_ps(t, negT, _mm_cmpge_ps(x, _mm_setzero_ps())));
+                y = _mm_add_ps(y, _mm_blendv_ps(t, negT, _mm_cmpge_ps(y, _mm_setzero_ps())));
+
+                __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+                StoreAoS3(dst + index * 3, _mm_div_ps(x, length), _mm_div_ps(y, length), _mm_div_ps(z, length));
+            }
+            Kernel::Scalar.decodeOctahedral(src + index * 2, dst + index * 3, count - index);
+        }
+
+    }
+
+    const Kernel::BatchTable Kernel::SSE41 = {
+        Utility::SimdLevel::SSE41,
+        PointsAoS,
+        VectorsAoS,
+        Homogeneous,
+        PointsSoA,
+        VectorsSoA,
+        Lerp,
+        Slerp,
+        Accumulate,
+        LinearBlend,
+        DualQuaternionBlend,
+        BoxesInFrustum,
+        FloatToHalf,
+        HalfToFloat,
+        FloatToSNorm16,
+        SNorm16ToFloat,
+        OctahedralEncode,
+        OctahedralDecode
+    };
+
+}
@@ -0,0 +1,372 @@
+#include "GeoMathBatchKernel.hpp"
+
+namespace GeoMath{
+
+    // plain C++ reference, one component at a time in the same add order as the SIMD kernels
+    namespace{
+
+        template<bool isPoint>
+        inline void TransformOne(float x, float y, float z, const Matrix4f& m, float& ox, float& oy, float& oz){
+            float rx = (x * m.data[0][0] + y * m.data[1][0]) + z * m.data[2][0];
+            float ry = (x * m.data[0][1] + y * m.data[1][1]) + z * m.data[2][1];
+            float rz = (x * m.data[0][2] + y * m.data[1][2]) + z * m.data[2][2];
+
+            if(isPoint){
+                rx += m.data[3][0];
+                ry += m.data[3][1];
+                rz += m.data[3][2];
+            }
+
+            ox = rx;
+            oy = ry;
+            oz = rz;
+        }
+
+        template<bool isPoint>
+        void TransformAoS3(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            for(size_t index = 0; index < count; index++){
+                const float* in  = src[index].data;
+                float*       out = dst[index].data;
+                TransformOne<isPoint>(in[0], in[1], in[2], m, out[0], out[1], out[2]);
+            }
+        }
+
+        template<bool isPoint>
+        void TransformSoA3(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            for(size_t index = 0; index < count; index++){
+                TransformOne<isPoint>(
+                    src.x[index], src.y[index], src.z[index], m,
+                    dst.x[index], dst.y[index], dst.z[index]
+                );
+            }
+        }
+
+        void PointsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<true>(src, dst, count, m);
+        }
+
+        void VectorsAoS(const Vector3f* src, Vector3f* dst, size_t count, const Matrix4f& m){
+            TransformAoS3<false>(src, dst, count, m);
+        }
+
+        void Homogeneous(const Vector4f* src, Vector4f* dst, size_t count, const Matrix4f& m){
+            for(size_t index = 0; index < count; index++){
+                const float* in = src[index].data;
+                float r[4];
+                for(int j = 0; j < 4; j++){
+                    r[j] = (in[0] * m.data[0][j] + in[1] * m.data[1][j]) + (in[2] * m.data[2][j] + in[3] * m.data[3][j]);
+                }
+                for(int j = 0; j < 4; j++){
+                    dst[index].data[j] = r[j];
+                }
+            }
+        }
+
+        void PointsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<true>(src, dst, count, m);
+        }
+
+        void VectorsSoA(const ConstVector3fStream& src, const Vector3fStream& dst, size_t count, const Matrix4f& m){
+            TransformSoA3<false>(src, dst, count, m);
+        }
+
+        void Lerp(const float* a, const float* b, const float* t, float* out, size_t count){
+            for(size_t index = 0; index < count; index++){
+                out[index] = a[index] + (b[index] - a[index]) * t[index];
+            }
+        }
+
+        void Accumulate(const float* src, float scale, float* dst, size_t count){
+            for(size_t index = 0; index < count; index++){
+                dst[index] += src[index] * scale;
+            }
+        }
+
+        // nlerp weight that follows the slerp, polynomial fit over t and d = |cos| of the arc
+        inline float SlerpWeight(float t, float d){
+            float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+            float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+            float h = t - 0.5f;
+            float k = a * h * h + b;
+            return t + ((t * h) * (t - 1.0f)) * k;
+        }
+
+        void Slerp(const ConstQuaternionStream& a, const ConstQuaternionStream& b, const float* t, const QuaternionStream& out, size_t count){
+            for(size_t index = 0; index < count; index++){
+                float ax = a.x[index], ay = a.y[index], az = a.z[index], aw = a.w[index];
+                float bx = b.x[index], by = b.y[index], bz = b.z[index], bw = b.w[index];
+
+                float cosine = ((ax * bx + ay * by) + az * bz) + aw * bw;
+                float wb = SlerpWeight(t[index], std::abs(cosine));
+                float wa = 1.0f - wb;
+                // the shorter arc goes through -b
+                wb = std::copysign(wb, cosine);
+
+                float x = ax * wa + bx * wb;
+                float y = ay * wa + by * wb;
+                float z = az * wa + bz * wb;
+                float w = aw * wa + bw * wb;
+
+                float length = std::sqrt(((x * x + y * y) + z * z) + w * w);
+                out.x[index] = x / length;
+                out.y[index] = y / length;
+                out.z[index] = z / length;
+                out.w[index] = w / length;
+            }
+        }
+
+        void LinearBlend(const Matrix4f* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            Matrix4f m;
+            for(size_t index = 0; index < count; index++){
+                // weighted sum of the 4x3 parts, the last column is not read
+                for(int i = 0; i < 4; i++){
+                    const Matrix4f& joint = palette[weights.joint[i][index]];
+                    const float weight = weights.weight[i][index];
+                    for(int r = 0; r < 4; r++){
+                        for(int c = 0; c < 3; c++){
+                            m.data[r][c] = i == 0 ? joint.data[r][c] * weight : m.data[r][c] + joint.data[r][c] * weight;
+                        }
+                    }
+                }
+
+                TransformOne<true>(
+                    src.position.x[index], src.position.y[index], src.position.z[index], m,
+                    dst.position.x[index], dst.position.y[index], dst.position.z[index]
+                );
+                if(src.normal.x != nullptr){
+                    TransformOne<false>(
+                        src.normal.x[index], src.normal.y[index], src.normal.z[index], m,
+                        dst.normal.x[index], dst.normal.y[index], dst.normal.z[index]
+                    );
+                }
+                if(src.tangent.x != nullptr){
+                    TransformOne<false>(
+                        src.tangent.x[index], src.tangent.y[index], src.tangent.z[index], m,
+                        dst.tangent.x[index], dst.tangent.y[index], dst.tangent.z[index]
+                    );
+                }
+            }
+        }
+
+        // v + 2 r.xyz x (r.xyz x v + r.w v), r is a unit quaternion
+        inline void Rotate(const float* r, float x, float y, float z, float& ox, float& oy, float& oz){
+            float cx = (r[1] * z - r[2] * y) + r[3] * x;
+            float cy = (r[2] * x - r[0] * z) + r[3] * y;
+            float cz = (r[0] * y - r[1] * x) + r[3] * z;
+            ox = x + 2.0f * (r[1] * cz - r[2] * cy);
+            oy = y + 2.0f * (r[2] * cx - r[0] * cz);
+            oz = z + 2.0f * (r[0] * cy - r[1] * cx);
+        }
+
+        void DualQuaternionBlend(const DualQuaternion* palette, const ConstSkinWeightStream& weights, const ConstSkinVertexStream& src, const SkinVertexStream& dst, size_t count){
+            for(size_t index = 0; index < count; index++){
+                const float* first = palette[weights.joint[0][index]].real;
+
+                float real[4], dual[4];
+                for(int i = 0; i < 4; i++){
+                    const DualQuaternion& joint = palette[weights.joint[i][index]];
+                    // q and -q are the same rotation, every joint is blended on the side of the first
+                    float cosine = ((joint.real[0] * first[0] + joint.real[1] * first[1]) + joint.real[2] * first[2]) + joint.real[3] * first[3];
+                    float weight = std::copysign(weights.weight[i][index], cosine);
+                    for(int k = 0; k < 4; k++){
+                        real[k] = i == 0 ? joint.real[k] * weight : real[k] + joint.real[k] * weight;
+                        dual[k] = i == 0 ? joint.dual[k] * weight : dual[k] + joint.dual[k] * weight;
+                    }
+                }
+
+                float inv = 1.0f / std::sqrt(((real[0] * real[0] + real[1] * real[1]) + real[2] * real[2]) + real[3] * real[3]);
+                for(int k = 0; k < 4; k++){
+                    real[k] *= inv;
+                    dual[k] *= inv;
+                }
+
+                // translation, the vector part of 2 dual * conjugate(real)
+                float tx = 2.0f * ((real[3] * dual[0] - dual[3] * real[0]) + (real[1] * dual[2] - real[2] * dual[1]));
+                float ty = 2.0f * ((real[3] * dual[1] - dual[3] * real[1]) + (real[2] * dual[0] - real[0] * dual[2]));
+                float tz = 2.0f * ((real[3] * dual[2] - dual[3] * real[2]) + (real[0] * dual[1] - real[1] * dual[0]));
+
+                float x, y, z;
+                Rotate(real, src.position.x[index], src.position.y[index], src.position.z[index], x, y, z);
+                dst.position.x[index] = x + tx;
+                dst.position.y[index] = y + ty;
+                dst.position.z[index] = z + tz;
+
+                if(src.normal.x != nullptr){
+                    Rotate(real, src.normal.x[index], src.normal.y[index], src.normal.z[index],
+                        dst.normal.x[index], dst.normal.y[index], dst.normal.z[index]);
+                }
+                if(src.tangent.x != nullptr){
+                    Rotate(real, src.tangent.x[index], src.tangent.y[index], src.tangent.z[index],
+                        dst.tangent.x[index], dst.tangent.y[index], dst.tangent.z[index]);
+                }
+            }
+        }
+
+        void BoxesInFrustum(const Frustum& frustum, const ConstBoxStream& boxes, size_t count, uint32_t* visible){
+            memset(visible, 0, (count + 31) / 32 * sizeof(uint32_t));
+
+            for(size_t index = 0; index < count; index++){
+                bool inside = true;
+                for(const auto& plane : frustum.planes){
+                    const float* n = plane.data;
+                    float d = (boxes.cx[index] * n[0] + boxes.cy[index] * n[1]) + (boxes.cz[index] * n[2] + n[3]);
+                    float r = (boxes.ex[index] * std::abs(n[0]) + boxes.ey[index] * std::abs(n[1])) + boxes.ez[index] * std::abs(n[2]);
+                    if(d + r < 0.0f){
+                        inside = false;
+                        break;
+                    }
+                }
+                if(inside) visible[index >> 5] |= 1u << (index & 31);
+            }
+        }
+
+        // float -> half with integer ops, round to nearest even
+        inline uint16_t ToHalf(float value){
+            const uint32_t f16max      = (127 + 16) << 23;
+            const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+
+            uint32_t half;
+            if(bits >= f16max){
+                half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+            }
+            else if(bits < (113u << 23)){
+                // denormal, the float add aligns and rounds the mantissa
+                float f, magic;
+                memcpy(&f, &bits, sizeof(f));
+                memcpy(&magic, &denormMagic, sizeof(magic));
+                f += magic;
+                memcpy(&half, &f, sizeof(half));
+                half -= denormMagic;
+            }
+            else{
+                uint32_t mantOdd = (bits >> 13) & 1u;
+                bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + mantOdd;
+                half = bits >> 13;
+            }
+            return static_cast<uint16_t>(half | (sign >> 16));
+        }
+
+        inline float FromHalf(uint16_t value){
+            const uint32_t shiftedExp = 0x7C00u << 13;
+
+            uint32_t bits = (value & 0x7FFFu) << 13;
+            uint32_t exp  = bits & shiftedExp;
+            bits += (127 - 15) << 23;
+
+            float result;
+            if(exp == shiftedExp){
+                bits += (128 - 16) << 23;
+                memcpy(&result, &bits, sizeof(result));
+            }
+            else if(exp == 0){
+                // denormal, renormalize through a float subtract
+                const uint32_t magicBits = 113u << 23;
+                float magic;
+                bits += 1u << 23;
+                memcpy(&result, &bits, sizeof(result));
+                memcpy(&magic, &magicBits, sizeof(magic));
+                result -= magic;
+            }
+            else{
+                memcpy(&result, &bits, sizeof(result));
+            }
+
+            uint32_t out;
+            memcpy(&out, &result, sizeof(out));
+            out |= static_cast<uint32_t>(value & 0x8000u) << 16;
+            memcpy(&result, &out, sizeof(result));
+            return result;
+        }
+
+        // NaN maps to 0 as on the GPU
+        inline int16_t ToSNorm16(float value){
+            if(!(value == value)) value = 0.0f;
+            value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+            return static_cast<int16_t>(std::nearbyint(value * 32767.0f));
+        }
+
+        inline float FromSNorm16(int16_t value){
+            float result = value * (1.0f / 32767.0f);
+            return result < -1.0f ? -1.0f : result;
+        }
+
+        void FloatToHalf(const float* src, uint16_t* dst, size_t count){
+            for(size_t index = 0; index < count; index++) dst[index] = ToHalf(src[index]);
+        }
+
+        void HalfToFloat(const uint16_t* src, float* dst, size_t count){
+            for(size_t index = 0; index < count; index++) dst[index] = FromHalf(src[index]);
+        }
+
+        void FloatToSNorm16(const float* src, int16_t* dst, size_t count){
+            for(size_t index = 0; index < count; index++) dst[index] = ToSNorm16(src[index]);
+        }
+
+        void SNorm16ToFloat(const int16_t* src, float* dst, size_t count){
+            for(size_t index = 0; index < count; index++) dst[index] = FromSNorm16(src[index]);
+        }
+
+        // project onto |x| + |y| + |z| = 1 and fold the lower half over the diagonals
+        void OctahedralEncode(const float* src, int16_t* dst, size_t count){
+            for(size_t index = 0; index < count; index++){
+                const float* n = src + index * 3;
+                float inv = 1.0f / ((std::abs(n[0]) + std::abs(n[1])) + std::abs(n[2]));
+                float x = n[0] * inv;
+                float y = n[1] * inv;
+                if(n[2] < 0.0f){
+                    float fx = (1.0f - std::abs(y)) * std::copysign(1.0f, x);
+                    float fy = (1.0f - std::abs(x)) * std::copysign(1.0f, y);
+                    x = fx;
+                    y = fy;
+                }
+                dst[index * 2]     = ToSNorm16(x);
+                dst[index * 2 + 1] = ToSNorm16(y);
+            }
+        }
+
+        void OctahedralDecode(const int16_t* src, float* dst, size_t count){
+            for(size_t index = 0; index < count; index++){
+                float x = FromSNorm16(src[index * 2]);
+                float y = FromSNorm16(src[index * 2 + 1]);
+                float z = (1.0f - std::abs(x)) - std::abs(y);
+                float t = -z > 0.0f ? -z : 0.0f;
+                x += x >= 0.0f ? -t : t;
+                y += y >= 0.0f ? -t : t;
+
+                float length = std::sqrt((x * x + y * y) + z * z);
+                float* n = dst + index * 3;
+                n[0] = x / length;
+                n[1] = y / length;
+                n[2] = z / length;
+            }
+        }
+
+    }
+
+    const Kernel::BatchTable Kernel::Scalar = {
+        Utility::SimdLevel::Scalar,
+        PointsAoS,
+        VectorsAoS,
+        Homogeneous,
+        PointsSoA,
+        VectorsSoA,
+        Lerp,
+        Slerp,
+        Accumulate,
+        LinearBlend,
+        DualQuaternionBlend,
+        BoxesInFrustum,
+        FloatToHalf,
+        HalfToFloat,
+        FloatToSNorm16,
+        SNorm16ToFloat,
+        OctahedralEncode,
+        OctahedralDecode
+    };
+
+}
@@ -0,0 +1,96 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Utility{
+
+    MappedFile::MappedFile(const char* fileName){
+#ifdef _WIN32
+        HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) return;
+        m_file = file;
+
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0){
+            Close();
+            return;
+        }
+
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(m_mapping == nullptr){
+            Close();
+            return;
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = m_data != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+        if(m_data == nullptr) Close();
+#else
+        int file = open(fileName, O_RDONLY);
+        if(file < 0) return;
+
+        struct stat info;
+        if(fstat(file, &info) == 0 && info.st_size > 0){
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if(data != MAP_FAILED){
+                m_data = static_cast<const uint8_t*>(data);
+                m_size = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(file);
+#endif
+    }
+
+    MappedFile::~MappedFile(){
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(other.m_data)
+        , m_size(other.m_size)
+        , m_file(other.m_file)
+        , m_mapping(other.m_mapping)
+    {
+        other.m_data    = nullptr;
+        other.m_size    = 0;
+        other.m_file    = nullptr;
+        other.m_mapping = nullptr;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept{
+        if(this != &other){
+            Close();
+            m_data    = other.m_data;
+            m_size    = other.m_size;
+            m_file    = other.m_file;
+            m_mapping = other.m_mapping;
+            other.m_data    = nullptr;
+            other.m_size    = 0;
+            other.m_file    = nullptr;
+            other.m_mapping = nullptr;
+        }
+        return *this;
+    }
+
+    void MappedFile::Close(){
+#ifdef _WIN32
+        if(m_data != nullptr)    UnmapViewOfFile(m_data);
+        if(m_mapping != nullptr) CloseHandle(m_mapping);
+        if(m_file != nullptr)    CloseHandle(m_file);
+#else
+        if(m_data != nullptr) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data    = nullptr;
+        m_size    = 0;
+        m_file    = nullptr;
+        m_mapping = nullptr;
+    }
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Utility{
+
+    // A file mapped read only into the address space. Pages are read in on first touch and shared
+    // with the file cache, reading through the mapping makes no private copy of the file.
+    class MappedFile{
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const char* fileName);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // false when the file could not be opened or is empty
+        bool           IsOpen()  const { return m_data != nullptr; }
+        const uint8_t* GetData() const { return m_data; }
+        size_t         GetSize() const { return m_size; }
+
+        void Close();
+
+    protected:
+        const uint8_t* m_data = nullptr;
+        size_t         m_size = 0;
+        // file and mapping handles on Windows, the mapping outlives the descriptor elsewhere
+        void*          m_file    = nullptr;
+        void*          m_mapping = nullptr;
+    };
+
+}
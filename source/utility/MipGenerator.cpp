@@ -0,0 +1,253 @@
+#include "MipGenerator.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace Utility{
+
+    namespace{
+
+        struct Tables{
+            float   toLinear[256];
+            // sRGB byte of linear i / 4095, steps stay under a byte even where the curve is steepest
+            uint8_t toSrgb[4096];
+        };
+
+        const Tables& GetTables(){
+            static const Tables tables = [](){
+                Tables t;
+                for(int i = 0; i < 256; i++){
+                    float c = i / 255.0f;
+                    t.toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                for(int i = 0; i < 4096; i++){
+                    float l = i / 4095.0f;
+                    float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                    t.toSrgb[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+                }
+                return t;
+            }();
+            return tables;
+        }
+
+        uint32_t Align(uint32_t size, uint32_t alignment){
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        float BesselI0(float x){
+            // power series, converges quickly for the arguments of the window
+            float sum = 1.0f, term = 1.0f, q = x * x * 0.25f;
+            for(int k = 1; k < 20; k++){
+                term *= q / float(k * k);
+                sum  += term;
+            }
+            return sum;
+        }
+
+        const float KaiserAlpha  = 4.0f;
+        const float KaiserRadius = 3.0f;
+
+        // x in texels of the smaller level
+        float KaiserSinc(float x){
+            if(std::fabs(x) >= KaiserRadius) return 0.0f;
+            const float pi   = 3.14159265358979f;
+            const float sinc = x == 0.0f ? 1.0f : std::sin(pi * x) / (pi * x);
+            const float t    = x / KaiserRadius;
+            return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(KaiserAlpha);
+        }
+
+        struct Tap{
+            uint32_t index;
+            float    weight;
+        };
+
+        // taps of every texel of the smaller level along one axis, texels past the edges are clamped
+        void BuildTaps(uint32_t srcSize, uint32_t dstSize, MipGenerator::Filter filter, std::vector<Tap>& taps, std::vector<uint32_t>& first){
+            const float scale = float(srcSize) / float(dstSize);
+            taps.clear();
+            first.assign(dstSize + 1, 0);
+
+            for(uint32_t d = 0; d < dstSize; d++){
+                first[d] = static_cast<uint32_t>(taps.size());
+                float sum = 0.0f;
+
+                if(filter == MipGenerator::Filter::Box){
+                    // coverage of every source texel by the footprint [lo, hi)
+                    const float lo = d * scale, hi = (d + 1) * scale;
+                    for(int i = int(lo); float(i) < hi; i++){
+                        float a = lo > float(i) ? lo : float(i);
+                        float b = hi < float(i + 1) ? hi : float(i + 1);
+                        if(b <= a) continue;
+                        taps.push_back({static_cast<uint32_t>(i < int(srcSize) ? i : int(srcSize) - 1), b - a});
+                        sum += b - a;
+                    }
+                }
+                else{
+                    const float center = (d + 0.5f) * scale;
+                    const float radius = KaiserRadius * scale;
+                    for(int i = int(std::floor(center - radius)); float(i) < center + radius; i++){
+                        float w = KaiserSinc((i + 0.5f - center) / scale);
+                        if(w == 0.0f) continue;
+                        int clamped = i < 0 ? 0 : (i >= int(srcSize) ? int(srcSize) - 1 : i);
+                        taps.push_back({static_cast<uint32_t>(clamped), w});
+                        sum += w;
+                    }
+                }
+
+                for(size_t t = first[d]; t < taps.size(); t++) taps[t].weight /= sum;
+            }
+            first[dstSize] = static_cast<uint32_t>(taps.size());
+        }
+
+        // share of texels of a float level with alpha * scale >= cutoff
+        float Coverage(const std::vector<float>& level, float scale, float cutoff){
+            size_t count = 0, total = level.size() / 4;
+            for(size_t i = 0; i < total; i++){
+                count += level[i * 4 + 3] * scale >= cutoff;
+            }
+            return float(count) / float(total);
+        }
+
+        // clamps to [0, 1] and encodes one row, alpha scaled for the coverage
+        void Quantize(const float* src, uint32_t width, bool isSrgb, float alphaScale, uint8_t* dst){
+            const Tables& tables = GetTables();
+            const __m128 scale = isSrgb ? _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f * alphaScale) : _mm_setr_ps(255.0f, 255.0f, 255.0f, 255.0f * alphaScale);
+            const __m128 limit = isSrgb ? _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f) : _mm_set1_ps(255.0f);
+            const __m128 half  = _mm_set1_ps(0.5f);
+
+            alignas(16) int32_t q[4];
+            for(uint32_t x = 0; x < width; x++){
+                __m128 v = _mm_mul_ps(_mm_loadu_ps(src + x * 4), scale);
+                v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), limit);
+                _mm_store_si128(reinterpret_cast<__m128i*>(q), _mm_cvttps_epi32(_mm_add_ps(v, half)));
+
+                uint8_t* t = dst + x * 4;
+                for(int c = 0; c < 3; c++){
+                    t[c] = isSrgb ? tables.toSrgb[q[c]] : static_cast<uint8_t>(q[c]);
+                }
+                t[3] = static_cast<uint8_t>(q[3]);
+            }
+        }
+
+    }
+
+    uint32_t MipGenerator::GetLevelCount(uint32_t width, uint32_t height){
+        uint32_t size  = width > height ? width : height;
+        uint32_t count = 1;
+        while(size > 1){
+            size >>= 1;
+            count++;
+        }
+        return count;
+    }
+
+    uint64_t MipGenerator::GetLayout(uint32_t width, uint32_t height, uint32_t levelCount, std::vector<Level>& levels){
+        levels.resize(levelCount);
+        uint64_t offset = 0;
+        for(uint32_t i = 0; i < levelCount; i++){
+            Level& level   = levels[i];
+            level.width    = width;
+            level.height   = height;
+            level.rowPitch = Align(width * 4, PitchAlignment);
+            level.offset   = (offset + PlacementAlignment - 1) / PlacementAlignment * PlacementAlignment;
+            offset = level.offset + uint64_t(level.rowPitch) * height;
+
+            width  = width  > 1 ? width  / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return offset;
+    }
+
+    MipGenerator::MipChain MipGenerator::Generate(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t srcPitch, const Settings& settings){
+        MipChain chain;
+        uint32_t levelCount = GetLevelCount(width, height);
+        levelCount = settings.maxLevels != 0 && settings.maxLevels < levelCount ? settings.maxLevels : levelCount;
+        chain.data.resize(GetLayout(width, height, levelCount, chain.levels), 0);
+
+        // the first level as it is, and in linear float for the filters
+        const Tables& tables = GetTables();
+        std::vector<float> level(size_t(width) * height * 4);
+        for(uint32_t y = 0; y < height; y++){
+            const uint8_t* row = texels + size_t(y) * srcPitch;
+            memcpy(chain.data.data() + chain.levels[0].offset + size_t(y) * chain.levels[0].rowPitch, row, size_t(width) * 4);
+
+            float* dst = level.data() + size_t(y) * width * 4;
+            for(uint32_t x = 0; x < width * 4; x++){
+                dst[x] = settings.isSrgb && x % 4 != 3 ? tables.toLinear[row[x]] : row[x] / 255.0f;
+            }
+        }
+
+        const bool  isCutout = settings.alphaCutoff > 0.0f;
+        const float coverage = isCutout ? GetAlphaCoverage(texels, width, height, srcPitch, settings.alphaCutoff) : 0.0f;
+
+        std::vector<Tap> tapsX, tapsY;
+        std::vector<uint32_t> firstX, firstY;
+        std::vector<float> filtered, next;
+        for(uint32_t l = 1; l < levelCount; l++){
+            const Level& src = chain.levels[l - 1];
+            const Level& dst = chain.levels[l];
+            BuildTaps(src.width,  dst.width,  settings.filter, tapsX, firstX);
+            BuildTaps(src.height, dst.height, settings.filter, tapsY, firstY);
+
+            // rows of the larger level to the width of the smaller one
+            filtered.assign(size_t(dst.width) * src.height * 4, 0.0f);
+            for(uint32_t y = 0; y < src.height; y++){
+                const float* in  = level.data() + size_t(y) * src.width * 4;
+                float*       out = filtered.data() + size_t(y) * dst.width * 4;
+                for(uint32_t x = 0; x < dst.width; x++){
+                    __m128 sum = _mm_setzero_ps();
+                    for(uint32_t t = firstX[x]; t < firstX[x + 1]; t++){
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + tapsX[t].index * 4), _mm_set1_ps(tapsX[t].weight)));
+                    }
+                    _mm_storeu_ps(out + x * 4, sum);
+                }
+            }
+
+            // then the columns, a whole row at a time
+            next.assign(size_t(dst.width) * dst.height * 4, 0.0f);
+            for(uint32_t y = 0; y < dst.height; y++){
+                float* out = next.data() + size_t(y) * dst.width * 4;
+                for(uint32_t t = firstY[y]; t < firstY[y + 1]; t++){
+                    const float* in = filtered.data() + size_t(tapsY[t].index) * dst.width * 4;
+                    const __m128 weight = _mm_set1_ps(tapsY[t].weight);
+                    for(uint32_t x = 0; x < dst.width * 4; x += 4){
+                        _mm_storeu_ps(out + x, _mm_add_ps(_mm_loadu_ps(out + x), _mm_mul_ps(_mm_loadu_ps(in + x), weight)));
+                    }
+                }
+            }
+            level.swap(next);
+
+            // the smallest scale that lets as many texels pass the test as on the first level, found by bisection.
+            // Only the stored level is scaled, the next one is filtered from the unscaled alpha.
+            float alphaScale = 1.0f;
+            if(isCutout){
+                float lo = 0.0f, hi = 16.0f;
+                for(int i = 0; i < 20; i++){
+                    float mid = (lo + hi) * 0.5f;
+                    if(Coverage(level, mid, settings.alphaCutoff) >= coverage) hi = mid;
+                    else lo = mid;
+                }
+                alphaScale = hi;
+            }
+
+            for(uint32_t y = 0; y < dst.height; y++){
+                Quantize(level.data() + size_t(y) * dst.width * 4, dst.width, settings.isSrgb, alphaScale, chain.data.data() + dst.offset + size_t(y) * dst.rowPitch);
+            }
+        }
+
+        return chain;
+    }
+
+    float MipGenerator::GetAlphaCoverage(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t pitch, float cutoff){
+        size_t count = 0;
+        for(uint32_t y = 0; y < height; y++){
+            const uint8_t* row = texels + size_t(y) * pitch;
+            for(uint32_t x = 0; x < width; x++){
+                count += row[x * 4 + 3] / 255.0f >= cutoff;
+            }
+        }
+        return float(count) / float(size_t(width) * height);
+    }
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utility{
+
+    // Builds the mip chain of an RGBA8 image on the CPU. Levels are filtered in linear light from the
+    // float copy of the level above, so rounding does not pile up down the chain, and written the way a
+    // buffer to texture copy reads subresources: rows at 256 byte pitch, levels at 512 byte offsets.
+    // Cutout textures can keep the share of texels passing the alpha test, which plain filtering
+    // erodes until foliage vanishes in the distance.
+    class MipGenerator{
+    public:
+        enum class Filter{
+            Box,        // average of the texels under the footprint
+            Kaiser      // Kaiser windowed sinc, sharper, radius of three texels of the smaller level
+        };
+
+        struct Settings{
+            Filter   filter      = Filter::Kaiser;
+            // color channels hold sRGB and are averaged in linear light, alpha is always linear
+            bool     isSrgb      = true;
+            // above 0 alpha is scaled on every level so as many texels pass alpha >= alphaCutoff as on the first
+            float    alphaCutoff = 0.0f;
+            // 0 goes down to 1x1
+            uint32_t maxLevels   = 0;
+        };
+
+        // placed footprint of a level, offsets and pitches in bytes
+        struct Level{
+            uint32_t width;
+            uint32_t height;
+            uint32_t rowPitch;
+            uint64_t offset;
+        };
+
+        struct MipChain{
+            std::vector<Level>   levels;
+            std::vector<uint8_t> data;
+        };
+
+        // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+        inline static const uint32_t PitchAlignment     = 256;
+        inline static const uint32_t PlacementAlignment = 512;
+
+        static uint32_t GetLevelCount(uint32_t width, uint32_t height);
+        // footprints of levelCount RGBA8 levels, returns the bytes they take
+        static uint64_t GetLayout(uint32_t width, uint32_t height, uint32_t levelCount, std::vector<Level>& levels);
+
+        // texels are height rows srcPitch bytes apart
+        static MipChain Generate(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t srcPitch, const Settings& settings);
+
+        // share of texels with alpha >= cutoff
+        static float GetAlphaCoverage(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t pitch, float cutoff);
+    };
+
+}
@@ -0,0 +1,136 @@
+#include "PackedVertex.hpp"
+#include "GeoMathBatch.hpp"
+
+namespace GeoMath{
+
+    namespace{
+
+        // bounds to quantize in, degenerate axes get a small extent so nothing divides by zero
+        BoundingBox QuantizationBounds(const float lo[3], const float hi[3]){
+            float center[3], extent[3];
+            for(int k = 0; k < 3; k++){
+                center[k] = (lo[k] + hi[k]) * 0.5f;
+                extent[k] = (hi[k] - lo[k]) * 0.5f;
+                extent[k] = extent[k] > 1e-6f ? extent[k] : 1e-6f;
+            }
+            return BoundingBox(Vector3f(center[0], center[1], center[2]), Vector3f(extent[0], extent[1], extent[2]));
+        }
+
+        const size_t Chunk = 256;
+
+    }
+
+    BoundingBox PackPositions(const float* src, size_t count, SNorm16x4* dst){
+        if(count == 0) return BoundingBox();
+
+        float lo[3] = {src[0], src[1], src[2]};
+        float hi[3] = {src[0], src[1], src[2]};
+        for(size_t index = 1; index < count; index++){
+            const float* p = src + index * 3;
+            for(int k = 0; k < 3; k++){
+                lo[k] = p[k] < lo[k] ? p[k] : lo[k];
+                hi[k] = p[k] > hi[k] ? p[k] : hi[k];
+            }
+        }
+
+        const BoundingBox bounds = QuantizationBounds(lo, hi);
+        const float* center = bounds.center.data;
+        const float scale[3] = {1.0f / bounds.extent.x, 1.0f / bounds.extent.y, 1.0f / bounds.extent.z};
+
+        // normalize a chunk into a stack buffer, the batch converter rounds and packs it
+        float normalized[Chunk * 4];
+        for(size_t first = 0; first < count; first += Chunk){
+            size_t size = count - first < Chunk ? count - first : Chunk;
+            for(size_t index = 0; index < size; index++){
+                const float* p = src + (first + index) * 3;
+                float* q = normalized + index * 4;
+                q[0] = (p[0] - center[0]) * scale[0];
+                q[1] = (p[1] - center[1]) * scale[1];
+                q[2] = (p[2] - center[2]) * scale[2];
+                q[3] = 0.0f;
+            }
+            ConvertFloatToSNorm16(normalized, dst[first].data, size * 4);
+        }
+
+        return bounds;
+    }
+
+    void PackNormals(const float* src, size_t count, SNorm16x2* dst){
+        EncodeOctahedral(src, dst->data, count);
+    }
+
+    void PackTangents(const float* src, size_t count, SNorm16x4* dst){
+        ConvertFloatToSNorm16(src, dst->data, count * 4);
+    }
+
+    void PackTexCoords(const float* src, size_t count, Half2* dst){
+        ConvertFloatToHalf(src, dst->data, count * 2);
+    }
+
+    BoundingBox PackPositions(const ConstVector3fStream& src, size_t count, SNorm16x4* dst){
+        if(count == 0) return BoundingBox();
+
+        const float* stream[3] = {src.x, src.y, src.z};
+        float lo[3], hi[3];
+        for(int k = 0; k < 3; k++){
+            const float* p = stream[k];
+            float l = p[0], h = p[0];
+            for(size_t index = 1; index < count; index++){
+                l = p[index] < l ? p[index] : l;
+                h = p[index] > h ? p[index] : h;
+            }
+            lo[k] = l;
+            hi[k] = h;
+        }
+
+        const BoundingBox bounds = QuantizationBounds(lo, hi);
+        const float* center = bounds.center.data;
+        const float scale[3] = {1.0f / bounds.extent.x, 1.0f / bounds.extent.y, 1.0f / bounds.extent.z};
+
+        // interleaved while normalizing, as above
+        float normalized[Chunk * 4];
+        for(size_t first = 0; first < count; first += Chunk){
+            size_t size = count - first < Chunk ? count - first : Chunk;
+            for(size_t index = 0; index < size; index++){
+                float* q = normalized + index * 4;
+                q[0] = (src.x[first + index] - center[0]) * scale[0];
+                q[1] = (src.y[first + index] - center[1]) * scale[1];
+                q[2] = (src.z[first + index] - center[2]) * scale[2];
+                q[3] = 0.0f;
+            }
+            ConvertFloatToSNorm16(normalized, dst[first].data, size * 4);
+        }
+
+        return bounds;
+    }
+
+    void PackNormals(const ConstVector3fStream& src, size_t count, SNorm16x2* dst){
+        float interleaved[Chunk * 3];
+        for(size_t first = 0; first < count; first += Chunk){
+            size_t size = count - first < Chunk ? count - first : Chunk;
+            for(size_t index = 0; index < size; index++){
+                float* n = interleaved + index * 3;
+                n[0] = src.x[first + index];
+                n[1] = src.y[first + index];
+                n[2] = src.z[first + index];
+            }
+            EncodeOctahedral(interleaved, dst[first].data, size);
+        }
+    }
+
+    void PackTangents(const ConstVector3fStream& src, const float* signs, size_t count, SNorm16x4* dst){
+        float interleaved[Chunk * 4];
+        for(size_t first = 0; first < count; first += Chunk){
+            size_t size = count - first < Chunk ? count - first : Chunk;
+            for(size_t index = 0; index < size; index++){
+                float* t = interleaved + index * 4;
+                t[0] = src.x[first + index];
+                t[1] = src.y[first + index];
+                t[2] = src.z[first + index];
+                t[3] = signs[first + index];
+            }
+            ConvertFloatToSNorm16(interleaved, dst[first].data, size * 4);
+        }
+    }
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "GeoMath.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GeoMath{
+
+    // Storage types of the compact vertex layout, the GPU expands them in the input assembler
+    struct Half2{
+        uint16_t data[2];
+    };
+
+    struct SNorm16x2{
+        int16_t data[2];
+    };
+
+    struct SNorm16x4{
+        int16_t data[4];
+    };
+
+    static_assert(sizeof(Half2) == 4);
+    static_assert(sizeof(SNorm16x2) == 4);
+    static_assert(sizeof(SNorm16x4) == 8);
+
+    // Positions as snorm16 relative to their bounds, w is 0. Returns the box to dequantize with,
+    // p = q * extent + center, degenerate axes get a small extent so nothing divides by zero.
+    BoundingBox PackPositions(const float* src, size_t count, SNorm16x4* dst);
+
+    // unit normals folded onto the octahedron
+    void PackNormals(const float* src, size_t count, SNorm16x2* dst);
+
+    // xyz in [-1, 1] and the handedness sign in w
+    void PackTangents(const float* src, size_t count, SNorm16x4* dst);
+
+    void PackTexCoords(const float* src, size_t count, Half2* dst);
+
+    struct ConstVector3fStream;
+
+    // the same from SoA streams, as the skinning kernels write them. Tangents take the
+    // handedness from signs, which skinning does not change.
+    BoundingBox PackPositions(const ConstVector3fStream& src, size_t count, SNorm16x4* dst);
+    void PackNormals(const ConstVector3fStream& src, size_t count, SNorm16x2* dst);
+    void PackTangents(const ConstVector3fStream& src, const float* signs, size_t count, SNorm16x4* dst);
+
+}
@@ -0,0 +1,29 @@
+#include "RedrawTracker.hpp"
+
+#include <cmath>
+
+namespace Utility{
+
+    RedrawTracker::RedrawTracker()
+        : m_framesToConverge(1)
+        , m_framesSinceChange(0)
+    {
+    }
+
+    void RedrawTracker::SetAccumulation(bool isEnabled, float alpha){
+        m_framesToConverge = isEnabled ? FramesToConverge(alpha, Threshold) : 1;
+    }
+
+    void RedrawTracker::OnFrameRendered(){
+        if(m_framesSinceChange < MaxFrames) m_framesSinceChange++;
+    }
+
+    uint32_t RedrawTracker::FramesToConverge(float alpha, float threshold){
+        // a blend that takes all of the new frame or none of it settles in one
+        if(alpha >= 1.0f || alpha <= 0.0f) return 1;
+
+        double frames = std::ceil(std::log(double(threshold)) / std::log(1.0 - double(alpha)));
+        return frames < double(MaxFrames) ? static_cast<uint32_t>(frames) : MaxFrames;
+    }
+
+}
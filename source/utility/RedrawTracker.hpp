@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+namespace Utility{
+
+    // Tells whether a frame would differ from the one on screen. A change restarts the count of frames
+    // still to render: one without temporal accumulation, with it as many as it takes the picture from
+    // before the change to weigh less than the threshold in the blend, (1 - alpha)^n < threshold.
+    class RedrawTracker{
+    public:
+        RedrawTracker();
+
+        // something the picture depends on changed, the scene, the view, the input or a setting
+        void Invalidate() { m_framesSinceChange = 0; }
+
+        // blend of the new frame into the history, new * alpha + history * (1 - alpha)
+        void SetAccumulation(bool isEnabled, float alpha);
+
+        bool IsRedrawNeeded() const { return m_framesSinceChange < m_framesToConverge; }
+        void OnFrameRendered();
+
+        uint32_t GetFramesToConverge() const { return m_framesToConverge; }
+        uint32_t GetFramesSinceChange() const { return m_framesSinceChange; }
+
+        static uint32_t FramesToConverge(float alpha, float threshold);
+
+        // a quantization step of an 8 bit target
+        inline static const float Threshold = 1.0f / 255.0f;
+        // blends that slow are cut off, they would keep the frame rendering for seconds
+        inline static const uint32_t MaxFrames = 512;
+
+    protected:
+        uint32_t m_framesToConverge;
+        uint32_t m_framesSinceChange;
+    };
+
+}
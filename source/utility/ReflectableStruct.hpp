@@ -11,7 +11,11 @@ namespace rtti{
 		enum class ScaleType : uint8_t{
 			Float,
 			Int,
-			UInt
+			UInt,
+			// 16 bit scales, kept after the 32 bit ones
+			Half,
+			SNorm16,
+			UNorm16
 		};
 
 		ScaleType scale;
@@ -19,7 +23,8 @@ namespace rtti{
 		uint8_t semanticIndex;
 		const char* semantic;
 
-		size_t GetSize() const { return static_cast<size_t>(dimension) * 4; }
+		size_t GetScaleSize() const { return scale >= ScaleType::Half ? 2 : 4; }
+		size_t GetSize() const { return static_cast<size_t>(dimension) * GetScaleSize(); }
 	};
 
 	enum class StructType : uint8_t{
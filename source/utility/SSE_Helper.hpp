@@ -47,3 +47,24 @@ inline __m128 Mat2MulAdj(__m128 vec1, __m128 vec2)
 	);
 }
 
+// 1/sqrt(vec) from the hardware estimate refined by one Newton-Raphson step
+// r' = 0.5 * r * (3 - vec * r * r)
+inline __m128 VecRsqrtNR(__m128 vec)
+{
+	__m128 r = _mm_rsqrt_ps(vec);
+	return _mm_mul_ps(
+		_mm_mul_ps(_mm_set1_ps(0.5f), r),
+		_mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(vec, r), r))
+	);
+}
+
+// quaternion product a*b, (x, y, z, w) layout
+// xyz = aw*b + bw*a + a x b, w = aw*bw - dot(a, b)
+inline __m128 QuatMul(__m128 a, __m128 b)
+{
+	const __m128 signW = _mm_set_ps(-0.0f, 0.0f, 0.0f, 0.0f);
+	__m128 r = _mm_mul_ps(VecSwizzle1(a, 3), b);
+	r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(VecSwizzle(a, 0, 1, 2, 0), VecSwizzle(b, 3, 3, 3, 0)), signW));
+	r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(VecSwizzle(a, 1, 2, 0, 1), VecSwizzle(b, 2, 0, 1, 1)), signW));
+	return _mm_sub_ps(r, _mm_mul_ps(VecSwizzle(a, 2, 0, 1, 2), VecSwizzle(b, 1, 2, 0, 2)));
+}
@@ -0,0 +1,99 @@
+#include "WorkerPool.hpp"
+
+namespace Utility{
+
+    WorkerPool::WorkerPool(uint32_t threadCount)
+        : m_generation(0)
+        , m_pending(0)
+        , m_isExit(false)
+        , m_func(nullptr)
+        , m_count(0)
+        , m_grain(1)
+        , m_next(0)
+    {
+        if(threadCount == 0) threadCount = std::thread::hardware_concurrency();
+        if(threadCount == 0) threadCount = 1;
+
+        m_workers.reserve(threadCount - 1);
+        for(uint32_t i = 1; i < threadCount; i++){
+            m_workers.emplace_back(&WorkerPool::WorkerLoop, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool(){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isExit = true;
+        }
+        m_wake.notify_all();
+
+        for(auto& worker : m_workers){
+            worker.join();
+        }
+    }
+
+    WorkerPool& WorkerPool::GetInstance(){
+        static WorkerPool s_instance;
+        return s_instance;
+    }
+
+    void WorkerPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func){
+        if(count == 0) return;
+        if(grain == 0) grain = 1;
+
+        // not worth waking the workers
+        if(m_workers.empty() || count <= grain){
+            func(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func    = &func;
+            m_count   = count;
+            m_grain   = grain;
+            m_pending = static_cast<uint32_t>(m_workers.size());
+            m_next.store(0, std::memory_order_relaxed);
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        RunChunks();
+
+        // every worker checks in, none of them can still be reading this loop when the next one starts
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this](){ return m_pending == 0; });
+        m_func = nullptr;
+    }
+
+    void WorkerPool::WorkerLoop(){
+        uint64_t generation = 0;
+
+        for(;;){
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&](){ return m_isExit || m_generation != generation; });
+                if(m_isExit) return;
+                generation = m_generation;
+            }
+
+            RunChunks();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(--m_pending == 0) m_finished.notify_one();
+            }
+        }
+    }
+
+    void WorkerPool::RunChunks(){
+        for(;;){
+            size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+            if(begin >= m_count) break;
+
+            size_t end = begin + m_grain < m_count ? begin + m_grain : m_count;
+            (*m_func)(begin, end);
+        }
+    }
+
+}
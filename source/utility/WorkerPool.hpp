@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utility{
+
+    // Fixed set of worker threads for data parallel loops. The calling thread takes part,
+    // so a pool of n threads starts n - 1 workers.
+    class WorkerPool{
+    public:
+        // 0 uses every hardware thread
+        explicit WorkerPool(uint32_t threadCount = 0);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        static WorkerPool& GetInstance();
+
+        uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+        // calls func(begin, end) on chunks of at most grain items covering [0, count),
+        // returns once all of them are done. Not reentrant, func must not call ParallelFor.
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func);
+
+    protected:
+        void WorkerLoop();
+        void RunChunks();
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex              m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_finished;
+        uint64_t                m_generation;
+        uint32_t                m_pending;
+        bool                    m_isExit;
+
+        // current loop, written under m_mutex before the generation moves on
+        const std::function<void(size_t, size_t)>* m_func;
+        size_t                                     m_count;
+        size_t                                     m_grain;
+        std::atomic<size_t>                        m_next;
+    };
+
+}